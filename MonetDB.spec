@@ -426,7 +426,9 @@ developer.
 %files client-tests
 %defattr(-,root,root)
 %{_bindir}/arraytest
+%{_bindir}/commitbench
 %{_bindir}/odbcsample1
+%{_bindir}/replaybench
 %{_bindir}/sample0
 %{_bindir}/sample1
 %{_bindir}/sample4
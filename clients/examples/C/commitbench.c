@@ -0,0 +1,133 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Measure the number of small transactions that can be committed per
+ * second by 1, 2, 4, ..., 256 concurrent clients.  Each client inserts
+ * a single row per transaction (autocommit) into a table of its own,
+ * so that the transactions do not conflict.  The clients run from a
+ * single thread: the inserts of all clients are sent before any of the
+ * responses is read, so that the server commits them concurrently.
+ *
+ * The server must allow enough connections, e.g. start it with
+ * --set max_clients=300 for 256 clients.
+ */
+
+#ifdef _MSC_VER
+/* suppress deprecation warning for snprintf */
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <mapi.h>
+
+#ifdef _MSC_VER
+#define snprintf _snprintf
+#endif
+
+#define MAXCLIENTS	256
+
+#define die(dbh,hdl)	do {						\
+				if (hdl)				\
+					mapi_explain_result(hdl,stderr); \
+				else if (dbh)				\
+					mapi_explain(dbh,stderr);	\
+				else					\
+					fprintf(stderr,"command failed\n"); \
+				exit(-1);				\
+			} while (0)
+
+static double
+now(void)
+{
+#ifdef _MSC_VER
+	return GetTickCount() / 1000.0;
+#else
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+int
+main(int argc, char **argv)
+{
+	Mapi dbh[MAXCLIENTS];
+	MapiHdl hdl[MAXCLIENTS], h = NULL;
+	int i, n, port, seconds = 5, maxclients = MAXCLIENTS;
+	char buf[100];
+	double start, elapsed;
+	long commits;
+
+	if (argc < 2 || argc > 4) {
+		printf("usage: commitbench <port> [<seconds> [<maxclients>]]\n");
+		exit(-1);
+	}
+	port = atoi(argv[1]);
+	if (argc > 2)
+		seconds = atoi(argv[2]);
+	if (argc > 3)
+		maxclients = atoi(argv[3]);
+	if (seconds <= 0 || maxclients <= 0 || maxclients > MAXCLIENTS) {
+		fprintf(stderr, "commitbench: bad arguments\n");
+		exit(-1);
+	}
+
+	for (i = 0; i < maxclients; i++) {
+		dbh[i] = mapi_connect("localhost", port, "monetdb", "monetdb", "sql", NULL);
+		if (dbh[i] == NULL || mapi_error(dbh[i]))
+			die(dbh[i], h);
+	}
+
+	for (i = 0; i < maxclients; i++) {
+		snprintf(buf, sizeof(buf), "create table commitbench%d (i int);", i);
+		if ((h = mapi_query(dbh[i], buf)) == NULL || mapi_error(dbh[i]))
+			die(dbh[i], h);
+		mapi_close_handle(h);
+	}
+	h = NULL;
+
+	for (n = 1; n <= maxclients; n *= 2) {
+		commits = 0;
+		start = now();
+		do {
+			for (i = 0; i < n; i++) {
+				snprintf(buf, sizeof(buf), "insert into commitbench%d values (%ld);", i, commits);
+				hdl[i] = mapi_send(dbh[i], buf);
+				if (hdl[i] == NULL || mapi_error(dbh[i]))
+					die(dbh[i], hdl[i]);
+			}
+			for (i = 0; i < n; i++) {
+				if (mapi_read_response(hdl[i]) != MOK ||
+				    mapi_error(dbh[i]))
+					die(dbh[i], hdl[i]);
+				mapi_close_handle(hdl[i]);
+			}
+			commits += n;
+			elapsed = now() - start;
+		} while (elapsed < seconds);
+		printf("%3d clients: %10.1f commits/second\n", n, commits / elapsed);
+		fflush(stdout);
+	}
+
+	for (i = 0; i < maxclients; i++) {
+		snprintf(buf, sizeof(buf), "drop table commitbench%d;", i);
+		if ((h = mapi_query(dbh[i], buf)) == NULL || mapi_error(dbh[i]))
+			die(dbh[i], h);
+		mapi_close_handle(h);
+		mapi_destroy(dbh[i]);
+	}
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Measure how long it takes to replay the write-ahead log after a
+ * crash.  The benchmark runs in two steps:
+ *
+ *	replaybench <port> fill <megabytes>
+ *
+ * inserts about the given amount of data in transactions of a
+ * million rows each and then kills the server (which must run on the
+ * local machine), so that the data is only in the log;
+ *
+ *	replaybench <port> report
+ *
+ * is to be run after the server was restarted, and reports the time
+ * the server spent replaying the log, and the number of rows that
+ * were recovered.
+ *
+ * The server only writes the log to the BATs once every 50 seconds
+ * or so, so the fill step should take less time than that for all of
+ * the data to end up in the log.
+ */
+
+#ifdef _MSC_VER
+/* suppress deprecation warning for snprintf */
+#define _CRT_SECURE_NO_WARNINGS
+#else
+#include <sys/types.h>
+#include <signal.h>
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <mapi.h>
+
+#ifdef _MSC_VER
+#define snprintf _snprintf
+#endif
+
+#define ROWS		1000000
+#define ROWSIZE		52	/* bytes logged per row */
+
+#define die(dbh,hdl)	do {						\
+				if (hdl)				\
+					mapi_explain_result(hdl,stderr); \
+				else if (dbh)				\
+					mapi_explain(dbh,stderr);	\
+				else					\
+					fprintf(stderr,"command failed\n"); \
+				exit(-1);				\
+			} while (0)
+
+static MapiHdl
+query(Mapi dbh, const char *q)
+{
+	MapiHdl hdl;
+
+	if ((hdl = mapi_query(dbh, q)) == NULL || mapi_error(dbh))
+		die(dbh, hdl);
+	return hdl;
+}
+
+static void
+fill(int port, int megabytes)
+{
+	Mapi dbh;
+	MapiHdl hdl;
+	char buf[512];
+	long pid = 0;
+	int i, n = (int) ((long long) megabytes * 1024 * 1024 / ((long long) ROWS * ROWSIZE));
+
+	if (n == 0)
+		n = 1;
+	dbh = mapi_connect("localhost", port, "monetdb", "monetdb", "sql", NULL);
+	if (dbh == NULL || mapi_error(dbh))
+		die(dbh, NULL);
+	mapi_close_handle(query(dbh, "create table replaybench (a int, b bigint, c double, d int, e bigint, f double, g int, h bigint);"));
+	hdl = query(dbh, "select value from sys.environment where name = 'monet_pid';");
+	if (mapi_fetch_row(hdl))
+		pid = atol(mapi_fetch_field(hdl, 0));
+	mapi_close_handle(hdl);
+
+	for (i = 0; i < n; i++) {
+		snprintf(buf, sizeof(buf),
+			 "insert into replaybench select value, "
+			 "cast(value as bigint), cast(value as double), value, "
+			 "cast(value as bigint), cast(value as double), value, "
+			 "cast(value as bigint) "
+			 "from sys.generate_series(cast(%d as int), cast(%d as int));",
+			 i * ROWS, (i + 1) * ROWS);
+		mapi_close_handle(query(dbh, buf));
+	}
+	printf("inserted %d rows (about %d MB of log)\n", n * ROWS, n * (ROWS / 1024) * ROWSIZE / 1024);
+
+#ifdef _MSC_VER
+	printf("kill the server (process %ld) and restart it\n", pid);
+#else
+	if (pid == 0 || kill((pid_t) pid, SIGKILL) < 0) {
+		fprintf(stderr, "replaybench: cannot kill the server\n");
+		exit(-1);
+	}
+	printf("killed the server, restart it\n");
+#endif
+	mapi_destroy(dbh);
+}
+
+static void
+report(int port)
+{
+	Mapi dbh;
+	MapiHdl hdl;
+	char *line, *p;
+
+	dbh = mapi_connect("localhost", port, "monetdb", "monetdb", "mal", NULL);
+	if (dbh == NULL || mapi_error(dbh))
+		die(dbh, NULL);
+	hdl = query(dbh, "(n, v) := status.startupStatistics();\nio.print(n, v);\n");
+	while ((line = mapi_fetch_line(hdl)) != NULL) {
+		if (strstr(line, "\"logger\"") != NULL &&
+		    (p = strrchr(line, ',')) != NULL)
+			printf("replaying the log took %.3f seconds\n", atoll(p + 1) / 1e6);
+	}
+	mapi_close_handle(hdl);
+	mapi_destroy(dbh);
+
+	dbh = mapi_connect("localhost", port, "monetdb", "monetdb", "sql", NULL);
+	if (dbh == NULL || mapi_error(dbh))
+		die(dbh, NULL);
+	hdl = query(dbh, "select count(*) from replaybench;");
+	if (mapi_fetch_row(hdl))
+		printf("recovered %s rows\n", mapi_fetch_field(hdl, 0));
+	mapi_close_handle(hdl);
+	mapi_close_handle(query(dbh, "drop table replaybench;"));
+	mapi_destroy(dbh);
+}
+
+int
+main(int argc, char **argv)
+{
+	if (argc == 4 && strcmp(argv[2], "fill") == 0 && atoi(argv[3]) > 0) {
+		fill(atoi(argv[1]), atoi(argv[3]));
+	} else if (argc == 3 && strcmp(argv[2], "report") == 0) {
+		report(atoi(argv[1]));
+	} else {
+		printf("usage: replaybench <port> fill <megabytes>\n"
+		       "       replaybench <port> report\n");
+		exit(-1);
+	}
+	return 0;
+}
@@ -205,8 +205,8 @@ mo_system_config(opt **Set, int setlen)
 	cfg = mo_find_option(*Set, setlen, "config");
 	if (!cfg)
 		return setlen;
+	/* cfg points into the option set, don't free it */
 	setlen = mo_config_file(Set, setlen, cfg);
-	free(cfg);
 	return setlen;
 }
 
@@ -636,11 +636,13 @@ typedef struct {
 	unsigned int copied:1,	/* a copy of an existing map. */
 		hashash:1,	/* the string heap contains hash values */
 		forcemap:1,	/* force STORE_MMAP even if heap exists */
-		cleanhash:1;	/* string heaps must clean hash */
+		cleanhash:1,	/* string heaps must clean hash */
+		zsave:1;	/* heap is saved compressed (GDKzsave) */
 	storage_t storage;	/* storage mode (mmap/malloc). */
 	storage_t newstorage;	/* new desired storage mode at re-allocation. */
 	bte dirty;		/* specific heap dirty marker */
 	bte farmid;		/* id of farm where heap is located */
+	bte advice;		/* access pattern last advised (MMAP_*) */
 	bat parentid;		/* cache id of VIEW parent bat */
 } Heap;
 
@@ -656,6 +658,7 @@ typedef struct {
 } Hash;
 
 typedef struct Imprints Imprints;
+typedef struct Compressed Compressed;
 
 /*
  * @+ Binary Association Tables
@@ -776,6 +779,8 @@ gdk_export int VALisnil(const ValRecord *v);
  *           Hash   *thash;           // linear chained hash table on tail
  *           Imprints *timprints;     // column imprints index on tail
  *           orderidx torderidx;      // order oid index on tail
+ *           Heap   *tzonemap;        // per-zone min/max of tail
+ *           Compressed *tcompressed; // compressed form of tail
  *  } BAT;
  * @end verbatim
  *
@@ -843,6 +848,8 @@ typedef struct {
 	Hash *hash;		/* hash table */
 	Imprints *imprints;	/* column imprints index */
 	Heap *orderidx;		/* order oid index */
+	Heap *zonemap;		/* min/max per zone */
+	Compressed *compressed;	/* lightweight compressed form */
 
 	PROPrec *props;		/* list of dynamic properties stored in the bat descriptor */
 } COLrec;
@@ -901,6 +908,8 @@ typedef struct BATiter {
 #define tdense		T.dense
 #define tident		T.id
 #define torderidx	T.orderidx
+#define tzonemap	T.zonemap
+#define tcompressed	T.compressed
 #define twidth		T.width
 #define tshift		T.shift
 #define tnonil		T.nonil
@@ -937,7 +946,7 @@ typedef struct BATiter {
  *  HEAPload (Heap *h, str nme,ext, int trunc);
  * @item int
  * @tab
- *  HEAPsave (Heap *h, str nme,ext);
+ *  HEAPsave (Heap *h, str nme,ext, int dosync);
  * @item int
  * @tab
  *  HEAPcopy (Heap *dst,*src);
@@ -947,6 +956,9 @@ typedef struct BATiter {
  * @item int
  * @tab
  *  HEAPwarm (Heap *h);
+ * @item void
+ * @tab
+ *  HEAPadvise (Heap *h, int advice);
  * @end multitable
  *
  *
@@ -1366,6 +1378,12 @@ bat_iterator(BAT *b)
  * @tab BATdirty (BAT *b)
  * @item int
  * @tab BATgetaccess (BAT *b)
+ * @item void
+ * @tab BATadvise (BAT *b, int advice)
+ * @item void
+ * @tab BATprefetch (bat bid)
+ * @item gdk_return
+ * @tab BATsetdiskcompression (BAT *b, int onoff)
  * @end multitable
  *
  * The function BATcount returns the number of associations stored in
@@ -1394,6 +1412,20 @@ bat_iterator(BAT *b)
  * a parent bat).  A special mode is append-only. It is then allowed
  * to insert BUNs at the end of the BAT, but not to modify anything
  * that already was in there.
+ *
+ * BATadvise tells the OS how the tail of the BAT is about to be
+ * accessed: MMAP_SEQUENTIAL for a scan, MMAP_RANDOM for probes at
+ * unpredictable positions, and MMAP_WILLNEED if all of it is going to
+ * be read soon.  This only affects memory mapped heaps.
+ *
+ * BATprefetch asks for the BAT to be loaded and read ahead in the
+ * background, so that the I/O overlaps with whatever the caller does
+ * until it uses the BAT.
+ *
+ * BATsetdiskcompression selects whether the heaps of a persistent BAT
+ * are saved block-compressed, which is worthwhile for columns that
+ * are read rather than appended to.  The heaps are rewritten in the
+ * new form when the BAT is saved next.
  */
 gdk_export BUN BATcount_no_nil(BAT *b);
 gdk_export void BATsetcapacity(BAT *b, BUN cnt);
@@ -1406,6 +1438,9 @@ gdk_export void BAThseqbase(BAT *b, oid o);
 gdk_export void BATtseqbase(BAT *b, oid o);
 gdk_export gdk_return BATsetaccess(BAT *b, int mode);
 gdk_export int BATgetaccess(BAT *b);
+gdk_export void BATadvise(BAT *b, int advice);
+gdk_export void BATprefetch(bat bid);
+gdk_export gdk_return BATsetdiskcompression(BAT *b, int onoff);
 
 
 #define BATdirty(b)	((b)->batCopiedtodisk == 0 || (b)->batDirty ||	\
@@ -1480,6 +1515,7 @@ gdk_export char *GDKfilepath(int farmid, const char *dir, const char *nme, const
 gdk_export gdk_return GDKcreatedir(const char *nme);
 
 gdk_export void OIDXdestroy(BAT *b);
+gdk_export void ZMdestroy(BAT *b);
 
 /*
  * @- Printing
@@ -1938,6 +1974,20 @@ gdk_export lng IMPSimprintsize(BAT *b);
 gdk_export gdk_return BATorderidx(BAT *b, int stable);
 gdk_export gdk_return GDKmergeidx(BAT *b, BAT**a, int n_ar);
 
+/* Zone maps (minimum and maximum value per block of rows) */
+
+gdk_export gdk_return BATzonemap(BAT *b);
+gdk_export lng ZMzonemapsize(BAT *b);
+
+/* Lightweight compression (frame-of-reference with bit packing,
+ * dictionary, or run-length encoding, and bitmaps for candidate
+ * lists) */
+
+gdk_export BAT *BATcompress(BAT *b);
+gdk_export gdk_return BATdecompress(BAT *b);
+gdk_export const char *BATcompression(BAT *b);
+gdk_export BAT *BATmaskcand(BAT *s);
+
 /*
  * @- Multilevel Storage Modes
  *
@@ -1967,6 +2017,10 @@ gdk_export gdk_return GDKmergeidx(BAT *b, BAT**a, int n_ar);
  * @tab GDKstrdup (str s)
  * @item str
  * @tab GDKstrndup (str s, size_t n)
+ * @item void*
+ * @tab GDKarenamalloc (size_t size)
+ * @item void*
+ * @tab GDKarenazalloc (size_t size)
  * @end multitable
  *
  * These utilities are primarily used to maintain control over
@@ -2002,6 +2056,25 @@ gdk_export str GDKstrdup(const char *s)
 gdk_export str GDKstrndup(const char *s, size_t n)
 	__attribute__ ((__warn_unused_result__));
 
+/* The memory arena of a query.  While a thread has an arena (set with
+ * GDKarenaset), GDKarenamalloc and GDKarenazalloc allocate from a pool
+ * of size classes that is kept in the arena; GDKfree returns the
+ * memory to the pool, and GDKarenadestroy releases the pool as a whole
+ * at the end of the query.  Without an arena, or for large sizes, they
+ * are the same as GDKmalloc and GDKzalloc. */
+typedef struct arena Arena;
+
+gdk_export Arena *GDKarenacreate(void);
+gdk_export void GDKarenadestroy(Arena *a);
+gdk_export Arena *GDKarenaset(Arena *a);
+gdk_export size_t GDKarenacached(Arena *a);
+gdk_export void *GDKarenamalloc(size_t size)
+	__attribute__((__malloc__))
+	__attribute__ ((__warn_unused_result__));
+gdk_export void *GDKarenazalloc(size_t size)
+	__attribute__((__malloc__))
+	__attribute__ ((__warn_unused_result__));
+
 #if !defined(NDEBUG) && !defined(STATIC_CODE_ANALYSIS)
 /* In debugging mode, replace GDKmalloc and other functions with a
  * version that optionally prints calling information.
@@ -2450,6 +2523,27 @@ BATdescriptor(bat i)
 		b = BBP_cache(i);
 		if (b == NULL)
 			b = BBPdescriptor(i);
+		if (b && b->tcompressed && b->theap.base == NULL &&
+		    BATdecompress(b) != GDK_SUCCEED) {
+			BBPunfix(i);
+			b = NULL;
+		}
+	}
+	return b;
+}
+
+/* like BATdescriptor, but leaves a compressed BAT compressed; only
+ * for callers that know how to deal with that */
+static inline BAT *
+BATcdescriptor(bat i)
+{
+	BAT *b = NULL;
+
+	if (BBPcheck(i, "BATcdescriptor")) {
+		BBPfix(i);
+		b = BBP_cache(i);
+		if (b == NULL)
+			b = BBPdescriptor(i);
 	}
 	return b;
 }
@@ -2821,6 +2915,10 @@ gdk_export void BATsetprop(BAT *b, int idx, int type, void *v);
 
 gdk_export BAT *BATselect(BAT *b, BAT *s, const void *tl, const void *th, int li, int hi, int anti);
 gdk_export BAT *BATthetaselect(BAT *b, BAT *s, const void *val, const char *op);
+/* like BATselect and BATthetaselect, but a large result may be
+ * returned as a bitmap (see gdk_cand.h) */
+gdk_export BAT *BATmaskselect(BAT *b, BAT *s, const void *tl, const void *th, int li, int hi, int anti);
+gdk_export BAT *BATmaskthetaselect(BAT *b, BAT *s, const void *val, const char *op);
 
 gdk_export BAT *BATconstant(oid hseq, int tt, const void *val, BUN cnt, int role);
 gdk_export gdk_return BATsubcross(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr)
@@ -2835,6 +2933,7 @@ gdk_export gdk_return BATthetajoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl
 gdk_export gdk_return BATsemijoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, int nil_matches, BUN estimate)
 	__attribute__ ((__warn_unused_result__));
 gdk_export BAT *BATdiff(BAT *l, BAT *r, BAT *sl, BAT *sr, int nil_matches, BUN estimate);
+gdk_export BAT *BATbloomselect(BAT *l, BAT *sl, BAT *r, BAT *sr);
 gdk_export gdk_return BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, int nil_matches, BUN estimate)
 	__attribute__ ((__warn_unused_result__));
 gdk_export gdk_return BATbandjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, const void *c1, const void *c2, int li, int hi, BUN estimate)
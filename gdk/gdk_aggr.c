@@ -551,6 +551,13 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 		GDKerror("BATsum: %s\n", err);
 		return GDK_FAIL;
 	}
+	if (b->tcompressed) {
+		if (CMPsummable(b, tp))
+			return CMPsum(res, tp, b, s, skip_nils,
+				      abort_on_error, nil_if_empty);
+		if (BATdecompress(b) != GDK_SUCCEED)
+			return GDK_FAIL;
+	}
 	switch (tp) {
 	case TYPE_bte:
 		* (bte *) res = nil_if_empty ? bte_nil : 0;
@@ -1154,6 +1161,8 @@ BATprod(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, in
 		GDKerror("BATprod: %s\n", err);
 		return GDK_FAIL;
 	}
+	if (b->tcompressed && BATdecompress(b) != GDK_SUCCEED)
+		return GDK_FAIL;
 	switch (tp) {
 	case TYPE_bte:
 		* (bte *) res = nil_if_empty ? bte_nil : (bte) 1;
@@ -2352,6 +2361,8 @@ BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 void *
 BATmin(BAT *b, void *aggr)
 {
+	if (b->tcompressed)
+		return CMPminmax(b, aggr, 0);
 	return BATminmax(b, aggr, do_groupmin);
 }
 
@@ -2366,6 +2377,8 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 void *
 BATmax(BAT *b, void *aggr)
 {
+	if (b->tcompressed)
+		return CMPminmax(b, aggr, 1);
 	return BATminmax(b, aggr, do_groupmax);
 }
 
@@ -2940,3 +2953,1475 @@ BATgroupvariance_population(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
 	return dogroupstdev(NULL, b, g, e, s, tp, skip_nils, 0, 1,
 			    "BATgroupvariance_population");
 }
+
+/* ---------------------------------------------------------------------- */
+/* fused grouping and aggregation */
+
+/* BATgroupaggr groups the values of b (like BATgroup without candidate
+ * list and without existing groups) and at the same time calculates
+ * naggr grouped aggregates: aggregate i is ops[i] (one of
+ * GDK_AGGR_COUNT, GDK_AGGR_SUM, GDK_AGGR_MIN, GDK_AGGR_MAX) of the
+ * values in vals[i], which must be aligned with b, with result type
+ * tps[i].  The results are the same as those of BATgroup followed by
+ * BATgroupcount, BATgroupsum, BATgroupmin, or BATgroupmax using the
+ * groups and extents.
+ *
+ * The input is processed in chunks of GRPAGGR_CHUNK rows.  For each
+ * chunk, the group ids are first found through an open addressing
+ * hash table on the values of b, and then each aggregate is updated in
+ * a tight loop over the chunk.  In this way the group ids and values of
+ * the chunk and the accumulators of its groups stay in the cache while
+ * all aggregates are calculated, instead of each aggregate making a
+ * pass of its own over the group ids.  Aggregates that are not covered
+ * by this (e.g. of variable-sized types, with a result type that needs
+ * a conversion, or with nils that are not skipped) are calculated by
+ * the regular functions afterwards using the groups that were found. */
+
+#define GRPAGGR_CHUNK	1024
+
+struct grpaggr {
+	int op;			/* GDK_AGGR_* */
+	int tp;			/* type of the result */
+	int vtp;		/* base type of the values */
+	int skip_nils;
+	int fused;		/* calculated while grouping */
+	BAT *b;			/* the values */
+	void *acc;		/* accumulators, one per group */
+};
+
+/* can aggregate a be calculated while grouping? */
+static int
+grpaggr_fusable(const struct grpaggr *a, int abort_on_error)
+{
+	int tp = ATOMbasetype(a->tp);
+
+	switch (a->vtp) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		break;
+	default:
+		/* only the number of values in a group is independent
+		 * of the type of the values */
+		return a->op == GDK_AGGR_COUNT && !a->skip_nils &&
+			tp == TYPE_lng;
+	}
+	switch (a->op) {
+	case GDK_AGGR_COUNT:
+		return tp == TYPE_lng;
+	case GDK_AGGR_SUM:
+		if (!a->skip_nils || !abort_on_error)
+			return 0;
+		switch (a->vtp) {
+		case TYPE_bte:
+		case TYPE_sht:
+		case TYPE_int:
+		case TYPE_lng:
+#ifdef HAVE_HGE
+			return tp == TYPE_lng || tp == TYPE_hge;
+		case TYPE_hge:
+			return tp == TYPE_hge;
+#else
+			return tp == TYPE_lng;
+#endif
+		case TYPE_flt:
+			return tp == TYPE_flt || tp == TYPE_dbl;
+		case TYPE_dbl:
+			return tp == TYPE_dbl;
+		}
+		return 0;
+	case GDK_AGGR_MIN:
+	case GDK_AGGR_MAX:
+		return a->skip_nils && tp == a->vtp;
+	}
+	return 0;
+}
+
+#define GRPAGGR_CNT(TYPE)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(a->b, 0); \
+		lng *restrict acc = (lng *) a->acc;			\
+		for (i = lo; i < hi; i++)				\
+			if (vals[i] != TYPE##_nil)			\
+				acc[gids[i]]++;				\
+	} while (0)
+
+#define GRPAGGR_SUM(TYPE1, TYPE2)					\
+	do {								\
+		const TYPE1 *restrict vals = (const TYPE1 *) Tloc(a->b, 0); \
+		TYPE2 *restrict acc = (TYPE2 *) a->acc;			\
+		for (i = lo; i < hi; i++) {				\
+			if (vals[i] != TYPE1##_nil) {			\
+				g = gids[i];				\
+				if (acc[g] == TYPE2##_nil)		\
+					acc[g] = (TYPE2) vals[i];	\
+				else					\
+					ADD_WITH_CHECK(TYPE1, vals[i],	\
+						       TYPE2, acc[g],	\
+						       TYPE2, acc[g],	\
+						       GDK_##TYPE2##_max, \
+						       goto overflow);	\
+			}						\
+		}							\
+	} while (0)
+
+#define GRPAGGR_MINMAX(TYPE, OP)					\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(a->b, 0); \
+		TYPE *restrict acc = (TYPE *) a->acc;			\
+		for (i = lo; i < hi; i++) {				\
+			if (vals[i] != TYPE##_nil) {			\
+				g = gids[i];				\
+				if (acc[g] == TYPE##_nil || vals[i] OP acc[g]) \
+					acc[g] = vals[i];		\
+			}						\
+		}							\
+	} while (0)
+
+/* update the accumulators of aggregate a with the values at positions
+ * [lo,hi), of which the group ids are in gids */
+static gdk_return
+grpaggr_chunk(struct grpaggr *a, const oid *restrict gids, BUN lo, BUN hi)
+{
+	BUN i, nils = 0;	/* nils is used by ADD_WITH_CHECK */
+	oid g;
+	const int abort_on_error = 1; /* sums are only fused if set */
+
+	switch (a->op) {
+	case GDK_AGGR_COUNT:
+		if (!a->skip_nils) {
+			for (i = lo; i < hi; i++)
+				((lng *) a->acc)[gids[i]]++;
+			break;
+		}
+		switch (a->vtp) {
+		case TYPE_bte:
+			GRPAGGR_CNT(bte);
+			break;
+		case TYPE_sht:
+			GRPAGGR_CNT(sht);
+			break;
+		case TYPE_int:
+			GRPAGGR_CNT(int);
+			break;
+		case TYPE_lng:
+			GRPAGGR_CNT(lng);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			GRPAGGR_CNT(hge);
+			break;
+#endif
+		case TYPE_flt:
+			GRPAGGR_CNT(flt);
+			break;
+		case TYPE_dbl:
+			GRPAGGR_CNT(dbl);
+			break;
+		}
+		break;
+	case GDK_AGGR_SUM:
+		switch (ATOMbasetype(a->tp)) {
+		case TYPE_lng:
+			switch (a->vtp) {
+			case TYPE_bte:
+				GRPAGGR_SUM(bte, lng);
+				break;
+			case TYPE_sht:
+				GRPAGGR_SUM(sht, lng);
+				break;
+			case TYPE_int:
+				GRPAGGR_SUM(int, lng);
+				break;
+			case TYPE_lng:
+				GRPAGGR_SUM(lng, lng);
+				break;
+			}
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			switch (a->vtp) {
+			case TYPE_bte:
+				GRPAGGR_SUM(bte, hge);
+				break;
+			case TYPE_sht:
+				GRPAGGR_SUM(sht, hge);
+				break;
+			case TYPE_int:
+				GRPAGGR_SUM(int, hge);
+				break;
+			case TYPE_lng:
+				GRPAGGR_SUM(lng, hge);
+				break;
+			case TYPE_hge:
+				GRPAGGR_SUM(hge, hge);
+				break;
+			}
+			break;
+#endif
+		case TYPE_flt:
+			GRPAGGR_SUM(flt, flt);
+			break;
+		case TYPE_dbl:
+			if (a->vtp == TYPE_flt)
+				GRPAGGR_SUM(flt, dbl);
+			else
+				GRPAGGR_SUM(dbl, dbl);
+			break;
+		}
+		break;
+	case GDK_AGGR_MIN:
+		switch (a->vtp) {
+		case TYPE_bte:
+			GRPAGGR_MINMAX(bte, <);
+			break;
+		case TYPE_sht:
+			GRPAGGR_MINMAX(sht, <);
+			break;
+		case TYPE_int:
+			GRPAGGR_MINMAX(int, <);
+			break;
+		case TYPE_lng:
+			GRPAGGR_MINMAX(lng, <);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			GRPAGGR_MINMAX(hge, <);
+			break;
+#endif
+		case TYPE_flt:
+			GRPAGGR_MINMAX(flt, <);
+			break;
+		case TYPE_dbl:
+			GRPAGGR_MINMAX(dbl, <);
+			break;
+		}
+		break;
+	case GDK_AGGR_MAX:
+		switch (a->vtp) {
+		case TYPE_bte:
+			GRPAGGR_MINMAX(bte, >);
+			break;
+		case TYPE_sht:
+			GRPAGGR_MINMAX(sht, >);
+			break;
+		case TYPE_int:
+			GRPAGGR_MINMAX(int, >);
+			break;
+		case TYPE_lng:
+			GRPAGGR_MINMAX(lng, >);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			GRPAGGR_MINMAX(hge, >);
+			break;
+#endif
+		case TYPE_flt:
+			GRPAGGR_MINMAX(flt, >);
+			break;
+		case TYPE_dbl:
+			GRPAGGR_MINMAX(dbl, >);
+			break;
+		}
+		break;
+	}
+	(void) nils;
+	return GDK_SUCCEED;
+
+  overflow:
+	GDKerror("22003!overflow in calculation.\n");
+	return GDK_FAIL;
+}
+
+/* Fibonacci hashing: the top bits of the product are well mixed */
+#define GRPAGGR_MIX(k)	((ulng) (k) * 0x9E3779B97F4A7C15ULL)
+
+#define GRPAGGR_KEY(TYPE)	((ulng) (TYPE) v)
+#ifdef HAVE_HGE
+#define GRPAGGR_KEYhge()	((ulng) v ^ (ulng) (v >> 64))
+#endif
+
+/* the bits of a floating point value, with -0 and 0 the same (they
+ * compare equal) */
+static inline ulng
+grpaggr_keyflt(flt v)
+{
+	unsigned int k = 0;
+
+	if (v != 0)
+		memcpy(&k, &v, sizeof(k));
+	return k;
+}
+
+static inline ulng
+grpaggr_keydbl(dbl v)
+{
+	ulng k = 0;
+
+	if (v != 0)
+		memcpy(&k, &v, sizeof(k));
+	return k;
+}
+
+/* find the group ids of the values of b at positions [lo,hi) */
+#define GRPAGGR_GROUP(TYPE, KEY)					\
+	do {								\
+		const TYPE *restrict keys = (const TYPE *) Tloc(b, 0);	\
+		TYPE v;							\
+		for (i = lo; i < hi; i++) {				\
+			v = keys[i];					\
+			m = GRPAGGR_MIX(KEY);				\
+			for (h = (BUN) (m >> shift);			\
+			     (g = slots[h]) != BUN_NONE &&		\
+				     keys[ext[g]] != v;			\
+			     h = (h + 1) & mask)			\
+				;					\
+			if (g == BUN_NONE) {				\
+				g = ngrp++;				\
+				slots[h] = g;				\
+				ext[g] = i;				\
+				hv[g] = m;				\
+				hcnt[g] = 0;				\
+			}						\
+			gids[i] = g;					\
+			hcnt[g]++;					\
+		}							\
+	} while (0)
+
+gdk_return
+BATgroupaggr(BAT **groups, BAT **extents, BAT **histo, BAT **res, BAT *b,
+	     int naggr, const int *ops, BAT *const *vals, const int *tps,
+	     const int *skip_nils, int abort_on_error)
+{
+	struct grpaggr *aggrs;
+	BAT *gn = NULL, *en = NULL, *hn = NULL, *t;
+	BUN n = BATcount(b), i, lo, hi, ngrp = 0, cap = 0, tsize = 0;
+	BUN mask = 0, h, g, *slots = NULL, *ext = NULL;
+	ulng m, *hv = NULL;
+	lng *cnts = NULL;
+	oid *restrict gids;
+	int k, shift = 64, nfused = 0, tpe = ATOMbasetype(b->ttype);
+	BATiter bi = bat_iterator(b);
+	int (*cmp)(const void *, const void *) = ATOMcompare(b->ttype);
+	BUN (*hash)(const void *) = BATatoms[b->ttype].atomHash;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	for (k = 0; k < naggr; k++) {
+		res[k] = NULL;
+		if (BATcount(vals[k]) != n ||
+		    (n > 0 && vals[k]->hseqbase != b->hseqbase)) {
+			GDKerror("BATgroupaggr: b and vals must be aligned\n");
+			return GDK_FAIL;
+		}
+	}
+	if ((aggrs = GDKzalloc(naggr * sizeof(struct grpaggr) + 1)) == NULL) {
+		GDKerror("BATgroupaggr: cannot allocate enough memory\n");
+		return GDK_FAIL;
+	}
+	for (k = 0; k < naggr; k++) {
+		aggrs[k].op = ops[k];
+		aggrs[k].tp = tps[k];
+		aggrs[k].vtp = ATOMbasetype(vals[k]->ttype);
+		aggrs[k].skip_nils = skip_nils[k];
+		aggrs[k].b = vals[k];
+	}
+
+	if (b->ttype == TYPE_void || hash == NULL) {
+		/* nothing to hash on, so group the regular way */
+		if (BATgroup(&gn, &en, &hn, b, NULL, NULL, NULL, NULL) != GDK_SUCCEED)
+			goto bailout;
+		ngrp = BATcount(en);
+		goto aggregate;
+	}
+
+	for (k = 0; k < naggr; k++)
+		nfused += aggrs[k].fused = grpaggr_fusable(&aggrs[k], abort_on_error);
+
+	if ((gn = COLnew(b->hseqbase, TYPE_oid, n, TRANSIENT)) == NULL)
+		goto bailout;
+	gids = (oid *) Tloc(gn, 0);
+	for (lo = 0; lo < n; lo = hi) {
+		hi = lo + GRPAGGR_CHUNK < n ? lo + GRPAGGR_CHUNK : n;
+		/* make room for all rows of the chunk being new groups */
+		if (ngrp + GRPAGGR_CHUNK > cap && cap < n) {
+			BUN ncap = cap * 2 > ngrp + GRPAGGR_CHUNK ? cap * 2 : ngrp + GRPAGGR_CHUNK;
+			void *p;
+
+			if (ncap > n)
+				ncap = n;
+			if ((p = GDKrealloc(ext, ncap * sizeof(BUN))) == NULL)
+				goto bailout;
+			ext = p;
+			if ((p = GDKrealloc(hv, ncap * sizeof(ulng))) == NULL)
+				goto bailout;
+			hv = p;
+			if ((p = GDKrealloc(cnts, ncap * sizeof(lng))) == NULL)
+				goto bailout;
+			cnts = p;
+			for (k = 0; k < naggr; k++) {
+				struct grpaggr *a = &aggrs[k];
+				int w = a->op == GDK_AGGR_COUNT ? (int) sizeof(lng) : ATOMsize(a->tp);
+				const void *nil = ATOMnilptr(a->tp);
+
+				if (!a->fused)
+					continue;
+				if ((p = GDKrealloc(a->acc, ncap * w)) == NULL)
+					goto bailout;
+				a->acc = p;
+				if (a->op == GDK_AGGR_COUNT)
+					memset((lng *) a->acc + cap, 0, (ncap - cap) * w);
+				else
+					for (i = cap; i < ncap; i++)
+						memcpy((char *) a->acc + i * w, nil, w);
+			}
+			cap = ncap;
+		}
+		/* keep the hash table at most half full */
+		if (2 * (ngrp + GRPAGGR_CHUNK) > tsize) {
+			while (2 * (ngrp + GRPAGGR_CHUNK) > tsize) {
+				shift--;
+				tsize = (BUN) 1 << (64 - shift);
+			}
+			mask = tsize - 1;
+			GDKfree(slots);
+			if ((slots = GDKmalloc(tsize * sizeof(BUN))) == NULL)
+				goto bailout;
+			for (i = 0; i < tsize; i++)
+				slots[i] = BUN_NONE;
+			for (g = 0; g < ngrp; g++) {
+				for (h = (BUN) (hv[g] >> shift);
+				     slots[h] != BUN_NONE;
+				     h = (h + 1) & mask)
+					;
+				slots[h] = g;
+			}
+		}
+		{
+			lng *restrict hcnt = cnts;
+
+			switch (tpe) {
+			case TYPE_bte:
+				GRPAGGR_GROUP(bte, GRPAGGR_KEY(unsigned char));
+				break;
+			case TYPE_sht:
+				GRPAGGR_GROUP(sht, GRPAGGR_KEY(unsigned short));
+				break;
+			case TYPE_int:
+				GRPAGGR_GROUP(int, GRPAGGR_KEY(unsigned int));
+				break;
+			case TYPE_lng:
+				GRPAGGR_GROUP(lng, GRPAGGR_KEY(ulng));
+				break;
+#ifdef HAVE_HGE
+			case TYPE_hge:
+				GRPAGGR_GROUP(hge, GRPAGGR_KEYhge());
+				break;
+#endif
+			case TYPE_flt:
+				GRPAGGR_GROUP(flt, grpaggr_keyflt(v));
+				break;
+			case TYPE_dbl:
+				GRPAGGR_GROUP(dbl, grpaggr_keydbl(v));
+				break;
+			default:
+				for (i = lo; i < hi; i++) {
+					const void *v = BUNtail(bi, i);
+
+					m = GRPAGGR_MIX((*hash)(v));
+					for (h = (BUN) (m >> shift);
+					     (g = slots[h]) != BUN_NONE &&
+						     (*cmp)(v, BUNtail(bi, ext[g])) != 0;
+					     h = (h + 1) & mask)
+						;
+					if (g == BUN_NONE) {
+						g = ngrp++;
+						slots[h] = g;
+						ext[g] = i;
+						hv[g] = m;
+						hcnt[g] = 0;
+					}
+					gids[i] = g;
+					hcnt[g]++;
+				}
+				break;
+			}
+		}
+		for (k = 0; k < naggr; k++)
+			if (aggrs[k].fused &&
+			    grpaggr_chunk(&aggrs[k], gids, lo, hi) != GDK_SUCCEED)
+				goto bailout;
+	}
+	BATsetcount(gn, n);
+	gn->tkey = ngrp == n;
+	gn->tsorted = ngrp <= 1 || n <= 1;
+	gn->trevsorted = n <= 1;
+	gn->tnil = 0;
+	gn->tnonil = 1;
+
+	if ((en = COLnew(0, TYPE_oid, ngrp, TRANSIENT)) == NULL ||
+	    (hn = COLnew(0, TYPE_lng, ngrp, TRANSIENT)) == NULL)
+		goto bailout;
+	for (g = 0; g < ngrp; g++)
+		((oid *) Tloc(en, 0))[g] = b->hseqbase + ext[g];
+	BATsetcount(en, ngrp);
+	en->tsorted = 1;
+	en->trevsorted = ngrp <= 1;
+	en->tkey = 1;
+	en->tnil = 0;
+	en->tnonil = 1;
+	if (ngrp > 0)
+		memcpy(Tloc(hn, 0), cnts, ngrp * sizeof(lng));
+	BATsetcount(hn, ngrp);
+	hn->tsorted = hn->trevsorted = hn->tkey = ngrp <= 1;
+	hn->tnil = 0;
+	hn->tnonil = 1;
+
+  aggregate:
+	for (k = 0; k < naggr; k++) {
+		struct grpaggr *a = &aggrs[k];
+
+		if (a->fused) {
+			int w = a->op == GDK_AGGR_COUNT ? (int) sizeof(lng) : ATOMsize(a->tp);
+			const void *nil = ATOMnilptr(a->tp);
+			BUN nils = 0;
+
+			if ((res[k] = COLnew(0, a->tp, ngrp, TRANSIENT)) == NULL)
+				goto bailout;
+			if (ngrp > 0)
+				memcpy(Tloc(res[k], 0), a->acc, ngrp * w);
+			if (a->op != GDK_AGGR_COUNT)
+				for (g = 0; g < ngrp; g++)
+					nils += memcmp((char *) a->acc + g * w, nil, w) == 0;
+			BATsetcount(res[k], ngrp);
+			res[k]->tkey = res[k]->tsorted = res[k]->trevsorted = ngrp <= 1;
+			res[k]->tnil = nils != 0;
+			res[k]->tnonil = nils == 0;
+			continue;
+		}
+		switch (a->op) {
+		case GDK_AGGR_COUNT:
+			res[k] = BATgroupcount(a->b, gn, en, NULL, a->tp, a->skip_nils, abort_on_error);
+			break;
+		case GDK_AGGR_SUM:
+			res[k] = BATgroupsum(a->b, gn, en, NULL, a->tp, a->skip_nils, abort_on_error);
+			break;
+		case GDK_AGGR_MIN:
+		case GDK_AGGR_MAX:
+			/* BATgroupmin and BATgroupmax return positions */
+			if (a->op == GDK_AGGR_MIN)
+				t = BATgroupmin(a->b, gn, en, NULL, TYPE_oid, a->skip_nils, abort_on_error);
+			else
+				t = BATgroupmax(a->b, gn, en, NULL, TYPE_oid, a->skip_nils, abort_on_error);
+			if (t != NULL) {
+				res[k] = BATproject(t, a->b);
+				BBPunfix(t->batCacheid);
+			}
+			break;
+		default:
+			GDKerror("BATgroupaggr: unknown aggregate\n");
+			break;
+		}
+		if (res[k] == NULL)
+			goto bailout;
+	}
+
+	ALGODEBUG fprintf(stderr, "#BATgroupaggr(b=%s#" BUNFMT "[%s],naggr=%d): "
+			  BUNFMT " groups, %d aggregates fused (" LLFMT " usec)\n",
+			  BATgetId(b), n, ATOMname(b->ttype), naggr, ngrp,
+			  nfused, GDKusec() - t0);
+	for (k = 0; k < naggr; k++)
+		GDKfree(aggrs[k].acc);
+	GDKfree(aggrs);
+	GDKfree(slots);
+	GDKfree(ext);
+	GDKfree(hv);
+	GDKfree(cnts);
+	*groups = gn;
+	if (extents)
+		*extents = en;
+	else
+		BBPunfix(en->batCacheid);
+	if (histo)
+		*histo = hn;
+	else
+		BBPunfix(hn->batCacheid);
+	return GDK_SUCCEED;
+
+  bailout:
+	for (k = 0; k < naggr; k++) {
+		GDKfree(aggrs[k].acc);
+		BBPreclaim(res[k]);
+		res[k] = NULL;
+	}
+	GDKfree(aggrs);
+	GDKfree(slots);
+	GDKfree(ext);
+	GDKfree(hv);
+	GDKfree(cnts);
+	BBPreclaim(gn);
+	BBPreclaim(en);
+	BBPreclaim(hn);
+	return GDK_FAIL;
+}
+
+/* ---------------------------------------------------------------------- */
+/* approximate aggregates */
+
+/* The approximate aggregates summarize the values of each group in a
+ * sketch of bounded size: the number of distinct values is estimated
+ * with a HyperLogLog sketch and quantiles are estimated with a
+ * t-digest.  The sketches of a group that were calculated over
+ * different parts of a column can be merged, so that the parts can be
+ * aggregated in parallel: BATgrouphll and BATgrouptdigest return the
+ * sketches of the groups as strings, and BATgrouphllcount and
+ * BATgrouptdigestquantile merge such strings per group and calculate
+ * the final result from the merged sketch.  Nils are never counted. */
+
+/* the loop over the values of b that are in the candidate list and in
+ * a group of the range [min,max]; gid is set to the group relative to
+ * min (all values are in group 0 if there are no groups) */
+#define APPROX_LOOP(TYPE, ADD)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (;;) {						\
+			if (cand) {					\
+				if (cand == candend)			\
+					break;				\
+				i = *cand++ - b->hseqbase;		\
+				if (i >= end)				\
+					break;				\
+			} else {					\
+				i = start++;				\
+				if (i == end)				\
+					break;				\
+			}						\
+			if (gids == NULL ||				\
+			    (gids[i] >= min && gids[i] <= max)) {	\
+				if (gids)				\
+					gid = gids[i] - min;		\
+				else					\
+					gid = g ? (oid) i : 0;		\
+				if (vals[i] != TYPE##_nil)		\
+					ADD;				\
+			}						\
+		}							\
+	} while (0)
+
+/* HyperLogLog: the hash of each value selects one of HLL_M registers
+ * with its first HLL_P bits, and the register keeps the maximum rank
+ * (position of the first 1 bit) of the remaining bits.  The relative
+ * standard error of the estimate is 1.04/sqrt(HLL_M), i.e. 2.3%.  A
+ * sketch starts out sparse, as a list of the registers that are set,
+ * so that small groups are cheap. */
+#define HLL_P		11
+#define HLL_M		(1 << HLL_P)
+#define HLL_SPARSE	64	/* maximum length of a sparse list */
+
+struct hll {
+	unsigned char *regs;	/* the HLL_M registers, or NULL if sparse */
+	unsigned int *sparse;	/* sparse list: index << 8 | rank */
+	int nsparse, ssize;	/* length and allocated size of the list */
+};
+
+/* finalizer of MurmurHash3: spreads the bits of a value over the hash */
+static inline ulng
+approx_mix(ulng x)
+{
+	x ^= x >> 33;
+	x *= (ulng) LL_CONSTANT(0xff51afd7ed558ccd);
+	x ^= x >> 33;
+	x *= (ulng) LL_CONSTANT(0xc4ceb9fe1a85ec53);
+	x ^= x >> 33;
+	return x;
+}
+
+/* 64 bit FNV-1a hash of a string */
+static inline ulng
+approx_strhash(const char *s)
+{
+	ulng h = (ulng) LL_CONSTANT(0xcbf29ce484222325);
+
+	while (*s) {
+		h ^= (unsigned char) *s++;
+		h *= (ulng) LL_CONSTANT(0x100000001b3);
+	}
+	return h;
+}
+
+#define HLL_KEY(v)	((ulng) (v))
+#define HLL_KEYflt(v)	grpaggr_keyflt(v)
+#define HLL_KEYdbl(v)	grpaggr_keydbl(v)
+#ifdef HAVE_HGE
+#define HLL_KEYhge(v)	((ulng) (v) ^ (ulng) ((v) >> 64))
+#endif
+
+static gdk_return
+hll_dense(struct hll *h)
+{
+	int j;
+
+	if (h->regs)
+		return GDK_SUCCEED;
+	if ((h->regs = GDKzalloc(HLL_M)) == NULL)
+		return GDK_FAIL;
+	for (j = 0; j < h->nsparse; j++)
+		h->regs[h->sparse[j] >> 8] = (unsigned char) (h->sparse[j] & 0xFF);
+	GDKfree(h->sparse);
+	h->sparse = NULL;
+	h->nsparse = h->ssize = 0;
+	return GDK_SUCCEED;
+}
+
+static gdk_return
+hll_set(struct hll *h, unsigned int idx, unsigned int rank)
+{
+	unsigned int *sparse;
+	int j;
+
+	if (h->regs == NULL) {
+		for (j = 0; j < h->nsparse; j++) {
+			if ((h->sparse[j] >> 8) == idx) {
+				if ((h->sparse[j] & 0xFF) < rank)
+					h->sparse[j] = idx << 8 | rank;
+				return GDK_SUCCEED;
+			}
+		}
+		if (h->nsparse < h->ssize) {
+			h->sparse[h->nsparse++] = idx << 8 | rank;
+			return GDK_SUCCEED;
+		}
+		if (h->ssize < HLL_SPARSE) {
+			j = h->ssize == 0 ? 4 : 2 * h->ssize;
+			sparse = GDKrealloc(h->sparse, j * sizeof(unsigned int));
+			if (sparse == NULL)
+				return GDK_FAIL;
+			h->sparse = sparse;
+			h->ssize = j;
+			h->sparse[h->nsparse++] = idx << 8 | rank;
+			return GDK_SUCCEED;
+		}
+		if (hll_dense(h) != GDK_SUCCEED)
+			return GDK_FAIL;
+	}
+	if (h->regs[idx] < rank)
+		h->regs[idx] = (unsigned char) rank;
+	return GDK_SUCCEED;
+}
+
+static inline gdk_return
+hll_add(struct hll *h, ulng x)
+{
+	unsigned int idx = (unsigned int) (x >> (64 - HLL_P));
+	unsigned int rank = 1;
+
+	x <<= HLL_P;
+	while (rank <= 64 - HLL_P && (x & ((ulng) 1 << 63)) == 0) {
+		x <<= 1;
+		rank++;
+	}
+	return hll_set(h, idx, rank);
+}
+
+/* the string representation of a sketch is a 'D' followed by the
+ * HLL_M registers as '0' + rank, or an 'S' followed by three
+ * characters per register in the sparse list (the index in two
+ * characters of 6 bits, and '0' + rank) */
+static void
+hll_tostr(const struct hll *h, char *buf)
+{
+	int j;
+
+	if (h->regs) {
+		*buf++ = 'D';
+		for (j = 0; j < HLL_M; j++)
+			*buf++ = '0' + h->regs[j];
+	} else {
+		*buf++ = 'S';
+		for (j = 0; j < h->nsparse; j++) {
+			*buf++ = '0' + (char) (h->sparse[j] >> 14);
+			*buf++ = '0' + (char) ((h->sparse[j] >> 8) & 0x3F);
+			*buf++ = '0' + (char) (h->sparse[j] & 0xFF);
+		}
+	}
+	*buf = 0;
+}
+
+/* merge the sketch in string s into h */
+static gdk_return
+hll_merge(struct hll *h, const char *s, const char *name)
+{
+	size_t len = strlen(s);
+	unsigned int idx, hi, lo, rank;
+	size_t j;
+
+	if (*s == 'D' && len == HLL_M + 1) {
+		if (hll_dense(h) != GDK_SUCCEED)
+			return GDK_FAIL;
+		for (j = 0; j < HLL_M; j++) {
+			rank = (unsigned char) s[j + 1] - '0';
+			if (rank > 64 - HLL_P + 1)
+				goto invalid;
+			if (h->regs[j] < rank)
+				h->regs[j] = (unsigned char) rank;
+		}
+		return GDK_SUCCEED;
+	}
+	if (*s != 'S' || len % 3 != 1)
+		goto invalid;
+	for (j = 1; j < len; j += 3) {
+		hi = (unsigned char) s[j] - '0';
+		lo = (unsigned char) s[j + 1] - '0';
+		rank = (unsigned char) s[j + 2] - '0';
+		if (hi >= HLL_M >> 6 || lo >= 64 ||
+		    rank < 1 || rank > 64 - HLL_P + 1)
+			goto invalid;
+		idx = hi << 6 | lo;
+		if (hll_set(h, idx, rank) != GDK_SUCCEED)
+			return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
+
+  invalid:
+	GDKerror("%s: invalid HyperLogLog sketch.\n", name);
+	return GDK_FAIL;
+}
+
+static lng
+hll_estimate(const struct hll *h)
+{
+	dbl sum = 0, est;
+	int j, zeros = 0;
+
+	if (h->regs) {
+		for (j = 0; j < HLL_M; j++) {
+			sum += ldexp(1.0, -(int) h->regs[j]);
+			zeros += h->regs[j] == 0;
+		}
+	} else {
+		zeros = HLL_M - h->nsparse;
+		sum = zeros;
+		for (j = 0; j < h->nsparse; j++)
+			sum += ldexp(1.0, -(int) (h->sparse[j] & 0xFF));
+	}
+	est = 0.7213 / (1 + 1.079 / HLL_M) * HLL_M * HLL_M / sum;
+	if (est <= 2.5 * HLL_M && zeros > 0) {
+		/* small range correction: linear counting */
+		est = HLL_M * log((dbl) HLL_M / zeros);
+	}
+	return (lng) (est + 0.5);
+}
+
+/* calculate HyperLogLog sketches per group of the values of b, or, if
+ * merge is set, merge the sketches in b (strings) per group; the result
+ * has type tp: the estimated counts (TYPE_lng) or the sketches
+ * (TYPE_str) */
+static BAT *
+hll_aggr(BAT *b, BAT *g, BAT *e, BAT *s, int merge, int tp, const char *name)
+{
+	const oid *restrict gids;
+	oid gid;
+	oid min, max;
+	BUN i, ngrp;
+	struct hll *hlls = NULL;
+	BAT *bn = NULL;
+	int t;
+	const void *nil;
+	int (*atomcmp)(const void *, const void *);
+	BATiter bi;
+	BUN start, end;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	const void *v;
+	char *buf = NULL;
+
+	assert(tp == TYPE_lng || tp == TYPE_str);
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		GDKerror("%s: %s\n", name, err);
+		return NULL;
+	}
+	if (merge && b->ttype != TYPE_str) {
+		GDKerror("%s: sketches must be strings.\n", name);
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, so return bat aligned with g
+		 * with empty counts or sketches in the tail */
+		lng zero = 0;
+		return BATconstant(ngrp == 0 ? 0 : min, tp,
+				   tp == TYPE_lng ? (const void *) &zero : "S",
+				   ngrp, TRANSIENT);
+	}
+
+	if ((hlls = GDKzalloc(ngrp * sizeof(struct hll))) == NULL)
+		return NULL;
+
+	if (g == NULL || BATtdense(g))
+		gids = NULL;
+	else
+		gids = (const oid *) Tloc(g, 0);
+
+	t = ATOMbasetype(b->ttype);
+	switch (merge ? TYPE_void : t) {
+	case TYPE_bte:
+		APPROX_LOOP(bte, if (hll_add(&hlls[gid], approx_mix(HLL_KEY(vals[i]))) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_sht:
+		APPROX_LOOP(sht, if (hll_add(&hlls[gid], approx_mix(HLL_KEY(vals[i]))) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_int:
+		APPROX_LOOP(int, if (hll_add(&hlls[gid], approx_mix(HLL_KEY(vals[i]))) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_lng:
+		APPROX_LOOP(lng, if (hll_add(&hlls[gid], approx_mix(HLL_KEY(vals[i]))) != GDK_SUCCEED) goto bailout);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		APPROX_LOOP(hge, if (hll_add(&hlls[gid], approx_mix(HLL_KEYhge(vals[i]))) != GDK_SUCCEED) goto bailout);
+		break;
+#endif
+	case TYPE_flt:
+		APPROX_LOOP(flt, if (hll_add(&hlls[gid], approx_mix(HLL_KEYflt(vals[i]))) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_dbl:
+		APPROX_LOOP(dbl, if (hll_add(&hlls[gid], approx_mix(HLL_KEYdbl(vals[i]))) != GDK_SUCCEED) goto bailout);
+		break;
+	default:
+		bi = bat_iterator(b);
+		nil = ATOMnilptr(b->ttype);
+		atomcmp = ATOMcompare(b->ttype);
+
+		for (;;) {
+			if (cand) {
+				if (cand == candend)
+					break;
+				i = *cand++ - b->hseqbase;
+				if (i >= end)
+					break;
+			} else {
+				i = start++;
+				if (i == end)
+					break;
+			}
+			if (gids == NULL ||
+			    (gids[i] >= min && gids[i] <= max)) {
+				if (gids)
+					gid = gids[i] - min;
+				else
+					gid = g ? (oid) i : 0;
+				v = BUNtail(bi, i);
+				if ((*atomcmp)(v, nil) == 0)
+					continue;
+				if (merge) {
+					if (hll_merge(&hlls[gid], v, name) != GDK_SUCCEED)
+						goto bailout;
+				} else if (hll_add(&hlls[gid], approx_mix(t == TYPE_str ? approx_strhash(v) : (ulng) ATOMhash(b->ttype, v))) != GDK_SUCCEED)
+					goto bailout;
+			}
+		}
+		break;
+	}
+
+	bn = COLnew(min, tp, ngrp, TRANSIENT);
+	if (bn == NULL)
+		goto bailout;
+	if (tp == TYPE_lng) {
+		lng *restrict cnts = (lng *) Tloc(bn, 0);
+
+		for (i = 0; i < ngrp; i++)
+			cnts[i] = hll_estimate(&hlls[i]);
+		BATsetcount(bn, ngrp);
+	} else {
+		if ((buf = GDKmalloc(HLL_M + 2)) == NULL)
+			goto bailout;
+		for (i = 0; i < ngrp; i++) {
+			hll_tostr(&hlls[i], buf);
+			if (BUNappend(bn, buf, FALSE) != GDK_SUCCEED)
+				goto bailout;
+		}
+		GDKfree(buf);
+	}
+	for (i = 0; i < ngrp; i++) {
+		GDKfree(hlls[i].regs);
+		GDKfree(hlls[i].sparse);
+	}
+	GDKfree(hlls);
+
+	bn->tkey = BATcount(bn) <= 1;
+	bn->tsorted = BATcount(bn) <= 1;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->tnil = 0;
+	bn->tnonil = 1;
+	return bn;
+
+  bailout:
+	for (i = 0; i < ngrp; i++) {
+		GDKfree(hlls[i].regs);
+		GDKfree(hlls[i].sparse);
+	}
+	GDKfree(hlls);
+	GDKfree(buf);
+	BBPreclaim(bn);
+	return NULL;
+}
+
+/* calculate the approximate number of distinct values per group */
+BAT *
+BATgroupapproxcountdistinct(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+			    int skip_nils, int abort_on_error)
+{
+	assert(tp == TYPE_lng);
+	(void) tp;		/* compatibility (with other BATgroup* */
+	(void) skip_nils;	/* functions) argument */
+	(void) abort_on_error;
+	return hll_aggr(b, g, e, s, 0, TYPE_lng, "BATgroupapproxcountdistinct");
+}
+
+/* calculate the HyperLogLog sketches of the groups */
+BAT *
+BATgrouphll(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+	    int skip_nils, int abort_on_error)
+{
+	assert(tp == TYPE_str);
+	(void) tp;
+	(void) skip_nils;
+	(void) abort_on_error;
+	return hll_aggr(b, g, e, s, 0, TYPE_str, "BATgrouphll");
+}
+
+/* merge the HyperLogLog sketches in b per group and estimate the
+ * number of distinct values */
+BAT *
+BATgrouphllcount(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+		 int skip_nils, int abort_on_error)
+{
+	assert(tp == TYPE_lng);
+	(void) tp;
+	(void) skip_nils;
+	(void) abort_on_error;
+	return hll_aggr(b, g, e, s, 1, TYPE_lng, "BATgrouphllcount");
+}
+
+/* t-digest (merging variant): the values of a group are summarized in
+ * centroids (mean and weight), where the weight of a centroid is
+ * limited by the scale function k(q) = delta/(2 pi) asin(2q - 1) of
+ * the quantiles q it covers: a centroid may only span an increase of 1
+ * in k.  Centroids near the extremes are therefore small, which makes
+ * the estimates of extreme quantiles accurate.  New values are
+ * collected as centroids of weight 1 until there are TDIGEST_BUFFER
+ * centroids, after which all centroids are sorted and merged. */
+#define TDIGEST_DELTA	200
+#define TDIGEST_BUFFER	(5 * TDIGEST_DELTA)
+#define TDIGEST_PI	3.14159265358979323846
+
+struct tdigest {
+	dbl *mean, *weight;	/* the centroids */
+	BUN n, size;		/* number and allocated number of centroids */
+	dbl total;		/* total weight */
+	dbl min, max;		/* smallest and largest value */
+};
+
+/* the largest quantile up to which a centroid that starts at quantile q
+ * may extend */
+static inline dbl
+tdigest_qlimit(dbl q)
+{
+	dbl a;
+
+	if (q >= 1)
+		return 1;
+	a = asin(2 * q - 1) + 2 * TDIGEST_PI / TDIGEST_DELTA;
+	if (a >= TDIGEST_PI / 2)
+		return 1;
+	return (sin(a) + 1) / 2;
+}
+
+static void
+tdigest_compress(struct tdigest *td)
+{
+	BUN i, j;
+	dbl q0, qlimit, w;
+
+	if (td->n <= 1)
+		return;
+	GDKqsort(td->mean, td->weight, NULL, (size_t) td->n,
+		 (int) sizeof(dbl), (int) sizeof(dbl), TYPE_dbl);
+	q0 = 0;
+	qlimit = tdigest_qlimit(q0);
+	for (i = 0, j = 1; j < td->n; j++) {
+		w = td->weight[i] + td->weight[j];
+		if (q0 + w / td->total <= qlimit) {
+			td->mean[i] += (td->mean[j] - td->mean[i]) * td->weight[j] / w;
+			td->weight[i] = w;
+		} else {
+			q0 += td->weight[i] / td->total;
+			qlimit = tdigest_qlimit(q0);
+			i++;
+			td->mean[i] = td->mean[j];
+			td->weight[i] = td->weight[j];
+		}
+	}
+	td->n = i + 1;
+}
+
+static gdk_return
+tdigest_add(struct tdigest *td, dbl mean, dbl weight)
+{
+	if (td->n == td->size) {
+		if (td->size >= TDIGEST_BUFFER) {
+			tdigest_compress(td);
+		} else {
+			BUN size = td->size == 0 ? 16 : 2 * td->size;
+			dbl *m, *w;
+
+			if ((m = GDKrealloc(td->mean, size * sizeof(dbl))) == NULL)
+				return GDK_FAIL;
+			td->mean = m;
+			if ((w = GDKrealloc(td->weight, size * sizeof(dbl))) == NULL)
+				return GDK_FAIL;
+			td->weight = w;
+			td->size = size;
+		}
+	}
+	td->mean[td->n] = mean;
+	td->weight[td->n++] = weight;
+	td->total += weight;
+	return GDK_SUCCEED;
+}
+
+static inline gdk_return
+tdigest_value(struct tdigest *td, dbl v)
+{
+	if (td->total == 0 || v < td->min)
+		td->min = v;
+	if (td->total == 0 || v > td->max)
+		td->max = v;
+	return tdigest_add(td, v, 1);
+}
+
+/* estimate quantile q; the values are numbered 0..total-1 in order,
+ * and the values of a centroid are centered around its mean; when the
+ * nearest centroids are single values, the result is the value that
+ * BATgroupquantile would find */
+static dbl
+tdigest_quantile(struct tdigest *td, dbl q)
+{
+	dbl target, c, cprev, m;
+	BUN i;
+
+	if (td->total == 0)
+		return dbl_nil;
+	tdigest_compress(td);
+	target = q * (td->total - 1);
+	c = (td->weight[0] - 1) / 2;
+	if (target <= c) {
+		if (c <= 0)
+			return td->mean[0];
+		return td->min + (td->mean[0] - td->min) * target / c;
+	}
+	for (i = 1; i < td->n; i++) {
+		cprev = c;
+		c += (td->weight[i - 1] + td->weight[i]) / 2;
+		if (target <= c) {
+			if (td->weight[i - 1] == 1 && td->weight[i] == 1)
+				return target - cprev <= 0.5 ? td->mean[i - 1] : td->mean[i];
+			m = td->mean[i - 1] + (td->mean[i] - td->mean[i - 1]) * (target - cprev) / (c - cprev);
+			return m;
+		}
+	}
+	/* beyond the center of the last centroid */
+	if (td->total - 1 <= c)
+		return td->mean[td->n - 1];
+	return td->mean[td->n - 1] + (td->max - td->mean[td->n - 1]) * (target - c) / (td->total - 1 - c);
+}
+
+/* the string representation of a t-digest consists of the smallest and
+ * largest value followed by the mean and weight of each centroid, each
+ * number as the 16 hexadecimal digits of its bits */
+static char *
+tdigest_putdbl(char *p, dbl v)
+{
+	ulng x;
+	int k;
+
+	memcpy(&x, &v, sizeof(x));
+	for (k = 60; k >= 0; k -= 4)
+		*p++ = "0123456789abcdef"[(x >> k) & 0xF];
+	return p;
+}
+
+static const char *
+tdigest_getdbl(const char *p, dbl *v)
+{
+	ulng x = 0;
+	int k;
+
+	for (k = 0; k < 16; k++, p++) {
+		if (*p >= '0' && *p <= '9')
+			x = x << 4 | (ulng) (*p - '0');
+		else if (*p >= 'a' && *p <= 'f')
+			x = x << 4 | (ulng) (*p - 'a' + 10);
+		else
+			return NULL;
+	}
+	memcpy(v, &x, sizeof(x));
+	return p;
+}
+
+static char *
+tdigest_tostr(struct tdigest *td)
+{
+	char *buf, *p;
+	BUN i;
+
+	tdigest_compress(td);
+	if ((buf = GDKmalloc(32 * (td->n + 1) + 1)) == NULL)
+		return NULL;
+	p = tdigest_putdbl(buf, td->min);
+	p = tdigest_putdbl(p, td->max);
+	for (i = 0; i < td->n; i++) {
+		p = tdigest_putdbl(p, td->mean[i]);
+		p = tdigest_putdbl(p, td->weight[i]);
+	}
+	*p = 0;
+	return buf;
+}
+
+/* merge the t-digest in string s into td */
+static gdk_return
+tdigest_merge(struct tdigest *td, const char *s, const char *name)
+{
+	size_t len = strlen(s);
+	dbl min, max, mean, weight;
+
+	if (len < 64 || len % 32 != 0 ||
+	    (s = tdigest_getdbl(s, &min)) == NULL ||
+	    (s = tdigest_getdbl(s, &max)) == NULL)
+		goto invalid;
+	if (td->total == 0 || min < td->min)
+		td->min = min;
+	if (td->total == 0 || max > td->max)
+		td->max = max;
+	while (*s) {
+		if ((s = tdigest_getdbl(s, &mean)) == NULL ||
+		    (s = tdigest_getdbl(s, &weight)) == NULL ||
+		    !(weight > 0))
+			goto invalid;
+		if (tdigest_add(td, mean, weight) != GDK_SUCCEED)
+			return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
+
+  invalid:
+	GDKerror("%s: invalid t-digest.\n", name);
+	return GDK_FAIL;
+}
+
+/* calculate t-digests per group of the values of b, or, if merge is
+ * set, merge the t-digests in b (strings) per group; the result has
+ * type tp: quantile estimates (TYPE_dbl) or the t-digests (TYPE_str,
+ * nil for groups without values) */
+static BAT *
+tdigest_aggr(BAT *b, BAT *g, BAT *e, BAT *s, int merge, int tp,
+	     double quantile, const char *name)
+{
+	const oid *restrict gids;
+	oid gid;
+	oid min, max;
+	BUN i, ngrp, nils = 0;
+	struct tdigest *tds = NULL;
+	BAT *bn = NULL;
+	BATiter bi;
+	BUN start, end;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	const void *v;
+	char *buf;
+
+	assert(tp == TYPE_dbl || tp == TYPE_str);
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		GDKerror("%s: %s\n", name, err);
+		return NULL;
+	}
+	if (merge && b->ttype != TYPE_str) {
+		GDKerror("%s: t-digests must be strings.\n", name);
+		return NULL;
+	}
+	if (quantile < 0 || quantile > 1) {
+		GDKerror("%s: cannot determine quantile for "
+			 "p=%f (p has to be in [0,1])\n", name, quantile);
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, thus also no quantiles,
+		 * so return bat aligned with g with nil in the tail */
+		return BATconstant(ngrp == 0 ? 0 : min, tp, ATOMnilptr(tp),
+				   ngrp, TRANSIENT);
+	}
+
+	if ((tds = GDKzalloc(ngrp * sizeof(struct tdigest))) == NULL)
+		return NULL;
+
+	if (g == NULL || BATtdense(g))
+		gids = NULL;
+	else
+		gids = (const oid *) Tloc(g, 0);
+
+	switch (merge ? TYPE_str : b->ttype) {
+	case TYPE_bte:
+		APPROX_LOOP(bte, if (tdigest_value(&tds[gid], (dbl) vals[i]) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_sht:
+		APPROX_LOOP(sht, if (tdigest_value(&tds[gid], (dbl) vals[i]) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_int:
+		APPROX_LOOP(int, if (tdigest_value(&tds[gid], (dbl) vals[i]) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_lng:
+		APPROX_LOOP(lng, if (tdigest_value(&tds[gid], (dbl) vals[i]) != GDK_SUCCEED) goto bailout);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		APPROX_LOOP(hge, if (tdigest_value(&tds[gid], (dbl) vals[i]) != GDK_SUCCEED) goto bailout);
+		break;
+#endif
+	case TYPE_flt:
+		APPROX_LOOP(flt, if (tdigest_value(&tds[gid], (dbl) vals[i]) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_dbl:
+		APPROX_LOOP(dbl, if (tdigest_value(&tds[gid], vals[i]) != GDK_SUCCEED) goto bailout);
+		break;
+	case TYPE_str:
+		bi = bat_iterator(b);
+
+		for (;;) {
+			if (cand) {
+				if (cand == candend)
+					break;
+				i = *cand++ - b->hseqbase;
+				if (i >= end)
+					break;
+			} else {
+				i = start++;
+				if (i == end)
+					break;
+			}
+			if (gids == NULL ||
+			    (gids[i] >= min && gids[i] <= max)) {
+				if (gids)
+					gid = gids[i] - min;
+				else
+					gid = g ? (oid) i : 0;
+				v = BUNtail(bi, i);
+				if (strcmp(v, str_nil) != 0 &&
+				    tdigest_merge(&tds[gid], v, name) != GDK_SUCCEED)
+					goto bailout;
+			}
+		}
+		break;
+	default:
+		GDKerror("%s: type %s not supported.\n", name,
+			 ATOMname(b->ttype));
+		goto bailout;
+	}
+
+	bn = COLnew(min, tp, ngrp, TRANSIENT);
+	if (bn == NULL)
+		goto bailout;
+	if (tp == TYPE_dbl) {
+		dbl *restrict qs = (dbl *) Tloc(bn, 0);
+
+		for (i = 0; i < ngrp; i++) {
+			qs[i] = tdigest_quantile(&tds[i], quantile);
+			nils += qs[i] == dbl_nil;
+		}
+		BATsetcount(bn, ngrp);
+	} else {
+		for (i = 0; i < ngrp; i++) {
+			if (tds[i].total == 0) {
+				nils++;
+				if (BUNappend(bn, str_nil, FALSE) != GDK_SUCCEED)
+					goto bailout;
+				continue;
+			}
+			if ((buf = tdigest_tostr(&tds[i])) == NULL)
+				goto bailout;
+			if (BUNappend(bn, buf, FALSE) != GDK_SUCCEED) {
+				GDKfree(buf);
+				goto bailout;
+			}
+			GDKfree(buf);
+		}
+	}
+	for (i = 0; i < ngrp; i++) {
+		GDKfree(tds[i].mean);
+		GDKfree(tds[i].weight);
+	}
+	GDKfree(tds);
+
+	bn->tkey = BATcount(bn) <= 1;
+	bn->tsorted = BATcount(bn) <= 1;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->tnil = nils != 0;
+	bn->tnonil = nils == 0;
+	return bn;
+
+  bailout:
+	for (i = 0; i < ngrp; i++) {
+		GDKfree(tds[i].mean);
+		GDKfree(tds[i].weight);
+	}
+	GDKfree(tds);
+	BBPreclaim(bn);
+	return NULL;
+}
+
+/* calculate the approximate quantile per group */
+BAT *
+BATgroupapproxquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+		       double quantile, int skip_nils, int abort_on_error)
+{
+	assert(tp == TYPE_dbl);
+	(void) tp;		/* compatibility (with other BATgroup* */
+	(void) skip_nils;	/* functions) argument */
+	(void) abort_on_error;
+	return tdigest_aggr(b, g, e, s, 0, TYPE_dbl, quantile,
+			    "BATgroupapproxquantile");
+}
+
+/* calculate the t-digests of the groups */
+BAT *
+BATgrouptdigest(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+		int skip_nils, int abort_on_error)
+{
+	assert(tp == TYPE_str);
+	(void) tp;
+	(void) skip_nils;
+	(void) abort_on_error;
+	return tdigest_aggr(b, g, e, s, 0, TYPE_str, 0.5, "BATgrouptdigest");
+}
+
+/* merge the t-digests in b per group and estimate the quantile */
+BAT *
+BATgrouptdigestquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+			double quantile, int skip_nils, int abort_on_error)
+{
+	assert(tp == TYPE_dbl);
+	(void) tp;
+	(void) skip_nils;
+	(void) abort_on_error;
+	return tdigest_aggr(b, g, e, s, 1, TYPE_dbl, quantile,
+			    "BATgrouptdigestquantile");
+}
@@ -134,6 +134,9 @@ VIEWcreate_(oid seq, BAT *b, int slice_view)
 	bat tp = 0;
 
 	BATcheck(b, "VIEWcreate_", NULL);
+	/* a view shares the tail heap, so it must exist */
+	if (b->tcompressed && BATdecompress(b) != GDK_SUCCEED)
+		return NULL;
 
 	bn = BATcreatedesc(seq, b->ttype, FALSE, TRANSIENT);
 	if (bn == NULL)
@@ -183,6 +186,10 @@ VIEWcreate_(oid seq, BAT *b, int slice_view)
 	bn->timprints = NULL;
 	/* Order OID index */
 	bn->torderidx = NULL;
+	/* zone maps are kept on the parent */
+	bn->tzonemap = NULL;
+	/* the compressed form is not shared */
+	bn->tcompressed = NULL;
 	if (BBPcacheit(bn, 1) != GDK_SUCCEED) {	/* enter in BBP */
 		if (tp)
 			BBPunshare(tp);
@@ -235,6 +242,7 @@ BATmaterialize(BAT *b)
 	HASHdestroy(b);
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
 
 	b->theap.filename = NULL;
 	if (HEAPalloc(&b->theap, cnt, sizeof(oid)) != GDK_SUCCEED) {
@@ -490,6 +498,7 @@ VIEWdestroy(BAT *b)
 	HASHdestroy(b);
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
 	VIEWunlink(b);
 
 	if (b->ttype && !b->theap.parentid) {
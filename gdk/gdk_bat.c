@@ -76,7 +76,10 @@ BATcreatedesc(oid hseq, int tt, int heapnames, int role)
 	assert(tt >= 0);
 	assert(role >= 0 && role < 32);
 
-	bn = GDKzalloc(sizeof(BAT));
+	if (role == TRANSIENT)
+		bn = GDKarenazalloc(sizeof(BAT));
+	else
+		bn = GDKzalloc(sizeof(BAT));
 
 	if (bn == NULL)
 		return NULL;
@@ -109,6 +112,8 @@ BATcreatedesc(oid hseq, int tt, int heapnames, int role)
  	* Default zero for order oid index
  	*/
 	bn->torderidx = 0;
+	bn->tzonemap = NULL;
+	bn->tcompressed = NULL;
 	/*
 	 * fill in heap names, so HEAPallocs can resort to disk for
 	 * very large writes.
@@ -471,7 +476,7 @@ BATextend(BAT *b, BUN newcap)
 	if (b->theap.base &&
 	    HEAPextend(&b->theap, theap_size, b->batRestricted == BAT_READ) != GDK_SUCCEED)
 		return GDK_FAIL;
-	HASHdestroy(b);
+	HASHgrow(b, newcap);
 	IMPSdestroy(b);
 	OIDXdestroy(b);
 	return GDK_SUCCEED;
@@ -505,6 +510,7 @@ BATclear(BAT *b, int force)
 	HASHdestroy(b);
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
 
@@ -571,6 +577,8 @@ BATfree(BAT *b)
 	HASHfree(b);
 	IMPSfree(b);
 	OIDXfree(b);
+	ZMfree(b);
+	CMPdestroy(b);
 	if (b->ttype)
 		HEAPfree(&b->theap, 0);
 	else
@@ -1028,6 +1036,10 @@ BUNappend(BAT *b, const void *t, bit force)
 
 	ALIGNapp(b, "BUNappend", force, GDK_FAIL);
 	b->batDirty = 1;
+	if (b->thash == (Hash *) 1) {
+		/* load the hash so that we can maintain it */
+		(void) BATcheckhash(b);
+	}
 	if (b->thash && b->tvheap)
 		tsize = b->tvheap->size;
 
@@ -1056,12 +1068,12 @@ BUNappend(BAT *b, const void *t, bit force)
 
 	IMPSdestroy(b); /* no support for inserts in imprints yet */
 	OIDXdestroy(b);
+	/* the zone map is extended lazily, but a persisted one must be
+	 * checked against the current count before rows are added */
+	if (b->tzonemap == (Heap *) 1)
+		(void) BATcheckzonemap(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
-	if (b->thash == (Hash *) 1) {
-		/* don't bother first loading the hash to then change it */
-		HASHdestroy(b);
-	}
 	if (b->thash) {
 		HASHins(b, p, t);
 		if (tsize && tsize != b->tvheap->size)
@@ -1120,6 +1132,7 @@ BUNdelete(BAT *b, oid o)
 	}
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
 	HASHdestroy(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
@@ -1160,6 +1173,7 @@ BUNinplace(BAT *b, BUN p, const void *t, bit force)
 		b->tnil = 0;
 	}
 	HASHdestroy(b);
+	ZMdestroy(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
 	Treplacevalue(b, BUNtloc(bi, p), t);
@@ -1381,6 +1395,9 @@ BATsetcount(BAT *b, BUN cnt)
 	assert(b->hseqbase != oid_nil);
 	assert(cnt <= BUN_MAX);
 
+	/* a zone map may cover rows that disappear */
+	if (cnt < b->batCount && b->tzonemap)
+		ZMdestroy(b);
 	b->batCount = cnt;
 	b->batDirtydesc = TRUE;
 	b->theap.free = tailsize(b, cnt);
@@ -1802,6 +1819,13 @@ BATsetaccess(BAT *b, int newmode)
 		if (VIEWreset(b) != GDK_SUCCEED)
 			return GDK_FAIL;
 	}
+	if (b->tcompressed && newmode != BAT_READ) {
+		/* a compressed BAT that can change is no longer
+		 * compressed */
+		if (BATdecompress(b) != GDK_SUCCEED)
+			return GDK_FAIL;
+		CMPdestroy(b);
+	}
 	bakmode = b->batRestricted;
 	bakdirty = b->batDirtydesc;
 	if (bakmode != newmode || (b->batSharecnt && newmode != BAT_READ)) {
@@ -2039,6 +2063,11 @@ BATassertProps(BAT *b)
 	       b->tvheap == NULL ||
 	       (BBPfarms[b->tvheap->farmid].roles & (1 << b->batRole)));
 
+	/* a compressed BAT that was not decompressed has no tail
+	 * values to check */
+	if (b->tcompressed && b->theap.base == NULL)
+		return;
+
 	cmpf = ATOMcompare(b->ttype);
 	nilp = ATOMnilptr(b->ttype);
 
@@ -70,6 +70,7 @@ insert_string_bat(BAT *b, BAT *n, BAT *s, int force)
 	var_t v;		/* value */
 	size_t off;		/* offset within n's string heap */
 	BUN start, end, cnt;
+	BUN first = BATcount(b);	/* position of first new value */
 	const oid *restrict cand = NULL, *candend = NULL;
 
 	assert(b->ttype == TYPE_str);
@@ -396,6 +397,11 @@ insert_string_bat(BAT *b, BAT *n, BAT *s, int force)
 	}
 	b->tvarsized = 1;
 	b->ttype = TYPE_str;
+	if (toff != ~(size_t) 0) {
+		/* the offsets were copied, so the new values still
+		 * need to be added to the hash */
+		HASHappend(b, first);
+	}
 	return GDK_SUCCEED;
       bunins_failed:
 	b->tvarsized = 1;
@@ -476,6 +482,15 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 
 	b->batDirty = 1;
 
+	if (BATcount(b) == 0) {
+		/* don't bother updating the hash if we replace the
+		 * heap */
+		HASHdestroy(b);
+	} else if (b->thash == (Hash *) 1) {
+		/* load the hash so that we can maintain it */
+		(void) BATcheckhash(b);
+	}
+
 	if (cnt > BATcapacity(b) - BUNlast(b)) {
 		/* if needed space exceeds a normal growth extend just
 		 * with what's needed */
@@ -490,13 +505,12 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 
 	IMPSdestroy(b);		/* imprints do not support updates yet */
 	OIDXdestroy(b);
+	/* the zone map is extended after the append, but a persisted
+	 * one must be checked against the current count first */
+	if (b->tzonemap == (Heap *) 1)
+		(void) BATcheckzonemap(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
-	if (b->thash == (Hash *) 1 || BATcount(b) == 0) {
-		/* don't bother first loading the hash to then change
-		 * it, or updating the hash if we replace the heap */
-		HASHdestroy(b);
-	}
 
 	if (b->ttype == TYPE_void) {
 		if (BATtdense(n) && cand == NULL) {
@@ -509,7 +523,9 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 			if (BATcount(b) == 0 && f != oid_nil)
 				BATtseqbase(b, f);
 			if (BATcount(b) + b->tseqbase == f) {
+				r = BUNlast(b);
 				BATsetcount(b, BATcount(b) + cnt);
+				HASHappend(b, r);
 				if (b->tunique)
 					BBPunfix(s->batCacheid);
 				return GDK_SUCCEED;
@@ -524,11 +540,6 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 		}
 	}
 
-	/* if growing too much, remove the hash, else we maintain it */
-	if (BATcheckhash(b) && (2 * b->thash->mask) < (BATcount(b) + cnt)) {
-		HASHdestroy(b);
-	}
-
 	r = BUNlast(b);
 
 	if (BATcount(b) == 0 && cand == NULL) {
@@ -604,13 +615,13 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 		    b->ttype != TYPE_void &&
 		    n->ttype != TYPE_void &&
 		    cand == NULL) {
-			/* use fast memcpy if we can, but then we
-			 * can't maintain the hash */
-			HASHdestroy(b);
+			/* use fast memcpy if we can, and add the
+			 * new values to the hash afterwards */
 			memcpy(Tloc(b, BUNlast(b)),
 			       Tloc(n, start),
 			       cnt * Tsize(n));
 			BATsetcount(b, BATcount(b) + cnt);
+			HASHappend(b, r);
 		} else {
 			BATiter ni = bat_iterator(n);
 
@@ -634,6 +645,7 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 			}
 		}
 	}
+	ZMappend(b);
 	if (b->tunique)
 		BBPunfix(s->batCacheid);
 	return GDK_SUCCEED;
@@ -753,6 +765,7 @@ BATdel(BAT *b, BAT *d)
 	b->tnokey[0] = b->tnokey[1] = 0;
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
+	ZMdestroy(b);
 
 	return GDK_SUCCEED;
 }
@@ -1187,29 +1200,17 @@ BATordered_rev(BAT *b)
 	return b->trevsorted;
 }
 
-/* figure out which sort function is to be called
- * stable sort can produce an error (not enough memory available),
- * "quick" sort does not produce errors */
+/* figure out which sort function is to be called; GDKpsort sorts
+ * large inputs in parallel and otherwise calls the stable or "quick"
+ * sort.  The stable and the parallel sort can produce an error (not
+ * enough memory available), "quick" sort does not produce errors */
 static gdk_return
 do_sort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe,
 	int reverse, int stable)
 {
 	if (n <= 1)		/* trivially sorted */
 		return GDK_SUCCEED;
-	if (reverse) {
-		if (stable) {
-			return GDKssort_rev(h, t, base, n, hs, ts, tpe);
-		} else {
-			GDKqsort_rev(h, t, base, n, hs, ts, tpe);
-		}
-	} else {
-		if (stable) {
-			return GDKssort(h, t, base, n, hs, ts, tpe);
-		} else {
-			GDKqsort(h, t, base, n, hs, ts, tpe);
-		}
-	}
-	return GDK_SUCCEED;
+	return GDKpsort(h, t, base, n, hs, ts, tpe, reverse, stable);
 }
 
 /* Sort the bat b according to both o and g.  The stable and reverse
@@ -1841,6 +1842,9 @@ BATmergecand(BAT *a, BAT *b)
 
 	BATcheck(a, "BATmergecand", NULL);
 	BATcheck(b, "BATmergecand", NULL);
+	if ((a->tcompressed && !CMPmask(a) && BATdecompress(a) != GDK_SUCCEED) ||
+	    (b->tcompressed && !CMPmask(b) && BATdecompress(b) != GDK_SUCCEED))
+		return NULL;
 	assert(ATOMtype(a->ttype) == TYPE_oid);
 	assert(ATOMtype(b->ttype) == TYPE_oid);
 	assert(BATcount(a) <= 1 || a->tsorted);
@@ -1850,6 +1854,12 @@ BATmergecand(BAT *a, BAT *b)
 	assert(a->tnonil);
 	assert(b->tnonil);
 
+	if ((CMPmask(a) && a->theap.base == NULL) ||
+	    (CMPmask(b) && b->theap.base == NULL)) {
+		/* OR the bitmaps */
+		return CMPmaskcombine(a, b, 1);
+	}
+
 	/* we can return a if b is empty (and v.v.) */
 	if (BATcount(a) == 0) {
 		return COLcopy(b, b->ttype, 0, TRANSIENT);
@@ -1971,6 +1981,9 @@ BATintersectcand(BAT *a, BAT *b)
 
 	BATcheck(a, "BATintersectcand", NULL);
 	BATcheck(b, "BATintersectcand", NULL);
+	if ((a->tcompressed && !CMPmask(a) && BATdecompress(a) != GDK_SUCCEED) ||
+	    (b->tcompressed && !CMPmask(b) && BATdecompress(b) != GDK_SUCCEED))
+		return NULL;
 	assert(ATOMtype(a->ttype) == TYPE_oid);
 	assert(ATOMtype(b->ttype) == TYPE_oid);
 	assert(a->tsorted);
@@ -1983,6 +1996,11 @@ BATintersectcand(BAT *a, BAT *b)
 	if (BATcount(a) == 0 || BATcount(b) == 0) {
 		return newdensecand(0, 0);
 	}
+	if ((CMPmask(a) && a->theap.base == NULL) ||
+	    (CMPmask(b) && b->theap.base == NULL)) {
+		/* AND the bitmaps */
+		return CMPmaskcombine(a, b, 0);
+	}
 
 	ai = bat_iterator(a);
 	bi = bat_iterator(b);
@@ -75,6 +75,9 @@
 #include "gdk_private.h"
 #include "gdk_storage.h"
 #include "mutils.h"
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
 
 #ifndef F_OK
 #define F_OK 0
@@ -330,7 +333,7 @@ BBPselectfarm(int role, int type, enum heaptype hptype)
 		role = TRANSIENT;
 #endif
 #ifndef PERSISTENTIDX
-	if (hptype == orderidxheap)
+	if (hptype == orderidxheap || hptype == zonemapheap)
 		role = TRANSIENT;
 #endif
 	for (i = 0; i < MAXFARMS; i++)
@@ -630,8 +633,8 @@ fixwkbheap(void)
 		}
 		HEAPfree(&h1, 0);
 		HEAPfree(&h2, 0);
-		if (HEAPsave(&b->theap, nme, "tail") != GDK_SUCCEED ||
-		    HEAPsave(b->tvheap, nme, "theap") != GDK_SUCCEED)
+		if (HEAPsave(&b->theap, nme, "tail", TRUE) != GDK_SUCCEED ||
+		    HEAPsave(b->tvheap, nme, "theap", TRUE) != GDK_SUCCEED)
 			GDKfatal("fixwkbheap: saving heap failed\n");
 		HEAPfree(&b->theap, 0);
 		HEAPfree(b->tvheap, 0);
@@ -857,12 +860,12 @@ fixstroffheap(BAT *b, int *restrict offsets)
 		if (h2.dirty) {
 			/* in addition, we added an empty string to
 			 * the string heap */
-			if (HEAPsave(&h2, nme, "theap") != GDK_SUCCEED)
+			if (HEAPsave(&h2, nme, "theap", TRUE) != GDK_SUCCEED)
 				GDKfatal("fixstroffheap: saving heap failed\n");
 			HEAPfree(&h2, 0);
 			*b->tvheap = h2;
 		}
-		if (HEAPsave(&h3, nme, "tail") != GDK_SUCCEED)
+		if (HEAPsave(&h3, nme, "tail", TRUE) != GDK_SUCCEED)
 			GDKfatal("fixstroffheap: saving heap failed\n");
 		HEAPfree(&h3, 0);
 		b->theap = h3;
@@ -922,6 +925,73 @@ fixstrbats(void)
 }
 #endif
 
+/*
+ * The BBP.dir file is parsed by hand instead of with sscanf: with
+ * millions of BATs, the repeated scanning of the format strings
+ * dominated the time it took to start the server.  The parse
+ * functions skip leading blanks, and on success store the value and
+ * advance *sp past it.
+ *
+ * Numbers are parsed modulo 2**64, since some values (the nil seqbase)
+ * are written as unsigned numbers.
+ */
+static int
+BBPparselng(const char **sp, lng *v)
+{
+	const char *s = *sp;
+	unsigned long long x = 0;
+	int neg = 0;
+
+	while (*s == ' ')
+		s++;
+	if (*s == '-') {
+		neg = 1;
+		s++;
+	}
+	if (*s < '0' || *s > '9')
+		return 0;
+	do {
+		if (x > (ULLONG_MAX - 9) / 10)
+			return 0;	/* overflow */
+		x = x * 10 + (unsigned) (*s++ - '0');
+	} while (*s >= '0' && *s <= '9');
+	*v = (lng) (neg ? 0 - x : x);
+	*sp = s;
+	return 1;
+}
+
+static int
+BBPparseushort(const char **sp, unsigned short *v)
+{
+	lng x;
+
+	if (!BBPparselng(sp, &x) || x < 0 || x > USHRT_MAX)
+		return 0;
+	*v = (unsigned short) x;
+	return 1;
+}
+
+/* parse a blank separated word of at most size-1 characters */
+static int
+BBPparseword(const char **sp, char *buf, size_t size)
+{
+	const char *s = *sp;
+	size_t n = 0;
+
+	while (*s == ' ')
+		s++;
+	while (*s != ' ' && *s != 0) {
+		if (n == size - 1)
+			return 0;
+		buf[n++] = *s++;
+	}
+	if (n == 0)
+		return 0;
+	buf[n] = 0;
+	*sp = s;
+	return 1;
+}
+
 /*
  * A read only BAT can be shared in a file system by reading its
  * descriptor separately.  The default src=0 is to read the full
@@ -930,6 +1000,7 @@ fixstrbats(void)
 static int
 headheapinit(oid *hseq, const char *buf, bat bid)
 {
+	const char *s = buf;
 	char type[11];
 	unsigned short width;
 	unsigned short var;
@@ -943,15 +1014,20 @@ headheapinit(oid *hseq, const char *buf, bat bid)
 	lng free;
 	lng size;
 	unsigned short storage;
-	int n;
 
-	if (sscanf(buf,
-		   " %10s %hu %hu %hu "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" %hu"
-		   "%n",
-		   type, &width, &var, &properties, &nokey0,
-		   &nokey1, &nosorted, &norevsorted, &base,
-		   &align, &free, &size, &storage,
-		   &n) < 13)
+	if (!BBPparseword(&s, type, sizeof(type)) ||
+	    !BBPparseushort(&s, &width) ||
+	    !BBPparseushort(&s, &var) ||
+	    !BBPparseushort(&s, &properties) ||
+	    !BBPparselng(&s, &nokey0) ||
+	    !BBPparselng(&s, &nokey1) ||
+	    !BBPparselng(&s, &nosorted) ||
+	    !BBPparselng(&s, &norevsorted) ||
+	    !BBPparselng(&s, &base) ||
+	    !BBPparselng(&s, &align) ||
+	    !BBPparselng(&s, &free) ||
+	    !BBPparselng(&s, &size) ||
+	    !BBPparseushort(&s, &storage))
 		GDKfatal("BBPinit: invalid format for BBP.dir\n%s", buf);
 
 	if (strcmp(type, "void") != 0)
@@ -963,12 +1039,13 @@ headheapinit(oid *hseq, const char *buf, bat bid)
 		)
 		GDKfatal("BBPinit: head seqbase out of range (ID = %d, seq = "LLFMT").", (int) bid, base);
 	*hseq = (oid) base;
-	return n;
+	return (int) (s - buf);
 }
 
 static int
-heapinit(BAT *b, const char *buf, int *hashash, const char *HT, int bbpversion, bat bid)
+heapinit(BAT *b, const char *buf, int *vflags, const char *HT, int bbpversion, bat bid)
 {
+	const char *s = buf;
 	int t;
 	char type[11];
 	unsigned short width;
@@ -983,32 +1060,28 @@ heapinit(BAT *b, const char *buf, int *hashash, const char *HT, int bbpversion,
 	lng free;
 	lng size;
 	unsigned short storage;
-	int n;
 
-	(void) bbpversion;	/* could be used to implement compatibility */
-
-	norevsorted = 0; /* default for first case */
-	if (bbpversion <= GDKLIBRARY_TALIGN ?
-	    sscanf(buf,
-		   " %10s %hu %hu %hu "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" %hu"
-		   "%n",
-		   type, &width, &var, &properties, &nokey0,
-		   &nokey1, &nosorted, &norevsorted, &base,
-		   &align, &free, &size, &storage,
-		   &n) < 13 :
-		sscanf(buf,
-		   " %10s %hu %hu %hu "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" %hu"
-		   "%n",
-		   type, &width, &var, &properties, &nokey0,
-		   &nokey1, &nosorted, &norevsorted, &base,
-		   &free, &size, &storage,
-		   &n) < 12)
+	if (!BBPparseword(&s, type, sizeof(type)) ||
+	    !BBPparseushort(&s, &width) ||
+	    !BBPparseushort(&s, &var) ||
+	    !BBPparseushort(&s, &properties) ||
+	    !BBPparselng(&s, &nokey0) ||
+	    !BBPparselng(&s, &nokey1) ||
+	    !BBPparselng(&s, &nosorted) ||
+	    !BBPparselng(&s, &norevsorted) ||
+	    !BBPparselng(&s, &base) ||
+	    /* the alignment is no longer used */
+	    (bbpversion <= GDKLIBRARY_TALIGN && !BBPparselng(&s, &align)) ||
+	    !BBPparselng(&s, &free) ||
+	    !BBPparselng(&s, &size) ||
+	    !BBPparseushort(&s, &storage))
 		GDKfatal("BBPinit: invalid format for BBP.dir\n%s", buf);
 
-	if (properties & ~0x0F81)
+	if (properties & ~0x1F81)
 		GDKfatal("BBPinit: unknown properties are set: incompatible database\n");
-	*hashash = var & 2;
-	var &= ~2;
+	/* the other bits of var describe the var heap */
+	*vflags = var & 6;
+	var &= ~6;
 #ifdef HAVE_HGE
 	if (strcmp(type, "hge") == 0)
 		havehge = 1;
@@ -1052,15 +1125,16 @@ heapinit(BAT *b, const char *buf, int *hashash, const char *HT, int bbpversion,
 	b->theap.newstorage = (storage_t) storage;
 	b->theap.farmid = BBPselectfarm(PERSISTENT, b->ttype, offheap);
 	b->theap.dirty = 0;
+	b->theap.zsave = (properties & 0x1000) != 0;
 	if (b->theap.free > b->theap.size)
 		GDKfatal("BBPinit: \"free\" value larger than \"size\" in heap of bat %d\n", (int) bid);
-	return n;
+	return (int) (s - buf);
 }
 
 static int
-vheapinit(BAT *b, const char *buf, int hashash, bat bid)
+vheapinit(BAT *b, const char *buf, int vflags, bat bid)
 {
-	int n = 0;
+	const char *s = buf;
 	lng free, size;
 	unsigned short storage;
 
@@ -1068,10 +1142,9 @@ vheapinit(BAT *b, const char *buf, int hashash, bat bid)
 		b->tvheap = GDKzalloc(sizeof(Heap));
 		if (b->tvheap == NULL)
 			GDKfatal("BBPinit: cannot allocate memory for heap.");
-		if (sscanf(buf,
-			   " "LLFMT" "LLFMT" %hu"
-			   "%n",
-			   &free, &size, &storage, &n) < 3)
+		if (!BBPparselng(&s, &free) ||
+		    !BBPparselng(&s, &size) ||
+		    !BBPparseushort(&s, &storage))
 			GDKfatal("BBPinit: invalid format for BBP.dir\n%s", buf);
 		b->tvheap->free = (size_t) free;
 		b->tvheap->size = (size_t) size;
@@ -1079,7 +1152,8 @@ vheapinit(BAT *b, const char *buf, int hashash, bat bid)
 		b->tvheap->filename = NULL;
 		b->tvheap->storage = (storage_t) storage;
 		b->tvheap->copied = 0;
-		b->tvheap->hashash = hashash != 0;
+		b->tvheap->hashash = (vflags & 2) != 0;
+		b->tvheap->zsave = (vflags & 4) != 0;
 		b->tvheap->cleanhash = 1;
 		b->tvheap->newstorage = (storage_t) storage;
 		b->tvheap->dirty = 0;
@@ -1088,25 +1162,40 @@ vheapinit(BAT *b, const char *buf, int hashash, bat bid)
 		if (b->tvheap->free > b->tvheap->size)
 			GDKfatal("BBPinit: \"free\" value larger than \"size\" in var heap of bat %d\n", (int) bid);
 	}
-	return n;
+	return (int) (s - buf);
 }
 
 static void
 BBPreadEntries(FILE *fp, int bbpversion)
 {
 	bat bid = 0;
-	char buf[4096];
+	char *buf, *line, *next;
+	size_t len;
+	long pos;
+	struct stat st;
 	BAT *bn;
 
-	/* read the BBP.dir and insert the BATs into the BBP */
-	while (fgets(buf, sizeof(buf), fp) != NULL) {
+	/* read the remainder of the BBP.dir in one go */
+	if ((pos = ftell(fp)) < 0 || fstat(fileno(fp), &st) < 0)
+		GDKfatal("BBPinit: cannot determine size of BBP.dir");
+	len = st.st_size > pos ? (size_t) (st.st_size - pos) : 0;
+	if ((buf = GDKmalloc(len + 1)) == NULL)
+		GDKfatal("BBPinit: cannot allocate memory for BBP.dir");
+	len = fread(buf, 1, len, fp);
+	if (ferror(fp))
+		GDKfatal("BBPinit: cannot read BBP.dir");
+	buf[len] = 0;
+
+	/* insert the BATs into the BBP */
+	for (line = buf; *line; line = next) {
 		lng batid;
 		unsigned short status;
 		char headname[129];
 		char filename[129];
-		unsigned int properties;
-		int lastused;
+		lng properties;
+		lng lastused;
 		int nread;
+		const char *p;
 		char *s, *options = NULL;
 		char logical[1024];
 		lng inserted = 0, deleted = 0, first = 0, count, capacity, base = 0;
@@ -1115,42 +1204,43 @@ BBPreadEntries(FILE *fp, int bbpversion)
 		char tailname[129];
 		unsigned short map_head = 0, map_tail = 0, map_hheap = 0, map_theap = 0;
 #endif
-		int Thashash;
-
-		if ((s = strchr(buf, '\r')) != NULL) {
-			/* convert \r\n into just \n */
-			if (s[1] != '\n')
-				GDKfatal("BBPinit: invalid format for BBP.dir");
-			*s++ = '\n';
-			*s = 0;
-		}
-
-		if (bbpversion <= GDKLIBRARY_INSERTED ?
-		    sscanf(buf,
-			   LLFMT" %hu %128s %128s %128s %d %u "LLFMT" "LLFMT" "LLFMT" "LLFMT" "LLFMT" %hu %hu %hu %hu"
-			   "%n",
-			   &batid, &status, headname, tailname, filename,
-			   &lastused, &properties, &inserted, &deleted, &first,
-			   &count, &capacity, &map_head, &map_tail, &map_hheap,
-			   &map_theap,
-			   &nread) < 16 :
-		    bbpversion <= GDKLIBRARY_HEADED ?
-		    sscanf(buf,
-			   LLFMT" %hu %128s %128s %128s %d %u "LLFMT" "LLFMT" "LLFMT" %hu %hu %hu %hu"
-			   "%n",
-			   &batid, &status, headname, tailname, filename,
-			   &lastused, &properties, &first,
-			   &count, &capacity, &map_head, &map_tail, &map_hheap,
-			   &map_theap,
-			   &nread) < 14 :
-		    sscanf(buf,
-			   LLFMT" %hu %128s %128s %u "LLFMT" "LLFMT" "LLFMT
-			   "%n",
-			   &batid, &status, headname, filename,
-			   &properties,
-			   &count, &capacity, &base,
-			   &nread) < 8)
-			GDKfatal("BBPinit: invalid format for BBP.dir\n%s", buf);
+		int Tvflags;
+
+		if ((s = strchr(line, '\n')) == NULL)
+			GDKfatal("BBPinit: invalid format for BBP.dir\n%s", line);
+		next = s + 1;
+		if (s > line && s[-1] == '\r') {
+			/* accept \r\n as line terminator */
+			s--;
+		}
+		*s = 0;
+
+		p = line;
+		if (!BBPparselng(&p, &batid) ||
+		    !BBPparseushort(&p, &status) ||
+		    !BBPparseword(&p, headname, sizeof(headname)) ||
+		    (bbpversion <= GDKLIBRARY_HEADED &&
+		     !BBPparseword(&p, tailname, sizeof(tailname))) ||
+		    !BBPparseword(&p, filename, sizeof(filename)) ||
+		    (bbpversion <= GDKLIBRARY_HEADED &&
+		     !BBPparselng(&p, &lastused)) ||
+		    !BBPparselng(&p, &properties) ||
+		    (bbpversion <= GDKLIBRARY_INSERTED &&
+		     (!BBPparselng(&p, &inserted) ||
+		      !BBPparselng(&p, &deleted))) ||
+		    (bbpversion <= GDKLIBRARY_HEADED &&
+		     !BBPparselng(&p, &first)) ||
+		    !BBPparselng(&p, &count) ||
+		    !BBPparselng(&p, &capacity) ||
+		    (bbpversion <= GDKLIBRARY_HEADED ?
+		     !BBPparseushort(&p, &map_head) ||
+		     !BBPparseushort(&p, &map_tail) ||
+		     !BBPparseushort(&p, &map_hheap) ||
+		     !BBPparseushort(&p, &map_theap) :
+		     !BBPparselng(&p, &base)) ||
+		    properties < 0 || properties > UINT_MAX)
+			GDKfatal("BBPinit: invalid format for BBP.dir\n%s", line);
+		nread = (int) (p - line);
 
 		/* convert both / and \ path separators to our own DIR_SEP */
 #if DIR_SEP != '/'
@@ -1188,7 +1278,7 @@ BBPreadEntries(FILE *fp, int bbpversion)
 		bn->batCapacity = (BUN) capacity;
 
 		if (bbpversion <= GDKLIBRARY_HEADED) {
-			nread += headheapinit(&bn->hseqbase, buf + nread, bid);
+			nread += headheapinit(&bn->hseqbase, line + nread, bid);
 		} else {
 			if (base < 0
 #if SIZEOF_OID < SIZEOF_LNG
@@ -1198,8 +1288,8 @@ BBPreadEntries(FILE *fp, int bbpversion)
 				GDKfatal("BBPinit: head seqbase out of range (ID = "LLFMT", seq = "LLFMT").", batid, base);
 			bn->hseqbase = (oid) base;
 		}
-		nread += heapinit(bn, buf + nread, &Thashash, "T", bbpversion, bid);
-		nread += vheapinit(bn, buf + nread, Thashash, bid);
+		nread += heapinit(bn, line + nread, &Tvflags, "T", bbpversion, bid);
+		nread += vheapinit(bn, line + nread, Tvflags, bid);
 
 		if (bbpversion <= GDKLIBRARY_NOKEY &&
 		    (bn->tnokey[0] != 0 || bn->tnokey[1] != 0)) {
@@ -1208,10 +1298,10 @@ BBPreadEntries(FILE *fp, int bbpversion)
 			bn->batDirtydesc = 1;
 		}
 
-		if (buf[nread] != '\n' && buf[nread] != ' ')
-			GDKfatal("BBPinit: invalid format for BBP.dir\n%s", buf);
-		if (buf[nread] == ' ')
-			options = buf + nread + 1;
+		if (line[nread] != 0 && line[nread] != ' ')
+			GDKfatal("BBPinit: invalid format for BBP.dir\n%s", line);
+		if (line[nread] == ' ')
+			options = line + nread + 1;
 
 		BBP_desc(bid) = bn;
 		BBP_status(bid) = BBPEXISTING;	/* do we need other status bits? */
@@ -1232,6 +1322,7 @@ BBPreadEntries(FILE *fp, int bbpversion)
 		BBP_refs(bid) = 0;
 		BBP_lrefs(bid) = 1;	/* any BAT we encounter here is persistent, so has a logical reference */
 	}
+	GDKfree(buf);
 }
 
 #ifdef HAVE_HGE
@@ -1379,6 +1470,7 @@ BBPinit(void)
 	str bbpdirstr = GDKfilepath(0, BATDIR, "BBP", "dir");
 	str backupbbpdirstr = GDKfilepath(0, BAKDIR, "BBP", "dir");
 	int i;
+	lng t0 = GDKusec(), t1;
 
 #ifdef NEED_MT_LOCK_INIT
 	MT_lock_init(&GDKunloadLock, "GDKunloadLock");
@@ -1432,8 +1524,10 @@ BBPinit(void)
 	BBPextend(0, FALSE);		/* allocate BBP records */
 	ATOMIC_SET(BBPsize, 1, BBPsizeLock);
 
+	t1 = GDKusec();
 	BBPreadEntries(fp, bbpversion);
 	fclose(fp);
+	GDKstartupphase("bbp.read", GDKusec() - t1);
 
 	if (BBPinithash(0) != GDK_SUCCEED)
 		GDKfatal("BBPinit: BBPinithash failed");
@@ -1443,6 +1537,7 @@ BBPinit(void)
 		GDKfatal("BBPinit: cannot properly prepare process %s. Please check whether your disk is full or write-protected", BAKDIR);
 
 	/* cleanup any leftovers (must be done after BBPrecover) */
+	t1 = GDKusec();
 	for (i = 0; i < MAXFARMS && BBPfarms[i].dirname != NULL; i++) {
 		int j;
 		for (j = 0; j < i; j++) {
@@ -1460,6 +1555,7 @@ BBPinit(void)
 			GDKfree(d);
 		}
 	}
+	GDKstartupphase("bbp.diskscan", GDKusec() - t1);
 
 #ifdef GDKLIBRARY_SORTEDPOS
 	if (bbpversion <= GDKLIBRARY_SORTEDPOS)
@@ -1477,6 +1573,7 @@ BBPinit(void)
 		TMcommit();
 	GDKfree(bbpdirstr);
 	GDKfree(backupbbpdirstr);
+	GDKstartupphase("bbp", GDKusec() - t0);
 	return;
 
       bailout:
@@ -1576,13 +1673,15 @@ heap_entry(FILE *fp, BAT *b)
 		       BUNFMT " " OIDFMT " " SZFMT " " SZFMT " %d",
 		       b->ttype >= 0 ? BATatoms[b->ttype].name : ATOMunknown_name(b->ttype),
 		       b->twidth,
-		       b->tvarsized | (b->tvheap ? b->tvheap->hashash << 1 : 0),
+		       b->tvarsized |
+			   (b->tvheap ? b->tvheap->hashash << 1 | b->tvheap->zsave << 2 : 0),
 		       (unsigned short) b->tsorted |
 			   ((unsigned short) b->trevsorted << 7) |
 			   (((unsigned short) b->tkey & 0x01) << 8) |
 			   ((unsigned short) b->tdense << 9) |
 			   ((unsigned short) b->tnonil << 10) |
-			   ((unsigned short) b->tnil << 11),
+			   ((unsigned short) b->tnil << 11) |
+			   ((unsigned short) b->theap.zsave << 12),
 		       b->tnokey[0],
 		       b->tnokey[1],
 		       b->tnosorted,
@@ -2835,7 +2934,7 @@ BBPsave(BAT *b)
 			ret = BBPbackup(b, FALSE);
 		if (ret == GDK_SUCCEED) {
 			BBPout++;
-			ret = BATsave(b);
+			ret = BATsave(b, TRUE);
 		}
 		/* clearing bits can be done without the lock */
 		BBP_status_off(bid, BBPSAVING, "BBPsave");
@@ -2988,6 +3087,136 @@ dirty_bat(bat *i, int subcommit)
 	return NULL;
 }
 
+/*
+ * @- save-dirty-bats
+ * The dirty persistent BATs of a commit are saved by a number of
+ * threads in parallel.  Where the system allows it (syncfs), the
+ * files are not synced one by one: the writers only start the
+ * write-back of each file, and once all BATs have been written, a
+ * single sync per database farm serves as the barrier before the new
+ * BBP.dir is written.  Otherwise each heap is synced when it is
+ * saved, as before.
+ *
+ * The writers can be held back to gdk_checkpoint_rate megabytes per
+ * second, so that a large checkpoint does not take all I/O bandwidth
+ * away from the queries that run at the same time.  The default, 0,
+ * means no limit.
+ */
+struct checkpoint {
+	MT_Lock lock;
+	BAT **bats;		/* the BATs to be saved */
+	int nbats;
+	int next;		/* the next BAT to be saved */
+	int dosync;		/* sync each heap when saving it */
+	int failed;
+	lng rate;		/* bytes per millisecond, 0: unlimited */
+	lng written;		/* bytes written so far */
+	int t0;			/* when the writers started */
+};
+
+static void
+BBPsaveworker(void *arg)
+{
+	struct checkpoint *cp = arg;
+	BAT *b;
+	lng sz, ahead;
+
+	for (;;) {
+		MT_lock_set(&cp->lock);
+		if (cp->failed || cp->next == cp->nbats) {
+			MT_lock_unset(&cp->lock);
+			return;
+		}
+		b = cp->bats[cp->next++];
+		MT_lock_unset(&cp->lock);
+
+		sz = 0;
+		if (b->batCopiedtodisk == 0 || b->batDirty || b->theap.dirty)
+			sz += (lng) b->theap.free;
+		if (b->tvheap && (b->batCopiedtodisk == 0 || b->batDirty || b->tvheap->dirty))
+			sz += (lng) b->tvheap->free;
+		if (BATsave(b, cp->dosync) != GDK_SUCCEED) {
+			MT_lock_set(&cp->lock);
+			cp->failed = 1;
+			MT_lock_unset(&cp->lock);
+			return;
+		}
+		MT_lock_set(&cp->lock);
+		cp->written += sz;
+		ahead = cp->rate > 0 ? cp->written / cp->rate - (GDKms() - cp->t0) : 0;
+		MT_lock_unset(&cp->lock);
+		if (ahead > 0)
+			MT_sleep_ms((unsigned int) ahead);
+	}
+}
+
+static gdk_return
+BBPsavedirty(int cnt, bat *subcommit, int *nsaved, lng *nbytes)
+{
+	struct checkpoint cp;
+	int idx = 0, n;
+	gdk_return ret = GDK_SUCCEED;
+
+	memset(&cp, 0, sizeof(cp));
+	if ((cp.bats = GDKmalloc(cnt * sizeof(BAT *))) == NULL)
+		return GDK_FAIL;
+	while (++idx < cnt) {
+		bat i = subcommit ? subcommit[idx] : idx;
+
+		if (BBP_status(i) & BBPPERSISTENT) {
+			BAT *b = dirty_bat(&i, subcommit != NULL);
+			if (i <= 0)
+				break;
+			if (b != NULL)
+				cp.bats[cp.nbats++] = b;
+		}
+	}
+	if (idx < cnt) {
+		GDKfree(cp.bats);
+		return GDK_FAIL;
+	}
+
+#ifdef HAVE_SYNCFS
+	cp.dosync = (GDKdebug & FORCEMITOMASK) != 0;
+#else
+	cp.dosync = TRUE;
+#endif
+	cp.rate = (lng) GDKgetenv_int("gdk_checkpoint_rate", 0) * 1024 * 1024 / 1000;
+	cp.t0 = GDKms();
+	n = cp.nbats < GDKnr_threads ? cp.nbats : GDKnr_threads;
+	if (n > 0) {
+		MT_lock_init(&cp.lock, "BBPsavedirty");
+		/* all writers share the one descriptor */
+		GDKparallel(BBPsaveworker, &cp, 0, n);
+		MT_lock_destroy(&cp.lock);
+	}
+	if (cp.failed)
+		ret = GDK_FAIL;
+
+#ifdef HAVE_SYNCFS
+	if (ret == GDK_SUCCEED && !cp.dosync && cp.nbats > 0) {
+		int i, fd;
+
+		for (i = 0; i < MAXFARMS; i++) {
+			if (BBPfarms[i].dirname == NULL ||
+			    (BBPfarms[i].roles & (1 << PERSISTENT)) == 0)
+				continue;
+			if ((fd = open(BBPfarms[i].dirname, O_RDONLY)) < 0 ||
+			    syncfs(fd) < 0) {
+				GDKsyserror("BBPsavedirty: cannot sync %s\n", BBPfarms[i].dirname);
+				ret = GDK_FAIL;
+			}
+			if (fd >= 0)
+				close(fd);
+		}
+	}
+#endif
+	*nsaved = cp.nbats;
+	*nbytes = cp.written;
+	GDKfree(cp.bats);
+	return ret;
+}
+
 /*
  * @- backup-bat
  * Backup-bat moves all files of a BAT to a backup directory. Only
@@ -3283,6 +3512,8 @@ BBPsync(int cnt, bat *subcommit)
 	gdk_return ret = GDK_SUCCEED;
 	int bbpdirty = 0;
 	int t0 = 0, t1 = 0;
+	int nsaved = 0;
+	lng nbytes = 0;
 
 	str bakdir = GDKfilepath(0, NULL, subcommit ? SUBDIR : BAKDIR, NULL);
 	str deldir = GDKfilepath(0, NULL, DELDIR, NULL);
@@ -3324,25 +3555,10 @@ BBPsync(int cnt, bat *subcommit)
 	PERFDEBUG fprintf(stderr, "#BBPsync (move time %d) %d files\n", (t1 = GDKms()) - t0, backup_files);
 
 	/* PHASE 2: save the repository */
-	if (ret == GDK_SUCCEED) {
-		int idx = 0;
+	if (ret == GDK_SUCCEED)
+		ret = BBPsavedirty(cnt, subcommit, &nsaved, &nbytes);
 
-		while (++idx < cnt) {
-			bat i = subcommit ? subcommit[idx] : idx;
-
-			if (BBP_status(i) & BBPPERSISTENT) {
-				BAT *b = dirty_bat(&i, subcommit != NULL);
-				if (i <= 0)
-					break;
-				if (b != NULL && BATsave(b) != GDK_SUCCEED)
-					break;	/* write error */
-			}
-		}
-		if (idx < cnt)
-			ret = GDK_FAIL;
-	}
-
-	PERFDEBUG fprintf(stderr, "#BBPsync (write time %d)\n", (t0 = GDKms()) - t1);
+	PERFDEBUG fprintf(stderr, "#BBPsync (write time %d) %d bats, " LLFMT " bytes\n", (t0 = GDKms()) - t1, nsaved, nbytes);
 
 	if (ret == GDK_SUCCEED) {
 		if (bbpdirty) {
@@ -3753,6 +3969,15 @@ BBPdiskscan(const char *parent, size_t baseoff)
 					b->torderidx = (Heap *) 1;
 #else
 				delete = TRUE;
+#endif
+			} else if (strncmp(p + 1, "tzonemap", 8) == 0) {
+#ifdef PERSISTENTIDX
+				BAT *b = getdesc(bid);
+				delete = b == NULL;
+				if (!delete)
+					b->tzonemap = (Heap *) 1;
+#else
+				delete = TRUE;
 #endif
 			} else if (strncmp(p + 1, "priv", 4) != 0 &&
 				   strncmp(p + 1, "new", 3) != 0 &&
@@ -3763,7 +3988,8 @@ BBPdiskscan(const char *parent, size_t baseoff)
 				   strncmp(p + 1, "hheap", 5) == 0 ||
 				   strncmp(p + 1, "hhash", 5) == 0 ||
 				   strncmp(p + 1, "himprints", 9) == 0 ||
-				   strncmp(p + 1, "horderidx", 9) == 0) {
+				   strncmp(p + 1, "horderidx", 9) == 0 ||
+				   strncmp(p + 1, "hzonemap", 8) == 0) {
 				/* head is VOID, so no head, hheap files, and
 				 * we do not support any indexes on the
 				 * head */
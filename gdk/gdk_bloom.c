@@ -0,0 +1,250 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Bloom filters for sideways information passing.
+ *
+ * When a selective filter on a (small) dimension table feeds a join
+ * with a (large) fact table, most rows of the fact table find no
+ * match.  BATbloomselect builds a Bloom filter over the values of the
+ * inner side of the join and returns a candidate list with only those
+ * rows of the outer side whose value may occur on the inner side.  A
+ * Bloom filter has no false negatives, so using the result as
+ * candidate list for the outer side of an equi-join or semijoin does
+ * not change the result of the join, while the join has far fewer
+ * rows to probe.
+ *
+ * The filter is blocked: each value sets three bits in a single 64
+ * bit word, so that testing a value costs a single memory access.
+ * The filter has about BLOOM_BITS bits per value of the inner side.
+ *
+ * Nils never match (the join must not be asked to match nils).  If
+ * filtering is not expected to pay off, i.e. when the outer side is
+ * small, the inner side is not much smaller than the outer side, or a
+ * sample of the outer side shows that most rows pass the filter, the
+ * candidate list of the outer side is returned unchanged.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_cand.h"
+
+#define BLOOM_BITS	16	/* filter bits per value of the inner side */
+#define BLOOM_MINCNT	((BUN) 1 << 16)	/* minimum size of the outer side */
+#define BLOOM_SAMPLE	((BUN) 4096)	/* rows used to check selectivity */
+
+/* finalizer of MurmurHash3, to spread the bits of the key */
+static inline ulng
+bloommix(ulng x)
+{
+	x ^= x >> 33;
+	x *= (ulng) LL_CONSTANT(0xff51afd7ed558ccd);
+	x ^= x >> 33;
+	x *= (ulng) LL_CONSTANT(0xc4ceb9fe1a85ec53);
+	x ^= x >> 33;
+	return x;
+}
+
+#define BLOOMWORD(h)	((BUN) ((h) >> 32) & mask)
+#define BLOOMBITS(h)	(((ulng) 1 << ((h) & 63)) |		\
+			 ((ulng) 1 << (((h) >> 6) & 63)) |	\
+			 ((ulng) 1 << (((h) >> 12) & 63)))
+
+#define KEY(x)		((ulng) (lng) (x))
+#ifdef HAVE_HGE
+#define KEYhge(x)	((ulng) ((x) >> 64) ^ (ulng) (x))
+#endif
+
+/* position of the k'th candidate of l and r */
+#define LPOS(k)	(lcand ? lcand[k] - l->hseqbase : lstart + (k))
+#define RPOS(k)	(rcand ? rcand[k] - r->hseqbase : rstart + (k))
+
+#define BLOOMBUILD(GET, ISNIL, HASH)					\
+	do {								\
+		for (k = 0; k < rcnt; k++) {				\
+			GET(r, RPOS(k));				\
+			if (!(ISNIL)) {					\
+				h = bloommix(HASH);			\
+				f[BLOOMWORD(h)] |= BLOOMBITS(h);	\
+			}						\
+		}							\
+	} while (0)
+
+#define BLOOMPROBE(GET, ISNIL, HASH, K0, K1)				\
+	do {								\
+		for (k = (K0); k < (K1); k++) {				\
+			p = LPOS(k);					\
+			GET(l, p);					\
+			if (!(ISNIL)) {					\
+				h = bloommix(HASH);			\
+				m = BLOOMBITS(h);			\
+				if ((f[BLOOMWORD(h)] & m) == m)		\
+					o[nr++] = l->hseqbase + p;	\
+			}						\
+		}							\
+	} while (0)
+
+/* build the filter, probe a sample of the outer side, and if the
+ * filter is selective enough, probe the rest of the outer side */
+#define BLOOMSELECT(GET, ISNIL, HASH)					\
+	do {								\
+		BLOOMBUILD(GET, ISNIL, HASH);				\
+		BLOOMPROBE(GET, ISNIL, HASH, 0, nsample);		\
+		if (nr > nsample - nsample / 4) {			\
+			reason = "not selective";			\
+			goto everything;				\
+		}							\
+		BLOOMPROBE(GET, ISNIL, HASH, nsample, lcnt);		\
+	} while (0)
+
+#define GETfix(TYPE, b, pos)	x = ((const TYPE *) Tloc(b, 0))[pos]
+#define GETbte(b, pos)	GETfix(bte, b, pos)
+#define GETsht(b, pos)	GETfix(sht, b, pos)
+#define GETint(b, pos)	GETfix(int, b, pos)
+#define GETlng(b, pos)	GETfix(lng, b, pos)
+#ifdef HAVE_HGE
+#define GEThge(b, pos)	GETfix(hge, b, pos)
+#endif
+#define GETstr(b, pos)	x = (b) == l ? BUNtvar(li, pos) : BUNtvar(ri, pos)
+
+#define BLOOMFIX(TYPE, HASH)						\
+	do {								\
+		TYPE x;							\
+		BLOOMSELECT(GET##TYPE, x == TYPE##_nil, HASH);		\
+	} while (0)
+
+BAT *
+BATbloomselect(BAT *l, BAT *sl, BAT *r, BAT *sr)
+{
+	BUN lstart, lend, lcnt, rstart, rend, rcnt;
+	BUN nwords, nsample, nr = 0, k, p;
+	const oid *lcand, *lcandend, *rcand, *rcandend;
+	ulng *restrict f = NULL, mask, h, m;
+	oid *restrict o;
+	BAT *bn = NULL;
+	int tpe;
+	const char *reason;
+	lng t0 = 0;
+
+	BATcheck(l, "BATbloomselect", NULL);
+	BATcheck(r, "BATbloomselect", NULL);
+	ALGODEBUG t0 = GDKusec();
+
+	if (ATOMtype(l->ttype) != ATOMtype(r->ttype)) {
+		GDKerror("BATbloomselect: type mismatch\n");
+		return NULL;
+	}
+	CANDINIT(l, sl, lstart, lend, lcnt, lcand, lcandend);
+	CANDINIT(r, sr, rstart, rend, rcnt, rcand, rcandend);
+	lcnt = lcand ? (BUN) (lcandend - lcand) : lend - lstart;
+	rcnt = rcand ? (BUN) (rcandend - rcand) : rend - rstart;
+
+	tpe = ATOMbasetype(l->ttype);
+	if (lcnt == 0 || rcnt == 0) {
+		/* no matches possible */
+		ALGODEBUG fprintf(stderr, "#BATbloomselect(l=%s#" BUNFMT
+				  ",r=%s#" BUNFMT "): empty\n",
+				  BATgetId(l), lcnt, BATgetId(r), rcnt);
+		return BATdense(0, 0, 0);
+	}
+	if (lcnt < BLOOM_MINCNT) {
+		reason = "outer too small";
+		goto everything;
+	}
+	if (rcnt > lcnt / 4) {
+		reason = "inner too large";
+		goto everything;
+	}
+	if (BATtdense(l) || BATtdense(r) ||
+	    l->ttype == TYPE_void || r->ttype == TYPE_void) {
+		reason = "dense";
+		goto everything;
+	}
+	switch (tpe) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_str:
+		break;
+	default:
+		/* equality of values may differ from equality of
+		 * their representation */
+		reason = "type";
+		goto everything;
+	}
+
+	for (nwords = 1; nwords * 64 < rcnt * BLOOM_BITS; nwords <<= 1)
+		;
+	mask = nwords - 1;
+	nsample = MIN(lcnt, BLOOM_SAMPLE);
+	if ((f = GDKzalloc(nwords * sizeof(ulng))) == NULL ||
+	    (bn = COLnew(0, TYPE_oid, lcnt, TRANSIENT)) == NULL) {
+		GDKfree(f);
+		return NULL;
+	}
+	o = (oid *) Tloc(bn, 0);
+
+	switch (tpe) {
+	case TYPE_bte:
+		BLOOMFIX(bte, KEY(x));
+		break;
+	case TYPE_sht:
+		BLOOMFIX(sht, KEY(x));
+		break;
+	case TYPE_int:
+		BLOOMFIX(int, KEY(x));
+		break;
+	case TYPE_lng:
+		BLOOMFIX(lng, KEY(x));
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		BLOOMFIX(hge, KEYhge(x));
+		break;
+#endif
+	case TYPE_str: {
+		BATiter li = bat_iterator(l);
+		BATiter ri = bat_iterator(r);
+		const char *x;
+
+		BLOOMSELECT(GETstr, strNil(x), (ulng) strHash(x));
+		break;
+	}
+	}
+	GDKfree(f);
+
+	BATsetcount(bn, nr);
+	bn->tsorted = 1;
+	bn->trevsorted = nr <= 1;
+	bn->tkey = 1;
+	bn->tdense = 0;
+	bn->tnil = 0;
+	bn->tnonil = 1;
+	ALGODEBUG fprintf(stderr, "#BATbloomselect(l=%s#" BUNFMT ",r=%s#" BUNFMT
+			  "): " BUNFMT " bits, selected " BUNFMT
+			  " (" LLFMT " usec)\n",
+			  BATgetId(l), lcnt, BATgetId(r), rcnt,
+			  nwords * 64, nr, GDKusec() - t0);
+	return bn;
+
+  everything:
+	GDKfree(f);
+	if (bn)
+		BBPreclaim(bn);
+	ALGODEBUG fprintf(stderr, "#BATbloomselect(l=%s#" BUNFMT ",r=%s#" BUNFMT
+			  "): no filter (%s)\n",
+			  BATgetId(l), lcnt, BATgetId(r), rcnt, reason);
+	if (sl)
+		return BATslice(sl, 0, BATcount(sl));
+	return BATdense(0, l->hseqbase, BATcount(l));
+}
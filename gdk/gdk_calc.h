@@ -130,6 +130,23 @@ gdk_export BAT *BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nil
 gdk_export BAT *BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile, int skip_nils, int abort_on_error);
 
+/* approximate aggregates, and the mergeable sketches (strings) they
+ * are calculated from */
+gdk_export BAT *BATgroupapproxcountdistinct(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgroupapproxquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgrouphll(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgrouphllcount(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgrouptdigest(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgrouptdigestquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile, int skip_nils, int abort_on_error);
+
+/* aggregates calculated by BATgroupaggr */
+#define GDK_AGGR_COUNT	0
+#define GDK_AGGR_SUM	1
+#define GDK_AGGR_MIN	2
+#define GDK_AGGR_MAX	3
+gdk_export gdk_return BATgroupaggr(BAT **groups, BAT **extents, BAT **histo, BAT **res, BAT *b, int naggr, const int *ops, BAT *const *vals, const int *tps, const int *skip_nils, int abort_on_error)
+	__attribute__ ((__warn_unused_result__));
+
 /* helper function for grouped aggregates */
 gdk_export const char *BATgroupaggrinit(
 	BAT *b, BAT *g, BAT *e, BAT *s,
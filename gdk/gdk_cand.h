@@ -58,3 +58,18 @@
 			}						\
 		}							\
 	} while (0)
+
+/* Besides the dense (VOID) and the materialized (sorted OID) forms, a
+ * large candidate list can be kept as a bitmap over the range of OIDs
+ * from its first to its last candidate (see CMP_MASK in
+ * gdk_compress.c).  Such a list has no tail heap, so CANDINIT cannot
+ * be used on it.  BATselect, BATproject, BATmergecand and
+ * BATintersectcand work on the bitmap directly, where combining two
+ * lists is a bitwise AND or OR of their words; everything else gets
+ * the list through BATdescriptor, which materializes the OIDs.  A
+ * bitmap costs one bit per OID in its range against 64 bits per
+ * candidate, so we only use one if it is at most half the size of the
+ * materialized list. */
+#define CANDMASK_MIN	((BUN) 1 << 16)
+#define CANDmaskworthwhile(n, first, last)				\
+	((ulng) ((last) - (first)) < (ulng) (n) * 32)
@@ -0,0 +1,1375 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Lightweight compression.
+ *
+ * BATcompress creates a read-only copy of a BAT of which the tail is
+ * kept in one of three compressed forms:
+ *
+ * - frame-of-reference with bit packing (FOR) for integer types: each
+ *   value is stored as its difference with the smallest value of the
+ *   column, using only as many bits as the range of the column needs;
+ * - dictionary encoding (DICT) for all linear types: the distinct
+ *   values are stored once in a separate BAT and each row stores the
+ *   bit-packed index of its value in that BAT;
+ * - run-length encoding (RLE) for columns that consist of few runs of
+ *   equal values, such as sorted low-cardinality columns: the value of
+ *   each run is stored in a separate BAT together with the position
+ *   where the run ends.
+ *
+ * The scheme that needs the least space is chosen.  If no scheme
+ * saves at least a quarter of the space of the tail heap, the BAT is
+ * not compressed and a view on it is returned instead.
+ *
+ * A fourth form (MASK) is used for candidate lists: a bitmap with a
+ * bit for each OID from the first to the last candidate.  Bitmaps are
+ * also produced by BATmaskselect and BATmaskcand, and by
+ * BATmergecand and BATintersectcand when given a bitmap, which
+ * combine them a word at a time (see gdk_cand.h).
+ *
+ * A compressed BAT has no tail heap.  BATselect, BATproject (for the
+ * right-hand side), BATmin, BATmax and BATsum understand the
+ * compressed form and work on it directly.  Everything else gets the
+ * BAT through BATdescriptor, which decompresses it into a regular
+ * tail heap first; the compressed form is kept so that the kernels
+ * that understand it can keep using it.  Making the BAT writable
+ * drops the compressed form.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_cand.h"
+
+/* a scheme is only used if it saves at least a quarter of the space */
+#define CMPworthwhile(sz, raw)	((sz) < (raw) - (raw) / 4)
+
+/* only consider a dictionary if FOR needs more bits than this */
+#define CMP_FORBITS		8
+
+#define CMPoid(b, i)	((b)->ttype == TYPE_void ? (b)->tseqbase + (i) : ((const oid *) Tloc((b), 0))[i])
+
+static const char *const CMPnames[] = {
+	[CMP_FOR] = "for",
+	[CMP_DICT] = "dict",
+	[CMP_RLE] = "rle",
+	[CMP_MASK] = "mask",
+};
+
+static int
+CMPbits(ulng v)
+{
+	int bits = 0;
+
+	while (v) {
+		bits++;
+		v >>= 1;
+	}
+	return bits;
+}
+
+/* store and retrieve the i'th code of a sequence of bit-packed codes
+ * of the given width; a code may straddle two words */
+static inline void
+CMPput(ulng *restrict w, int bits, BUN i, ulng v)
+{
+	ulng o = (ulng) i * bits;
+	BUN k = (BUN) (o >> 6);
+	int r = (int) (o & 63);
+
+	w[k] |= v << r;
+	if (r + bits > 64)
+		w[k + 1] |= v >> (64 - r);
+}
+
+static inline ulng
+CMPget(const ulng *restrict w, int bits, BUN i)
+{
+	ulng o = (ulng) i * bits;
+	BUN k = (BUN) (o >> 6);
+	int r = (int) (o & 63);
+	ulng v = w[k] >> r;
+
+	if (r + bits > 64)
+		v |= w[k + 1] << (64 - r);
+	return v & (((ulng) 1 << bits) - 1);
+}
+
+/* index of the run that contains position p */
+static BUN
+CMPrun(const Compressed *c, BUN p)
+{
+	const oid *ends = (const oid *) c->codes.base;
+	BUN lo = 0, hi = c->nvals, m;
+
+	while (lo < hi) {
+		m = (lo + hi) / 2;
+		if (ends[m] <= p)
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	return lo;
+}
+
+static lng
+CMPlng(int tpe, const void *v)
+{
+	switch (tpe) {
+	case TYPE_bte:
+		return *(const bte *) v;
+	case TYPE_sht:
+		return *(const sht *) v;
+	case TYPE_int:
+		return *(const int *) v;
+	default:
+		assert(tpe == TYPE_lng);
+		return *(const lng *) v;
+	}
+}
+
+static gdk_return
+CMPalloc(Compressed *c, size_t nitems, size_t itemsize)
+{
+	if (HEAPalloc(&c->codes, nitems, itemsize) != GDK_SUCCEED)
+		return GDK_FAIL;
+	memset(c->codes.base, 0, c->codes.size);
+	c->codes.free = c->codes.size;
+	return GDK_SUCCEED;
+}
+
+static void
+CMPfree(Compressed *c)
+{
+	HEAPfree(&c->codes, 0);
+	if (c->vals)
+		BBPunfix(c->vals->batCacheid);
+	GDKfree(c);
+}
+
+/* collect the values at the given positions of b in a new read-only
+ * BAT */
+static BAT *
+CMPvals(BAT *b, BAT *pos, const oid *ends, BUN nvals)
+{
+	BAT *vals;
+	BATiter bi = bat_iterator(b);
+	BUN i;
+	oid p;
+
+	if ((vals = COLnew(0, b->ttype, nvals, TRANSIENT)) == NULL)
+		return NULL;
+	for (i = 0; i < nvals; i++) {
+		p = pos ? CMPoid(pos, i) - b->hseqbase : ends[i] - 1;
+		if (BUNappend(vals, BUNtail(bi, p), FALSE) != GDK_SUCCEED) {
+			BBPreclaim(vals);
+			return NULL;
+		}
+	}
+	if (BATsetaccess(vals, BAT_READ) != GDK_SUCCEED) {
+		BBPreclaim(vals);
+		return NULL;
+	}
+	return vals;
+}
+
+/* create a read-only BAT of n rows which is kept in compressed form
+ * c; the compressed BAT has no tail heap until it is decompressed */
+static BAT *
+CMPnew(oid hseq, int tt, BUN n, Compressed *c)
+{
+	BAT *bn;
+
+	if ((bn = COLnew(hseq, tt, 0, TRANSIENT)) == NULL)
+		return NULL;
+	HEAPfree(&bn->theap, 0);
+	bn->theap.size = 0;
+	bn->batCapacity = 0;
+	bn->batCount = n;
+	bn->batRestricted = BAT_READ;
+	bn->tcompressed = c;
+	return bn;
+}
+
+#define CMPSTATS(TYPE)							\
+	do {								\
+		const TYPE *restrict v = (const TYPE *) Tloc(b, 0);	\
+		TYPE mn = 0, mx = 0;					\
+									\
+		for (i = 0; i < n; i++) {				\
+			if (i > 0 && v[i] != v[i - 1])			\
+				runs++;					\
+			if (v[i] == TYPE##_nil) {			\
+				hasnil = 1;				\
+			} else if (!hasval) {				\
+				mn = mx = v[i];				\
+				hasval = 1;				\
+			} else if (v[i] < mn) {				\
+				mn = v[i];				\
+			} else if (v[i] > mx) {				\
+				mx = v[i];				\
+			}						\
+		}							\
+		base = mn;						\
+		range = (ulng) (lng) mx - (ulng) (lng) mn;		\
+	} while (0)
+
+#define FORENCODE(TYPE)							\
+	do {								\
+		const TYPE *restrict v = (const TYPE *) Tloc(b, 0);	\
+									\
+		for (i = 0; i < n; i++)					\
+			CMPput(w, c->bits, i,				\
+			       v[i] == TYPE##_nil ? c->nilcode :	\
+			       (ulng) (lng) v[i] - (ulng) c->base);	\
+	} while (0)
+
+BAT *
+BATcompress(BAT *b)
+{
+	BUN n, runs = 1, ngrp = 0, i;
+	int tpe, scheme = 0, forbits = 0, hasnil = 0, hasval = 0;
+	lng base = 0;
+	ulng range = 0, raw, sz, forsz, dictsz, rlesz;
+	BAT *bn, *g = NULL, *e = NULL;
+	Compressed *c = NULL;
+	ulng *w;
+	lng t0 = 0;
+
+	BATcheck(b, "BATcompress", NULL);
+	ALGODEBUG t0 = GDKusec();
+
+	n = BATcount(b);
+	tpe = ATOMbasetype(b->ttype);
+	if (n < 2 || b->ttype == TYPE_void || BATtdense(b) ||
+	    !ATOMlinear(b->ttype) || ATOMnilptr(b->ttype) == NULL ||
+	    (b->tvarsized && b->tvheap == NULL) ||
+	    (b->tcompressed && BATdecompress(b) != GDK_SUCCEED))
+		goto nocompress;
+
+	/* collect statistics: number of runs and, for integers, the
+	 * range of the values */
+	switch (ATOMtype(b->ttype) == TYPE_oid ? TYPE_oid : tpe) {
+	case TYPE_bte:
+		CMPSTATS(bte);
+		break;
+	case TYPE_sht:
+		CMPSTATS(sht);
+		break;
+	case TYPE_int:
+		CMPSTATS(int);
+		break;
+	case TYPE_lng:
+		CMPSTATS(lng);
+		break;
+	default: {
+		BATiter bi = bat_iterator(b);
+		int (*cmp)(const void *, const void *) = ATOMcompare(b->ttype);
+
+		for (i = 1; i < n; i++)
+			if ((*cmp)(BUNtail(bi, i - 1), BUNtail(bi, i)) != 0)
+				runs++;
+		tpe = TYPE_void; /* no FOR */
+		break;
+	}
+	}
+
+	/* sizes in bits of the tail heap and of the candidate schemes */
+	raw = (ulng) n * b->twidth * 8;
+	sz = raw;
+	if (tpe != TYPE_void) {
+		forbits = CMPbits(range + hasnil);
+		forsz = (ulng) n * forbits;
+		if (forbits < b->twidth * 8 && CMPworthwhile(forsz, sz)) {
+			scheme = CMP_FOR;
+			sz = forsz;
+		}
+	}
+	rlesz = (ulng) runs * (b->twidth + SIZEOF_OID) * 8;
+	if (CMPworthwhile(rlesz, raw) && rlesz < sz) {
+		scheme = CMP_RLE;
+		sz = rlesz;
+	}
+	if (ATOMtype(b->ttype) == TYPE_oid && b->tsorted && b->tkey &&
+	    b->tnonil) {
+		/* a candidate list: one bit per OID in its range */
+		const oid *o = (const oid *) Tloc(b, 0);
+
+		base = (lng) o[0];
+		range = (ulng) (o[n - 1] - o[0]) + 1;
+		if (CANDmaskworthwhile(n, o[0], o[n - 1]) && range < sz) {
+			scheme = CMP_MASK;
+			sz = range;
+		}
+	}
+	if (scheme != CMP_RLE && scheme != CMP_MASK &&
+	    (tpe == TYPE_void || forbits > CMP_FORBITS)) {
+		if (BATgroup(&g, &e, NULL, b, NULL, NULL, NULL, NULL) != GDK_SUCCEED)
+			return NULL;
+		ngrp = BATcount(e);
+		dictsz = (ulng) n * CMPbits(ngrp - 1) + (ulng) ngrp * b->twidth * 8;
+		if (CMPworthwhile(dictsz, raw) && dictsz < sz) {
+			scheme = CMP_DICT;
+			sz = dictsz;
+		}
+	}
+	if (scheme == 0) {
+		if (g)
+			BBPunfix(g->batCacheid);
+		if (e)
+			BBPunfix(e->batCacheid);
+		goto nocompress;
+	}
+
+	if ((c = GDKzalloc(sizeof(Compressed))) == NULL)
+		goto bailout;
+	c->scheme = scheme;
+	switch (scheme) {
+	case CMP_FOR:
+		c->bits = forbits;
+		c->base = base;
+		c->range = range;
+		c->hasval = hasval;
+		c->nilcode = hasnil ? range + 1 : ~(ulng) 0;
+		if (CMPalloc(c, ((ulng) n * forbits + 63) / 64 + 1, sizeof(ulng)) != GDK_SUCCEED)
+			goto bailout;
+		w = (ulng *) c->codes.base;
+		switch (tpe) {
+		case TYPE_bte:
+			FORENCODE(bte);
+			break;
+		case TYPE_sht:
+			FORENCODE(sht);
+			break;
+		case TYPE_int:
+			FORENCODE(int);
+			break;
+		case TYPE_lng:
+			FORENCODE(lng);
+			break;
+		}
+		break;
+	case CMP_DICT:
+		c->bits = CMPbits(ngrp - 1);
+		c->nvals = ngrp;
+		if ((c->vals = CMPvals(b, e, NULL, ngrp)) == NULL ||
+		    CMPalloc(c, ((ulng) n * c->bits + 63) / 64 + 1, sizeof(ulng)) != GDK_SUCCEED)
+			goto bailout;
+		w = (ulng *) c->codes.base;
+		for (i = 0; i < n; i++)
+			CMPput(w, c->bits, i, (ulng) CMPoid(g, i));
+		break;
+	case CMP_RLE: {
+		BATiter bi = bat_iterator(b);
+		int (*cmp)(const void *, const void *) = ATOMcompare(b->ttype);
+		oid *ends;
+		BUN r = 0;
+
+		c->nvals = runs;
+		if (CMPalloc(c, runs, sizeof(oid)) != GDK_SUCCEED)
+			goto bailout;
+		ends = (oid *) c->codes.base;
+		for (i = 1; i <= n; i++)
+			if (i == n || (*cmp)(BUNtail(bi, i - 1), BUNtail(bi, i)) != 0)
+				ends[r++] = i;
+		assert(r == runs);
+		if ((c->vals = CMPvals(b, NULL, ends, runs)) == NULL)
+			goto bailout;
+		break;
+	}
+	case CMP_MASK: {
+		const oid *o = (const oid *) Tloc(b, 0);
+
+		c->base = base;
+		c->range = range;
+		if (CMPalloc(c, CMPmaskwords(range), sizeof(ulng)) != GDK_SUCCEED)
+			goto bailout;
+		w = (ulng *) c->codes.base;
+		for (i = 0; i < n; i++)
+			w[(o[i] - base) / 64] |= (ulng) 1 << ((o[i] - base) % 64);
+		break;
+	}
+	}
+	if (g)
+		BBPunfix(g->batCacheid);
+	if (e)
+		BBPunfix(e->batCacheid);
+	g = e = NULL;
+
+	if ((bn = CMPnew(b->hseqbase, b->ttype, n, c)) == NULL)
+		goto bailout;
+	bn->tsorted = b->tsorted;
+	bn->trevsorted = b->trevsorted;
+	bn->tkey = b->tkey;
+	bn->tnonil = b->tnonil;
+	bn->tnil = b->tnil;
+
+	ALGODEBUG fprintf(stderr, "#BATcompress(b=%s#" BUNFMT "[%s]): %s, "
+			  ULLFMT " of " ULLFMT " bytes (" LLFMT " usec)\n",
+			  BATgetId(b), n, ATOMname(b->ttype),
+			  CMPnames[scheme], (ulng) (sz / 8), (ulng) (raw / 8),
+			  GDKusec() - t0);
+	return bn;
+
+  nocompress:
+	ALGODEBUG fprintf(stderr, "#BATcompress(b=%s#" BUNFMT "[%s]): "
+			  "not compressed\n",
+			  BATgetId(b), BATcount(b), ATOMname(b->ttype));
+	return VIEWcreate(b->hseqbase, b);
+
+  bailout:
+	if (g)
+		BBPunfix(g->batCacheid);
+	if (e)
+		BBPunfix(e->batCacheid);
+	if (c)
+		CMPfree(c);
+	return NULL;
+}
+
+const char *
+BATcompression(BAT *b)
+{
+	BATcheck(b, "BATcompression", NULL);
+	return b->tcompressed ? CMPnames[b->tcompressed->scheme] : "none";
+}
+
+/* write the uncompressed values of positions [0,n) into a heap of the
+ * given width */
+#define CMPCOPY(TYPE)							\
+	do {								\
+		const TYPE *restrict src = (const TYPE *) Tloc(c->vals, 0); \
+		TYPE *restrict dst = (TYPE *) b->theap.base;		\
+									\
+		if (c->scheme == CMP_DICT) {				\
+			for (i = 0; i < n; i++)				\
+				dst[i] = src[CMPget(w, c->bits, i)];	\
+		} else {						\
+			for (r = 0, i = 0; r < c->nvals; r++)		\
+				for (; i < ends[r]; i++)		\
+					dst[i] = src[r];		\
+		}							\
+	} while (0)
+
+#define FORDECODE(TYPE)							\
+	do {								\
+		TYPE *restrict dst = (TYPE *) b->theap.base;		\
+		ulng v;							\
+									\
+		for (i = 0; i < n; i++) {				\
+			v = CMPget(w, c->bits, i);			\
+			dst[i] = v == c->nilcode ? TYPE##_nil :		\
+				(TYPE) (lng) ((ulng) c->base + v);	\
+		}							\
+	} while (0)
+
+static gdk_return
+CMPdecode(BAT *b, const Compressed *c)
+{
+	const char *nme = BBP_physical(b->batCacheid);
+	const ulng *w = (const ulng *) c->codes.base;
+	const oid *ends = (const oid *) c->codes.base;
+	BUN n = BATcount(b), i, r;
+
+	if (c->scheme == CMP_DICT || c->scheme == CMP_RLE) {
+		/* the values are copied from the dictionary or run
+		 * values, so we need their string heap and width */
+		if (b->tvheap) {
+			HEAPfree(b->tvheap, 0);
+			if ((b->tvheap->filename = GDKfilepath(NOFARM, NULL, nme, "theap")) == NULL ||
+			    HEAPcopy(b->tvheap, c->vals->tvheap) != GDK_SUCCEED)
+				return GDK_FAIL;
+		}
+		b->twidth = c->vals->twidth;
+		b->tshift = c->vals->tshift;
+	}
+	if (b->theap.filename == NULL &&
+	    (b->theap.filename = GDKfilepath(NOFARM, NULL, nme, "tail")) == NULL)
+		return GDK_FAIL;
+	if (HEAPalloc(&b->theap, n, b->twidth) != GDK_SUCCEED)
+		return GDK_FAIL;
+
+	if (c->scheme == CMP_MASK) {
+		oid *restrict dst = (oid *) b->theap.base;
+		BUN k, nw = CMPmaskwords(c->range);
+		ulng m;
+
+		for (k = 0, i = 0; k < nw; k++)
+			for (m = w[k]; m; m &= m - 1)
+				dst[i++] = (oid) c->base + k * 64 + CMPctz(m);
+		assert(i == n);
+	} else if (c->scheme == CMP_FOR) {
+		switch (ATOMbasetype(b->ttype)) {
+		case TYPE_bte:
+			FORDECODE(bte);
+			break;
+		case TYPE_sht:
+			FORDECODE(sht);
+			break;
+		case TYPE_int:
+			FORDECODE(int);
+			break;
+		case TYPE_lng:
+			FORDECODE(lng);
+			break;
+		}
+	} else {
+		switch (b->twidth) {
+		case 1:
+			CMPCOPY(bte);
+			break;
+		case 2:
+			CMPCOPY(sht);
+			break;
+		case 4:
+			CMPCOPY(int);
+			break;
+		case 8:
+			CMPCOPY(lng);
+			break;
+#ifdef HAVE_HGE
+		case 16:
+			CMPCOPY(hge);
+			break;
+#endif
+		default: {
+			const char *src = Tloc(c->vals, 0);
+			char *dst = b->theap.base;
+			int width = b->twidth;
+
+			for (i = 0, r = 0; i < n; i++) {
+				if (c->scheme == CMP_DICT)
+					r = CMPget(w, c->bits, i);
+				else if (i == ends[r])
+					r++;
+				memcpy(dst + i * width, src + r * width, width);
+			}
+			break;
+		}
+		}
+	}
+	b->theap.free = n << b->tshift;
+	b->theap.dirty = TRUE;
+	b->batCapacity = n;
+	return GDK_SUCCEED;
+}
+
+gdk_return
+BATdecompress(BAT *b)
+{
+	gdk_return ret = GDK_SUCCEED;
+	lng t0 = 0;
+
+	BATcheck(b, "BATdecompress", GDK_FAIL);
+	if (b->tcompressed == NULL || b->theap.base != NULL)
+		return GDK_SUCCEED;
+	ALGODEBUG t0 = GDKusec();
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->theap.base == NULL)
+		ret = CMPdecode(b, b->tcompressed);
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	ALGODEBUG fprintf(stderr, "#BATdecompress(b=%s#" BUNFMT "): %s "
+			  "(" LLFMT " usec)\n",
+			  BATgetId(b), BATcount(b),
+			  CMPnames[b->tcompressed->scheme], GDKusec() - t0);
+	return ret;
+}
+
+/* drop the compressed representation; the BAT must have been
+ * decompressed, unless it is being freed */
+void
+CMPdestroy(BAT *b)
+{
+	Compressed *c;
+
+	if (b && (c = b->tcompressed) != NULL) {
+		b->tcompressed = NULL;
+		CMPfree(c);
+	}
+}
+
+/* for each dictionary or run value, whether it qualifies */
+static bte *
+CMPqual(BAT *v, const void *tl, const void *th, int li, int hi,
+	int equi, int anti, int lval, int hval, int lnil)
+{
+	BUN i, n = BATcount(v);
+	BATiter vi = bat_iterator(v);
+	int (*cmp)(const void *, const void *) = ATOMcompare(v->ttype);
+	const void *nil = ATOMnilptr(v->ttype);
+	const void *x;
+	bte *q;
+	int c, in;
+
+	if ((q = GDKmalloc(n + 1)) == NULL)
+		return NULL;
+	for (i = 0; i < n; i++) {
+		x = BUNtail(vi, i);
+		if ((*cmp)(x, nil) == 0) {
+			q[i] = equi && lnil;
+		} else if (equi && lnil) {
+			q[i] = 0;
+		} else {
+			in = (!lval || (c = (*cmp)(x, tl)) > 0 || (li && c == 0)) &&
+				(!hval || (c = (*cmp)(x, th)) < 0 || (hi && c == 0));
+			q[i] = anti ? !in : in;
+		}
+	}
+	return q;
+}
+
+#define CMPaddoid(o)							\
+	do {								\
+		if (nr == BATcapacity(bn)) {				\
+			BATsetcount(bn, nr);				\
+			if (BATextend(bn, BATgrows(bn)) != GDK_SUCCEED)	\
+				goto bailout;				\
+			dst = (oid *) Tloc(bn, 0);			\
+		}							\
+		dst[nr++] = (o);					\
+	} while (0)
+
+#define CMPSCAN(QUAL)							\
+	do {								\
+		if (cand) {						\
+			for (; cand < candend; cand++) {		\
+				v = CMPget(w, c->bits, *cand - off);	\
+				if (QUAL)				\
+					CMPaddoid(*cand);		\
+			}						\
+		} else {						\
+			for (p = start; p < end; p++) {		\
+				v = CMPget(w, c->bits, p);		\
+				if (QUAL)				\
+					CMPaddoid(p + off);		\
+			}						\
+		}							\
+	} while (0)
+
+/* select on a compressed BAT; the arguments are as computed by
+ * BATselect before the type-specific normalization */
+BAT *
+CMPselect(BAT *b, BAT *s, const void *tl, const void *th, int li, int hi,
+	  int equi, int anti, int lval, int hval, int lnil)
+{
+	const Compressed *c = b->tcompressed;
+	const ulng *w = (const ulng *) c->codes.base;
+	BUN start, end, cnt, p, nr = 0;
+	const oid *cand, *candend;
+	oid off = b->hseqbase, *dst;
+	bte *qual = NULL;
+	ulng v, clo, chi;
+	BAT *bn;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	CANDINIT(b, s, start, end, cnt, cand, candend);
+	cnt = cand ? (BUN) (candend - cand) : end - start;
+	if ((bn = COLnew(0, TYPE_oid, MIN(cnt, BATTINY), TRANSIENT)) == NULL)
+		return NULL;
+	dst = (oid *) Tloc(bn, 0);
+
+	if (c->scheme == CMP_FOR) {
+		/* translate the range into a range of codes */
+		int tpe = ATOMbasetype(b->ttype);
+		ulng d;
+		lng x;
+
+		if (equi && lnil) {
+			clo = c->nilcode;
+			chi = c->nilcode + 1;
+			anti = 0;
+		} else {
+			clo = 0;
+			chi = c->range + 1;
+			if (lval && (x = CMPlng(tpe, tl)) >= c->base) {
+				d = (ulng) x - (ulng) c->base;
+				clo = li ? d : d + 1;
+			}
+			if (hval) {
+				if ((x = CMPlng(tpe, th)) < c->base) {
+					chi = 0;
+				} else {
+					d = (ulng) x - (ulng) c->base;
+					if (d <= c->range)
+						chi = hi ? d + 1 : d;
+				}
+			}
+		}
+		if (clo > chi)
+			clo = chi;
+		if (anti)
+			CMPSCAN(v != c->nilcode && (v < clo || v >= chi));
+		else if (clo < chi)
+			CMPSCAN(v >= clo && v < chi);
+	} else {
+		if ((qual = CMPqual(c->vals, tl, th, li, hi, equi, anti,
+				    lval, hval, lnil)) == NULL)
+			goto bailout;
+		if (c->scheme == CMP_DICT) {
+			CMPSCAN(qual[v]);
+		} else {
+			const oid *ends = (const oid *) c->codes.base;
+			BUN r, e;
+
+			if (cand) {
+				for (r = CMPrun(c, *cand - off);
+				     cand < candend; cand++) {
+					p = *cand - off;
+					while (ends[r] <= p)
+						r++;
+					if (qual[r])
+						CMPaddoid(*cand);
+				}
+			} else {
+				for (r = CMPrun(c, start), p = start;
+				     p < end; r++) {
+					e = MIN(ends[r], end);
+					if (qual[r]) {
+						for (; p < e; p++)
+							CMPaddoid(p + off);
+					}
+					p = e;
+				}
+			}
+		}
+		GDKfree(qual);
+		qual = NULL;
+	}
+
+	BATsetcount(bn, nr);
+	bn->tsorted = 1;
+	bn->trevsorted = nr <= 1;
+	bn->tkey = 1;
+	bn->tdense = 0;
+	bn->tnonil = 1;
+	bn->tnil = 0;
+	ALGODEBUG fprintf(stderr, "#BATselect(b=%s#" BUNFMT ",s=%s%s,anti=%d): "
+			  "compressed (%s) select " BUNFMT " (" LLFMT " usec)\n",
+			  BATgetId(b), BATcount(b),
+			  s ? BATgetId(s) : "NULL",
+			  s && BATtdense(s) ? "(dense)" : "", anti,
+			  CMPnames[c->scheme], nr, GDKusec() - t0);
+	return bn;
+
+  bailout:
+	GDKfree(qual);
+	BBPreclaim(bn);
+	return NULL;
+}
+
+/* position of the i'th row of l in r, or BUN_NONE for a nil oid */
+#define CMPPOS(i)							\
+	do {								\
+		o = lv ? lv[i] : l->tseqbase == oid_nil ? oid_nil : l->tseqbase + (i); \
+		if (o == oid_nil) {					\
+			p = BUN_NONE;					\
+		} else if (o < rseq || o >= rend) {			\
+			GDKerror("BATproject: does not match always\n"); \
+			goto bailout;					\
+		} else {						\
+			p = (BUN) (o - rseq);				\
+		}							\
+	} while (0)
+
+#define FORPROJECT(TYPE)						\
+	do {								\
+		TYPE *restrict dst = (TYPE *) Tloc(bn, 0);		\
+		ulng v;							\
+									\
+		for (i = 0; i < n; i++) {				\
+			CMPPOS(i);					\
+			if (p == BUN_NONE ||				\
+			    (v = CMPget(w, c->bits, p)) == c->nilcode) { \
+				dst[i] = TYPE##_nil;			\
+				nils = 1;				\
+			} else {					\
+				dst[i] = (TYPE) (lng) ((ulng) c->base + v); \
+			}						\
+		}							\
+	} while (0)
+
+/* BATproject with a compressed right-hand side */
+BAT *
+CMPproject(BAT *l, BAT *r)
+{
+	const Compressed *c = r->tcompressed;
+	const ulng *w = (const ulng *) c->codes.base;
+	const oid *lv = l->ttype == TYPE_void ? NULL : (const oid *) Tloc(l, 0);
+	oid rseq = r->hseqbase, rend = rseq + BATcount(r), o, *cv;
+	BUN n = BATcount(l), i, p, run = 0;
+	BAT *bn = NULL, *cb = NULL;
+	int nils = 0;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	if (c->scheme == CMP_FOR) {
+		if ((bn = COLnew(l->hseqbase, r->ttype, n, TRANSIENT)) == NULL)
+			return NULL;
+		switch (ATOMbasetype(r->ttype)) {
+		case TYPE_bte:
+			FORPROJECT(bte);
+			break;
+		case TYPE_sht:
+			FORPROJECT(sht);
+			break;
+		case TYPE_int:
+			FORPROJECT(int);
+			break;
+		case TYPE_lng:
+			FORPROJECT(lng);
+			break;
+		}
+		BATsetcount(bn, n);
+		bn->tsorted = bn->trevsorted = bn->tkey = n <= 1;
+		bn->tnil = nils;
+		bn->tnonil = !nils;
+	} else {
+		/* project the dictionary or run values using the
+		 * codes of the selected rows */
+		const oid *ends = (const oid *) c->codes.base;
+
+		if ((cb = COLnew(0, TYPE_oid, n, TRANSIENT)) == NULL)
+			return NULL;
+		cv = (oid *) Tloc(cb, 0);
+		for (i = 0; i < n; i++) {
+			CMPPOS(i);
+			if (p == BUN_NONE) {
+				cv[i] = oid_nil;
+				nils = 1;
+			} else if (c->scheme == CMP_DICT) {
+				cv[i] = (oid) CMPget(w, c->bits, p);
+			} else {
+				if (ends[run] <= p || (run > 0 && ends[run - 1] > p))
+					run = CMPrun(c, p);
+				cv[i] = run;
+			}
+		}
+		BATsetcount(cb, n);
+		cb->tsorted = cb->trevsorted = cb->tkey = n <= 1;
+		cb->tdense = 0;
+		cb->tnil = nils;
+		cb->tnonil = !nils;
+		bn = BATproject(cb, c->vals);
+		BBPunfix(cb->batCacheid);
+		cb = NULL;
+		if (bn == NULL)
+			return NULL;
+		BAThseqbase(bn, l->hseqbase);
+	}
+	if (n > 1 && l->tnonil) {
+		bn->tsorted |= (l->tsorted & r->tsorted) | (l->trevsorted & r->trevsorted);
+		bn->trevsorted |= (l->tsorted & r->trevsorted) | (l->trevsorted & r->tsorted);
+		bn->tkey |= l->tkey & r->tkey;
+	}
+	ALGODEBUG fprintf(stderr, "#BATproject(l=%s,r=%s)=%s#" BUNFMT
+			  ": compressed (%s) " LLFMT "us\n",
+			  BATgetId(l), BATgetId(r), BATgetId(bn), BATcount(bn),
+			  CMPnames[c->scheme], GDKusec() - t0);
+	return bn;
+
+  bailout:
+	if (cb)
+		BBPreclaim(cb);
+	if (bn)
+		BBPreclaim(bn);
+	return NULL;
+}
+
+/* BATmin and BATmax of a compressed BAT */
+void *
+CMPminmax(BAT *b, void *aggr, int max)
+{
+	const Compressed *c = b->tcompressed;
+	lng v;
+
+	if (c->scheme == CMP_MASK) {
+		/* the first and last bits are set */
+		if (aggr == NULL && (aggr = GDKmalloc(sizeof(oid))) == NULL)
+			return NULL;
+		*(oid *) aggr = (oid) c->base + (max ? (oid) c->range - 1 : 0);
+		return aggr;
+	}
+	if (c->scheme != CMP_FOR) {
+		/* the dictionary and run values contain exactly the
+		 * values of the column */
+		return max ? BATmax(c->vals, aggr) : BATmin(c->vals, aggr);
+	}
+	if (aggr == NULL && (aggr = GDKmalloc(ATOMsize(b->ttype))) == NULL)
+		return NULL;
+	v = max ? (lng) ((ulng) c->base + c->range) : c->base;
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		*(bte *) aggr = c->hasval ? (bte) v : bte_nil;
+		break;
+	case TYPE_sht:
+		*(sht *) aggr = c->hasval ? (sht) v : sht_nil;
+		break;
+	case TYPE_int:
+		*(int *) aggr = c->hasval ? (int) v : int_nil;
+		break;
+	case TYPE_lng:
+		*(lng *) aggr = c->hasval ? v : lng_nil;
+		break;
+	}
+	return aggr;
+}
+
+/* whether BATsum can work on the compressed representation: integer
+ * input summed into an integer at least as wide as lng, calculated
+ * exactly using hge */
+int
+CMPsummable(BAT *b, int tp)
+{
+#ifdef HAVE_HGE
+	switch (b->ttype) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return tp == TYPE_lng || tp == TYPE_hge;
+	}
+#else
+	(void) b;
+	(void) tp;
+#endif
+	return 0;
+}
+
+gdk_return
+CMPsum(void *res, int tp, BAT *b, BAT *s, int skip_nils,
+       int abort_on_error, int nil_if_empty)
+{
+#ifdef HAVE_HGE
+	const Compressed *c = b->tcompressed;
+	const ulng *w = (const ulng *) c->codes.base;
+	BUN start, end, cnt, p, k, nils = 0, nvals = 0;
+	const oid *cand, *candend;
+	oid off = b->hseqbase;
+	BUN *counts = NULL;
+	hge sum = 0;
+	ulng v;
+
+	CANDINIT(b, s, start, end, cnt, cand, candend);
+	if (c->scheme == CMP_FOR) {
+		/* sum of the codes plus the base for each non-nil */
+		if (cand) {
+			for (; cand < candend; cand++) {
+				v = CMPget(w, c->bits, *cand - off);
+				if (v == c->nilcode)
+					nils++;
+				else
+					sum += v;
+			}
+			nvals = cnt - nils;
+		} else {
+			for (p = start; p < end; p++) {
+				v = CMPget(w, c->bits, p);
+				if (v == c->nilcode)
+					nils++;
+				else
+					sum += v;
+			}
+			nvals = end - start - nils;
+		}
+		sum += (hge) c->base * (hge) nvals;
+	} else {
+		/* count how often each dictionary or run value
+		 * occurs */
+		const oid *ends = (const oid *) c->codes.base;
+		BATiter vi = bat_iterator(c->vals);
+		const void *nil = ATOMnilptr(b->ttype);
+		int tpe = ATOMbasetype(b->ttype);
+		const void *x;
+
+		if ((counts = GDKzalloc(c->nvals * sizeof(BUN))) == NULL)
+			return GDK_FAIL;
+		if (c->scheme == CMP_DICT) {
+			if (cand) {
+				for (; cand < candend; cand++)
+					counts[CMPget(w, c->bits, *cand - off)]++;
+			} else {
+				for (p = start; p < end; p++)
+					counts[CMPget(w, c->bits, p)]++;
+			}
+		} else if (cand) {
+			for (k = CMPrun(c, *cand - off); cand < candend; cand++) {
+				while (ends[k] <= *cand - off)
+					k++;
+				counts[k]++;
+			}
+		} else if (start < end) {
+			for (k = CMPrun(c, start), p = start; p < end; k++) {
+				counts[k] = MIN(ends[k], end) - p;
+				p = MIN(ends[k], end);
+			}
+		}
+		for (k = 0; k < c->nvals; k++) {
+			if (counts[k] == 0)
+				continue;
+			x = BUNtail(vi, k);
+			if (ATOMcmp(b->ttype, x, nil) == 0) {
+				nils += counts[k];
+			} else {
+				sum += (hge) CMPlng(tpe, x) * (hge) counts[k];
+				nvals += counts[k];
+			}
+		}
+		GDKfree(counts);
+	}
+
+	if (nils > 0 && !skip_nils) {
+		sum = hge_nil;
+	} else if (nvals == 0) {
+		sum = nil_if_empty ? hge_nil : 0;
+	}
+	if (tp == TYPE_lng) {
+		if (sum == hge_nil) {
+			*(lng *) res = lng_nil;
+		} else if (sum > (hge) GDK_lng_max || sum < -(hge) GDK_lng_max) {
+			if (abort_on_error) {
+				GDKerror("22003!overflow in calculation.\n");
+				return GDK_FAIL;
+			}
+			*(lng *) res = lng_nil;
+		} else {
+			*(lng *) res = (lng) sum;
+		}
+	} else {
+		assert(tp == TYPE_hge);
+		*(hge *) res = sum;
+	}
+	return GDK_SUCCEED;
+#else
+	(void) res;
+	(void) tp;
+	(void) b;
+	(void) s;
+	(void) skip_nils;
+	(void) abort_on_error;
+	(void) nil_if_empty;
+	GDKerror("CMPsum: not supported\n");
+	return GDK_FAIL;
+#endif
+}
+
+/* candidate lists as bitmaps */
+
+/* a new, empty bitmap of nbits bits of which bit 0 stands for OID
+ * base */
+Compressed *
+CMPmasknew(oid base, BUN nbits)
+{
+	Compressed *c;
+
+	if ((c = GDKzalloc(sizeof(Compressed))) == NULL)
+		return NULL;
+	c->scheme = CMP_MASK;
+	c->base = (lng) base;
+	c->range = nbits;
+	if (CMPalloc(c, CMPmaskwords(nbits), sizeof(ulng)) != GDK_SUCCEED) {
+		GDKfree(c);
+		return NULL;
+	}
+	return c;
+}
+
+/* the candidate list of n candidates that is kept as bitmap c */
+static BAT *
+CMPmaskbat(Compressed *c, BUN n)
+{
+	BAT *bn;
+
+	if ((bn = CMPnew(0, TYPE_oid, n, c)) == NULL)
+		return NULL;
+	bn->tsorted = 1;
+	bn->trevsorted = 0;
+	bn->tkey = 1;
+	bn->tdense = 0;
+	bn->tseqbase = oid_nil;
+	bn->tnonil = 1;
+	bn->tnil = 0;
+	return bn;
+}
+
+/* turn the bitmap c into a candidate list: an empty or dense list if
+ * possible, else the bitmap itself if that is allowed and pays off,
+ * else a materialized list; c is consumed */
+BAT *
+CMPmaskresult(Compressed *c, int keepmask)
+{
+	ulng *w = (ulng *) c->codes.base;
+	BUN nw = CMPmaskwords(c->range), lo, hi, k, cnt = 0;
+	oid first, last, *restrict dst;
+	int r;
+	ulng m;
+	BAT *bn;
+
+	for (k = 0; k < nw; k++)
+		cnt += CMPpop(w[k]);
+	if (cnt == 0) {
+		CMPfree(c);
+		return BATdense(0, 0, 0);
+	}
+	for (lo = 0; w[lo] == 0; lo++)
+		;
+	for (hi = nw; w[hi - 1] == 0; hi--)
+		;
+	first = (oid) c->base + lo * 64 + CMPctz(w[lo]);
+	last = (oid) c->base + (hi - 1) * 64 + 63 - CMPclz(w[hi - 1]);
+	if (last - first + 1 == cnt) {
+		CMPfree(c);
+		return BATdense(0, first, cnt);
+	}
+	if (keepmask && cnt >= CANDMASK_MIN &&
+	    CANDmaskworthwhile(cnt, first, last)) {
+		/* shift the bits so that bit 0 is the first
+		 * candidate */
+		r = CMPctz(w[lo]);
+		if (lo > 0 || r > 0) {
+			for (k = lo; k < hi; k++)
+				w[k - lo] = r == 0 ? w[k] :
+					(w[k] >> r) |
+					(k + 1 < hi ? w[k + 1] << (64 - r) : 0);
+			memset(w + (hi - lo), 0, (nw - (hi - lo)) * sizeof(ulng));
+		}
+		c->base = (lng) first;
+		c->range = last - first + 1;
+		if ((bn = CMPmaskbat(c, cnt)) == NULL)
+			CMPfree(c);
+		return bn;
+	}
+	if ((bn = COLnew(0, TYPE_oid, cnt, TRANSIENT)) == NULL) {
+		CMPfree(c);
+		return NULL;
+	}
+	dst = (oid *) Tloc(bn, 0);
+	for (k = lo, cnt = 0; k < hi; k++)
+		for (m = w[k]; m; m &= m - 1)
+			dst[cnt++] = (oid) c->base + k * 64 + CMPctz(m);
+	CMPfree(c);
+	BATsetcount(bn, cnt);
+	bn->tsorted = 1;
+	bn->trevsorted = 0;
+	bn->tkey = 1;
+	bn->tdense = 0;
+	bn->tseqbase = oid_nil;
+	bn->tnonil = 1;
+	bn->tnil = 0;
+	return bn;
+}
+
+BAT *
+BATmaskcand(BAT *s)
+{
+	const oid *o;
+	Compressed *c;
+	ulng *w;
+	BUN i, n;
+	BAT *bn;
+
+	BATcheck(s, "BATmaskcand", NULL);
+	if (ATOMtype(s->ttype) != TYPE_oid) {
+		GDKerror("BATmaskcand: candidate list must have OID tail\n");
+		return NULL;
+	}
+	n = BATcount(s);
+	if (s->tcompressed && BATdecompress(s) != GDK_SUCCEED)
+		return NULL;
+	if (n < 2 || BATtdense(s) || s->ttype == TYPE_void)
+		return VIEWcreate(s->hseqbase, s);
+	o = (const oid *) Tloc(s, 0);
+	if (!BATordered(s) || !BATkeyed(s) ||
+	    o[0] == oid_nil || o[n - 1] == oid_nil) {
+		GDKerror("BATmaskcand: candidate list must be sorted and unique\n");
+		return NULL;
+	}
+	if (!CANDmaskworthwhile(n, o[0], o[n - 1]))
+		return VIEWcreate(s->hseqbase, s);
+	if ((c = CMPmasknew(o[0], o[n - 1] - o[0] + 1)) == NULL)
+		return NULL;
+	w = (ulng *) c->codes.base;
+	for (i = 0; i < n; i++)
+		w[(o[i] - o[0]) / 64] |= (ulng) 1 << ((o[i] - o[0]) % 64);
+	if ((bn = CMPmaskbat(c, n)) == NULL) {
+		CMPfree(c);
+		return NULL;
+	}
+	BAThseqbase(bn, s->hseqbase);
+	return bn;
+}
+
+/* the first and last OID of a non-empty candidate list */
+static void
+CMPmaskrange(BAT *s, oid *first, oid *last)
+{
+	if (CMPmask(s)) {
+		*first = (oid) s->tcompressed->base;
+		*last = *first + (oid) s->tcompressed->range - 1;
+	} else if (BATtdense(s)) {
+		*first = s->tseqbase;
+		*last = *first + BATcount(s) - 1;
+	} else {
+		*first = *(const oid *) Tloc(s, 0);
+		*last = *(const oid *) Tloc(s, BUNlast(s) - 1);
+	}
+}
+
+/* set the bits of the bitmap c for the candidates of s, as far as
+ * they fall in the range of c */
+static void
+CMPmaskadd(Compressed *c, BAT *s)
+{
+	ulng *restrict w = (ulng *) c->codes.base;
+	oid cfirst = (oid) c->base, cend = cfirst + (oid) c->range;
+	BUN nw = CMPmaskwords(c->range), k, lo, hi;
+	oid first, last;
+
+	if (BATcount(s) == 0)
+		return;
+	CMPmaskrange(s, &first, &last);
+	if (CMPmask(s)) {
+		/* OR the words of s shifted by the difference of
+		 * their first OIDs */
+		const ulng *restrict sw = (const ulng *) s->tcompressed->codes.base;
+		BUN snw = CMPmaskwords(s->tcompressed->range);
+		lng d = (lng) first - (lng) cfirst, q, t;
+		int r;
+
+		q = d >= 0 ? d / 64 : -((-d + 63) / 64);
+		r = (int) (d - q * 64);
+		for (k = 0; k < snw; k++) {
+			t = (lng) k + q;
+			if (t >= 0 && t < (lng) nw)
+				w[t] |= sw[k] << r;
+			if (r > 0 && t + 1 >= 0 && t + 1 < (lng) nw)
+				w[t + 1] |= sw[k] >> (64 - r);
+		}
+		/* clear what fell beyond the end */
+		if (c->range % 64 != 0)
+			w[nw - 1] &= ((ulng) 1 << (c->range % 64)) - 1;
+	} else if (BATtdense(s)) {
+		lo = (BUN) (MAX(first, cfirst) - cfirst);
+		hi = (BUN) (MIN(last + 1, cend) - cfirst);
+		for (; lo < hi && lo % 64 != 0; lo++)
+			w[lo / 64] |= (ulng) 1 << (lo % 64);
+		for (; lo + 64 <= hi; lo += 64)
+			w[lo / 64] = ~(ulng) 0;
+		for (; lo < hi; lo++)
+			w[lo / 64] |= (ulng) 1 << (lo % 64);
+	} else {
+		const oid *o = (const oid *) Tloc(s, 0);
+		BUN n = BATcount(s);
+
+		for (k = 0; k < n; k++)
+			if (o[k] >= cfirst && o[k] < cend)
+				w[(o[k] - cfirst) / 64] |= (ulng) 1 << ((o[k] - cfirst) % 64);
+	}
+}
+
+/* BATmergecand (merge set) and BATintersectcand (merge not set) when
+ * at least one of the lists is a bitmap: the lists are turned into
+ * bitmaps over the range of the result and combined word by word */
+BAT *
+CMPmaskcombine(BAT *a, BAT *b, int merge)
+{
+	oid af = 0, al = 0, bf = 0, bl = 0, first, last;
+	Compressed *c, *cb;
+	BUN nw, k;
+	ulng *w;
+	const ulng *bw;
+	BAT *bn;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	if (BATcount(a) == 0 || BATcount(b) == 0) {
+		if (!merge)
+			return BATdense(0, 0, 0);
+		if (BATcount(a) == 0)
+			a = b;
+		b = a;
+	}
+	CMPmaskrange(a, &af, &al);
+	CMPmaskrange(b, &bf, &bl);
+	if (merge) {
+		first = MIN(af, bf);
+		last = MAX(al, bl);
+		if (!CANDmaskworthwhile(MAX(BATcount(a), BATcount(b)), first, last)) {
+			/* the lists are far apart: materialize */
+			if (BATdecompress(a) != GDK_SUCCEED ||
+			    BATdecompress(b) != GDK_SUCCEED)
+				return NULL;
+			return BATmergecand(a, b);
+		}
+	} else {
+		first = MAX(af, bf);
+		last = MIN(al, bl);
+		if (first > last)
+			return BATdense(0, 0, 0);
+		if (!CMPmask(a) || !CMPmask(b)) {
+			if (CMPmask(b)) {
+				bn = a;
+				a = b;
+				b = bn;
+			}
+			if (!BATtdense(b)) {
+				/* filter the materialized list b
+				 * through the bitmap a */
+				const Compressed *ca = a->tcompressed;
+				const ulng *aw = (const ulng *) ca->codes.base;
+				const oid *o = (const oid *) Tloc(b, 0);
+				oid *restrict dst, x;
+				BUN n = BATcount(b), cnt = 0;
+
+				if ((bn = COLnew(0, TYPE_oid, n, TRANSIENT)) == NULL)
+					return NULL;
+				dst = (oid *) Tloc(bn, 0);
+				for (k = 0; k < n; k++) {
+					if (o[k] < first || o[k] > last)
+						continue;
+					x = o[k] - (oid) ca->base;
+					if ((aw[x / 64] >> (x % 64)) & 1)
+						dst[cnt++] = o[k];
+				}
+				BATsetcount(bn, cnt);
+				bn->tsorted = 1;
+				bn->trevsorted = cnt <= 1;
+				bn->tkey = 1;
+				bn->tnonil = 1;
+				bn->tnil = 0;
+				return virtualize(bn);
+			}
+		}
+	}
+	if ((c = CMPmasknew(first, last - first + 1)) == NULL)
+		return NULL;
+	CMPmaskadd(c, a);
+	if (merge) {
+		CMPmaskadd(c, b);
+	} else {
+		if ((cb = CMPmasknew(first, last - first + 1)) == NULL) {
+			CMPfree(c);
+			return NULL;
+		}
+		CMPmaskadd(cb, b);
+		w = (ulng *) c->codes.base;
+		bw = (const ulng *) cb->codes.base;
+		nw = CMPmaskwords(c->range);
+		for (k = 0; k < nw; k++)
+			w[k] &= bw[k];
+		CMPfree(cb);
+	}
+	bn = CMPmaskresult(c, 1);
+	ALGODEBUG fprintf(stderr, "#%s(a=%s#" BUNFMT ",b=%s#" BUNFMT
+			  "): bitmap " BUNFMT " (" LLFMT " usec)\n",
+			  merge ? "BATmergecand" : "BATintersectcand",
+			  BATgetId(a), BATcount(a), BATgetId(b), BATcount(b),
+			  bn ? BATcount(bn) : 0, GDKusec() - t0);
+	return bn;
+}
@@ -100,20 +100,233 @@
 		oids[p2] = item;		\
 	} while (0)
 
+/* Values are tested against the root of the heap (the "last" of the
+ * first N seen so far) a block at a time in a loop that the compiler
+ * can vectorize.  Only if a value in the block makes it into the heap
+ * do we look at the values in the block one by one.  Since the root
+ * quickly becomes very selective, most blocks are skipped. */
+#define FIRSTN_BLOCK	64
+
 #define shuffle_unique(TYPE, OP)					\
 	do {								\
 		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		TYPE top;						\
+		int hit;						\
 		heapify(OP##fix, SWAP1);				\
+		top = vals[oids[0] - b->hseqbase];			\
+		while (cand == NULL && start + FIRSTN_BLOCK <= end) {	\
+			hit = 0;					\
+			for (i = start; i < start + FIRSTN_BLOCK; i++)	\
+				hit |= OP(vals[i], top);		\
+			for (i = start; hit && i < start + FIRSTN_BLOCK; i++) { \
+				if (OP(vals[i], top)) {			\
+					oids[0] = i + b->hseqbase;	\
+					siftup(OP##fix, 0, SWAP1);	\
+					top = vals[oids[0] - b->hseqbase]; \
+				}					\
+			}						\
+			start += FIRSTN_BLOCK;				\
+		}							\
 		while (cand ? cand < candend : start < end) {		\
 			i = cand ? *cand++ : start++ + b->hseqbase;	\
-			if (OP(vals[i - b->hseqbase],			\
-				 vals[oids[0] - b->hseqbase])) {	\
+			if (OP(vals[i - b->hseqbase], top)) {		\
 				oids[0] = i;				\
 				siftup(OP##fix, 0, SWAP1);		\
+				top = vals[oids[0] - b->hseqbase];	\
+			}						\
+		}							\
+	} while (0)
+
+/* If the input happens to be almost sorted in ascending order
+ * (likely a common use case), it is more efficient to start off with
+ * the first n elements when doing a firstn-ascending and to start off
+ * with the last n elements when doing a firstn-descending so that
+ * most values that we look at after this will be skipped. */
+#define firstn_seed()							\
+	do {								\
+		if (cand) {						\
+			if (asc) {					\
+				for (i = 0; i < n; i++)			\
+					oids[i] = *cand++;		\
+			} else {					\
+				for (i = 0; i < n; i++)			\
+					oids[i] = *--candend;		\
+			}						\
+		} else {						\
+			if (asc) {					\
+				for (i = 0; i < n; i++)			\
+					oids[i] = start++ + b->hseqbase; \
+			} else {					\
+				for (i = 0; i < n; i++)			\
+					oids[i] = --end + b->hseqbase;	\
 			}						\
 		}							\
 	} while (0)
 
+/* Fill oids with a heap of the oids of the n smallest (asc) or
+ * largest (!asc) values in b of fixed-size base type tpe, considering
+ * either the candidates [cand,candend) (which need not be sorted) or,
+ * if cand is NULL, the positions [start,end).  There must be at least
+ * n values to consider.  The root of the heap (oids[0]) refers to the
+ * "last" value. */
+static void
+firstn_fix(BAT *b, const oid *restrict cand, const oid *restrict candend,
+	   BUN start, BUN end, BUN n, int asc, int tpe, oid *restrict oids)
+{
+	BUN i;
+	/* variables used in heapify/siftup macros */
+	oid item;
+	BUN pos, childpos;
+
+	firstn_seed();
+	if (asc) {
+		switch (tpe) {
+		case TYPE_bte:
+			shuffle_unique(bte, LT);
+			break;
+		case TYPE_sht:
+			shuffle_unique(sht, LT);
+			break;
+		case TYPE_int:
+			shuffle_unique(int, LT);
+			break;
+		case TYPE_lng:
+			shuffle_unique(lng, LT);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			shuffle_unique(hge, LT);
+			break;
+#endif
+		case TYPE_flt:
+			shuffle_unique(flt, LT);
+			break;
+		case TYPE_dbl:
+			shuffle_unique(dbl, LT);
+			break;
+		default:
+			assert(0);
+		}
+	} else {
+		switch (tpe) {
+		case TYPE_bte:
+			shuffle_unique(bte, GT);
+			break;
+		case TYPE_sht:
+			shuffle_unique(sht, GT);
+			break;
+		case TYPE_int:
+			shuffle_unique(int, GT);
+			break;
+		case TYPE_lng:
+			shuffle_unique(lng, GT);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			shuffle_unique(hge, GT);
+			break;
+#endif
+		case TYPE_flt:
+			shuffle_unique(flt, GT);
+			break;
+		case TYPE_dbl:
+			shuffle_unique(dbl, GT);
+			break;
+		default:
+			assert(0);
+		}
+	}
+}
+
+/* minimum number of values before we consider a parallel first-N */
+#define FIRSTN_PARALLEL	((BUN) 1 << 20)
+/* minimum number of values per thread */
+#define FIRSTN_MINRUN	((BUN) 1 << 18)
+/* minimum ratio between the number of values per thread and n: the
+ * final merge looks at n values of each thread */
+#define FIRSTN_RATIO	16
+
+/* Each worker computes the first N of a slice of the input in a heap
+ * of its own.  The first N of the union of the results of the
+ * workers is then the first N of the whole input. */
+struct firstnworker {
+	BAT *b;
+	const oid *cand, *candend;
+	BUN start, end;
+	BUN n;
+	int asc, tpe;
+	oid *oids;		/* the heap of this worker */
+};
+
+static void
+firstnworker(void *arg)
+{
+	struct firstnworker *w = arg;
+
+	firstn_fix(w->b, w->cand, w->candend, w->start, w->end,
+		   w->n, w->asc, w->tpe, w->oids);
+}
+
+/* Like firstn_fix, but with the input split over multiple threads if
+ * it is large enough. */
+static void
+firstn_parallel(BAT *b, const oid *cand, const oid *candend,
+		BUN start, BUN end, BUN n, int asc, int tpe, oid *oids)
+{
+	struct firstnworker *ws;
+	oid *all;
+	BUN cnt = cand ? (BUN) (candend - cand) : end - start;
+	int i, nthreads = GDKnr_threads;
+	lng t0 = 0;
+
+	if (nthreads > 64)
+		nthreads = 64;
+	if ((BUN) nthreads > cnt / FIRSTN_MINRUN)
+		nthreads = (int) (cnt / FIRSTN_MINRUN);
+	if ((BUN) nthreads > cnt / (n * FIRSTN_RATIO))
+		nthreads = (int) (cnt / (n * FIRSTN_RATIO));
+	if (cnt < FIRSTN_PARALLEL || nthreads <= 1) {
+		firstn_fix(b, cand, candend, start, end, n, asc, tpe, oids);
+		return;
+	}
+	ws = GDKmalloc(nthreads * sizeof(struct firstnworker));
+	all = GDKmalloc(nthreads * n * sizeof(oid));
+	if (ws == NULL || all == NULL) {
+		/* not fatal: do it all in this thread */
+		GDKfree(ws);
+		GDKfree(all);
+		GDKclrerr();
+		firstn_fix(b, cand, candend, start, end, n, asc, tpe, oids);
+		return;
+	}
+	ALGODEBUG t0 = GDKusec();
+	for (i = 0; i < nthreads; i++) {
+		ws[i].b = b;
+		if (cand) {
+			ws[i].cand = cand + cnt * i / nthreads;
+			ws[i].candend = cand + cnt * (i + 1) / nthreads;
+		} else {
+			ws[i].cand = ws[i].candend = NULL;
+		}
+		ws[i].start = start + cnt * i / nthreads;
+		ws[i].end = start + cnt * (i + 1) / nthreads;
+		ws[i].n = n;
+		ws[i].asc = asc;
+		ws[i].tpe = tpe;
+		ws[i].oids = all + i * n;
+	}
+	GDKparallel(firstnworker, ws, sizeof(struct firstnworker), nthreads);
+	/* merge the heaps of the workers */
+	firstn_fix(b, all, all + nthreads * n, 0, 0, n, asc, tpe, oids);
+	ALGODEBUG fprintf(stderr, "#BATfirstn: first " BUNFMT " of " BUNFMT
+			  " values of type %s%s with %d threads ("
+			  LLFMT " usec)\n", n, cnt, ATOMname(b->ttype),
+			  asc ? "" : ", descending", nthreads,
+			  GDKusec() - t0);
+	GDKfree(ws);
+	GDKfree(all);
+}
+
 /* This version of BATfirstn returns a list of N oids (where N is the
  * smallest among BATcount(b), BATcount(s), and n).  The oids returned
  * refer to the N smallest/largest (depending on asc) tail values of b
@@ -205,55 +418,21 @@ BATfirstn_unique(BAT *b, BAT *s, BUN n, int asc, oid *lastp)
 	/* if base type has same comparison function as type itself, we
 	 * can use the base type */
 	tpe = ATOMbasetype(tpe); /* takes care of oid */
-	/* if the input happens to be almost sorted in ascending order
-	 * (likely a common use case), it is more efficient to start
-	 * off with the first n elements when doing a firstn-ascending
-	 * and to start off with the last n elements when doing a
-	 * firstn-descending so that most values that we look at after
-	 * this will be skipped. */
-	if (cand) {
-		if (asc) {
-			for (i = 0; i < n; i++)
-				oids[i] = *cand++;
-		} else {
-			for (i = 0; i < n; i++)
-				oids[i] = *--candend;
-		}
-	} else {
-		if (asc) {
-			for (i = 0; i < n; i++)
-				oids[i] = start++ + b->hseqbase;
-		} else {
-			for (i = 0; i < n; i++)
-				oids[i] = --end + b->hseqbase;
-		}
-	}
-	if (asc) {
-		switch (tpe) {
-		case TYPE_bte:
-			shuffle_unique(bte, LT);
-			break;
-		case TYPE_sht:
-			shuffle_unique(sht, LT);
-			break;
-		case TYPE_int:
-			shuffle_unique(int, LT);
-			break;
-		case TYPE_lng:
-			shuffle_unique(lng, LT);
-			break;
+	switch (tpe) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
 #ifdef HAVE_HGE
-		case TYPE_hge:
-			shuffle_unique(hge, LT);
-			break;
+	case TYPE_hge:
 #endif
-		case TYPE_flt:
-			shuffle_unique(flt, LT);
-			break;
-		case TYPE_dbl:
-			shuffle_unique(dbl, LT);
-			break;
-		default:
+	case TYPE_flt:
+	case TYPE_dbl:
+		firstn_parallel(b, cand, candend, start, end, n, asc, tpe, oids);
+		break;
+	default:
+		firstn_seed();
+		if (asc) {
 			heapify(LTany, SWAP1);
 			while (cand ? cand < candend : start < end) {
 				i = cand ? *cand++ : start++ + b->hseqbase;
@@ -263,34 +442,7 @@ BATfirstn_unique(BAT *b, BAT *s, BUN n, int asc, oid *lastp)
 					siftup(LTany, 0, SWAP1);
 				}
 			}
-			break;
-		}
-	} else {
-		switch (tpe) {
-		case TYPE_bte:
-			shuffle_unique(bte, GT);
-			break;
-		case TYPE_sht:
-			shuffle_unique(sht, GT);
-			break;
-		case TYPE_int:
-			shuffle_unique(int, GT);
-			break;
-		case TYPE_lng:
-			shuffle_unique(lng, GT);
-			break;
-#ifdef HAVE_HGE
-		case TYPE_hge:
-			shuffle_unique(hge, GT);
-			break;
-#endif
-		case TYPE_flt:
-			shuffle_unique(flt, GT);
-			break;
-		case TYPE_dbl:
-			shuffle_unique(dbl, GT);
-			break;
-		default:
+		} else {
 			heapify(GTany, SWAP1);
 			while (cand ? cand < candend : start < end) {
 				i = cand ? *cand++ : start++ + b->hseqbase;
@@ -300,8 +452,8 @@ BATfirstn_unique(BAT *b, BAT *s, BUN n, int asc, oid *lastp)
 					siftup(GTany, 0, SWAP1);
 				}
 			}
-			break;
 		}
+		break;
 	}
 	if (lastp)
 		*lastp = oids[0]; /* store id of largest value */
@@ -40,7 +40,7 @@
  * is always created.  In other words, the groups argument may not be
  * NULL, but the extents and histo arguments may be NULL.
  *
- * There are six different implementations of the grouping code.
+ * There are seven different implementations of the grouping code.
  *
  * If it can be trivially determined that all groups are singletons,
  * we can produce the outputs trivially.
@@ -58,6 +58,11 @@
  *
  * If a hash table already exists on b, we can make use of it.
  *
+ * If b is large and of a fixed-size numeric type and we may use
+ * multiple threads, we partition the values by hash and let each
+ * thread group its own partition, after which the group ids are
+ * renumbered so that the result is the same as in the serial case.
+ *
  * Otherwise we build a partial hash table on the fly.
  *
  * A decision should be made on the order in which grouping occurs.
@@ -523,6 +528,364 @@ pop(oid x)
 	)
 
 
+/* Parallel grouping.  The values are partitioned by hash value over
+ * the threads, and each thread builds a hash table containing the
+ * groups of its own partition, remembering for each group its first
+ * occurrence and its size.  Since each thread scans all values in
+ * order, the groups within a partition are numbered in order of
+ * first occurrence, so the global group id of a group is its local
+ * number plus the number of groups in the other partitions that
+ * occur earlier.  In the last phase, the input is divided into
+ * slices, and each thread looks up the values of its slice in the
+ * hash tables to assign the global group ids.  The result is the
+ * same as that of the serial implementation. */
+
+/* minimum number of values before we consider grouping in parallel */
+#define GRP_PARALLEL_MIN	((BUN) 1 << 20)
+
+struct grpparallel {
+	const void *vals;	/* values of b */
+	const oid *cand;	/* candidate list, or NULL */
+	BUN start;		/* first value of b if no candidate list */
+	oid seq;		/* hseqbase of b */
+	BUN cnt;		/* number of values to group */
+	const oid *grps;	/* pre-existing grouping, or NULL */
+	oid *ngrps;		/* output groups */
+	oid *exts;		/* output extents, or NULL */
+	lng *cnts;		/* output histogram, or NULL */
+	int tpe;		/* (base) type of the values */
+	int nthreads;
+	int phase;		/* enum grpphase */
+	struct grpworker *ws;
+};
+
+struct grpworker {
+	struct grpparallel *gp;
+	int idx;		/* worker number, also partition number */
+	BUN lo, hi;		/* slice of values for the last phase */
+	BUN *buckets;		/* hash table on the groups of the partition */
+	BUN mask;		/* number of buckets minus one */
+	BUN *first;		/* per group: first occurrence */
+	BUN *link;		/* per group: next group in bucket chain */
+	lng *sizes;		/* per group: number of occurrences */
+	oid *gids;		/* per group: global group id */
+	BUN ngrp, cap;		/* used and allocated size of group arrays */
+	int sorted;		/* whether group ids of slice are sorted */
+	int failed;
+};
+
+enum grpphase {
+	GRP_PARTITION,		/* group the values of a partition */
+	GRP_NUMBER,		/* calculate global group ids */
+	GRP_ASSIGN		/* assign group ids to a slice of values */
+};
+
+#define GRPPARVAL(TYPE, gp, r)						\
+	(((const TYPE *) (gp)->vals)[(gp)->cand ? (gp)->cand[r] - (gp)->seq : (gp)->start + (r)])
+#define GRPPARHASH(HTYPE, gp, r)					\
+	((BUN) mix_##HTYPE(GRPPARVAL(HTYPE, gp, r)) ^			\
+	 ((gp)->grps ? (BUN) mix_lng((ulng) (gp)->grps[r] * LL_CONSTANT(0x9E3779B97F4A7C15)) : 0))
+/* find the group of value r in the hash table of worker w, the
+ * result (k) is BUN_NONE if not found */
+#define GRPPARFIND(TYPE, gp, w, r, h, k)				\
+	do {								\
+		for (k = (w)->buckets[((h) / (gp)->nthreads) & (w)->mask]; \
+		     k != BUN_NONE;					\
+		     k = (w)->link[k]) {				\
+			if (GRPPARVAL(TYPE, gp, (w)->first[k]) ==	\
+			    GRPPARVAL(TYPE, gp, r) &&			\
+			    ((gp)->grps == NULL ||			\
+			     (gp)->grps[(w)->first[k]] == (gp)->grps[r])) \
+				break;					\
+		}							\
+	} while (0)
+
+/* make room for more groups in the worker's group arrays */
+static gdk_return
+grpgrow(struct grpworker *w)
+{
+	BUN cap = w->cap < GROUPBATINCR ? GROUPBATINCR : w->cap * 2;
+	BUN *first, *link;
+	lng *sizes;
+
+	if ((first = GDKrealloc(w->first, cap * sizeof(BUN))) == NULL) {
+		w->failed = 1;
+		return GDK_FAIL;
+	}
+	w->first = first;
+	if ((link = GDKrealloc(w->link, cap * sizeof(BUN))) == NULL) {
+		w->failed = 1;
+		return GDK_FAIL;
+	}
+	w->link = link;
+	if ((sizes = GDKrealloc(w->sizes, cap * sizeof(lng))) == NULL) {
+		w->failed = 1;
+		return GDK_FAIL;
+	}
+	w->sizes = sizes;
+	w->cap = cap;
+	return GDK_SUCCEED;
+}
+
+/* TYPE is the type used for comparing values, HTYPE is the type
+ * whose bit pattern is used for hashing (they differ for floating
+ * point types) */
+#define GRPPARALLEL_IMPL(TYPE, HTYPE)					\
+static void								\
+grppartition_##TYPE(struct grpworker *w)				\
+{									\
+	struct grpparallel *gp = w->gp;					\
+	BUN r, h, k, prb;						\
+									\
+	for (r = 0; r < gp->cnt; r++) {					\
+		h = GRPPARHASH(HTYPE, gp, r);				\
+		if (h % gp->nthreads != (BUN) w->idx)			\
+			continue;					\
+		GRPPARFIND(TYPE, gp, w, r, h, k);			\
+		if (k == BUN_NONE) {					\
+			if (w->ngrp == w->cap &&			\
+			    grpgrow(w) != GDK_SUCCEED)			\
+				return;					\
+			k = w->ngrp++;					\
+			prb = (h / gp->nthreads) & w->mask;		\
+			w->first[k] = r;				\
+			w->sizes[k] = 0;				\
+			w->link[k] = w->buckets[prb];			\
+			w->buckets[prb] = k;				\
+		}							\
+		w->sizes[k]++;						\
+	}								\
+}									\
+									\
+static void								\
+grpassign_##TYPE(struct grpworker *w)					\
+{									\
+	struct grpparallel *gp = w->gp;					\
+	struct grpworker *u;						\
+	BUN r, h, k;							\
+	oid prev = 0;							\
+									\
+	w->sorted = 1;							\
+	for (r = w->lo; r < w->hi; r++) {				\
+		h = GRPPARHASH(HTYPE, gp, r);				\
+		u = &gp->ws[h % gp->nthreads];				\
+		GRPPARFIND(TYPE, gp, u, r, h, k);			\
+		assert(k != BUN_NONE);					\
+		gp->ngrps[r] = u->gids[k];				\
+		if (r > w->lo && gp->ngrps[r] < prev)			\
+			w->sorted = 0;					\
+		prev = gp->ngrps[r];					\
+	}								\
+}
+
+GRPPARALLEL_IMPL(int, int)
+GRPPARALLEL_IMPL(lng, lng)
+#ifdef HAVE_HGE
+GRPPARALLEL_IMPL(hge, hge)
+#endif
+GRPPARALLEL_IMPL(flt, int)
+GRPPARALLEL_IMPL(dbl, lng)
+
+/* The global group id of a group is its number within its own
+ * partition plus the number of groups in the other partitions whose
+ * first occurrence comes earlier.  Since the groups in each
+ * partition are sorted on first occurrence, we can count those by
+ * merging. */
+static void
+grpnumber(struct grpworker *w)
+{
+	struct grpparallel *gp = w->gp;
+	struct grpworker *u;
+	BUN j, k;
+	int i;
+
+	if (w->ngrp == 0)
+		return;
+	if ((w->gids = GDKmalloc(w->ngrp * sizeof(oid))) == NULL) {
+		w->failed = 1;
+		return;
+	}
+	for (j = 0; j < w->ngrp; j++)
+		w->gids[j] = (oid) j;
+	for (i = 0; i < gp->nthreads; i++) {
+		if (i == w->idx)
+			continue;
+		u = &gp->ws[i];
+		for (j = 0, k = 0; j < w->ngrp; j++) {
+			while (k < u->ngrp && u->first[k] < w->first[j])
+				k++;
+			w->gids[j] += (oid) k;
+		}
+	}
+	for (j = 0; j < w->ngrp; j++) {
+		if (gp->exts)
+			gp->exts[w->gids[j]] = gp->cand ? gp->cand[w->first[j]] : gp->seq + gp->start + w->first[j];
+		if (gp->cnts)
+			gp->cnts[w->gids[j]] = w->sizes[j];
+	}
+}
+
+static void
+grpworker(void *arg)
+{
+	struct grpworker *w = arg;
+
+#ifdef HAVE_HGE
+#define GRPCALL(phase)							\
+	do {								\
+		switch (w->gp->tpe) {					\
+		case TYPE_int: phase##_int(w); break;			\
+		case TYPE_lng: phase##_lng(w); break;			\
+		case TYPE_hge: phase##_hge(w); break;			\
+		case TYPE_flt: phase##_flt(w); break;			\
+		case TYPE_dbl: phase##_dbl(w); break;			\
+		}							\
+	} while (0)
+#else
+#define GRPCALL(phase)							\
+	do {								\
+		switch (w->gp->tpe) {					\
+		case TYPE_int: phase##_int(w); break;			\
+		case TYPE_lng: phase##_lng(w); break;			\
+		case TYPE_flt: phase##_flt(w); break;			\
+		case TYPE_dbl: phase##_dbl(w); break;			\
+		}							\
+	} while (0)
+#endif
+	switch ((enum grpphase) w->gp->phase) {
+	case GRP_PARTITION:
+		GRPCALL(grppartition);
+		break;
+	case GRP_NUMBER:
+		grpnumber(w);
+		break;
+	case GRP_ASSIGN:
+		GRPCALL(grpassign);
+		break;
+	}
+#undef GRPCALL
+}
+
+/* Return whether the parallel implementation can and should be used
+ * to group cnt values of (storage) type t. */
+static int
+grpparallel_usable(int t, BUN cnt)
+{
+	if (GDKnr_threads <= 1 || cnt < GRP_PARALLEL_MIN)
+		return 0;
+	switch (t) {
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* Group the cnt values of b (restricted by start or cand) of type t
+ * in parallel, subdividing the groups in grps if set.  The group ids
+ * are written to ngrps; the extents and histogram are written to *enp
+ * and *hnp if set, which are extended when needed.  The number of
+ * groups is returned in *ngrpp, and whether ngrps is sorted in
+ * *sortedp. */
+static gdk_return
+grpparallel(BAT *b, const oid *cand, BUN start, BUN cnt,
+	    const oid *grps, int t, oid *ngrps,
+	    BAT *en, BAT *hn, oid *ngrpp, int *sortedp)
+{
+	struct grpparallel gp;
+	struct grpworker *ws;
+	int i, nthreads = GDKnr_threads;
+	BUN mask, ngrp, j;
+	lng t0 = GDKusec();
+	gdk_return rc = GDK_FAIL;
+
+	if ((ws = GDKzalloc(nthreads * sizeof(struct grpworker))) == NULL)
+		return GDK_FAIL;
+	gp.vals = Tloc(b, 0);
+	gp.cand = cand;
+	gp.start = start;
+	gp.seq = b->hseqbase;
+	gp.cnt = cnt;
+	gp.grps = grps;
+	gp.ngrps = ngrps;
+	gp.exts = NULL;
+	gp.cnts = NULL;
+	gp.tpe = t;
+	gp.nthreads = nthreads;
+	gp.ws = ws;
+	mask = HASHmask(cnt / nthreads) - 1;
+	for (i = 0; i < nthreads; i++) {
+		ws[i].gp = &gp;
+		ws[i].idx = i;
+		ws[i].lo = cnt * i / nthreads;
+		ws[i].hi = cnt * (i + 1) / nthreads;
+		ws[i].mask = mask;
+		if ((ws[i].buckets = GDKmalloc((mask + 1) * sizeof(BUN))) == NULL)
+			goto bailout;
+		for (j = 0; j <= mask; j++)
+			ws[i].buckets[j] = BUN_NONE;
+	}
+
+	gp.phase = GRP_PARTITION;
+	GDKparallel(grpworker, ws, sizeof(struct grpworker), nthreads);
+	ngrp = 0;
+	for (i = 0; i < nthreads; i++) {
+		if (ws[i].failed)
+			goto bailout;
+		ngrp += ws[i].ngrp;
+	}
+	ALGODEBUG fprintf(stderr, "#BATgroup: %d threads, " BUNFMT
+			  " groups, partitioning " LLFMT "usec\n",
+			  nthreads, ngrp, GDKusec() - t0);
+	if (en) {
+		if (BATcapacity(en) < ngrp &&
+		    BATextend(en, ngrp) != GDK_SUCCEED)
+			goto bailout;
+		gp.exts = (oid *) Tloc(en, 0);
+	}
+	if (hn) {
+		if (BATcapacity(hn) < ngrp &&
+		    BATextend(hn, ngrp) != GDK_SUCCEED)
+			goto bailout;
+		gp.cnts = (lng *) Tloc(hn, 0);
+	}
+	gp.phase = GRP_NUMBER;
+	GDKparallel(grpworker, ws, sizeof(struct grpworker), nthreads);
+	for (i = 0; i < nthreads; i++)
+		if (ws[i].failed)
+			goto bailout;
+	gp.phase = GRP_ASSIGN;
+	GDKparallel(grpworker, ws, sizeof(struct grpworker), nthreads);
+	*sortedp = 1;
+	for (i = 0; i < nthreads; i++) {
+		if (!ws[i].sorted ||
+		    (i > 0 && ws[i].lo < ws[i].hi && ws[i - 1].lo < ws[i - 1].hi &&
+		     ngrps[ws[i].lo] < ngrps[ws[i - 1].hi - 1]))
+			*sortedp = 0;
+	}
+	*ngrpp = (oid) ngrp;
+	rc = GDK_SUCCEED;
+
+  bailout:
+	for (i = 0; i < nthreads; i++) {
+		GDKfree(ws[i].buckets);
+		GDKfree(ws[i].first);
+		GDKfree(ws[i].link);
+		GDKfree(ws[i].sizes);
+		GDKfree(ws[i].gids);
+	}
+	GDKfree(ws);
+	if (rc != GDK_SUCCEED)
+		GDKerror("BATgroup: cannot allocate memory for parallel grouping\n");
+	return rc;
+}
+
 gdk_return
 BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 		  BAT *b, BAT *s, BAT *g, BAT *e, BAT *h, int subsorted)
@@ -1070,6 +1433,27 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 			GRP_use_existing_hash_table_any();
 			break;
 		}
+	} else if (grpparallel_usable(t, cnt)) {
+		int sorted;
+
+		/* large input and we may use multiple threads: group
+		 * the hash partitions in parallel */
+		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT "[%s],"
+				  "s=%s#" BUNFMT ","
+				  "g=%s#" BUNFMT ","
+				  "e=%s#" BUNFMT ","
+				  "h=%s#" BUNFMT ",subsorted=%d): "
+				  "parallel partitioned hash tables\n",
+				  BATgetId(b), BATcount(b), ATOMname(b->ttype),
+				  s ? BATgetId(s) : "NULL", s ? BATcount(s) : 0,
+				  g ? BATgetId(g) : "NULL", g ? BATcount(g) : 0,
+				  e ? BATgetId(e) : "NULL", e ? BATcount(e) : 0,
+				  h ? BATgetId(h) : "NULL", h ? BATcount(h) : 0,
+				  subsorted);
+		if (grpparallel(b, cand, start, cnt, grps, t, ngrps,
+				en, hn, &ngrp, &sorted) != GDK_SUCCEED)
+			goto error;
+		gn->tsorted = sorted != 0;
 	} else {
 		bit gc = g && (BATordered(g) || BATordered_rev(g));
 		const char *nme;
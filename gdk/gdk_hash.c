@@ -30,6 +30,12 @@
  * number of collisssions occurs (mask/2) then we abandon the attempt
  * and restart with a mask that is 4 times larger. This converges
  * after three cycles to direct hashing.
+ *
+ * When values are appended to a BAT, its hash table is maintained
+ * rather than destroyed.  If the capacity of the BAT grows, the link
+ * array is grown along with it (HASHgrow), and if the bucket chains
+ * become too long, the hash table is rebuilt in place with a larger
+ * mask (HASHrehash).
  */
 
 #include "monetdb_config.h"
@@ -98,6 +104,7 @@ HASHnew(Heap *hp, int tpe, BUN size, BUN mask, BUN count)
 
 	if (HEAPalloc(hp, mask + size + HASH_HEADER_SIZE * SIZEOF_SIZE_T / width, width) != GDK_SUCCEED)
 		return NULL;
+	HEAPadvise(hp, MMAP_RANDOM);
 	hp->free = (mask + size) * width + HASH_HEADER_SIZE * SIZEOF_SIZE_T;
 	h = GDKmalloc(sizeof(Hash));
 	if (h == NULL)
@@ -248,10 +255,15 @@ BATcheckhash(BAT *b)
 					}
 					h->Link = hp->base + HASH_HEADER_SIZE * SIZEOF_SIZE_T;
 					h->Hash = (void *) ((char *) h->Link + h->lim * h->width);
+					HEAPadvise(hp, MMAP_RANDOM);
 					close(fd);
 					hp->parentid = b->batCacheid;
 					hp->dirty = FALSE;
 					b->thash = h;
+					/* the capacity of b may have
+					 * changed since the hash was
+					 * saved */
+					HASHgrow(b, BATcapacity(b));
 					ALGODEBUG fprintf(stderr, "#BATcheckhash: reusing persisted hash %s\n", BATgetId(b));
 					MT_lock_unset(&GDKhashLock(b->batCacheid));
 					return 1;
@@ -289,7 +301,7 @@ BAThashsync(void *arg)
 
 	ALGODEBUG t0 = GDKusec();
 
-	if (HEAPsave(hp, hp->filename, NULL) == GDK_SUCCEED &&
+	if (HEAPsave(hp, hp->filename, NULL, TRUE) == GDK_SUCCEED &&
 	    (fd = GDKfdlocate(hp->farmid, hp->filename, "rb+", NULL)) >= 0) {
 		((size_t *) hp->base)[0] |= 1 << 24;
 		if (write(fd, hp->base, SIZEOF_SIZE_T) >= 0) {
@@ -314,6 +326,48 @@ BAThashsync(void *arg)
 }
 #endif
 
+/* add the values at positions [p,q) of b to the hash table h */
+static void
+HASHbuild(BAT *b, Hash *h, BUN p, BUN q)
+{
+	BATiter bi = bat_iterator(b);
+
+	switch (b->ttype == TYPE_void ? TYPE_void : ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		finishhash(bte);
+		break;
+	case TYPE_sht:
+		finishhash(sht);
+		break;
+	case TYPE_int:
+		finishhash(int);
+		break;
+	case TYPE_flt:
+		finishhash(flt);
+		break;
+	case TYPE_dbl:
+		finishhash(dbl);
+		break;
+	case TYPE_lng:
+		finishhash(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		finishhash(hge);
+		break;
+#endif
+	default:
+		for (; p < q; p++) {
+			ptr v = BUNtail(bi, p);
+			BUN c = (BUN) heap_hash_any(b->tvheap, h, v);
+
+			HASHputlink(h, p, HASHget(h, c));
+			HASHput(h, c, p);
+		}
+		break;
+	}
+}
+
 /*
  * The prime routine for the BAT layer is to create a new hash index.
  * Its argument is the element type and the maximum number of BUNs be
@@ -460,41 +514,7 @@ BAThash(BAT *b, BUN masksize)
 		} while (r < p && mask < maxmask && (mask <<= 2));
 
 		/* finish the hashtable with the current mask */
-		p = r;
-		switch (tpe) {
-		case TYPE_bte:
-			finishhash(bte);
-			break;
-		case TYPE_sht:
-			finishhash(sht);
-			break;
-		case TYPE_int:
-			finishhash(int);
-			break;
-		case TYPE_flt:
-			finishhash(flt);
-			break;
-		case TYPE_dbl:
-			finishhash(dbl);
-			break;
-		case TYPE_lng:
-			finishhash(lng);
-			break;
-#ifdef HAVE_HGE
-		case TYPE_hge:
-			finishhash(hge);
-			break;
-#endif
-		default:
-			for (; p < q; p++) {
-				ptr v = BUNtail(bi, p);
-				BUN c = (BUN) heap_hash_any(b->tvheap, h, v);
-
-				HASHputlink(h, p, HASHget(h, c));
-				HASHput(h, c, p);
-			}
-			break;
-		}
+		HASHbuild(b, h, r, q);
 #ifndef NDEBUG
 		/* clear unused part of Link array */
 		memset((char *) h->Link + q * h->width, 0, (h->lim - q) * h->width);
@@ -607,6 +627,9 @@ HASHfree(BAT *b)
 		MT_lock_set(&GDKhashLock(b->batCacheid));
 		if (b->thash && b->thash != (Hash *) -1) {
 			if (b->thash != (Hash *) 1) {
+				/* the hash was maintained when values
+				 * were appended */
+				((size_t *) b->thash->heap->base)[4] = BATcount(b);
 				if (b->thash->heap->storage == STORE_MEM &&
 				    b->thash->heap->dirty) {
 					if (GDKsave(b->thash->heap->farmid,
@@ -662,3 +685,126 @@ HASHgonebad(BAT *b, const void *v)
 	}
 	return 0;		/* a-ok */
 }
+
+/* Make room in the hash table of b for newcap values, i.e. grow the
+ * link array along with the capacity of b.  The entries are widened
+ * if newcap does not fit in the current width.  If growing fails, the
+ * hash table is destroyed. */
+void
+HASHgrow(BAT *b, BUN newcap)
+{
+	Hash *h = b->thash, o;
+	Heap *hp;
+	BUN i, v, nbuckets, cnt = BATcount(b);
+	size_t size;
+	int width;
+
+	if (h == NULL || h == (Hash *) -1)
+		return;
+	if (h == (Hash *) 1) {
+		/* not loaded, and no longer valid */
+		HASHdestroy(b);
+		return;
+	}
+	if (newcap <= h->lim)
+		return;
+	hp = h->heap;
+	width = HASHwidth(newcap);
+	assert(width >= h->width);
+	nbuckets = h->mask + 1;
+	size = (newcap + nbuckets) * width + HASH_HEADER_SIZE * SIZEOF_SIZE_T;
+	if (HEAPextend(hp, size, 0) != GDK_SUCCEED) {
+		GDKclrerr();
+		HASHdestroy(b);
+		return;
+	}
+	hp->free = size;
+	o = *h;
+	o.Link = hp->base + HASH_HEADER_SIZE * SIZEOF_SIZE_T;
+	o.Hash = (void *) ((char *) o.Link + o.lim * o.width);
+	h->Link = o.Link;
+	h->Hash = (void *) ((char *) h->Link + newcap * width);
+	h->lim = newcap;
+	if (width == o.width) {
+		memmove(h->Hash, o.Hash, nbuckets * width);
+	} else {
+		h->width = width;
+#ifdef BUN8
+		h->nil = width == BUN8 ? (BUN) BUN8_NONE : (BUN) BUN4_NONE;
+#else
+		h->nil = (BUN) BUN4_NONE;
+#endif
+		/* widen from back to front, so that no entry is
+		 * overwritten before it is read; the buckets move
+		 * first since the link array grows into them */
+		for (i = nbuckets; i > 0; i--) {
+			v = HASHget(&o, i - 1);
+			HASHput(h, i - 1, v == o.nil ? h->nil : v);
+		}
+		for (i = cnt; i > 0; i--) {
+			v = HASHgetlink(&o, i - 1);
+			HASHputlink(h, i - 1, v == o.nil ? h->nil : v);
+		}
+	}
+	((size_t *) hp->base)[1] = newcap;
+	((size_t *) hp->base)[3] = width;
+	hp->dirty = TRUE;
+	ALGODEBUG fprintf(stderr, "#HASHgrow(%s#" BUNFMT "): size " BUNFMT ", width %d\n", BATgetId(b), cnt, newcap, width);
+}
+
+/* Rebuild the hash table of b in place with a mask that suits the
+ * current number of values.  If the mask would not grow, the bucket
+ * chains are long because of the distribution of the values, and the
+ * hash table is destroyed instead. */
+void
+HASHrehash(BAT *b)
+{
+	Hash *h = b->thash;
+	Heap *hp;
+	BUN mask, cnt = BATcount(b);
+	size_t size;
+	lng t0 = 0;
+
+	if (h == NULL || h == (Hash *) 1 || h == (Hash *) -1)
+		return;
+	mask = HASHmask(cnt);
+	if (mask <= h->mask + 1) {
+		HASHdestroy(b);
+		return;
+	}
+	ALGODEBUG t0 = GDKusec();
+	hp = h->heap;
+	size = (h->lim + mask) * h->width + HASH_HEADER_SIZE * SIZEOF_SIZE_T;
+	if (HEAPextend(hp, size, 0) != GDK_SUCCEED) {
+		GDKclrerr();
+		HASHdestroy(b);
+		return;
+	}
+	hp->free = size;
+	h->mask = mask - 1;
+	h->Link = hp->base + HASH_HEADER_SIZE * SIZEOF_SIZE_T;
+	h->Hash = (void *) ((char *) h->Link + h->lim * h->width);
+	HASHclear(h);
+	HASHbuild(b, h, 0, cnt);
+	((size_t *) hp->base)[2] = mask;
+	hp->dirty = TRUE;
+	ALGODEBUG fprintf(stderr, "#HASHrehash(%s#" BUNFMT "): mask " BUNFMT " (" LLFMT " usec)\n", BATgetId(b), cnt, mask, GDKusec() - t0);
+}
+
+/* Add the values that were appended to b at positions start and up
+ * to its hash table (if any). */
+void
+HASHappend(BAT *b, BUN start)
+{
+	BUN cnt = BATcount(b);
+	BATiter bi = bat_iterator(b);
+
+	if (b->thash == NULL || b->thash == (Hash *) 1 ||
+	    b->thash == (Hash *) -1 || start >= cnt)
+		return;
+	assert(b->thash->lim >= cnt);
+	HASHbuild(b, b->thash, start, cnt);
+	b->thash->heap->dirty = TRUE;
+	if (HASHgonebad(b, BUNtail(bi, cnt - 1)))
+		HASHrehash(b);
+}
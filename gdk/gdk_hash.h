@@ -231,15 +231,15 @@ gdk_export BUN HASHlist(Hash *h, BUN i);
  * A new entry is added with HASHins using the BAT, the BUN index, and
  * a pointer to the value to be stored.
  *
- * HASHins receives a BAT* param and is adaptive, killing wrongly
- * configured hash tables.
+ * HASHins receives a BAT* param and is adaptive, rebuilding (or
+ * killing) wrongly configured hash tables.
  * Use HASHins_any or HASHins_<tpe> instead if you know what you're
  * doing or want to keep the hash. */
 #define HASHins(b,i,v)							\
 	do {								\
 		if ((b)->thash) {					\
 			if (((i) & 1023) == 1023 && HASHgonebad((b), (v))) { \
-				HASHdestroy(b);				\
+				HASHrehash(b);				\
 			} else {					\
 				BUN _c = HASHprobe((b)->thash, (v));	\
 				HASHputall((b)->thash, (i), _c);	\
@@ -45,6 +45,7 @@
 #include "monetdb_config.h"
 #include "gdk.h"
 #include "gdk_private.h"
+#include "gdk_atomic.h"
 
 static void *
 HEAPcreatefile(int farmid, size_t *maxsz, const char *fn)
@@ -62,7 +63,7 @@ HEAPcreatefile(int farmid, size_t *maxsz, const char *fn)
 }
 
 static gdk_return HEAPload_intern(Heap *h, const char *nme, const char *ext, const char *suffix, int trunc);
-static gdk_return HEAPsave_intern(Heap *h, const char *nme, const char *ext, const char *suffix);
+static gdk_return HEAPsave_intern(Heap *h, const char *nme, const char *ext, const char *suffix, int dosync);
 
 static char *
 decompose_filename(str nme)
@@ -94,6 +95,7 @@ HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 		h->size = MAX(1, nitems) * itemsize;
 	h->free = 0;
 	h->cleanhash = 0;
+	h->advice = MMAP_NORMAL;
 
 	/* check for overflow */
 	if (itemsize && nitems > (h->size / itemsize)) {
@@ -105,7 +107,14 @@ HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 	    (GDKmem_cursize() + h->size < GDK_mem_maxsize &&
 	     h->size < (h->farmid == 0 ? GDK_mmap_minsize_persistent : GDK_mmap_minsize_transient))) {
 		h->storage = STORE_MEM;
-		h->base = (char *) GDKmalloc(h->size);
+		if (h->farmid == 0) {
+			h->base = (char *) GDKmalloc(h->size);
+			GDKnumaplace(h->base, h->size);
+		} else {
+			/* transient heaps come from the arena of the query */
+			h->base = (char *) GDKarenamalloc(h->size);
+		}
+		GDKhugepages(h->base, h->size);
 		HEAPDEBUG fprintf(stderr, "#HEAPalloc " SZFMT " " PTRFMT "\n", h->size, PTRFMTCAST h->base);
 	}
 	if (h->filename && h->base == NULL) {
@@ -201,6 +210,9 @@ HEAPextend(Heap *h, size_t size, int mayshare)
 		if (p) {
 			h->size = size;
 			h->base = p;
+			h->advice = MMAP_NORMAL;
+			if (h->farmid == 0)
+				GDKnumaplace(h->base, h->size);
  			return GDK_SUCCEED; /* success */
  		}
 		failure = "GDKmremap() failed";
@@ -220,8 +232,14 @@ HEAPextend(Heap *h, size_t size, int mayshare)
 			h->base = GDKrealloc(h->base, size);
 			HEAPDEBUG fprintf(stderr, "#HEAPextend: extending malloced heap " SZFMT " " SZFMT " " PTRFMT " " PTRFMT "\n", size, h->size, PTRFMTCAST bak.base, PTRFMTCAST h->base);
 			h->size = size;
-			if (h->base)
+			if (h->base) {
+				/* the piece of the heap on each
+				 * node changes as the heap grows */
+				if (h->farmid == 0)
+					GDKnumaplace(h->base, h->size);
+				GDKhugepages(h->base, h->size);
 				return GDK_SUCCEED; /* success */
+			}
 			/* bak.base is still valid and may get restored */
 			failure = "h->storage == STORE_MEM && !must_map && !h->base";
 		}
@@ -232,6 +250,8 @@ HEAPextend(Heap *h, size_t size, int mayshare)
 
 			assert(h->storage == STORE_MEM);
 			assert(ext != NULL);
+			/* a memory mapped heap is saved as is */
+			bak.zsave = h->zsave = 0;
 			h->filename = NULL;
 			/* if the heap file already exists, we want to
 			 * switch to STORE_PRIV (copy-on-write memory
@@ -283,7 +303,7 @@ HEAPextend(Heap *h, size_t size, int mayshare)
 				failure = "h->storage == STORE_MEM && can_map && fd >= 0 && HEAPload() != GDK_SUCCEED";
 				/* couldn't allocate, now first save
 				 * data to file */
-				if (HEAPsave_intern(&bak, nme, ext, ".tmp") != GDK_SUCCEED) {
+				if (HEAPsave_intern(&bak, nme, ext, ".tmp", TRUE) != GDK_SUCCEED) {
 					failure = "h->storage == STORE_MEM && can_map && fd >= 0 && HEAPsave_intern() != GDK_SUCCEED";
 					goto failed;
 				}
@@ -361,6 +381,7 @@ HEAPshrink(Heap *h, size_t size)
 	if (p) {
 		h->size = size;
 		h->base = p;
+		h->advice = MMAP_NORMAL;
 		return GDK_SUCCEED;
 	}
 	return GDK_FAIL;
@@ -602,6 +623,7 @@ HEAPfree(Heap *h, int remove)
 	}
 #endif
 	h->base = NULL;
+	h->advice = MMAP_NORMAL;
 	if (h->filename) {
 		if (remove) {
 			char *path = GDKfilepath(h->farmid, BATDIR, h->filename, NULL);
@@ -634,7 +656,8 @@ HEAPload_intern(Heap *h, const char *nme, const char *ext, const char *suffix, i
 	char *srcpath, *dstpath, *tmp;
 	int t0;
 
-	h->storage = h->newstorage = h->size < 4 * GDK_mmap_pagesize ? STORE_MEM : STORE_MMAP;
+	/* a compressed heap can only be read into memory */
+	h->storage = h->newstorage = h->size < 4 * GDK_mmap_pagesize || h->zsave ? STORE_MEM : STORE_MMAP;
 	if (h->filename == NULL)
 		h->filename = (char *) GDKmalloc(strlen(nme) + strlen(ext) + 2);
 	if (h->filename == NULL)
@@ -647,7 +670,7 @@ HEAPload_intern(Heap *h, const char *nme, const char *ext, const char *suffix, i
 
 	/* when a bat is made read-only, we can truncate any unused
 	 * space at the end of the heap */
-	if (trunc) {
+	if (trunc && !h->zsave) {
 		/* round up mmap heap sizes to GDK_mmap_pagesize
 		 * segments, also add some slack */
 		size_t truncsize = ((size_t) (h->free * 1.05) + GDK_mmap_pagesize - 1) & ~(GDK_mmap_pagesize - 1);
@@ -696,9 +719,19 @@ HEAPload_intern(Heap *h, const char *nme, const char *ext, const char *suffix, i
 	GDKfree(srcpath);
 	GDKfree(dstpath);
 
-	h->base = GDKload(h->farmid, nme, ext, h->free, &h->size, h->newstorage);
+	if (h->zsave) {
+		int plain;
+
+		h->base = GDKzload(h->farmid, nme, ext, h->free, &h->size, &plain);
+		/* not saved compressed yet: do so at the next save */
+		if (h->base != NULL && plain)
+			h->dirty = TRUE;
+	} else {
+		h->base = GDKload(h->farmid, nme, ext, h->free, &h->size, h->newstorage);
+	}
 	if (h->base == NULL)
 		return GDK_FAIL; /* file could  not be read satisfactorily */
+	h->advice = MMAP_NORMAL;
 
 	return GDK_SUCCEED;
 }
@@ -725,7 +758,7 @@ HEAPload(Heap *h, const char *nme, const char *ext, int trunc)
  * safe on stable storage.
  */
 static gdk_return
-HEAPsave_intern(Heap *h, const char *nme, const char *ext, const char *suffix)
+HEAPsave_intern(Heap *h, const char *nme, const char *ext, const char *suffix, int dosync)
 {
 	storage_t store = h->newstorage;
 	long_str extension;
@@ -746,13 +779,15 @@ HEAPsave_intern(Heap *h, const char *nme, const char *ext, const char *suffix)
 	HEAPDEBUG {
 		fprintf(stderr, "#HEAPsave(%s.%s,storage=%d,free=" SZFMT ",size=" SZFMT ")\n", nme, ext, (int) h->newstorage, h->free, h->size);
 	}
-	return GDKsave(h->farmid, nme, ext, h->base, h->free, store, TRUE);
+	if (h->zsave && store == STORE_MEM)
+		return GDKzsave(h->farmid, nme, ext, h->base, h->free, dosync);
+	return GDKsave(h->farmid, nme, ext, h->base, h->free, store, dosync);
 }
 
 gdk_return
-HEAPsave(Heap *h, const char *nme, const char *ext)
+HEAPsave(Heap *h, const char *nme, const char *ext, int dosync)
 {
-	return HEAPsave_intern(h, nme, ext, ".new");
+	return HEAPsave_intern(h, nme, ext, ".new", dosync);
 }
 
 /*
@@ -795,6 +830,125 @@ HEAPwarm(Heap *h)
 	return bogus_result;
 }
 
+/*
+ * @- HEAPadvise
+ *
+ * Large heaps are accessed in a few typical ways: a scan reads them
+ * front to back, a hash probe or a projection through unordered oids
+ * hits them at random, and the inner side of a join is read in its
+ * entirety.  For heaps that are memory mapped files we pass this on to
+ * the OS, so that it reads ahead for scans, doesn't read ahead for
+ * random access, and starts reading the inner side of a join before
+ * we get to it.  Setting gdk_madvise=no switches this off.
+ *
+ * Sequential and random access are properties of the whole mapping.
+ * The advice last given is kept in the heap, so that repeating it
+ * doesn't cost a system call (which on Linux takes a lock that stalls
+ * page faults of all other threads).  MMAP_WILLNEED starts reading the
+ * pages, so that is always passed on.
+ *
+ * For heaps in allocated memory the cost of random access is in the
+ * TLB rather than the disk.  Those are backed by transparent huge
+ * pages where the OS allows it (GDKhugepages), unless gdk_hugepages
+ * is set to no.
+ */
+static int heap_madvise = 1;	/* pass access patterns on to the OS */
+static int heap_hugepages = 1;	/* back allocated heaps by huge pages */
+/* amounts advised, in KiB */
+static volatile ATOMIC_TYPE heap_hugekb, heap_seqkb, heap_randomkb, heap_willneedkb;
+#ifdef ATOMIC_LOCK
+static MT_Lock heap_advise_lock MT_LOCK_INITIALIZER("heap_advise_lock");
+#endif
+
+void
+HEAPadviseinit(void)
+{
+	const char *p;
+
+#ifdef NEED_MT_LOCK_INIT
+	ATOMIC_INIT(heap_advise_lock);
+#endif
+	heap_madvise = (p = GDKgetenv("gdk_madvise")) == NULL || strcasecmp(p, "no") != 0;
+	heap_hugepages = (p = GDKgetenv("gdk_hugepages")) == NULL || strcasecmp(p, "no") != 0;
+}
+
+static void
+heap_advise(const char *base, size_t size, int advice)
+{
+	if (MT_madvise((void *) base, size, advice) < 0)
+		return;
+	/* not a switch: without madvise all advice values are 0 */
+	if (advice == MMAP_SEQUENTIAL)
+		(void) ATOMIC_ADD(heap_seqkb, (ATOMIC_TYPE) (size >> 10), heap_advise_lock);
+	else if (advice == MMAP_RANDOM)
+		(void) ATOMIC_ADD(heap_randomkb, (ATOMIC_TYPE) (size >> 10), heap_advise_lock);
+	else if (advice == MMAP_WILLNEED)
+		(void) ATOMIC_ADD(heap_willneedkb, (ATOMIC_TYPE) (size >> 10), heap_advise_lock);
+}
+
+void
+HEAPadvise(Heap *h, int advice)
+{
+	if (!heap_madvise ||
+	    h->base == NULL ||
+	    h->storage == STORE_MEM ||
+	    (advice != MMAP_WILLNEED && advice == h->advice))
+		return;
+	if (advice == MMAP_WILLNEED) {
+		heap_advise(h->base, h->free, advice);
+	} else {
+		heap_advise(h->base, h->size, advice);
+		h->advice = (bte) advice;
+	}
+}
+
+/* Advise about the tail of b.  For a view, sequential and random
+ * access are advised for the heap of the parent, but only the pages
+ * of the view itself will be needed. */
+void
+BATadvise(BAT *b, int advice)
+{
+	BAT *pb;
+	bat tp;
+
+	if (!heap_madvise || b->ttype == TYPE_void)
+		return;
+	if ((tp = VIEWtparent(b)) != 0 && (pb = BBP_cache(tp)) != NULL) {
+		if (advice != MMAP_WILLNEED)
+			HEAPadvise(&pb->theap, advice);
+		else if (pb->theap.storage != STORE_MEM && BATcount(b) > 0)
+			heap_advise(Tloc(b, 0), (size_t) BATcount(b) << b->tshift, advice);
+	} else {
+		HEAPadvise(&b->theap, advice);
+	}
+	/* the values of a scan are not in order of their offsets */
+	if (b->tvheap && advice != MMAP_SEQUENTIAL)
+		HEAPadvise(b->tvheap, advice);
+}
+
+/* Back the allocated memory [base, base+size) by huge pages. */
+void
+GDKhugepages(void *base, size_t size)
+{
+	if (heap_hugepages && base != NULL)
+		(void) ATOMIC_ADD(heap_hugekb, (ATOMIC_TYPE) (MT_hugepages(base, size) >> 10), heap_advise_lock);
+}
+
+/* Report whether heaps are backed by huge pages, the amount (in KiB)
+ * of memory requested to be backed by huge pages and the amount that
+ * actually is, and the amounts advised to be accessed sequentially,
+ * randomly, or to be read in. */
+void
+GDKheapstatistics(int *hugepages, lng *hugekb, lng *hugerss, lng *seqkb, lng *randomkb, lng *willneedkb)
+{
+	*hugepages = heap_hugepages;
+	*hugekb = (lng) ATOMIC_GET(heap_hugekb, heap_advise_lock);
+	*hugerss = (lng) (MT_gethugerss() >> 10);
+	*seqkb = (lng) ATOMIC_GET(heap_seqkb, heap_advise_lock);
+	*randomkb = (lng) ATOMIC_GET(heap_randomkb, heap_advise_lock);
+	*willneedkb = (lng) ATOMIC_GET(heap_willneedkb, heap_advise_lock);
+}
+
 
 /* Return the (virtual) size of the heap. */
 size_t
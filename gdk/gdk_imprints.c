@@ -477,7 +477,7 @@ BATimprints(BAT *b)
 		((size_t *) imprints->imprints->base)[2] = (size_t) imprints->dictcnt;
 		((size_t *) imprints->imprints->base)[3] = (size_t) BATcount(b);
 		if ((BBP_status(b->batCacheid) & BBPEXISTING) &&
-		    HEAPsave(imprints->imprints, nme, "timprints") == GDK_SUCCEED &&
+		    HEAPsave(imprints->imprints, nme, "timprints", TRUE) == GDK_SUCCEED &&
 		    (fd = GDKfdlocate(imprints->imprints->farmid, nme, "rb+",
 				      "timprints")) >= 0) {
 			ALGODEBUG fprintf(stderr, "#BATimprints: persisting imprints\n");
@@ -2546,6 +2546,10 @@ hashjoin(BAT *r1, BAT *r2, BAT *l, BAT *r, BAT *sl, BAT *sr, int nil_matches,
 
 	if (BAThash(r, 0) != GDK_SUCCEED)
 		goto bailout;
+	/* l is scanned, and the values of r are compared with all
+	 * along */
+	BATadvise(l, MMAP_SEQUENTIAL);
+	BATadvise(r, MMAP_WILLNEED);
 	ri = bat_iterator(r);
 	nrcand = (BUN) (rcandend - rcand);
 	hsh = r->thash;
@@ -2866,6 +2870,580 @@ hashjoin(BAT *r1, BAT *r2, BAT *l, BAT *r, BAT *sl, BAT *sr, int nil_matches,
 	return GDK_FAIL;
 }
 
+/* Radix-partitioned hash join.
+ *
+ * If both inputs are large, a hash table on the inner (right) input
+ * does not fit in the CPU caches and just about every probe results
+ * in one or more cache misses.  Instead, we partition both inputs on
+ * the low-order bits of the hash value of the values into partitions
+ * whose inner part (including its hash table) fits in the cache, and
+ * then join the matching partitions using small, private hash
+ * tables.  The partitioning is done in at most two passes so that
+ * the number of partitions that are written to simultaneously stays
+ * small (TLB friendly).  Both the partitioning and the joining are
+ * done in parallel: the inputs are divided into slices for the first
+ * pass, and the partitions are divided over the workers for the
+ * second pass and the join.  Since tuples keep their relative order
+ * when they are partitioned and the results are collected in
+ * partition order, the result does not depend on the number of
+ * threads that were used.
+ *
+ * This is only used for inner joins on fixed-size types of at least
+ * 4 bytes, where we compare values bitwise, just like the hash join
+ * does. */
+
+#define RADIX_CACHE_SIZE	(256 * 1024) /* target size of an inner partition */
+#define RADIX_PASS_BITS		8	/* max bits partitioned in a single pass */
+#define RADIX_MAX_BITS		(2 * RADIX_PASS_BITS)
+#define RADIX_MIN_COUNT		((BUN) 1 << 20) /* min size of both inputs */
+
+struct radixside {
+	const char *vals;	/* values of the input column */
+	const oid *cand;	/* candidate list or NULL */
+	BUN start;		/* first BUN (if no candidate list) */
+	oid seq;		/* hseqbase of the input column */
+	BUN cnt;		/* number of tuples to consider */
+	char *pvals[2];		/* partitioned values (both passes) */
+	oid *poids[2];		/* partitioned oids (both passes) */
+	BUN *bounds1;		/* partition boundaries after first pass */
+	BUN *bounds;		/* final partition boundaries */
+};
+
+struct radixjoin {
+	struct radixside side[2]; /* 0: outer (left), 1: inner (right) */
+	const void *nil;	/* nil value if nils don't match, else NULL */
+	int width;		/* width of the values */
+	int bits1, bits2;	/* number of bits in first and second pass */
+	BUN nparts1;		/* number of partitions after first pass */
+	BUN nparts;		/* number of partitions after second pass */
+	int nthreads;
+	int phase;		/* which phase the workers are to execute */
+	BUN *resstart;		/* offset of partition result in worker buffer */
+	BUN *rescnt;		/* size of partition result */
+};
+
+struct radixworker {
+	struct radixjoin *rj;
+	int idx;		/* worker number */
+	BUN lo[2], hi[2];	/* slice of both inputs for the first pass */
+	BUN *hist[2];		/* histograms, later write offsets */
+	BUN *buckets, *next;	/* hash table for a single partition */
+	BUN nbuckets, nnext;	/* allocated sizes of buckets and next */
+	oid *r1, *r2;		/* result buffers */
+	BUN cnt, cap;		/* used and allocated size of result buffers */
+	int failed;
+};
+
+enum radixphase {
+	RADIX_HISTOGRAM,	/* first pass: build histogram of slice */
+	RADIX_SCATTER,		/* first pass: scatter slice over partitions */
+	RADIX_REFINE,		/* second pass: partition partitions */
+	RADIX_JOIN		/* join matching partitions */
+};
+
+#define RADIXVAL(TYPE, s, i)						\
+	(((const TYPE *) (s)->vals)[(s)->cand ? (s)->cand[i] - (s)->seq : (s)->start + (i)])
+#define RADIXOID(s, i)							\
+	((s)->cand ? (s)->cand[i] : (s)->seq + (s)->start + (i))
+#define RADIXHASH(TYPE, v)	((BUN) mix_##TYPE(v))
+
+#define RADIXJOIN_IMPL(TYPE)						\
+static void								\
+radixhistogram_##TYPE(struct radixworker *w)				\
+{									\
+	struct radixjoin *rj = w->rj;					\
+	const BUN mask = rj->nparts1 - 1;				\
+	int s;								\
+	BUN i;								\
+	TYPE v;								\
+									\
+	for (s = 0; s < 2; s++) {					\
+		const struct radixside *sd = &rj->side[s];		\
+		BUN *restrict hist = w->hist[s];			\
+									\
+		for (i = w->lo[s]; i < w->hi[s]; i++) {			\
+			v = RADIXVAL(TYPE, sd, i);			\
+			if (rj->nil && v == *(const TYPE *) rj->nil)	\
+				continue;				\
+			hist[RADIXHASH(TYPE, v) & mask]++;		\
+		}							\
+	}								\
+}									\
+									\
+static void								\
+radixscatter_##TYPE(struct radixworker *w)				\
+{									\
+	struct radixjoin *rj = w->rj;					\
+	const BUN mask = rj->nparts1 - 1;				\
+	int s;								\
+	BUN i, p;							\
+	TYPE v;								\
+									\
+	for (s = 0; s < 2; s++) {					\
+		const struct radixside *sd = &rj->side[s];		\
+		BUN *restrict offs = w->hist[s];			\
+		TYPE *restrict pvals = (TYPE *) sd->pvals[0];		\
+		oid *restrict poids = sd->poids[0];			\
+									\
+		for (i = w->lo[s]; i < w->hi[s]; i++) {			\
+			v = RADIXVAL(TYPE, sd, i);			\
+			if (rj->nil && v == *(const TYPE *) rj->nil)	\
+				continue;				\
+			p = offs[RADIXHASH(TYPE, v) & mask]++;		\
+			pvals[p] = v;					\
+			poids[p] = RADIXOID(sd, i);			\
+		}							\
+	}								\
+}									\
+									\
+static void								\
+radixrefine_##TYPE(struct radixworker *w)				\
+{									\
+	struct radixjoin *rj = w->rj;					\
+	const BUN nparts2 = (BUN) 1 << rj->bits2;			\
+	const BUN mask = nparts2 - 1;					\
+	const int shift = rj->bits1;					\
+	int s;								\
+	BUN i, k, p, q, off;						\
+	TYPE v;								\
+									\
+	for (s = 0; s < 2; s++) {					\
+		struct radixside *sd = &rj->side[s];			\
+		const TYPE *restrict ivals = (const TYPE *) sd->pvals[0]; \
+		const oid *restrict ioids = sd->poids[0];		\
+		TYPE *restrict ovals = (TYPE *) sd->pvals[1];		\
+		oid *restrict ooids = sd->poids[1];			\
+		BUN *restrict offs = w->hist[s];			\
+									\
+		for (q = (BUN) w->idx; q < rj->nparts1; q += (BUN) rj->nthreads) { \
+			memset(offs, 0, nparts2 * sizeof(BUN));		\
+			for (i = sd->bounds1[q]; i < sd->bounds1[q + 1]; i++) \
+				offs[(RADIXHASH(TYPE, ivals[i]) >> shift) & mask]++; \
+			for (k = 0, off = sd->bounds1[q]; k < nparts2; k++) { \
+				sd->bounds[q * nparts2 + k] = off;	\
+				off += offs[k];				\
+				offs[k] = sd->bounds[q * nparts2 + k];	\
+			}						\
+			for (i = sd->bounds1[q]; i < sd->bounds1[q + 1]; i++) { \
+				v = ivals[i];				\
+				p = offs[(RADIXHASH(TYPE, v) >> shift) & mask]++; \
+				ovals[p] = v;				\
+				ooids[p] = ioids[i];			\
+			}						\
+		}							\
+	}								\
+}									\
+									\
+static void								\
+radixprobe_##TYPE(struct radixworker *w)				\
+{									\
+	struct radixjoin *rj = w->rj;					\
+	const int buf = rj->bits2 > 0;					\
+	const int shift = rj->bits1 + rj->bits2;			\
+	const struct radixside *os = &rj->side[0];			\
+	const struct radixside *is = &rj->side[1];			\
+	const TYPE *restrict ovals = (const TYPE *) os->pvals[buf];	\
+	const oid *restrict ooids = os->poids[buf];			\
+	const TYPE *restrict ivals = (const TYPE *) is->pvals[buf];	\
+	const oid *restrict ioids = is->poids[buf];			\
+	BUN p, i, k, lo, hi, n, nb, mask;				\
+	TYPE v;								\
+									\
+	for (p = (BUN) w->idx; p < rj->nparts; p += (BUN) rj->nthreads) { \
+		rj->resstart[p] = w->cnt;				\
+		lo = is->bounds[p];					\
+		hi = is->bounds[p + 1];					\
+		n = hi - lo;						\
+		if (n == 0 || os->bounds[p] == os->bounds[p + 1]) {	\
+			rj->rescnt[p] = 0;				\
+			continue;					\
+		}							\
+		for (nb = 1; nb < n; nb <<= 1)				\
+			;						\
+		mask = nb - 1;						\
+		if (nb > w->nbuckets) {					\
+			GDKfree(w->buckets);				\
+			w->buckets = GDKmalloc(nb * sizeof(BUN));	\
+			if (w->buckets == NULL) {			\
+				w->nbuckets = 0;			\
+				w->failed = 1;				\
+				return;					\
+			}						\
+			w->nbuckets = nb;				\
+		}							\
+		if (n > w->nnext) {					\
+			GDKfree(w->next);				\
+			w->next = GDKmalloc(n * sizeof(BUN));		\
+			if (w->next == NULL) {				\
+				w->nnext = 0;				\
+				w->failed = 1;				\
+				return;					\
+			}						\
+			w->nnext = n;					\
+		}							\
+		memset(w->buckets, 0xFF, nb * sizeof(BUN));		\
+		/* insert back to front so that the chains are in	\
+		 * input order */					\
+		for (i = n; i > 0; i--) {				\
+			k = (RADIXHASH(TYPE, ivals[lo + i - 1]) >> shift) & mask; \
+			w->next[i - 1] = w->buckets[k];			\
+			w->buckets[k] = i - 1;				\
+		}							\
+		for (i = os->bounds[p]; i < os->bounds[p + 1]; i++) {	\
+			v = ovals[i];					\
+			for (k = w->buckets[(RADIXHASH(TYPE, v) >> shift) & mask]; \
+			     k != (BUN) -1;				\
+			     k = w->next[k]) {				\
+				if (ivals[lo + k] != v)			\
+					continue;			\
+				if (w->cnt == w->cap &&			\
+				    radixgrow(w) != GDK_SUCCEED)	\
+					return;				\
+				w->r1[w->cnt] = ooids[i];		\
+				w->r2[w->cnt] = ioids[lo + k];		\
+				w->cnt++;				\
+			}						\
+		}							\
+		rj->rescnt[p] = w->cnt - rj->resstart[p];		\
+	}								\
+}
+
+/* make room for more results in the worker's result buffers */
+static gdk_return
+radixgrow(struct radixworker *w)
+{
+	BUN cap = w->cap < 1024 ? 1024 : w->cap * 2;
+	oid *r1, *r2;
+
+	r1 = GDKrealloc(w->r1, cap * sizeof(oid));
+	if (r1 == NULL) {
+		w->failed = 1;
+		return GDK_FAIL;
+	}
+	w->r1 = r1;
+	r2 = GDKrealloc(w->r2, cap * sizeof(oid));
+	if (r2 == NULL) {
+		w->failed = 1;
+		return GDK_FAIL;
+	}
+	w->r2 = r2;
+	w->cap = cap;
+	return GDK_SUCCEED;
+}
+
+RADIXJOIN_IMPL(int)
+RADIXJOIN_IMPL(lng)
+#ifdef HAVE_HGE
+RADIXJOIN_IMPL(hge)
+#endif
+
+static void
+radixworker(void *arg)
+{
+	struct radixworker *w = arg;
+
+#ifdef HAVE_HGE
+#define RADIXCALL(phase)						\
+	(w->rj->width == 4 ? phase##_int(w) :				\
+	 w->rj->width == 8 ? phase##_lng(w) :				\
+	 phase##_hge(w))
+#else
+#define RADIXCALL(phase)						\
+	(w->rj->width == 4 ? phase##_int(w) : phase##_lng(w))
+#endif
+	switch ((enum radixphase) w->rj->phase) {
+	case RADIX_HISTOGRAM:
+		RADIXCALL(radixhistogram);
+		break;
+	case RADIX_SCATTER:
+		RADIXCALL(radixscatter);
+		break;
+	case RADIX_REFINE:
+		RADIXCALL(radixrefine);
+		break;
+	case RADIX_JOIN:
+		RADIXCALL(radixprobe);
+		break;
+	}
+#undef RADIXCALL
+}
+
+/* Return whether the radix-partitioned join can and should be used
+ * to join l and r, with r the inner (hashed) side. */
+static int
+radixjoin_usable(BAT *l, BAT *r, BUN lcount, BUN rcount)
+{
+	int t = ATOMbasetype(l->ttype);
+	size_t width, size;
+
+	if (lcount < RADIX_MIN_COUNT || rcount < RADIX_MIN_COUNT)
+		return 0;
+	if (BATtvoid(l) || BATtvoid(r) || l->tvarsized)
+		return 0;
+	switch (t) {
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_oid:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		break;
+	default:
+		return 0;
+	}
+	width = (size_t) ATOMsize(t);
+	if (width != 4 && width != 8 && width != 16)
+		return 0;
+	/* the partitioned copies of both inputs (two of each if
+	 * there are two passes) must fit comfortably in memory */
+	size = (lcount + rcount) * (width + sizeof(oid)) * 2;
+	return size < GDK_mem_maxsize / 2;
+}
+
+static void
+radixcleanup(struct radixjoin *rj, struct radixworker *ws)
+{
+	int s, t;
+
+	for (s = 0; s < 2; s++) {
+		GDKfree(rj->side[s].pvals[0]);
+		GDKfree(rj->side[s].pvals[1]);
+		GDKfree(rj->side[s].poids[0]);
+		GDKfree(rj->side[s].poids[1]);
+		if (rj->side[s].bounds != rj->side[s].bounds1)
+			GDKfree(rj->side[s].bounds);
+		GDKfree(rj->side[s].bounds1);
+	}
+	if (ws) {
+		for (t = 0; t < rj->nthreads; t++) {
+			GDKfree(ws[t].hist[0]);
+			GDKfree(ws[t].hist[1]);
+			GDKfree(ws[t].buckets);
+			GDKfree(ws[t].next);
+			GDKfree(ws[t].r1);
+			GDKfree(ws[t].r2);
+		}
+		GDKfree(ws);
+	}
+	GDKfree(rj->resstart);
+	GDKfree(rj->rescnt);
+}
+
+static gdk_return
+radixjoin(BAT *r1, BAT *r2, BAT *l, BAT *r, BAT *sl, BAT *sr,
+	  int nil_matches, int sorted, lng t0, int swapped,
+	  const char *reason)
+{
+	struct radixjoin rj;
+	struct radixworker *ws = NULL;
+	BAT *bs[2], *ss[2];
+	BUN start, end, cnt, nbits, i, p, off, total;
+	const oid *cand, *candend;
+	size_t width;
+	int s, t, nthreads;
+	oid *o1, *o2;
+
+	ALGODEBUG fprintf(stderr, "#radixjoin(l=%s#" BUNFMT "[%s],"
+			  "r=%s#" BUNFMT "[%s],sl=%s#" BUNFMT ","
+			  "sr=%s#" BUNFMT ",nil_matches=%d,sorted=%d)%s%s%s\n",
+			  BATgetId(l), BATcount(l), ATOMname(l->ttype),
+			  BATgetId(r), BATcount(r), ATOMname(r->ttype),
+			  sl ? BATgetId(sl) : "NULL", sl ? BATcount(sl) : 0,
+			  sr ? BATgetId(sr) : "NULL", sr ? BATcount(sr) : 0,
+			  nil_matches, sorted,
+			  swapped ? " swapped" : "",
+			  *reason ? " " : "", reason);
+
+	assert(ATOMtype(l->ttype) == ATOMtype(r->ttype));
+	assert(!l->tvarsized);
+
+	memset(&rj, 0, sizeof(rj));
+	width = (size_t) ATOMsize(ATOMbasetype(l->ttype));
+	rj.width = (int) width;
+	rj.nil = nil_matches ? NULL : ATOMnilptr(l->ttype);
+
+	bs[0] = l;
+	bs[1] = r;
+	ss[0] = sl;
+	ss[1] = sr;
+	for (s = 0; s < 2; s++) {
+		CANDINIT(bs[s], ss[s], start, end, cnt, cand, candend);
+		rj.side[s].vals = (const char *) Tloc(bs[s], 0);
+		rj.side[s].cand = cand;
+		rj.side[s].start = start;
+		rj.side[s].seq = bs[s]->hseqbase;
+		rj.side[s].cnt = cand ? (BUN) (candend - cand) : end - start;
+	}
+
+	/* number of radix bits needed to make the inner partitions
+	 * (values, oids, hash table) fit in the cache */
+	for (nbits = 0;
+	     nbits < RADIX_MAX_BITS &&
+		     ((rj.side[1].cnt * (width + sizeof(oid) + 2 * sizeof(BUN))) >> nbits) > RADIX_CACHE_SIZE;
+	     nbits++)
+		;
+	rj.bits1 = (int) (nbits < RADIX_PASS_BITS ? nbits : RADIX_PASS_BITS);
+	rj.bits2 = (int) nbits - rj.bits1;
+	rj.nparts1 = (BUN) 1 << rj.bits1;
+	rj.nparts = (BUN) 1 << nbits;
+
+	nthreads = GDKnr_threads ? GDKnr_threads : 1;
+	if ((BUN) nthreads > rj.nparts1)
+		nthreads = (int) rj.nparts1;
+	rj.nthreads = nthreads;
+
+	ws = GDKzalloc(nthreads * sizeof(struct radixworker));
+	rj.resstart = GDKmalloc(rj.nparts * sizeof(BUN));
+	rj.rescnt = GDKmalloc(rj.nparts * sizeof(BUN));
+	if (ws == NULL || rj.resstart == NULL || rj.rescnt == NULL)
+		goto bailout;
+	for (s = 0; s < 2; s++) {
+		struct radixside *sd = &rj.side[s];
+
+		sd->pvals[0] = GDKmalloc(sd->cnt * width);
+		sd->poids[0] = GDKmalloc(sd->cnt * sizeof(oid));
+		sd->bounds1 = GDKmalloc((rj.nparts1 + 1) * sizeof(BUN));
+		if (sd->pvals[0] == NULL || sd->poids[0] == NULL ||
+		    sd->bounds1 == NULL)
+			goto bailout;
+		if (rj.bits2 > 0) {
+			sd->pvals[1] = GDKmalloc(sd->cnt * width);
+			sd->poids[1] = GDKmalloc(sd->cnt * sizeof(oid));
+			sd->bounds = GDKmalloc((rj.nparts + 1) * sizeof(BUN));
+			if (sd->pvals[1] == NULL || sd->poids[1] == NULL ||
+			    sd->bounds == NULL)
+				goto bailout;
+		} else {
+			sd->bounds = sd->bounds1;
+		}
+	}
+	for (t = 0; t < nthreads; t++) {
+		ws[t].rj = &rj;
+		ws[t].idx = t;
+		for (s = 0; s < 2; s++) {
+			ws[t].lo[s] = rj.side[s].cnt * t / nthreads;
+			ws[t].hi[s] = rj.side[s].cnt * (t + 1) / nthreads;
+			/* big enough for both passes */
+			ws[t].hist[s] = GDKzalloc(((BUN) 1 << (rj.bits1 > rj.bits2 ? rj.bits1 : rj.bits2)) * sizeof(BUN));
+			if (ws[t].hist[s] == NULL)
+				goto bailout;
+		}
+	}
+
+	/* first pass: histograms of all slices, then turn them into
+	 * write offsets such that each partition contains the
+	 * tuples of the slices in slice order */
+	rj.phase = RADIX_HISTOGRAM;
+	GDKparallel(radixworker, ws, sizeof(struct radixworker), nthreads);
+	for (s = 0; s < 2; s++) {
+		for (p = 0, off = 0; p < rj.nparts1; p++) {
+			rj.side[s].bounds1[p] = off;
+			for (t = 0; t < nthreads; t++) {
+				cnt = ws[t].hist[s][p];
+				ws[t].hist[s][p] = off;
+				off += cnt;
+			}
+		}
+		/* nils were skipped, so we may have fewer tuples */
+		rj.side[s].bounds1[rj.nparts1] = off;
+	}
+	rj.phase = RADIX_SCATTER;
+	GDKparallel(radixworker, ws, sizeof(struct radixworker), nthreads);
+	if (rj.bits2 > 0) {
+		rj.phase = RADIX_REFINE;
+		GDKparallel(radixworker, ws, sizeof(struct radixworker), nthreads);
+		for (s = 0; s < 2; s++)
+			rj.side[s].bounds[rj.nparts] = rj.side[s].bounds1[rj.nparts1];
+	}
+	ALGODEBUG fprintf(stderr, "#radixjoin: %d+%d bits, %d threads, "
+			  "partitioning " LLFMT "usec\n",
+			  rj.bits1, rj.bits2, nthreads, GDKusec() - t0);
+
+	rj.phase = RADIX_JOIN;
+	GDKparallel(radixworker, ws, sizeof(struct radixworker), nthreads);
+	total = 0;
+	for (t = 0; t < nthreads; t++) {
+		if (ws[t].failed)
+			goto bailout;
+		total += ws[t].cnt;
+	}
+
+	/* collect the results in partition order */
+	if (total > BATcapacity(r1) &&
+	    (BATextend(r1, total) != GDK_SUCCEED ||
+	     BATextend(r2, total) != GDK_SUCCEED))
+		goto bailout;
+	o1 = (oid *) Tloc(r1, 0);
+	o2 = (oid *) Tloc(r2, 0);
+	for (p = 0, i = 0; p < rj.nparts; p++) {
+		struct radixworker *w = &ws[p % (BUN) nthreads];
+
+		if (rj.rescnt[p] == 0)
+			continue;
+		memcpy(o1 + i, w->r1 + rj.resstart[p], rj.rescnt[p] * sizeof(oid));
+		memcpy(o2 + i, w->r2 + rj.resstart[p], rj.rescnt[p] * sizeof(oid));
+		i += rj.rescnt[p];
+	}
+	assert(i == total);
+	BATsetcount(r1, total);
+	BATsetcount(r2, total);
+	if (sorted && total > 1) {
+		/* within a partition the left oids are ascending, but
+		 * the partitions need to be merged */
+#if SIZEOF_OID == SIZEOF_INT
+		GDKqsort(o1, o2, NULL, total, sizeof(oid), sizeof(oid), TYPE_int);
+#else
+		GDKqsort(o1, o2, NULL, total, sizeof(oid), sizeof(oid), TYPE_lng);
+#endif
+	}
+
+	/* if an input column is key, the opposite output column
+	 * will be key */
+	r1->tkey = r->tkey != 0;
+	r2->tkey = l->tkey != 0;
+	r1->tsorted = sorted;
+	r1->trevsorted = 0;
+	r1->tdense = 0;
+	r2->tsorted = 0;
+	r2->trevsorted = 0;
+	r2->tdense = 0;
+	if (total <= 1) {
+		r1->tsorted = r1->trevsorted = r1->tkey = r1->tdense = 1;
+		r2->tsorted = r2->trevsorted = r2->tkey = r2->tdense = 1;
+		if (total == 1) {
+			r1->tseqbase = o1[0];
+			r2->tseqbase = o2[0];
+		}
+	} else if (sorted && r1->tkey && o1[total - 1] - o1[0] == total - 1) {
+		r1->tdense = 1;
+		r1->tseqbase = o1[0];
+	}
+
+	ALGODEBUG fprintf(stderr, "#radixjoin(l=%s,r=%s)=(%s#"BUNFMT"%s%s%s%s,%s#"BUNFMT"%s%s%s%s) " LLFMT "us\n",
+			  BATgetId(l), BATgetId(r),
+			  BATgetId(r1), BATcount(r1),
+			  r1->tsorted ? "-sorted" : "",
+			  r1->trevsorted ? "-revsorted" : "",
+			  r1->tdense ? "-dense" : "",
+			  r1->tkey ? "-key" : "",
+			  BATgetId(r2), BATcount(r2),
+			  r2->tsorted ? "-sorted" : "",
+			  r2->trevsorted ? "-revsorted" : "",
+			  r2->tdense ? "-dense" : "",
+			  r2->tkey ? "-key" : "",
+			  GDKusec() - t0);
+	radixcleanup(&rj, ws);
+	return GDK_SUCCEED;
+
+  bailout:
+	radixcleanup(&rj, ws);
+	BBPreclaim(r1);
+	BBPreclaim(r2);
+	return GDK_FAIL;
+}
+
 #define MASK_EQ		1
 #define MASK_LT		2
 #define MASK_GT		4
@@ -3620,6 +4198,10 @@ subleftjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr,
 				 nil_on_miss, semi, only_misses, maxsize, t0, 0);
 	if (BATtdense(l) && BATordered(r) && (rcount * 1024) < lcount && ATOMtype(l->ttype) == TYPE_oid && !sl && !sr && !nil_matches && !only_misses)
 		return fetchjoin(r1, r2, l, r);
+	if (r2 && !nil_on_miss && !semi && !only_misses &&
+	    !BATcheckhash(r) && radixjoin_usable(l, r, lcount, rcount))
+		return radixjoin(r1, r2, l, r, sl, sr, nil_matches, 1, t0, 0,
+				 "leftjoin");
 	return hashjoin(r1, r2, l, r, sl, sr, nil_matches,
 			nil_on_miss, semi, only_misses, maxsize, t0, 0, "leftjoin");
 }
@@ -3835,6 +4417,12 @@ BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, int nil_matches,
 		 * large (i.e. prefer hash over binary search, but
 		 * only if the hash table doesn't cause thrashing) */
 		return mergejoin(r1, r2, l, r, sl, sr, nil_matches, 0, 0, 0, maxsize, t0, 0);
+	} else if (radixjoin_usable(l, r, lcount, rcount)) {
+		/* both large and no hashes, partition both and build
+		 * the (small) hash tables on the smallest */
+		if (lcount < rcount)
+			return radixjoin(r2, r1, r, l, sr, sl, nil_matches, 0, t0, 1, "both large");
+		return radixjoin(r1, r2, l, r, sl, sr, nil_matches, 0, t0, 0, "both large");
 	} else if ((l->batPersistence == PERSISTENT
 #ifndef DISABLE_PARENT_HASH
 		     || (lparent != 0 &&
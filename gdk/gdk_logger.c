@@ -109,6 +109,9 @@ static int geomisoldversion;
 static gdk_return bm_commit(logger *lg);
 static gdk_return tr_grow(trans *tr);
 
+typedef struct replay replay;
+static gdk_return replay_flush(replay *rp, int async);
+
 static BUN
 log_find(BAT *b, BAT *d, int val)
 {
@@ -309,7 +312,7 @@ log_read_seq(logger *lg, logformat *l)
 }
 
 static log_return
-log_read_updates(logger *lg, trans *tr, logformat *l, char *name)
+log_read_updates(logger *lg, trans *tr, logformat *l, char *name, replay *rp)
 {
 	log_bid bid = logger_find_bat(lg, name);
 	BAT *b = BATdescriptor(bid);
@@ -319,6 +322,15 @@ log_read_updates(logger *lg, trans *tr, logformat *l, char *name)
 	if (lg->debug & 1)
 		fprintf(stderr, "#logger found log_read_updates %s %s " LLFMT "\n", name, l->flag == LOG_INSERT ? "insert" : "update", l->nr);
 
+	if (b && b->ttype == TYPE_void) {
+		/* appending may turn a void column into an oid
+		 * column, so the type is only known after all earlier
+		 * transactions have been applied */
+		if (replay_flush(rp, 0) != GDK_SUCCEED) {
+			logbat_destroy(b);
+			return LOG_ERR;
+		}
+	}
 	if (b) {
 		ht = TYPE_void;
 		tt = b->ttype;
@@ -373,7 +385,23 @@ log_read_updates(logger *lg, trans *tr, logformat *l, char *name)
 		if (tseq)
 			BATtseqbase(r, 0);
 
-		if (ht == TYPE_void && l->flag == LOG_INSERT) {
+		if (ht == TYPE_void && l->flag == LOG_INSERT &&
+		    tt > TYPE_void && tt < TYPE_str) {
+			/* log_bat writes fixed-size values in one go,
+			 * so read them in one go straight into the heap */
+			if (rt(Tloc(r, 0), lg->log, (size_t) l->nr) == NULL) {
+				res = LOG_EOF;
+			} else {
+				BATsetcount(r, (BUN) l->nr);
+				r->tsorted = r->trevsorted = 0;
+				r->tkey = r->tdense = 0;
+				r->tnosorted = r->tnorevsorted = 0;
+				r->tnokey[0] = r->tnokey[1] = 0;
+				r->tnonil = r->tnil = 0;
+				BATsettrivprop(r);
+				l->nr = 0;
+			}
+		} else if (ht == TYPE_void && l->flag == LOG_INSERT) {
 			for (; res == LOG_OK && l->nr > 0; l->nr--) {
 				void *t = rt(tv, lg->log, 1);
 
@@ -449,20 +477,29 @@ log_read_updates(logger *lg, trans *tr, logformat *l, char *name)
 	return res;
 }
 
-static gdk_return
-la_bat_updates(logger *lg, logaction *la)
+/* the BAT to which the inserts or updates of la apply, or 0 if they
+ * are to be skipped */
+static log_bid
+la_bat_target(logger *lg, logaction *la)
 {
 	log_bid bid = logger_find_bat(lg, la->name);
-	BAT *b;
 
 	if (bid == 0)
-		return GDK_SUCCEED; /* ignore bats no longer in the catalog */
+		return 0; /* ignore bats no longer in the catalog */
 
 	/* do we need to skip these old updates */
 	if (avoid_snapshot(lg, bid))
-		return GDK_SUCCEED;
+		return 0;
+	return bid;
+}
+
+/* apply the inserts or updates of la to BAT bid; this only touches
+ * that BAT, so it can be done in parallel for different BATs */
+static gdk_return
+la_bat_apply(logaction *la, log_bid bid)
+{
+	BAT *b = BATdescriptor(bid);
 
-	b = BATdescriptor(bid);
 	if (b == NULL)
 		return GDK_FAIL;
 	if (la->type == LOG_INSERT) {
@@ -511,6 +548,16 @@ la_bat_updates(logger *lg, logaction *la)
 	return GDK_SUCCEED;
 }
 
+static gdk_return
+la_bat_updates(logger *lg, logaction *la)
+{
+	log_bid bid = la_bat_target(lg, la);
+
+	if (bid == 0)
+		return GDK_SUCCEED;
+	return la_bat_apply(la, bid);
+}
+
 static log_return
 log_read_destroy(logger *lg, trans *tr, char *name)
 {
@@ -799,22 +846,190 @@ tr_abort(logger *lg, trans *tr)
 	return tr_destroy(tr);
 }
 
+/*
+ * Parallel replay.  The thread that reads the log only decodes it.
+ * The inserts and updates of a committed transaction are queued in a
+ * batch, and a full batch is applied by a separate thread while the
+ * reading continues with the next batch.  The changes of a batch are
+ * divided over GDKnr_threads workers by BAT, and each worker applies
+ * the changes to its BATs in the order in which they were logged.
+ * The other actions (create, use, destroy, and clear) change the
+ * catalog of the logger, so they are applied by the reading thread
+ * itself, after all queued changes have been applied.
+ */
+#define REPLAY_ACTIONS	1024		/* max. changes in a batch */
+#define REPLAY_SIZE	((BUN) 1 << 23)	/* max. values in a batch */
+
+typedef struct replaybatch {
+	logaction *changes;
+	log_bid *bids;		/* the BAT each change applies to */
+	int nr, sz;
+	BUN size;		/* number of values in the changes */
+} replaybatch;
+
+struct replay {
+	int nthreads;
+	replaybatch batch[2];	/* being filled, and being applied */
+	int cur;		/* index of the batch being filled */
+	MT_Id tid;		/* thread applying the other batch, or 0 */
+	gdk_return res;
+};
+
+struct replayworker {
+	replaybatch *batch;
+	int nr, n;		/* apply BATs with bid % n == nr */
+	gdk_return res;
+};
+
+static void
+replay_worker(void *arg)
+{
+	struct replayworker *w = arg;
+	replaybatch *batch = w->batch;
+	int i;
+
+	for (i = 0; i < batch->nr; i++) {
+		if (batch->bids[i] % w->n != w->nr)
+			continue;
+		if (w->res == GDK_SUCCEED)
+			w->res = la_bat_apply(&batch->changes[i], batch->bids[i]);
+		la_destroy(&batch->changes[i]);
+	}
+}
+
+/* apply the batch that is not being filled */
+static void
+replay_apply(void *arg)
+{
+	replay *rp = arg;
+	replaybatch *batch = &rp->batch[1 - rp->cur];
+	struct replayworker ws[16], *w = ws;
+	int i, n = rp->nthreads;
+
+	if (n > batch->nr)
+		n = batch->nr;
+	if (n > (int) (sizeof(ws) / sizeof(ws[0])) &&
+	    (w = GDKmalloc(n * sizeof(struct replayworker))) == NULL)
+		n = (int) (sizeof(ws) / sizeof(ws[0]));
+	for (i = 0; i < n; i++) {
+		w[i].batch = batch;
+		w[i].nr = i;
+		w[i].n = n;
+		/* if an earlier batch failed, only clean up */
+		w[i].res = rp->res;
+	}
+	GDKparallel(replay_worker, w, sizeof(struct replayworker), n);
+	for (i = 0; i < n; i++)
+		if (w[i].res != GDK_SUCCEED)
+			rp->res = GDK_FAIL;
+	if (w != ws)
+		GDKfree(w);
+	batch->nr = 0;
+	batch->size = 0;
+}
+
+/* wait for the batch that is being applied */
+static gdk_return
+replay_wait(replay *rp)
+{
+	if (rp->tid) {
+		MT_join_thread(rp->tid);
+		rp->tid = 0;
+	}
+	return rp->res;
+}
+
+/* apply the batch that is being filled, in the background if async,
+ * and otherwise before returning */
+static gdk_return
+replay_flush(replay *rp, int async)
+{
+	replay_wait(rp);
+	if (rp->batch[rp->cur].nr > 0) {
+		rp->cur = 1 - rp->cur;
+		if (!async || rp->nthreads <= 1 ||
+		    MT_create_thread(&rp->tid, replay_apply, rp, MT_THR_JOINABLE) < 0) {
+			rp->tid = 0;
+			replay_apply(rp);
+		}
+	}
+	return rp->res;
+}
+
+/* queue the inserts or updates of la to BAT bid, taking over the
+ * BATs and name of la */
+static gdk_return
+replay_queue(replay *rp, logaction *la, log_bid bid)
+{
+	replaybatch *batch = &rp->batch[rp->cur];
+
+	if (batch->nr == batch->sz) {
+		int sz = batch->sz ? batch->sz * 2 : 64;
+		logaction *changes;
+		log_bid *bids;
+
+		if ((changes = GDKrealloc(batch->changes, sz * sizeof(logaction))) == NULL)
+			return GDK_FAIL;
+		batch->changes = changes;
+		if ((bids = GDKrealloc(batch->bids, sz * sizeof(log_bid))) == NULL)
+			return GDK_FAIL;
+		batch->bids = bids;
+		batch->sz = sz;
+	}
+	batch->changes[batch->nr] = *la;
+	batch->bids[batch->nr] = bid;
+	batch->nr++;
+	batch->size += BATcount(la->b);
+	la->name = NULL;
+	la->b = NULL;
+	la->uid = NULL;
+	if (batch->nr >= REPLAY_ACTIONS || batch->size >= REPLAY_SIZE)
+		return replay_flush(rp, 1);
+	return rp->res;
+}
+
+/* apply all queued changes and free the batches */
+static gdk_return
+replay_destroy(replay *rp)
+{
+	gdk_return res = replay_flush(rp, 0);
+
+	GDKfree(rp->batch[0].changes);
+	GDKfree(rp->batch[0].bids);
+	GDKfree(rp->batch[1].changes);
+	GDKfree(rp->batch[1].bids);
+	return res;
+}
+
 static trans *
-tr_commit(logger *lg, trans *tr)
+tr_commit(logger *lg, trans *tr, replay *rp)
 {
 	int i;
+	gdk_return ret;
+	log_bid bid;
 
 	if (lg->debug & 1)
 		fprintf(stderr, "#tr_commit\n");
 
 	for (i = 0; i < tr->nr; i++) {
-		if (la_apply(lg, &tr->changes[i]) != GDK_SUCCEED) {
+		logaction *c = &tr->changes[i];
+
+		if (c->type == LOG_INSERT || c->type == LOG_UPDATE) {
+			bid = la_bat_target(lg, c);
+			ret = bid ? replay_queue(rp, c, bid) : GDK_SUCCEED;
+			lg->changes += (ret == GDK_SUCCEED);
+		} else {
+			ret = replay_flush(rp, 0);
+			if (ret == GDK_SUCCEED)
+				ret = la_apply(lg, c);
+		}
+		if (ret != GDK_SUCCEED) {
 			do {
 				tr = tr_abort(lg, tr);
 			} while (tr != NULL);
 			return (trans *) -1;
 		}
-		la_destroy(&tr->changes[i]);
+		la_destroy(c);
 	}
 	return tr_destroy(tr);
 }
@@ -918,8 +1133,18 @@ logger_open(logger *lg)
 static void
 logger_close(logger *lg)
 {
+	/* wait for a running log_tsync, and make the transactions
+	 * that are still waiting for it durable before the log goes */
+	MT_lock_set(&lg->synclock);
+	if (lg->log && lg->syncednr < lg->flushednr) {
+		/* the committers cannot be told */
+		if (mnstr_fsync(lg->log))
+			GDKfatal("logger_close: sync of the write-ahead log failed");
+		lg->syncednr = lg->flushednr;
+	}
 	close_stream(lg->log);
 	lg->log = NULL;
+	MT_lock_unset(&lg->synclock);
 }
 
 static gdk_return
@@ -932,6 +1157,7 @@ logger_readlog(logger *lg, char *filename)
 	struct stat sb;
 	int dbg = GDKdebug;
 	int fd;
+	replay rp;
 
 	GDKdebug &= ~(CHECKMASK|PROPMASK);
 
@@ -962,6 +1188,9 @@ logger_readlog(logger *lg, char *filename)
 		printf("# Start reading the write-ahead log '%s'\n", filename);
 		fflush(stdout);
 	}
+	memset(&rp, 0, sizeof(rp));
+	rp.nthreads = GDKnr_threads;
+	rp.res = GDK_SUCCEED;
 	while (err == LOG_OK && log_read_format(lg, &l)) {
 		char *name = NULL;
 
@@ -1028,7 +1257,7 @@ logger_readlog(logger *lg, char *filename)
 			else if (l.tid != l.nr)	/* abort record */
 				tr = tr_abort(lg, tr);
 			else
-				tr = tr_commit(lg, tr);
+				tr = tr_commit(lg, tr, &rp);
 			break;
 		case LOG_SEQ:
 			err = log_read_seq(lg, &l);
@@ -1038,7 +1267,7 @@ logger_readlog(logger *lg, char *filename)
 			if (name == NULL || tr == NULL)
 				err = LOG_EOF;
 			else
-				err = log_read_updates(lg, tr, &l, name);
+				err = log_read_updates(lg, tr, &l, name, &rp);
 			break;
 		case LOG_CREATE:
 			if (name == NULL || tr == NULL)
@@ -1076,6 +1305,8 @@ logger_readlog(logger *lg, char *filename)
 		}
 	}
 	logger_close(lg);
+	if (replay_destroy(&rp) != GDK_SUCCEED)
+		err = LOG_ERR;
 
 	/* remaining transactions are not committed, ie abort */
 	while (tr)
@@ -1810,6 +2041,8 @@ logger_load(int debug, const char *fn, char filename[PATHLENGTH], logger *lg)
 	logbat_destroy(lg->seqs_id);
 	logbat_destroy(lg->seqs_val);
 	logbat_destroy(lg->dseqs);
+	MT_lock_destroy(&lg->synclock);
+	MT_lock_destroy(&lg->flushlock);
 	GDKfree(lg->fn);
 	GDKfree(lg->dir);
 	GDKfree(lg->local_dir);
@@ -1907,6 +2140,11 @@ logger_new(int debug, const char *fn, const char *logdir, int version, preversio
 	lg->postfuncp = postfuncp;
 	lg->log = NULL;
 	lg->end = 0;
+	MT_lock_init(&lg->synclock, "logger_synclock");
+	MT_lock_init(&lg->flushlock, "logger_flushlock");
+	lg->flushednr = 0;
+	lg->syncednr = 0;
+	lg->syncdelay = GDKgetenv_int("gdk_group_commit_delay", 0);
 	lg->catalog_bid = NULL;
 	lg->catalog_nme = NULL;
 	lg->dcatalog = NULL;
@@ -2015,6 +2253,8 @@ logger_destroy(logger *lg)
 	GDKfree(lg->fn);
 	GDKfree(lg->dir);
 	logger_close(lg);
+	MT_lock_destroy(&lg->synclock);
+	MT_lock_destroy(&lg->flushlock);
 	GDKfree(lg);
 }
 
@@ -2558,46 +2798,52 @@ pre_allocate(logger *lg)
 	return GDK_SUCCEED;
 }
 
+/* sub commit all new snapshots of the transaction */
+static gdk_return
+log_tend_snapshots(logger *lg)
+{
+	BAT *cands, *tids, *bids;
+	gdk_return res;
+
+	if (!DELTAdirty(lg->snapshots_bid))
+		return GDK_SUCCEED;
+	tids = bm_tids(lg->snapshots_tid, lg->dsnapshots);
+	if (tids == NULL) {
+		fprintf(stderr, "!ERROR: log_tend: bm_tids failed\n");
+		return GDK_FAIL;
+	}
+	cands = BATselect(lg->snapshots_tid, tids, &lg->tid, &lg->tid,
+			  TRUE, TRUE, FALSE);
+	if (cands == NULL) {
+		fprintf(stderr, "!ERROR: log_tend: select failed\n");
+		return GDK_FAIL;
+	}
+	bids = BATproject(cands, lg->snapshots_bid);
+	BBPunfix(cands->batCacheid);
+	BBPunfix(tids->batCacheid);
+	if (bids == NULL) {
+		fprintf(stderr, "!ERROR: log_tend: project failed\n");
+		return GDK_FAIL;
+	}
+	res = bm_subcommit(lg, bids, NULL, lg->snapshots_bid,
+			   lg->snapshots_tid, lg->dsnapshots, NULL, lg->debug);
+	BBPunfix(bids->batCacheid);
+	return res;
+}
+
 gdk_return
 log_tend(logger *lg)
 {
 	logformat l;
-	gdk_return res = GDK_SUCCEED;
 
 	if (lg->debug & 1)
 		fprintf(stderr, "#log_tend %d\n", lg->tid);
 
-	if (DELTAdirty(lg->snapshots_bid)) {
-		/* sub commit all new snapshots */
-		BAT *cands, *tids, *bids;
-
-		tids = bm_tids(lg->snapshots_tid, lg->dsnapshots);
-		if (tids == NULL) {
-			fprintf(stderr, "!ERROR: log_tend: bm_tids failed\n");
-			return GDK_FAIL;
-		}
-		cands = BATselect(lg->snapshots_tid, tids, &lg->tid, &lg->tid,
-				     TRUE, TRUE, FALSE);
-		if (cands == NULL) {
-			fprintf(stderr, "!ERROR: log_tend: select failed\n");
-			return GDK_FAIL;
-		}
-		bids = BATproject(cands, lg->snapshots_bid);
-		BBPunfix(cands->batCacheid);
-		BBPunfix(tids->batCacheid);
-		if (bids == NULL) {
-			fprintf(stderr, "!ERROR: log_tend: project failed\n");
-			return GDK_FAIL;
-		}
-		res = bm_subcommit(lg, bids, NULL, lg->snapshots_bid,
-				   lg->snapshots_tid, lg->dsnapshots, NULL, lg->debug);
-		BBPunfix(bids->batCacheid);
-	}
 	l.flag = LOG_END;
 	l.tid = lg->tid;
 	l.nr = lg->tid;
 
-	if (res != GDK_SUCCEED ||
+	if (log_tend_snapshots(lg) != GDK_SUCCEED ||
 	    log_write_format(lg, &l) != GDK_SUCCEED ||
 	    mnstr_flush(lg->log) ||
 	    mnstr_fsync(lg->log) ||
@@ -2608,6 +2854,80 @@ log_tend(logger *lg)
 	return GDK_SUCCEED;
 }
 
+/*
+ * Group commit.  Instead of log_tend, which syncs the log for every
+ * transaction while the caller holds its store lock, a committer can
+ * call log_tflush, which only writes the end of the transaction to
+ * the operating system and returns its commit number, and then, after
+ * releasing its store lock, log_tsync with that number.  The
+ * committers that wait in log_tsync at the same time queue on the
+ * synclock; the first one (the leader) syncs the log for all
+ * transactions written so far, and the others find that their
+ * transaction has been synced already.  The leader waits at most
+ * gdk_group_commit_delay milliseconds for more transactions to be
+ * written before it syncs, as long as they keep coming.
+ */
+gdk_return
+log_tflush(logger *lg, lng *commitnr)
+{
+	logformat l;
+
+	if (lg->debug & 1)
+		fprintf(stderr, "#log_tflush %d\n", lg->tid);
+
+	if (log_tend_snapshots(lg) != GDK_SUCCEED)
+		return GDK_FAIL;
+	l.flag = LOG_END;
+	l.tid = lg->tid;
+	l.nr = lg->tid;
+
+	if (log_write_format(lg, &l) != GDK_SUCCEED ||
+	    mnstr_flush(lg->log) ||
+	    pre_allocate(lg) != GDK_SUCCEED) {
+		fprintf(stderr, "!ERROR: log_tflush: write failed\n");
+		return GDK_FAIL;
+	}
+	MT_lock_set(&lg->flushlock);
+	*commitnr = ++lg->flushednr;
+	MT_lock_unset(&lg->flushlock);
+	return GDK_SUCCEED;
+}
+
+gdk_return
+log_tsync(logger *lg, lng commitnr)
+{
+	gdk_return res = GDK_SUCCEED;
+	lng nr, prev;
+	int i;
+
+	MT_lock_set(&lg->synclock);
+	if (lg->syncednr < commitnr) {
+		/* we are the leader */
+		MT_lock_set(&lg->flushlock);
+		nr = lg->flushednr;
+		MT_lock_unset(&lg->flushlock);
+		for (i = 0; i < lg->syncdelay; i++) {
+			MT_sleep_ms(1);
+			prev = nr;
+			MT_lock_set(&lg->flushlock);
+			nr = lg->flushednr;
+			MT_lock_unset(&lg->flushlock);
+			if (nr == prev)
+				break;
+		}
+		if (lg->log == NULL || mnstr_fsync(lg->log)) {
+			fprintf(stderr, "!ERROR: log_tsync: sync failed\n");
+			res = GDK_FAIL;
+		} else {
+			if (lg->debug & 1)
+				fprintf(stderr, "#log_tsync " LLFMT " transactions\n", nr - lg->syncednr);
+			lg->syncednr = nr;
+		}
+	}
+	MT_lock_unset(&lg->synclock);
+	return res;
+}
+
 gdk_return
 log_abort(logger *lg)
 {
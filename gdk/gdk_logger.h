@@ -70,6 +70,12 @@ typedef struct logger {
 				   commit). */
 	void *buf;
 	size_t bufsize;
+	/* group commit, see log_tflush and log_tsync */
+	MT_Lock synclock;	/* held while syncing the log */
+	MT_Lock flushlock;	/* protects flushednr */
+	lng flushednr;		/* number of transactions written */
+	lng syncednr;		/* number of transactions synced */
+	int syncdelay;		/* max. ms to wait for more committers */
 } logger;
 
 /* Holds logger settings
@@ -123,6 +129,8 @@ gdk_export gdk_return log_delta(logger *lg, BAT *uid, BAT *uval, const char *n);
 
 gdk_export gdk_return log_tstart(logger *lg);	/* TODO return transaction id */
 gdk_export gdk_return log_tend(logger *lg);
+gdk_export gdk_return log_tflush(logger *lg, lng *commitnr);
+gdk_export gdk_return log_tsync(logger *lg, lng commitnr);
 gdk_export gdk_return log_abort(logger *lg);
 
 gdk_export gdk_return log_sequence(logger *lg, int seq, lng id);
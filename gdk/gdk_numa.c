@@ -0,0 +1,328 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * NUMA-aware placement of heaps and worker threads.
+ *
+ * On a machine with more than one NUMA node, memory is by default
+ * allocated on the node of the thread that first touches it, which
+ * for a persistent column is whichever thread happened to load it.
+ * The parallel plans produced by mitosis then read most of their
+ * slices across the interconnect.
+ *
+ * Instead, large heaps of persistent BATs (farm 0) are placed
+ * explicitly when they are loaded or allocated, according to the
+ * gdk_numa_policy setting:
+ *
+ * partition	(default) the heap is cut into GDKnr_nodes equally
+ *		sized consecutive pieces and piece i is placed on node
+ *		i, so that a slice of the column lives on a single node;
+ * interleave	the pages of the heap are interleaved over all nodes;
+ * off		no explicit placement and no thread affinity.
+ *
+ * Heaps of transient BATs are left alone: they are first touched by
+ * the worker that produces them, and since workers are pinned to the
+ * CPUs of a node (GDKnumabind), that is local placement.  With the
+ * partition policy, BATnumanode tells on which node the values of a
+ * slice of a persistent column live, which the dataflow scheduler uses
+ * to run the instruction on a worker of that node.
+ *
+ * Setting gdk_numa_nodes overrides the number of nodes found in
+ * /sys/devices/system/node.  If it differs from the real number, the
+ * nodes are emulated: the CPUs the server may use are split over the
+ * emulated nodes, and the placement is only administered, not
+ * requested from the kernel.  This allows testing the NUMA code paths
+ * on a single socket machine.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_atomic.h"
+
+#ifdef HAVE_SCHED_H
+#include <sched.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_mbind)
+#define HAVE_MBIND 1
+/* from <numaif.h>, which we don't want to depend on */
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED	1
+#define MPOL_INTERLEAVE	3
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE	(1 << 1)
+#endif
+#endif
+
+#if defined(__linux__) && defined(HAVE_SCHED_H) && defined(CPU_SETSIZE)
+#define HAVE_AFFINITY 1
+#endif
+
+#define NUMA_MAXNODES	64	/* nodes fit in a single word mask */
+#define NUMA_MINSIZE	((size_t) 1 << 22) /* don't place smaller heaps */
+
+int GDKnr_nodes = 1;
+
+static enum {
+	NUMA_OFF,
+	NUMA_INTERLEAVE,
+	NUMA_PARTITION,
+} numa_policy = NUMA_OFF;
+static int numa_emulated;	/* nodes are emulated, not real */
+static int numa_nodeid[NUMA_MAXNODES]; /* kernel id of each node */
+#ifdef HAVE_AFFINITY
+static cpu_set_t numa_cpus[NUMA_MAXNODES]; /* CPUs of each node */
+#endif
+static volatile ATOMIC_TYPE numa_placed;	/* bytes placed (in KiB) */
+#ifdef ATOMIC_LOCK
+static MT_Lock numa_lock MT_LOCK_INITIALIZER("numa_lock");
+#endif
+
+#ifdef HAVE_AFFINITY
+/* parse a cpulist ("0-3,8-11") into a CPU set */
+static void
+numa_cpulist(const char *s, cpu_set_t *set)
+{
+	char *e;
+	long lo, hi;
+
+	CPU_ZERO(set);
+	while (*s) {
+		lo = strtol(s, &e, 10);
+		if (e == s)
+			break;
+		hi = lo;
+		if (*e == '-')
+			hi = strtol(e + 1, &e, 10);
+		for (; lo <= hi && lo < CPU_SETSIZE; lo++)
+			CPU_SET((int) lo, set);
+		if (*e != ',')
+			break;
+		s = e + 1;
+	}
+}
+#endif
+
+/* find the NUMA nodes of the machine; returns the number of nodes */
+static int
+numa_realnodes(void)
+{
+	int n = 0;
+#ifdef __linux__
+	int i;
+	char path[64], buf[1024];
+	FILE *f;
+
+	for (i = 0; i < NUMA_MAXNODES; i++) {
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", i);
+		if ((f = fopen(path, "r")) == NULL)
+			continue;
+		if (fgets(buf, (int) sizeof(buf), f) != NULL) {
+#ifdef HAVE_AFFINITY
+			numa_cpulist(buf, &numa_cpus[n]);
+#endif
+			numa_nodeid[n++] = i;
+		}
+		fclose(f);
+	}
+#endif
+	return n;
+}
+
+/* split the CPUs we may use over nemul emulated nodes */
+static void
+numa_emulate(int nemul)
+{
+	int i;
+#ifdef HAVE_AFFINITY
+	cpu_set_t all;
+	int cpus[CPU_SETSIZE];
+	int ncpus = 0;
+
+	if (sched_getaffinity(0, sizeof(all), &all) == 0) {
+		for (i = 0; i < CPU_SETSIZE; i++)
+			if (CPU_ISSET(i, &all))
+				cpus[ncpus++] = i;
+	}
+	for (i = 0; i < nemul; i++)
+		CPU_ZERO(&numa_cpus[i]);
+	if (ncpus >= nemul) {
+		/* consecutive CPUs form a node */
+		for (i = 0; i < ncpus; i++)
+			CPU_SET(cpus[i], &numa_cpus[(lng) i * nemul / ncpus]);
+	} else if (ncpus > 0) {
+		/* fewer CPUs than nodes: nodes share CPUs */
+		for (i = 0; i < nemul; i++)
+			CPU_SET(cpus[i % ncpus], &numa_cpus[i]);
+	}
+#endif
+	for (i = 0; i < nemul; i++)
+		numa_nodeid[i] = i;
+}
+
+void
+GDKnumainit(void)
+{
+	int nreal, n;
+	const char *p = GDKgetenv("gdk_numa_policy");
+
+#ifdef NEED_MT_LOCK_INIT
+	ATOMIC_INIT(numa_lock);
+#endif
+	nreal = numa_realnodes();
+	n = GDKgetenv_int("gdk_numa_nodes", 0);
+	if (n <= 0)
+		n = nreal;
+	if (n > NUMA_MAXNODES)
+		n = NUMA_MAXNODES;
+	numa_emulated = n > 1 && n != nreal;
+	if (numa_emulated)
+		numa_emulate(n);
+
+	if (n <= 1 || (p != NULL && strcmp(p, "off") == 0)) {
+		numa_policy = NUMA_OFF;
+		GDKnr_nodes = 1;
+	} else {
+		if (p != NULL && strcmp(p, "interleave") == 0)
+			numa_policy = NUMA_INTERLEAVE;
+		else
+			numa_policy = NUMA_PARTITION;
+		GDKnr_nodes = n;
+	}
+	ATOMIC_SET(numa_placed, 0, numa_lock);
+	ALGODEBUG fprintf(stderr, "#GDKnumainit: %d %s nodes, policy %s\n",
+			  GDKnr_nodes, numa_emulated ? "emulated" : "real",
+			  numa_policy == NUMA_PARTITION ? "partition" :
+			  numa_policy == NUMA_INTERLEAVE ? "interleave" : "off");
+}
+
+/* the node that holds byte off of a partitioned heap of the given
+ * size */
+static inline int
+numa_node(size_t size, size_t off)
+{
+	int node = (int) ((double) off * GDKnr_nodes / size);
+
+	return node < GDKnr_nodes ? node : GDKnr_nodes - 1;
+}
+
+/* Place the memory area [base, base+size) according to the policy.
+ * Pages that were already touched are moved.  Only the whole pages
+ * inside the area are placed. */
+void
+GDKnumaplace(void *base, size_t size)
+{
+	size_t pagesize = MT_pagesize();
+	char *first, *last;
+
+	if (numa_policy == NUMA_OFF || base == NULL || size < NUMA_MINSIZE)
+		return;
+	first = (char *) (((uintptr_t) base + pagesize - 1) & ~(uintptr_t) (pagesize - 1));
+	last = (char *) (((uintptr_t) base + size) & ~(uintptr_t) (pagesize - 1));
+	if (last <= first)
+		return;
+#ifdef HAVE_MBIND
+	if (!numa_emulated) {
+		unsigned long mask = 0;
+		int i;
+
+		if (numa_policy == NUMA_INTERLEAVE) {
+			for (i = 0; i < GDKnr_nodes; i++)
+				mask |= 1UL << numa_nodeid[i];
+			if (syscall(SYS_mbind, first, (size_t) (last - first),
+				    MPOL_INTERLEAVE, &mask, NUMA_MAXNODES + 1,
+				    MPOL_MF_MOVE) < 0)
+				ALGODEBUG fprintf(stderr, "#GDKnumaplace: mbind failed: %s\n", strerror(errno));
+		} else {
+			for (i = 0; i < GDKnr_nodes; i++) {
+				char *lo = (char *) base + (size_t) ((double) size * i / GDKnr_nodes);
+				char *hi = (char *) base + (size_t) ((double) size * (i + 1) / GDKnr_nodes);
+
+				/* align the boundaries on pages */
+				lo = i == 0 ? first : (char *) ((uintptr_t) lo & ~(uintptr_t) (pagesize - 1));
+				hi = i == GDKnr_nodes - 1 ? last : (char *) ((uintptr_t) hi & ~(uintptr_t) (pagesize - 1));
+				if (hi <= lo)
+					continue;
+				mask = 1UL << numa_nodeid[i];
+				if (syscall(SYS_mbind, lo, (size_t) (hi - lo),
+					    MPOL_PREFERRED, &mask,
+					    NUMA_MAXNODES + 1, MPOL_MF_MOVE) < 0) {
+					ALGODEBUG fprintf(stderr, "#GDKnumaplace: mbind failed: %s\n", strerror(errno));
+					break;
+				}
+			}
+		}
+	}
+#endif
+	(void) ATOMIC_ADD(numa_placed, (ATOMIC_TYPE) ((last - first) >> 10), numa_lock);
+}
+
+/* Pin the calling thread to the CPUs of the given node.  Returns 0 on
+ * success, -1 if there is nothing to pin to or the pinning failed. */
+int
+GDKnumabind(int node)
+{
+#ifdef HAVE_AFFINITY
+	if (numa_policy == NUMA_OFF || node < 0)
+		return -1;
+	node %= GDKnr_nodes;
+	if (CPU_COUNT(&numa_cpus[node]) == 0)
+		return -1;
+	if (sched_setaffinity(0, sizeof(cpu_set_t), &numa_cpus[node]) < 0) {
+		ALGODEBUG fprintf(stderr, "#GDKnumabind: node %d: %s\n", node, strerror(errno));
+		return -1;
+	}
+	return 0;
+#else
+	(void) node;
+	return -1;
+#endif
+}
+
+/* Return the node that holds the values of b, or -1 if there is no
+ * single such node.  That is only known for a slice of a partitioned
+ * persistent heap; the node of the middle of the slice is returned. */
+int
+BATnumanode(BAT *b)
+{
+	BAT *pb;
+	bat tp;
+	const char *base, *mid;
+
+	if (numa_policy != NUMA_PARTITION ||
+	    b->ttype == TYPE_void ||
+	    (tp = VIEWtparent(b)) == 0 ||
+	    (pb = BBP_cache(tp)) == NULL)
+		return -1;
+	base = pb->theap.base;
+	if (base == NULL ||
+	    pb->theap.farmid != 0 ||
+	    pb->theap.size < NUMA_MINSIZE ||
+	    b->theap.base < base ||
+	    b->theap.base >= base + pb->theap.size)
+		return -1;
+	mid = b->theap.base + (b->theap.size >> 1);
+	if (mid >= base + pb->theap.size)
+		mid = b->theap.base;
+	return numa_node(pb->theap.size, (size_t) (mid - base));
+}
+
+/* Report the NUMA configuration: number of nodes, whether they are
+ * emulated, and the amount of memory (in KiB) placed so far. */
+void
+GDKnumastatistics(int *nodes, int *emulated, lng *placed)
+{
+	*nodes = GDKnr_nodes;
+	*emulated = numa_emulated;
+	*placed = (lng) ATOMIC_GET(numa_placed, numa_lock);
+}
@@ -29,7 +29,7 @@ BATidxsync(void *arg)
 
 	ALGODEBUG t0 = GDKusec();
 
-	if (HEAPsave(hp, hp->filename, NULL) != GDK_SUCCEED ||
+	if (HEAPsave(hp, hp->filename, NULL, TRUE) != GDK_SUCCEED ||
 	    (fd = GDKfdlocate(hp->farmid, hp->filename, "rb+", NULL)) < 0) {
 		BBPunfix(hs->id);
 		GDKfree(arg);
@@ -205,22 +205,16 @@ BATorderidx(BAT *b, int stable)
 			MT_lock_unset(&GDKhashLock(b->batCacheid));
 			return GDK_FAIL;
 		}
-		if (stable) {
-			if (GDKssort(Tloc(bn, 0), mv,
-				     bn->tvheap ? bn->tvheap->base : NULL,
-				     BATcount(bn), Tsize(bn), SIZEOF_OID,
-				     bn->ttype) != GDK_SUCCEED) {
-				HEAPfree(m, 1);
-				GDKfree(m);
-				MT_lock_unset(&GDKhashLock(b->batCacheid));
-				BBPunfix(bn->batCacheid);
-				return GDK_FAIL;
-			}
-		} else {
-			GDKqsort(Tloc(bn, 0), mv,
-				 bn->tvheap ? bn->tvheap->base : NULL,
-				 BATcount(bn), Tsize(bn), SIZEOF_OID,
-				 bn->ttype);
+		/* large columns are sorted in parallel */
+		if (GDKpsort(Tloc(bn, 0), mv,
+			     bn->tvheap ? bn->tvheap->base : NULL,
+			     BATcount(bn), Tsize(bn), SIZEOF_OID,
+			     bn->ttype, 0, stable) != GDK_SUCCEED) {
+			HEAPfree(m, 1);
+			GDKfree(m);
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			BBPunfix(bn->batCacheid);
+			return GDK_FAIL;
 		}
 		/* we must unfix after releasing the lock since we
 		 * might get deadlock otherwise (we're holding a lock
@@ -692,6 +692,70 @@ MT_msync(void *p, size_t len)
 	return ret;
 }
 
+/* advise the OS how [p, p+len) is going to be accessed; the area is
+ * extended to whole pages */
+int
+MT_madvise(void *p, size_t len, int advice)
+{
+	char *first = (char *) ((uintptr_t) p & ~(uintptr_t) (MT_pagesize() - 1));
+	int ret;
+
+	ret = posix_madvise(first, len + (size_t) ((char *) p - first), advice);
+#ifdef MMAP_DEBUG
+	fprintf(stderr,
+		     "#madvise(" PTRFMT "," SZFMT ",%d) = %d\n",
+		     PTRFMTCAST p, len, advice, ret);
+#endif
+	return ret;
+}
+
+#define MT_HUGEPAGESIZE	((size_t) 1 << 21)
+
+/* ask for transparent huge pages for the part of [p, p+len) that
+ * consists of whole huge pages; returns the size of that part, or 0
+ * if there is none or the OS doesn't support it */
+size_t
+MT_hugepages(void *p, size_t len)
+{
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+	char *first = (char *) (((uintptr_t) p + MT_HUGEPAGESIZE - 1) & ~(uintptr_t) (MT_HUGEPAGESIZE - 1));
+	char *last = (char *) (((uintptr_t) p + len) & ~(uintptr_t) (MT_HUGEPAGESIZE - 1));
+
+	if (last <= first || madvise(first, (size_t) (last - first), MADV_HUGEPAGE) < 0)
+		return 0;
+	return (size_t) (last - first);
+#else
+	(void) p;
+	(void) len;
+	return 0;
+#endif
+}
+
+/* return the amount of memory of the process that is backed by
+ * transparent huge pages, in bytes */
+size_t
+MT_gethugerss(void)
+{
+#ifdef __linux__
+	FILE *f;
+	char buf[256];
+	size_t kb = 0;
+
+	if ((f = fopen("/proc/self/smaps_rollup", "r")) == NULL)
+		return 0;
+	while (fgets(buf, (int) sizeof(buf), f) != NULL) {
+		if (strncmp(buf, "AnonHugePages:", 14) == 0) {
+			kb = (size_t) strtoull(buf + 14, NULL, 10);
+			break;
+		}
+	}
+	fclose(f);
+	return kb << 10;
+#else
+	return 0;
+#endif
+}
+
 int
 MT_path_absolute(const char *pathname)
 {
@@ -892,6 +956,29 @@ MT_msync(void *p, size_t len)
 	return 0;
 }
 
+int
+MT_madvise(void *p, size_t len, int advice)
+{
+	(void) p;
+	(void) len;
+	(void) advice;
+	return 0;
+}
+
+size_t
+MT_hugepages(void *p, size_t len)
+{
+	(void) p;
+	(void) len;
+	return 0;
+}
+
+size_t
+MT_gethugerss(void)
+{
+	return 0;
+}
+
 int
 MT_path_absolute(const char *pathname)
 {
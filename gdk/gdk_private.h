@@ -23,9 +23,15 @@ enum heaptype {
 	varheap,
 	hashheap,
 	imprintsheap,
-	orderidxheap
+	orderidxheap,
+	zonemapheap
 };
 
+/* number of rows per zone of a zone map, and the minimum size of a
+ * persistent column for which BATselect creates one */
+#define ZONEMAP_ROWS	1024
+#define ZONEMAP_MINCNT	((BUN) 16 * ZONEMAP_ROWS)
+
 __hidden gdk_return ATOMheap(int id, Heap *hp, size_t cap)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -45,6 +51,8 @@ __hidden gdk_return BATcheckmodes(BAT *b, int persistent)
 	__attribute__((__visibility__("hidden")));
 __hidden int BATcheckorderidx(BAT *b)
 	__attribute__((__visibility__("hidden")));
+__hidden int BATcheckzonemap(BAT *b)
+	__attribute__((__visibility__("hidden")));
 __hidden BAT *BATcreatedesc(oid hseq, int tt, int heapnames, int role)
 	__attribute__((__visibility__("hidden")));
 __hidden void BATdelete(BAT *b)
@@ -63,7 +71,9 @@ __hidden BAT *BATload_intern(bat bid, int lock)
 __hidden gdk_return BATmaterialize(BAT *b)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
-__hidden gdk_return BATsave(BAT *b)
+__hidden void BATprefetchinit(void)
+	__attribute__((__visibility__("hidden")));
+__hidden gdk_return BATsave(BAT *b, int dosync)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
 __hidden void BATsetdims(BAT *b)
@@ -110,6 +120,32 @@ __hidden Heap *createOIDXheap(BAT *b, int stable)
 __hidden gdk_return BUNreplace(BAT *b, oid left, const void *right, bit force)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
+__hidden void CMPdestroy(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden BAT *CMPmaskcombine(BAT *a, BAT *b, int merge)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden Compressed *CMPmasknew(oid base, BUN nbits)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden BAT *CMPmaskresult(Compressed *c, int keepmask)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden void *CMPminmax(BAT *b, void *aggr, int max)
+	__attribute__((__visibility__("hidden")));
+__hidden BAT *CMPproject(BAT *l, BAT *r)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden BAT *CMPselect(BAT *b, BAT *s, const void *tl, const void *th, int li, int hi, int equi, int anti, int lval, int hval, int lnil)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden gdk_return CMPsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int nil_if_empty)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden int CMPsummable(BAT *b, int tp)
+	__attribute__((__visibility__("hidden")));
+__hidden void GDKarenainit(void)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKextend(const char *fn, size_t size)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -122,6 +158,8 @@ __hidden FILE *GDKfilelocate(int farmid, const char *nme, const char *mode, cons
 	__attribute__((__visibility__("hidden")));
 __hidden FILE *GDKfileopen(int farmid, const char *dir, const char *name, const char *extension, const char *mode)
 	__attribute__((__visibility__("hidden")));
+__hidden void GDKhugepages(void *base, size_t size)
+	__attribute__((__visibility__("hidden")));
 __hidden char *GDKload(int farmid, const char *nme, const char *ext, size_t size, size_t *maxsize, storage_t mode)
 	__attribute__((__visibility__("hidden")));
 __hidden void GDKlog(_In_z_ _Printf_format_string_ FILE * fl, const char *format, ...)
@@ -135,9 +173,21 @@ __hidden void *GDKmremap(const char *path, int mode, void *old_address, size_t o
 __hidden gdk_return GDKmunmap(void *addr, size_t len)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
+__hidden void GDKnumainit(void)
+	__attribute__((__visibility__("hidden")));
+__hidden void GDKnumaplace(void *base, size_t size)
+	__attribute__((__visibility__("hidden")));
+__hidden void GDKparallel(void (*func)(void *), void *args, size_t argsize, int n)
+	__attribute__((__visibility__("hidden")));
+__hidden gdk_return GDKpsort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe, int reverse, int stable)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKremovedir(int farmid, const char *nme)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
+__hidden gdk_return GDKrsort(void *h, void *t, size_t n, int tpe, int reverse)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKsave(int farmid, const char *nme, const char *ext, void *buf, size_t size, storage_t mode, int dosync)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -149,14 +199,31 @@ __hidden gdk_return GDKssort(void *h, void *t, const void *base, size_t n, int h
 	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKunlink(int farmid, const char *dir, const char *nme, const char *extension)
 	__attribute__((__visibility__("hidden")));
+__hidden void GDKzinit(void)
+	__attribute__((__visibility__("hidden")));
+__hidden char *GDKzload(int farmid, const char *nme, const char *ext, size_t size, size_t *maxsize, int *plain)
+	__attribute__((__visibility__("hidden")));
+__hidden gdk_return GDKzsave(int farmid, const char *nme, const char *ext, void *buf, size_t size, int dosync)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden void HASHappend(BAT *b, BUN start)
+	__attribute__((__visibility__("hidden")));
 __hidden void HASHfree(BAT *b)
 	__attribute__((__visibility__("hidden")));
 __hidden int HASHgonebad(BAT *b, const void *v)
 	__attribute__((__visibility__("hidden")));
+__hidden void HASHgrow(BAT *b, BUN newcap)
+	__attribute__((__visibility__("hidden")));
 __hidden BUN HASHmask(BUN cnt)
 	__attribute__((__visibility__("hidden")));
 __hidden Hash *HASHnew(Heap *hp, int tpe, BUN size, BUN mask, BUN count)
 	__attribute__((__visibility__("hidden")));
+__hidden void HASHrehash(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void HEAPadvise(Heap *h, int advice)
+	__attribute__((__visibility__("hidden")));
+__hidden void HEAPadviseinit(void)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -170,7 +237,7 @@ __hidden void HEAPfree(Heap *h, int remove)
 __hidden gdk_return HEAPload(Heap *h, const char *nme, const char *ext, int trunc)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
-__hidden gdk_return HEAPsave(Heap *h, const char *nme, const char *ext)
+__hidden gdk_return HEAPsave(Heap *h, const char *nme, const char *ext, int dosync)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
 __hidden gdk_return HEAPshrink(Heap *h, size_t size)
@@ -186,8 +253,14 @@ __hidden int IMPSgetbin(int tpe, bte bits, const char *restrict bins, const void
 __hidden void IMPSprint(BAT *b)
 	__attribute__((__visibility__("hidden")));
 #endif
+__hidden size_t MT_gethugerss(void)
+	__attribute__((__visibility__("hidden")));
+__hidden size_t MT_hugepages(void *p, size_t len)
+	__attribute__((__visibility__("hidden")));
 __hidden void MT_init_posix(void)
 	__attribute__((__visibility__("hidden")));
+__hidden int MT_madvise(void *p, size_t len, int advice)
+	__attribute__((__visibility__("hidden")));
 __hidden void *MT_mremap(const char *path, int mode, void *old_address, size_t old_size, size_t *new_size)
 	__attribute__((__visibility__("hidden")));
 __hidden int MT_msync(void *p, size_t len)
@@ -213,6 +286,14 @@ __hidden void VIEWdestroy(BAT *b)
 __hidden gdk_return VIEWreset(BAT *b)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
+__hidden void ZMappend(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void ZMfree(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void ZMsave(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden BUN *ZMselect(BAT *b, const void *tl, const void *th, int li, int hi, int equi, int anti, int lval, int hval, BUN p, BUN q, BUN *nruns)
+	__attribute__((__visibility__("hidden")));
 __hidden BAT *virtualize(BAT *bn)
 	__attribute__((__visibility__("hidden")));
 __hidden int binsearchcand(const oid *cand, BUN lo, BUN hi, oid v)
@@ -242,6 +323,75 @@ struct Imprints {
 	BUN dictcnt;		/* counter for cache dictionary               */
 };
 
+/* compression schemes, see gdk_compress.c */
+enum {
+	CMP_FOR = 1,		/* frame-of-reference with bit packing */
+	CMP_DICT,		/* dictionary encoding */
+	CMP_RLE,		/* run-length encoding */
+	CMP_MASK		/* bitmap of a candidate list */
+};
+
+struct Compressed {
+	int scheme;		/* one of the CMP_* schemes */
+	int bits;		/* bits per code (FOR and DICT) */
+	lng base;		/* smallest value (FOR), OID of bit 0 (MASK) */
+	ulng range;		/* largest minus smallest value (FOR),
+				 * number of bits (MASK) */
+	ulng nilcode;		/* code used for nil (FOR) */
+	int hasval;		/* whether there are non-nil values (FOR) */
+	BUN nvals;		/* number of dictionary or run values */
+	BAT *vals;		/* dictionary or run values (DICT and RLE) */
+	Heap codes;		/* packed codes, run ends (RLE), or bits (MASK) */
+};
+
+/* is b a candidate list kept as a bitmap; the first and the last bit
+ * of the bitmap are always set */
+#define CMPmask(b)	((b)->tcompressed != NULL &&			\
+			 (b)->tcompressed->scheme == CMP_MASK)
+#define CMPmaskwords(n)	(((n) + 63) / 64)
+
+#ifdef __GNUC__
+#define CMPctz(w)	__builtin_ctzll(w)
+#define CMPclz(w)	__builtin_clzll(w)
+#define CMPpop(w)	__builtin_popcountll(w)
+#else
+static inline int
+CMPctz(ulng w)
+{
+	int n = 0;
+
+	while ((w & 1) == 0) {
+		w >>= 1;
+		n++;
+	}
+	return n;
+}
+
+static inline int
+CMPclz(ulng w)
+{
+	int n = 0;
+
+	while ((w & ((ulng) 1 << 63)) == 0) {
+		w <<= 1;
+		n++;
+	}
+	return n;
+}
+
+static inline int
+CMPpop(ulng w)
+{
+	int n = 0;
+
+	while (w) {
+		w &= w - 1;
+		n++;
+	}
+	return n;
+}
+#endif
+
 typedef struct {
 	MT_Lock swap;
 	MT_Lock hash;
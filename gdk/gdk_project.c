@@ -97,6 +97,60 @@ project_loop(lng)
 project_loop(hge)
 #endif
 
+/* the same with a bitmap as left input: walk the set bits, copying
+ * whole words of values where all bits are set */
+#define project_mask_loop(TYPE)						\
+static gdk_return							\
+project_mask_##TYPE(BAT *bn, BAT *l, BAT *r, int nilcheck)		\
+{									\
+	const Compressed *c = l->tcompressed;				\
+	const ulng *restrict w = (const ulng *) c->codes.base;		\
+	const TYPE *restrict rt;					\
+	TYPE *restrict bt;						\
+	BUN k, n = 0, nw = CMPmaskwords(c->range);			\
+	ulng m;								\
+									\
+	if ((oid) c->base < r->hseqbase ||				\
+	    (oid) c->base + c->range > r->hseqbase + BATcount(r)) {	\
+		GDKerror("BATproject: does not match always\n");	\
+		return GDK_FAIL;					\
+	}								\
+	rt = (const TYPE *) Tloc(r, 0) + ((oid) c->base - r->hseqbase); \
+	bt = (TYPE *) Tloc(bn, 0);					\
+	for (k = 0; k < nw; k++) {					\
+		m = w[k];						\
+		if (m == ~(ulng) 0) {					\
+			memcpy(bt + n, rt + k * 64, 64 * sizeof(TYPE));	\
+			n += 64;					\
+			continue;					\
+		}							\
+		for (; m; m &= m - 1)					\
+			bt[n++] = rt[k * 64 + CMPctz(m)];		\
+	}								\
+	assert(n == BATcount(l));					\
+	if (nilcheck) {							\
+		for (k = 0; k < n; k++) {				\
+			if (bt[k] == TYPE##_nil) {			\
+				bn->tnonil = 0;				\
+				bn->tnil = 1;				\
+				break;					\
+			}						\
+		}							\
+	}								\
+	BATsetcount(bn, n);						\
+	return GDK_SUCCEED;						\
+}
+
+project_mask_loop(bte)
+project_mask_loop(sht)
+project_mask_loop(int)
+project_mask_loop(flt)
+project_mask_loop(dbl)
+project_mask_loop(lng)
+#ifdef HAVE_HGE
+project_mask_loop(hge)
+#endif
+
 static gdk_return
 project_void(BAT *bn, BAT *l, BAT *r)
 {
@@ -189,7 +243,7 @@ BATproject(BAT *l, BAT *r)
 	BAT *bn;
 	oid lo, hi;
 	gdk_return res;
-	int tpe = ATOMtype(r->ttype), nilcheck = 1, stringtrick = 0;
+	int tpe = ATOMtype(r->ttype), nilcheck = 1, stringtrick = 0, mask;
 	BUN lcount = BATcount(l), rcount = BATcount(r);
 	lng t0 = 0;
 
@@ -208,6 +262,16 @@ BATproject(BAT *l, BAT *r)
 
 	assert(ATOMtype(l->ttype) == TYPE_oid);
 
+	if ((l->tcompressed && !CMPmask(l) && BATdecompress(l) != GDK_SUCCEED) ||
+	    (CMPmask(r) && BATdecompress(r) != GDK_SUCCEED))
+		return NULL;
+	if (r->tcompressed && !CMPmask(r)) {
+		/* decode only the values we need */
+		if (CMPmask(l) && BATdecompress(l) != GDK_SUCCEED)
+			return NULL;
+		return CMPproject(l, r);
+	}
+
 	if (BATtdense(l) && BATcount(l) > 0) {
 		lo = l->tseqbase;
 		hi = l->tseqbase + BATcount(l);
@@ -249,6 +313,9 @@ BATproject(BAT *l, BAT *r)
 		return bn;
 	}
 	assert(l->ttype == TYPE_oid);
+	/* unless l is sorted, r is accessed at random */
+	if (!l->tsorted)
+		BATadvise(r, MMAP_RANDOM);
 
 	if (ATOMstorage(tpe) == TYPE_str &&
 	    l->tnonil &&
@@ -300,6 +367,52 @@ BATproject(BAT *l, BAT *r)
 	}
 	bn->tnil = 0;
 
+	mask = CMPmask(l);
+	if (mask) {
+		/* walk the bitmap of candidates, unless we need the
+		 * general code */
+		switch (tpe) {
+		case TYPE_bte:
+			res = project_mask_bte(bn, l, r, nilcheck);
+			break;
+		case TYPE_sht:
+			res = project_mask_sht(bn, l, r, nilcheck);
+			break;
+		case TYPE_int:
+			res = project_mask_int(bn, l, r, nilcheck);
+			break;
+		case TYPE_flt:
+			res = project_mask_flt(bn, l, r, nilcheck);
+			break;
+		case TYPE_dbl:
+			res = project_mask_dbl(bn, l, r, nilcheck);
+			break;
+		case TYPE_lng:
+			res = project_mask_lng(bn, l, r, nilcheck);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			res = project_mask_hge(bn, l, r, nilcheck);
+			break;
+#endif
+		case TYPE_oid:
+			if (r->ttype != TYPE_void) {
+#if SIZEOF_OID == SIZEOF_INT
+				res = project_mask_int(bn, l, r, nilcheck);
+#else
+				res = project_mask_lng(bn, l, r, nilcheck);
+#endif
+				break;
+			}
+			/* fall through */
+		default:
+			if (BATdecompress(l) != GDK_SUCCEED)
+				goto bailout;
+			mask = 0;
+			break;
+		}
+	}
+	if (!mask)
 	switch (tpe) {
 	case TYPE_bte:
 		res = project_bte(bn, l, r, nilcheck);
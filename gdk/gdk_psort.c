@@ -0,0 +1,350 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Parallel sort.
+ *
+ * GDKpsort sorts the arrays h (and t along with it) like GDKqsort and
+ * GDKssort do, but uses multiple threads for large arrays.  The array
+ * is divided into one run per thread, and each thread sorts its own
+ * run with GDKqsort or GDKssort.  Splitters are then chosen from a
+ * sample of the sorted runs, and each run is divided into ranges
+ * between consecutive splitters using binary search.  Each thread
+ * then merges the corresponding ranges of all runs into its own part
+ * of the output.  All values equal to a splitter go to the same
+ * output part, and when merging, equal values are taken from the
+ * earlier run first, so the parallel sort is stable if the runs are
+ * sorted stably.
+ *
+ * Runs (and arrays too small to sort in parallel) of integer types
+ * are sorted with the radix sort GDKrsort, which is stable.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+/* minimum number of values before we consider sorting in parallel */
+#define PSORT_MIN	((size_t) 1 << 20)
+/* minimum number of values per thread */
+#define PSORT_MINRUN	((size_t) 1 << 18)
+/* number of samples per run used to choose the splitters */
+#define PSORT_SAMPLE	64
+/* minimum number of values before we consider a radix sort */
+#define PSORT_RADIXMIN	((size_t) 1 << 12)
+
+struct psort {
+	char *h, *t;		/* arrays to be sorted */
+	char *oh, *ot;		/* output of the merge */
+	const char *base;	/* heap of var-sized values, or NULL */
+	size_t n;
+	int hs, ts;
+	int tpe;
+	int (*cmp)(const void *, const void *);
+	int reverse, stable;
+	int nthreads;
+	int phase;		/* enum psortphase */
+	size_t *bounds;		/* nthreads+1 bounds per run */
+	struct psortworker *ws;
+};
+
+struct psortworker {
+	struct psort *ps;
+	int idx;		/* worker number, also run and part number */
+	size_t lo, hi;		/* the run of this worker */
+	size_t olo, ohi;	/* the output part of this worker */
+	int failed;
+};
+
+enum psortphase {
+	PSORT_RUN,		/* sort the run of a worker */
+	PSORT_MERGE,		/* merge the ranges of a part */
+	PSORT_COPY		/* copy the output part back */
+};
+
+#define PSVAL(ps, a, i)							\
+	((ps)->base ? (const void *) ((ps)->base + VarHeapVal(a, i, (ps)->hs)) : \
+	 (const void *) ((a) + (i) * (ps)->hs))
+/* compare in the requested order */
+#define PSCMP(ps, x, y)						\
+	((ps)->reverse ? (*(ps)->cmp)(y, x) : (*(ps)->cmp)(x, y))
+
+static inline void
+psmove(char *dst, const char *src, int w)
+{
+	switch (w) {
+	case 1:
+		*(bte *) dst = *(const bte *) src;
+		break;
+	case 2:
+		*(sht *) dst = *(const sht *) src;
+		break;
+	case 4:
+		*(int *) dst = *(const int *) src;
+		break;
+	case 8:
+		*(lng *) dst = *(const lng *) src;
+		break;
+	default:
+		memcpy(dst, src, w);
+		break;
+	}
+}
+
+/* first position in [lo,hi) of h whose value does not sort before v */
+static size_t
+psbound(struct psort *ps, size_t lo, size_t hi, const void *v)
+{
+	size_t mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (PSCMP(ps, PSVAL(ps, ps->h, mid), v) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* whether n values of type tpe are sorted with a radix sort */
+static int
+psradix(size_t n, int ts, int tpe)
+{
+	if (n < PSORT_RADIXMIN || (ts != 0 && ts != (int) sizeof(oid)))
+		return 0;
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* sort the array without using threads */
+static gdk_return
+psserial(void *h, void *t, const void *base, size_t n, int hs, int ts,
+	 int tpe, int reverse, int stable)
+{
+	if (psradix(n, ts, tpe))
+		return GDKrsort(h, ts ? t : NULL, n, tpe, reverse);
+	if (stable)
+		return reverse ?
+			GDKssort_rev(h, t, base, n, hs, ts, tpe) :
+			GDKssort(h, t, base, n, hs, ts, tpe);
+	if (reverse)
+		GDKqsort_rev(h, t, base, n, hs, ts, tpe);
+	else
+		GDKqsort(h, t, base, n, hs, ts, tpe);
+	return GDK_SUCCEED;
+}
+
+static void
+psrun(struct psortworker *w)
+{
+	struct psort *ps = w->ps;
+	char *h = ps->h + w->lo * ps->hs;
+	char *t = ps->t ? ps->t + w->lo * ps->ts : NULL;
+
+	if (psserial(h, t, ps->base, w->hi - w->lo, ps->hs, ps->ts,
+		     ps->tpe, ps->reverse, ps->stable) != GDK_SUCCEED)
+		w->failed = 1;
+}
+
+/* merge range idx of all runs into the output; with equal values, the
+ * earliest run wins */
+static void
+psmerge(struct psortworker *w)
+{
+	struct psort *ps = w->ps;
+	int r, m, k = ps->nthreads;
+	size_t *cur = ps->bounds, o;
+	size_t pos[64], end[64];
+
+	assert(k <= 64);
+	for (r = 0; r < k; r++) {
+		pos[r] = cur[r * (k + 1) + w->idx];
+		end[r] = cur[r * (k + 1) + w->idx + 1];
+	}
+	for (o = w->olo; o < w->ohi; o++) {
+		m = -1;
+		for (r = 0; r < k; r++) {
+			if (pos[r] < end[r] &&
+			    (m < 0 ||
+			     PSCMP(ps, PSVAL(ps, ps->h, pos[r]),
+				   PSVAL(ps, ps->h, pos[m])) < 0))
+				m = r;
+		}
+		assert(m >= 0);
+		psmove(ps->oh + o * ps->hs, ps->h + pos[m] * ps->hs, ps->hs);
+		if (ps->t)
+			psmove(ps->ot + o * ps->ts, ps->t + pos[m] * ps->ts, ps->ts);
+		pos[m]++;
+	}
+}
+
+static void
+pscopy(struct psortworker *w)
+{
+	struct psort *ps = w->ps;
+
+	memcpy(ps->h + w->olo * ps->hs, ps->oh + w->olo * ps->hs,
+	       (w->ohi - w->olo) * ps->hs);
+	if (ps->t)
+		memcpy(ps->t + w->olo * ps->ts, ps->ot + w->olo * ps->ts,
+		       (w->ohi - w->olo) * ps->ts);
+}
+
+static void
+psworker(void *arg)
+{
+	struct psortworker *w = arg;
+
+	switch ((enum psortphase) w->ps->phase) {
+	case PSORT_RUN:
+		psrun(w);
+		break;
+	case PSORT_MERGE:
+		psmerge(w);
+		break;
+	case PSORT_COPY:
+		pscopy(w);
+		break;
+	}
+}
+
+/* choose the splitters from a sample of the sorted runs and divide
+ * each run at the splitters */
+static gdk_return
+pssplit(struct psort *ps)
+{
+	int k = ps->nthreads, r, i, j;
+	size_t ns = (size_t) k * PSORT_SAMPLE, s, x;
+	size_t *sample;
+	struct psortworker *ws = ps->ws;
+
+	if ((sample = GDKmalloc(ns * sizeof(size_t))) == NULL)
+		return GDK_FAIL;
+	for (r = 0, s = 0; r < k; r++)
+		for (i = 0; i < PSORT_SAMPLE; i++)
+			sample[s++] = ws[r].lo + (ws[r].hi - ws[r].lo) * (2 * i + 1) / (2 * PSORT_SAMPLE);
+	/* insertion sort of the (small) sample */
+	for (s = 1; s < ns; s++) {
+		x = sample[s];
+		for (j = (int) s;
+		     j > 0 && PSCMP(ps, PSVAL(ps, ps->h, x), PSVAL(ps, ps->h, sample[j - 1])) < 0;
+		     j--)
+			sample[j] = sample[j - 1];
+		sample[j] = x;
+	}
+	for (r = 0; r < k; r++) {
+		size_t *b = ps->bounds + r * (k + 1);
+
+		b[0] = ws[r].lo;
+		for (i = 1; i < k; i++)
+			b[i] = psbound(ps, b[i - 1], ws[r].hi,
+				       PSVAL(ps, ps->h, sample[i * PSORT_SAMPLE]));
+		b[k] = ws[r].hi;
+	}
+	GDKfree(sample);
+	/* the output part of each worker */
+	for (i = 0, x = 0; i < k; i++) {
+		ws[i].olo = x;
+		for (r = 0; r < k; r++)
+			x += ps->bounds[r * (k + 1) + i + 1] - ps->bounds[r * (k + 1) + i];
+		ws[i].ohi = x;
+	}
+	assert(x == ps->n);
+	return GDK_SUCCEED;
+}
+
+/* Sort the n values in h (and the values in t along with it) like
+ * GDKqsort or GDKssort (or their reverse versions) do.  Large arrays
+ * are sorted in parallel.  Only a stable sort can fail. */
+gdk_return
+GDKpsort(void *h, void *t, const void *base, size_t n, int hs, int ts,
+	 int tpe, int reverse, int stable)
+{
+	struct psort ps;
+	struct psortworker *ws = NULL;
+	int i, nthreads = GDKnr_threads;
+	gdk_return rc = GDK_FAIL;
+	lng t0 = 0;
+
+	if (nthreads > 64)
+		nthreads = 64;
+	if ((size_t) nthreads > n / PSORT_MINRUN)
+		nthreads = (int) (n / PSORT_MINRUN);
+	if (n < PSORT_MIN || nthreads <= 1) {
+		if (!psradix(n, ts, tpe))
+			return psserial(h, t, base, n, hs, ts, tpe, reverse, stable);
+		ALGODEBUG t0 = GDKusec();
+		rc = psserial(h, t, base, n, hs, ts, tpe, reverse, stable);
+		ALGODEBUG fprintf(stderr, "#GDKpsort: radix sorted " SZFMT
+				  " values of type %s%s (" LLFMT " usec)\n",
+				  n, ATOMname(tpe), reverse ? ", reverse" : "",
+				  GDKusec() - t0);
+		return rc;
+	}
+
+	ALGODEBUG t0 = GDKusec();
+	ps.h = h;
+	ps.t = ts ? t : NULL;
+	ps.base = ATOMvarsized(tpe) ? base : NULL;
+	ps.n = n;
+	ps.hs = hs;
+	ps.ts = ts;
+	ps.tpe = tpe;
+	ps.cmp = ATOMcompare(tpe);
+	ps.reverse = reverse;
+	ps.stable = stable;
+	ps.nthreads = nthreads;
+	ps.oh = GDKmalloc(n * hs);
+	ps.ot = ps.t ? GDKmalloc(n * ts) : NULL;
+	ps.bounds = GDKmalloc(nthreads * (nthreads + 1) * sizeof(size_t));
+	ps.ws = ws = GDKzalloc(nthreads * sizeof(struct psortworker));
+	if (ps.oh == NULL || (ps.t && ps.ot == NULL) ||
+	    ps.bounds == NULL || ws == NULL)
+		goto bailout;
+	for (i = 0; i < nthreads; i++) {
+		ws[i].ps = &ps;
+		ws[i].idx = i;
+		ws[i].lo = n * i / nthreads;
+		ws[i].hi = n * (i + 1) / nthreads;
+	}
+
+	ps.phase = PSORT_RUN;
+	GDKparallel(psworker, ws, sizeof(struct psortworker), nthreads);
+	for (i = 0; i < nthreads; i++)
+		if (ws[i].failed)
+			goto bailout;
+	if (pssplit(&ps) != GDK_SUCCEED)
+		goto bailout;
+	ps.phase = PSORT_MERGE;
+	GDKparallel(psworker, ws, sizeof(struct psortworker), nthreads);
+	ps.phase = PSORT_COPY;
+	GDKparallel(psworker, ws, sizeof(struct psortworker), nthreads);
+	rc = GDK_SUCCEED;
+	ALGODEBUG fprintf(stderr, "#GDKpsort: sorted " SZFMT " values of type %s%s%s%s "
+			  "with %d threads (" LLFMT " usec)\n",
+			  n, ATOMname(tpe), reverse ? ", reverse" : "",
+			  stable ? ", stable" : "",
+			  psradix(n / nthreads, ts, tpe) ? ", radix" : "",
+			  nthreads, GDKusec() - t0);
+
+  bailout:
+	GDKfree(ps.oh);
+	GDKfree(ps.ot);
+	GDKfree(ps.bounds);
+	GDKfree(ws);
+	if (rc != GDK_SUCCEED)
+		GDKerror("GDKpsort: cannot allocate memory for parallel sort\n");
+	return rc;
+}
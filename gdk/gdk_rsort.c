@@ -0,0 +1,119 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Radix sort.
+ *
+ * GDKrsort sorts an array of sht, int, or lng values (and an array of
+ * oids along with it) using a least significant digit radix sort with
+ * 8 bit digits.  The sign bit of each value is inverted, so that the
+ * values sort as unsigned integers in the same order as their signed
+ * counterparts and nil (the smallest value) comes first.  For a
+ * reverse sort, all bits of the values are inverted.  A least
+ * significant digit radix sort is stable by nature, so the result is
+ * the same as that of GDKssort (or GDKssort_rev).
+ *
+ * The counts of all digits are computed in a single pass over the
+ * data.  Digits that are the same for all values (e.g. the high
+ * digits of small numbers) are skipped.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+#define RSORT_BITS	8
+#define RSORT_BUCKETS	(1 << RSORT_BITS)
+#define RSORT_MASK	(RSORT_BUCKETS - 1)
+
+#define RSORT(TYPE)							\
+	do {								\
+		const TYPE flip = (TYPE) (((TYPE) 1 << (sizeof(TYPE) * 8 - 1)) ^ \
+					  (reverse ? ~(TYPE) 0 : 0));	\
+		TYPE *restrict src = h, *restrict dst, *tmp;		\
+		TYPE k;							\
+									\
+		if ((dst = GDKmalloc(n * sizeof(TYPE))) == NULL)	\
+			goto bailout;					\
+		hbuf = dst;						\
+		for (i = 0; i < n; i++) {				\
+			k = src[i] ^ flip;				\
+			for (d = 0; d < (int) sizeof(TYPE); d++)	\
+				cnt[d][(k >> (d * RSORT_BITS)) & RSORT_MASK]++; \
+		}							\
+		for (d = 0; d < (int) sizeof(TYPE); d++) {		\
+			size_t *c = cnt[d];				\
+									\
+			k = src[0] ^ flip;				\
+			if (c[(k >> (d * RSORT_BITS)) & RSORT_MASK] == n) \
+				continue; /* digit is the same everywhere */ \
+			for (b = 0, s = 0; b < RSORT_BUCKETS; b++) {	\
+				x = c[b];				\
+				c[b] = s;				\
+				s += x;					\
+			}						\
+			for (i = 0; i < n; i++) {			\
+				k = src[i] ^ flip;			\
+				x = c[(k >> (d * RSORT_BITS)) & RSORT_MASK]++; \
+				dst[x] = src[i];			\
+				if (osrc)				\
+					odst[x] = osrc[i];		\
+			}						\
+			tmp = src;					\
+			src = dst;					\
+			dst = tmp;					\
+			otmp = osrc;					\
+			osrc = odst;					\
+			odst = otmp;					\
+		}							\
+		if (src != (TYPE *) h) {				\
+			memcpy(h, src, n * sizeof(TYPE));		\
+			if (t)						\
+				memcpy(t, osrc, n * sizeof(oid));	\
+		}							\
+	} while (0)
+
+/* Sort the n values of type tpe (a type whose base type is sht, int,
+ * or lng) in h, and the oids in t (if not NULL) along with them.  The
+ * sort is stable. */
+gdk_return
+GDKrsort(void *h, void *t, size_t n, int tpe, int reverse)
+{
+	size_t cnt[8][RSORT_BUCKETS];
+	size_t i, s, x;
+	int b, d;
+	void *hbuf = NULL;
+	oid *tbuf = NULL, *osrc = t, *odst = NULL, *otmp;
+	gdk_return rc = GDK_FAIL;
+
+	if (n <= 1)
+		return GDK_SUCCEED;
+	if (t && (tbuf = GDKmalloc(n * sizeof(oid))) == NULL)
+		return GDK_FAIL;
+	odst = tbuf;
+	memset(cnt, 0, sizeof(cnt));
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_sht:
+		RSORT(unsigned short);
+		break;
+	case TYPE_int:
+		RSORT(unsigned int);
+		break;
+	case TYPE_lng:
+		RSORT(ulng);
+		break;
+	default:
+		assert(0);
+		goto bailout;
+	}
+	rc = GDK_SUCCEED;
+  bailout:
+	GDKfree(hbuf);
+	GDKfree(tbuf);
+	return rc;
+}
@@ -20,6 +20,14 @@
 /* auxiliary functions and structs for imprints */
 #include "gdk_imprints.h"
 
+/* SIMD versions of the scan select need a compiler that can compile
+ * individual functions for a particular instruction set */
+#if defined(__x86_64__) && SIZEOF_OID == 8 &&				\
+	(defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_SIMD_SELECT 1
+#include <immintrin.h>
+#endif
+
 #define buninsfix(B,A,I,V,G,M,R)					\
 	do {								\
 		if ((I) == BATcapacity(B)) {				\
@@ -852,10 +860,624 @@ scan_sel(candscan, o = *candlist++, w = (BUN) ((*(oid *) Tloc(s,q?(q - 1):0)) +
 scan_sel(fullscan, o = (oid) (p+off), w = (BUN) (q+off))
 
 
+/* SIMD scan select
+ *
+ * When there is no candidate list (or a dense one) and no imprints
+ * are used, the scan over the fixed-size numeric types is done using
+ * AVX2 or AVX-512 instructions if the CPU supports them.  The values
+ * are compared in blocks of 64, resulting in a 64-bit mask of
+ * qualifying values which is then converted to OIDs, with AVX-512 by
+ * compress-storing vectors of OIDs, with AVX2 by iterating over the
+ * set bits.  Which instruction set is used is decided at run time;
+ * without either, the scalar code above is used.
+ *
+ * As in the scalar code, the ranges are closed (see NORMALIZE), so
+ * we select vl <= v <= vh, or in the anti case v <= vl || v >= vh,
+ * excluding nil if the column may contain nils.  Nil is smaller than
+ * MINVALUE##TYPE, so it is automatically excluded in the non-anti
+ * case. */
+#ifdef HAVE_SIMD_SELECT
+
+#define SIMDBLOCK	64	/* number of values per comparison block */
+#define SIMDCHUNK	((BUN) 1 << 16) /* values per capacity check */
+
+static int simdlevel = -1;	/* 0: scalar; 1: AVX2; 2: AVX-512 */
+
+static int
+simdselect_level(void)
+{
+	if (simdlevel < 0) {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") &&
+		    __builtin_cpu_supports("avx512bw"))
+			simdlevel = 2;
+		else if (__builtin_cpu_supports("avx2"))
+			simdlevel = 1;
+		else
+			simdlevel = 0;
+	}
+	return simdlevel;
+}
+
+/* scalar test, used for the values that don't fill a block */
+#define SIMDTEST(v)							\
+	(anti ?								\
+	 ((v) <= vl || (v) >= vh) && (!checknil || (v) != nil) :	\
+	 (v) >= vl && (v) <= vh)
+
+/* AVX2: calculate the mask of qualifying values for a block of 64
+ * values; for the integer types we calculate which values do not
+ * qualify since there only is a greater-than comparison */
+#define AVX2REJECT(W, x)						\
+	(anti ?								\
+	 (checknil ?							\
+	  _mm256_or_si256(_mm256_and_si256(_mm256_cmpgt_epi##W(x, l),	\
+					   _mm256_cmpgt_epi##W(h, x)),	\
+			  _mm256_cmpeq_epi##W(x, n)) :			\
+	  _mm256_and_si256(_mm256_cmpgt_epi##W(x, l),			\
+			   _mm256_cmpgt_epi##W(h, x))) :		\
+	 _mm256_or_si256(_mm256_cmpgt_epi##W(l, x),			\
+			 _mm256_cmpgt_epi##W(x, h)))
+#define AVX2ACCEPT(SUF, x)						\
+	(anti ?								\
+	 (checknil ?							\
+	  _mm256_and_##SUF(_mm256_or_##SUF(_mm256_cmp_##SUF(x, l, _CMP_LE_OQ), \
+					   _mm256_cmp_##SUF(x, h, _CMP_GE_OQ)), \
+			   _mm256_cmp_##SUF(x, n, _CMP_NEQ_UQ)) :	\
+	  _mm256_or_##SUF(_mm256_cmp_##SUF(x, l, _CMP_LE_OQ),		\
+			  _mm256_cmp_##SUF(x, h, _CMP_GE_OQ))) :	\
+	 _mm256_and_##SUF(_mm256_cmp_##SUF(x, l, _CMP_GE_OQ),		\
+			  _mm256_cmp_##SUF(x, h, _CMP_LE_OQ)))
+
+static inline uint64_t __attribute__((__target__("avx2")))
+avx2block_bte(const bte *src, bte vl, bte vh, bte nil, int anti, int checknil)
+{
+	const __m256i l = _mm256_set1_epi8(vl), h = _mm256_set1_epi8(vh);
+	const __m256i n = _mm256_set1_epi8(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + 32 * i));
+		m |= (uint64_t) (uint32_t) _mm256_movemask_epi8(AVX2REJECT(8, x)) << (32 * i);
+	}
+	return ~m;
+}
+
+static inline uint64_t __attribute__((__target__("avx2")))
+avx2block_sht(const sht *src, sht vl, sht vh, sht nil, int anti, int checknil)
+{
+	const __m256i l = _mm256_set1_epi16(vl), h = _mm256_set1_epi16(vh);
+	const __m256i n = _mm256_set1_epi16(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + 32 * i));
+		__m256i y = _mm256_loadu_si256((const __m256i *) (src + 32 * i + 16));
+		/* pack the two 16-bit masks into one 8-bit mask,
+		 * restoring the order of the 128-bit lanes */
+		__m256i r = _mm256_packs_epi16(AVX2REJECT(16, x), AVX2REJECT(16, y));
+		r = _mm256_permute4x64_epi64(r, 0xD8);
+		m |= (uint64_t) (uint32_t) _mm256_movemask_epi8(r) << (32 * i);
+	}
+	return ~m;
+}
+
+static inline uint64_t __attribute__((__target__("avx2")))
+avx2block_int(const int *src, int vl, int vh, int nil, int anti, int checknil)
+{
+	const __m256i l = _mm256_set1_epi32(vl), h = _mm256_set1_epi32(vh);
+	const __m256i n = _mm256_set1_epi32(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + 8 * i));
+		m |= (uint64_t) _mm256_movemask_ps(_mm256_castsi256_ps(AVX2REJECT(32, x))) << (8 * i);
+	}
+	return ~m;
+}
+
+static inline uint64_t __attribute__((__target__("avx2")))
+avx2block_lng(const lng *src, lng vl, lng vh, lng nil, int anti, int checknil)
+{
+	const __m256i l = _mm256_set1_epi64x(vl), h = _mm256_set1_epi64x(vh);
+	const __m256i n = _mm256_set1_epi64x(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		__m256i x = _mm256_loadu_si256((const __m256i *) (src + 4 * i));
+		m |= (uint64_t) _mm256_movemask_pd(_mm256_castsi256_pd(AVX2REJECT(64, x))) << (4 * i);
+	}
+	return ~m;
+}
+
+static inline uint64_t __attribute__((__target__("avx2")))
+avx2block_flt(const flt *src, flt vl, flt vh, flt nil, int anti, int checknil)
+{
+	const __m256 l = _mm256_set1_ps(vl), h = _mm256_set1_ps(vh);
+	const __m256 n = _mm256_set1_ps(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		__m256 x = _mm256_loadu_ps(src + 8 * i);
+		m |= (uint64_t) _mm256_movemask_ps(AVX2ACCEPT(ps, x)) << (8 * i);
+	}
+	return m;
+}
+
+static inline uint64_t __attribute__((__target__("avx2")))
+avx2block_dbl(const dbl *src, dbl vl, dbl vh, dbl nil, int anti, int checknil)
+{
+	const __m256d l = _mm256_set1_pd(vl), h = _mm256_set1_pd(vh);
+	const __m256d n = _mm256_set1_pd(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		__m256d x = _mm256_loadu_pd(src + 4 * i);
+		m |= (uint64_t) _mm256_movemask_pd(AVX2ACCEPT(pd, x)) << (4 * i);
+	}
+	return m;
+}
+
+/* convert the mask of a block starting at OID o to OIDs */
+static inline BUN __attribute__((__target__("avx2")))
+avx2emit(uint64_t m, oid o, oid *restrict dst, BUN cnt)
+{
+	while (m) {
+		dst[cnt++] = o + (oid) __builtin_ctzll(m);
+		m &= m - 1;
+	}
+	return cnt;
+}
+
+/* AVX-512: the comparisons produce masks directly */
+#define AVX512MASK(W, NE, LE, GE, x)				\
+	(anti ?								\
+	 ((_mm512_cmp_##W##_mask(x, l, LE) |				\
+	   _mm512_cmp_##W##_mask(x, h, GE)) &				\
+	  (checknil ? _mm512_cmp_##W##_mask(x, n, NE) : ~0)) :		\
+	 (_mm512_cmp_##W##_mask(x, l, GE) &				\
+	  _mm512_cmp_##W##_mask(x, h, LE)))
+#define AVX512MASKI(W, x)						\
+	AVX512MASK(W, _MM_CMPINT_NE, _MM_CMPINT_LE, _MM_CMPINT_NLT, x)
+#define AVX512MASKF(W, x)						\
+	AVX512MASK(W, _CMP_NEQ_UQ, _CMP_LE_OQ, _CMP_GE_OQ, x)
+
+static inline uint64_t __attribute__((__target__("avx512f,avx512bw")))
+avx512block_bte(const bte *src, bte vl, bte vh, bte nil, int anti, int checknil)
+{
+	const __m512i l = _mm512_set1_epi8(vl), h = _mm512_set1_epi8(vh);
+	const __m512i n = _mm512_set1_epi8(nil);
+	__m512i x = _mm512_loadu_si512(src);
+
+	return (uint64_t) AVX512MASKI(epi8, x);
+}
+
+static inline uint64_t __attribute__((__target__("avx512f,avx512bw")))
+avx512block_sht(const sht *src, sht vl, sht vh, sht nil, int anti, int checknil)
+{
+	const __m512i l = _mm512_set1_epi16(vl), h = _mm512_set1_epi16(vh);
+	const __m512i n = _mm512_set1_epi16(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		__m512i x = _mm512_loadu_si512(src + 32 * i);
+		m |= (uint64_t) (uint32_t) AVX512MASKI(epi16, x) << (32 * i);
+	}
+	return m;
+}
+
+static inline uint64_t __attribute__((__target__("avx512f,avx512bw")))
+avx512block_int(const int *src, int vl, int vh, int nil, int anti, int checknil)
+{
+	const __m512i l = _mm512_set1_epi32(vl), h = _mm512_set1_epi32(vh);
+	const __m512i n = _mm512_set1_epi32(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		__m512i x = _mm512_loadu_si512(src + 16 * i);
+		m |= (uint64_t) (uint16_t) AVX512MASKI(epi32, x) << (16 * i);
+	}
+	return m;
+}
+
+static inline uint64_t __attribute__((__target__("avx512f,avx512bw")))
+avx512block_lng(const lng *src, lng vl, lng vh, lng nil, int anti, int checknil)
+{
+	const __m512i l = _mm512_set1_epi64(vl), h = _mm512_set1_epi64(vh);
+	const __m512i n = _mm512_set1_epi64(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		__m512i x = _mm512_loadu_si512(src + 8 * i);
+		m |= (uint64_t) (uint8_t) AVX512MASKI(epi64, x) << (8 * i);
+	}
+	return m;
+}
+
+static inline uint64_t __attribute__((__target__("avx512f,avx512bw")))
+avx512block_flt(const flt *src, flt vl, flt vh, flt nil, int anti, int checknil)
+{
+	const __m512 l = _mm512_set1_ps(vl), h = _mm512_set1_ps(vh);
+	const __m512 n = _mm512_set1_ps(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		__m512 x = _mm512_loadu_ps(src + 16 * i);
+		m |= (uint64_t) (uint16_t) AVX512MASKF(ps, x) << (16 * i);
+	}
+	return m;
+}
+
+static inline uint64_t __attribute__((__target__("avx512f,avx512bw")))
+avx512block_dbl(const dbl *src, dbl vl, dbl vh, dbl nil, int anti, int checknil)
+{
+	const __m512d l = _mm512_set1_pd(vl), h = _mm512_set1_pd(vh);
+	const __m512d n = _mm512_set1_pd(nil);
+	uint64_t m = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		__m512d x = _mm512_loadu_pd(src + 8 * i);
+		m |= (uint64_t) (uint8_t) AVX512MASKF(pd, x) << (8 * i);
+	}
+	return m;
+}
+
+static inline BUN __attribute__((__target__("avx512f,avx512bw")))
+avx512emit(uint64_t m, oid o, oid *restrict dst, BUN cnt)
+{
+	__m512i idx = _mm512_add_epi64(_mm512_set1_epi64((lng) o),
+				       _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+	const __m512i eight = _mm512_set1_epi64(8);
+
+	while (m) {
+		__mmask8 k = (__mmask8) m;
+		if (k) {
+			_mm512_mask_compressstoreu_epi64(dst + cnt, k, idx);
+			cnt += __builtin_popcount(k);
+		}
+		m >>= 8;
+		idx = _mm512_add_epi64(idx, eight);
+	}
+	return cnt;
+}
+
+/* select from src[p..q) which corresponds with OIDs starting at o;
+ * the result is appended to dst which must have enough room */
+#define SIMDSCAN_IMPL(ISA, TARGET, TYPE)				\
+static BUN __attribute__((__target__(TARGET)))				\
+ISA##scan_##TYPE(const TYPE *restrict src, TYPE vl, TYPE vh,		\
+		 int anti, int checknil, BUN p, BUN q, oid o,		\
+		 oid *restrict dst, BUN cnt)				\
+{									\
+	const TYPE nil = TYPE##_nil;					\
+	TYPE v;								\
+									\
+	for (; p + SIMDBLOCK <= q; p += SIMDBLOCK, o += SIMDBLOCK)	\
+		cnt = ISA##emit(ISA##block_##TYPE(src + p, vl, vh, nil,	\
+						 anti, checknil),	\
+				o, dst, cnt);				\
+	for (; p < q; p++, o++) {					\
+		v = src[p];						\
+		if (SIMDTEST(v))					\
+			dst[cnt++] = o;					\
+	}								\
+	return cnt;							\
+}
+
+#define SIMDSCAN_TYPES(ISA, TARGET)		\
+	SIMDSCAN_IMPL(ISA, TARGET, bte)		\
+	SIMDSCAN_IMPL(ISA, TARGET, sht)		\
+	SIMDSCAN_IMPL(ISA, TARGET, int)		\
+	SIMDSCAN_IMPL(ISA, TARGET, lng)		\
+	SIMDSCAN_IMPL(ISA, TARGET, flt)		\
+	SIMDSCAN_IMPL(ISA, TARGET, dbl)
+
+SIMDSCAN_TYPES(avx2, "avx2")
+SIMDSCAN_TYPES(avx512, "avx512f,avx512bw")
+
+/* can we use a SIMD scan for (base) type t? */
+static int
+simdselect_usable(int t)
+{
+	switch (t) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		return simdselect_level() > 0;
+	default:
+		return 0;
+	}
+}
+
+#define SIMDCALL(TYPE)							\
+	(level == 2 ?							\
+	 avx512scan_##TYPE((const TYPE *) Tloc(b, 0), *(const TYPE *) tl, \
+			   *(const TYPE *) th, anti, !b->tnonil,	\
+			   p, p + n, (oid) (p + off), dst, cnt) :	\
+	 avx2scan_##TYPE((const TYPE *) Tloc(b, 0), *(const TYPE *) tl,	\
+			 *(const TYPE *) th, anti, !b->tnonil,		\
+			 p, p + n, (oid) (p + off), dst, cnt))
+
+/* SIMD version of the fullscan_TYPE functions (without imprints);
+ * the values in b from p to q are scanned in chunks, and before each
+ * chunk we make sure there is enough room in bn for the worst
+ * case */
+static BUN
+simdscan(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
+	 int equi, int anti, BUN p, BUN q, BUN cnt, lng off, BUN maximum)
+{
+	int level = simdselect_level();
+	BUN r = p, n, c0 = cnt, ncap;
+	oid *restrict dst = (oid *) Tloc(bn, 0);
+
+	ALGODEBUG fprintf(stderr,
+			  "#BATselect(b=%s#"BUNFMT",s=%s%s,anti=%d): "
+			  "simdscan %s (%s)\n", BATgetId(b), BATcount(b),
+			  s ? BATgetId(s) : "NULL",
+			  s && BATtdense(s) ? "(dense)" : "",
+			  anti, equi ? "equi" : anti ? "anti" : "range",
+			  level == 2 ? "avx512" : "avx2");
+	if (equi)
+		th = tl;
+	while (p < q) {
+		n = MIN(q - p, SIMDCHUNK);
+		if (BATcapacity(bn) - cnt < n && BATcapacity(bn) < maximum) {
+			/* extrapolate the selectivity so far, like
+			 * buninsfix */
+			ncap = (BUN) ((dbl) (cnt - c0) / (dbl) (p == r ? 1 : p - r)
+				      * (dbl) (q - p) * 1.1 + 1024);
+			ncap = MIN(MAX(ncap, n) + cnt, maximum);
+			BATsetcount(bn, cnt);
+			if (BATextend(bn, ncap) != GDK_SUCCEED) {
+				BBPreclaim(bn);
+				return BUN_NONE;
+			}
+			dst = (oid *) Tloc(bn, 0);
+		}
+		switch (ATOMbasetype(b->ttype)) {
+		case TYPE_bte:
+			cnt = SIMDCALL(bte);
+			break;
+		case TYPE_sht:
+			cnt = SIMDCALL(sht);
+			break;
+		case TYPE_int:
+			cnt = SIMDCALL(int);
+			break;
+		case TYPE_lng:
+			cnt = SIMDCALL(lng);
+			break;
+		case TYPE_flt:
+			cnt = SIMDCALL(flt);
+			break;
+		case TYPE_dbl:
+			cnt = SIMDCALL(dbl);
+			break;
+		default:
+			assert(0);
+		}
+		p += n;
+	}
+	return cnt;
+}
+
+#endif	/* HAVE_SIMD_SELECT */
+
+/* Select into a bitmap (see gdk_cand.h).  Word k of the bitmap w
+ * covers the values of src starting at position d + 64 * k, of which
+ * only those in [p,q) exist; if there is a candidate bitmap cw, it is
+ * aligned with w and the result is ANDed with it, skipping the words
+ * without candidates.  As in simdscan, the range is closed. */
+#define MASKTEST(v)							\
+	(anti ?								\
+	 ((v) <= vl || (v) >= vh) && (!checknil || (v) != nil) :	\
+	 (v) >= vl && (v) <= vh)
+
+#define MASKSCALAR(TYPE)						\
+	do {								\
+		for (j = 0; j < 64; j++) {				\
+			v = src[x + j];					\
+			m |= (ulng) MASKTEST(v) << j;			\
+		}							\
+	} while (0)
+
+#define MASKSCAN_IMPL(NAME, ATTR, TYPE, BLOCK)				\
+static void ATTR							\
+NAME##_##TYPE(const TYPE *restrict src, TYPE vl, TYPE vh, int anti,	\
+	      int checknil, lng d, BUN p, BUN q, ulng *restrict w,	\
+	      const ulng *restrict cw, BUN nw)				\
+{									\
+	const TYPE nil = TYPE##_nil;					\
+	BUN k;								\
+	lng x;								\
+	int j;								\
+	ulng m;								\
+	TYPE v;								\
+									\
+	for (k = 0; k < nw; k++) {					\
+		if (cw && cw[k] == 0)					\
+			continue;					\
+		x = d + (lng) k * 64;					\
+		m = 0;							\
+		if (x >= (lng) p && x + 64 <= (lng) q) {		\
+			BLOCK(TYPE);					\
+		} else {						\
+			for (j = 0; j < 64; j++) {			\
+				if (x + j < (lng) p || x + j >= (lng) q) \
+					continue;			\
+				v = src[x + j];				\
+				m |= (ulng) MASKTEST(v) << j;		\
+			}						\
+		}							\
+		w[k] = cw ? m & cw[k] : m;				\
+	}								\
+}
+
+MASKSCAN_IMPL(maskscan, , bte, MASKSCALAR)
+MASKSCAN_IMPL(maskscan, , sht, MASKSCALAR)
+MASKSCAN_IMPL(maskscan, , int, MASKSCALAR)
+MASKSCAN_IMPL(maskscan, , lng, MASKSCALAR)
+#ifdef HAVE_HGE
+MASKSCAN_IMPL(maskscan, , hge, MASKSCALAR)
+#endif
+MASKSCAN_IMPL(maskscan, , flt, MASKSCALAR)
+MASKSCAN_IMPL(maskscan, , dbl, MASKSCALAR)
+
+#ifdef HAVE_SIMD_SELECT
+#define MASKAVX2(TYPE)	\
+	(m = avx2block_##TYPE(src + x, vl, vh, nil, anti, checknil))
+#define MASKAVX512(TYPE)	\
+	(m = avx512block_##TYPE(src + x, vl, vh, nil, anti, checknil))
+
+#define MASKSCAN_SIMD(TYPE)						\
+	MASKSCAN_IMPL(avx2maskscan, __attribute__((__target__("avx2"))), \
+		      TYPE, MASKAVX2)					\
+	MASKSCAN_IMPL(avx512maskscan,					\
+		      __attribute__((__target__("avx512f,avx512bw"))),	\
+		      TYPE, MASKAVX512)
+
+MASKSCAN_SIMD(bte)
+MASKSCAN_SIMD(sht)
+MASKSCAN_SIMD(int)
+MASKSCAN_SIMD(lng)
+MASKSCAN_SIMD(flt)
+MASKSCAN_SIMD(dbl)
+
+#define MASKCALL(TYPE)							\
+	(level == 2 ? avx512maskscan_##TYPE :				\
+	 level == 1 ? avx2maskscan_##TYPE : maskscan_##TYPE)		\
+	((const TYPE *) Tloc(b, 0), *(const TYPE *) tl,			\
+	 *(const TYPE *) th, anti, !b->tnonil, d, p, q, w, cw, nw)
+#else
+#define MASKCALL(TYPE)							\
+	maskscan_##TYPE((const TYPE *) Tloc(b, 0), *(const TYPE *) tl,	\
+			*(const TYPE *) th, anti, !b->tnonil, d, p, q,	\
+			w, cw, nw)
+#endif
+
+/* can BAT_maskselect be used on b */
+static int
+maskselect_usable(BAT *b)
+{
+	if (b->tcompressed || ATOMtype(b->ttype) == TYPE_oid ||
+	    BATordered(b) || BATordered_rev(b))
+		return 0;
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* scan select producing a bitmap; s is NULL, dense, or a bitmap, and
+ * the arguments are normalized (see NORMALIZE) */
+static BAT *
+BAT_maskselect(BAT *b, BAT *s, const void *tl, const void *th,
+	       int anti, int keepmask)
+{
+	const Compressed *sc = s && CMPmask(s) ? s->tcompressed : NULL;
+	const ulng *cw = NULL;
+	oid off = b->hseqbase, base;
+	BUN p = 0, q = BATcount(b), nbits, nw;
+	Compressed *c;
+	ulng *w;
+	lng d;
+	BAT *bn;
+#ifdef HAVE_SIMD_SELECT
+	int level = simdselect_level();
+#endif
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	BATadvise(b, MMAP_SEQUENTIAL);
+	if (sc) {
+		base = (oid) sc->base;
+		nbits = (BUN) sc->range;
+		cw = (const ulng *) sc->codes.base;
+	} else {
+		if (s) {
+			assert(BATtdense(s));
+			if (s->tseqbase > off)
+				p = (BUN) (s->tseqbase - off);
+			if (s->tseqbase + BATcount(s) < off + q)
+				q = (BUN) (s->tseqbase + BATcount(s) - off);
+		}
+		base = off + p;
+		nbits = q - p;
+	}
+	if ((c = CMPmasknew(base, nbits)) == NULL)
+		return NULL;
+	w = (ulng *) c->codes.base;
+	nw = CMPmaskwords(nbits);
+	d = (lng) base - (lng) off;
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		MASKCALL(bte);
+		break;
+	case TYPE_sht:
+		MASKCALL(sht);
+		break;
+	case TYPE_int:
+		MASKCALL(int);
+		break;
+	case TYPE_lng:
+		MASKCALL(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		maskscan_hge((const hge *) Tloc(b, 0), *(const hge *) tl,
+			     *(const hge *) th, anti, !b->tnonil, d, p, q,
+			     w, cw, nw);
+		break;
+#endif
+	case TYPE_flt:
+		MASKCALL(flt);
+		break;
+	case TYPE_dbl:
+		MASKCALL(dbl);
+		break;
+	default:
+		assert(0);
+	}
+	bn = CMPmaskresult(c, keepmask);
+	ALGODEBUG fprintf(stderr, "#BATselect(b=%s#" BUNFMT ",s=%s%s,anti=%d): "
+			  "bitmap select " BUNFMT "%s (" LLFMT " usec)\n",
+			  BATgetId(b), BATcount(b),
+			  s ? BATgetId(s) : "NULL",
+			  sc ? "(bitmap)" : s ? "(dense)" : "", anti,
+			  bn ? BATcount(bn) : 0,
+			  bn && CMPmask(bn) ? " as bitmap" : "",
+			  GDKusec() - t0);
+	return bn;
+}
+
 static BAT *
 BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 	       int li, int hi, int equi, int anti, int lval, int hval,
-	       BUN maximum, int use_imprints)
+	       BUN maximum, int use_imprints, int use_zonemap)
 {
 #ifndef NDEBUG
 	int (*cmp)(const void *, const void *);
@@ -865,6 +1487,7 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 	oid o, *restrict dst;
 	lng off;
 	const oid *candlist;
+	BUN *zones = NULL, nzones = 0, z = 0;
 
 	assert(b != NULL);
 	assert(bn != NULL);
@@ -906,38 +1529,60 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 		p = SORTfndfirst(s, &b->hseqbase);
 		/* should we return an error if p > 0 || q <
 		 * BUNlast(s) (i.e. s not fully used)? */
-		candlist = (const oid *) Tloc(s, p);
-		/* call type-specific core scan select function */
+
+		/* use the zone map to restrict the scan to the
+		 * candidates in zones that may contain qualifying
+		 * values */
+		if (use_zonemap && p < q) {
+			const oid *c = (const oid *) Tloc(s, 0);
+			zones = ZMselect(b, tl, th, li, hi, equi, anti,
+					 lval, hval, (BUN) (c[p] - off),
+					 (BUN) (c[q - 1] + 1 - off), &nzones);
+		}
 		assert(b->batCapacity >= BATcount(b));
 		assert(s->batCapacity >= BATcount(s));
-		switch (t) {
-		case TYPE_bte:
-			cnt = candscan_bte(scanargs);
-			break;
-		case TYPE_sht:
-			cnt = candscan_sht(scanargs);
-			break;
-		case TYPE_int:
-			cnt = candscan_int(scanargs);
-			break;
-		case TYPE_flt:
-			cnt = candscan_flt(scanargs);
-			break;
-		case TYPE_dbl:
-			cnt = candscan_dbl(scanargs);
-			break;
-		case TYPE_lng:
-			cnt = candscan_lng(scanargs);
-			break;
+		do {
+			if (zones) {
+				if (z == nzones)
+					break;
+				o = (oid) (zones[2 * z] + off);
+				p = SORTfndfirst(s, &o);
+				o = (oid) (zones[2 * z + 1] + off);
+				q = SORTfndfirst(s, &o);
+				z++;
+			}
+			candlist = (const oid *) Tloc(s, p);
+			dst = (oid *) Tloc(bn, 0);
+			/* call type-specific core scan select function */
+			switch (t) {
+			case TYPE_bte:
+				cnt = candscan_bte(scanargs);
+				break;
+			case TYPE_sht:
+				cnt = candscan_sht(scanargs);
+				break;
+			case TYPE_int:
+				cnt = candscan_int(scanargs);
+				break;
+			case TYPE_flt:
+				cnt = candscan_flt(scanargs);
+				break;
+			case TYPE_dbl:
+				cnt = candscan_dbl(scanargs);
+				break;
+			case TYPE_lng:
+				cnt = candscan_lng(scanargs);
+				break;
 #ifdef HAVE_HGE
-		case TYPE_hge:
-			cnt = candscan_hge(scanargs);
-			break;
+			case TYPE_hge:
+				cnt = candscan_hge(scanargs);
+				break;
 #endif
-		default:
-			cnt = candscan_any(scanargs);
-			break;
-		}
+			default:
+				cnt = candscan_any(scanargs);
+				break;
+			}
+		} while (zones && cnt != BUN_NONE);
 	} else {
 		if (s) {
 			assert(BATtdense(s));
@@ -954,39 +1599,59 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 			q = BUNlast(b);
 		}
 		candlist = NULL;
-		/* call type-specific core scan select function */
-		switch (t) {
-		case TYPE_bte:
-			cnt = fullscan_bte(scanargs);
-			break;
-		case TYPE_sht:
-			cnt = fullscan_sht(scanargs);
-			break;
-		case TYPE_int:
-			cnt = fullscan_int(scanargs);
-			break;
-		case TYPE_flt:
-			cnt = fullscan_flt(scanargs);
-			break;
-		case TYPE_dbl:
-			cnt = fullscan_dbl(scanargs);
-			break;
-		case TYPE_lng:
-			cnt = fullscan_lng(scanargs);
-			break;
+		if (use_zonemap && p < q)
+			zones = ZMselect(b, tl, th, li, hi, equi, anti,
+					 lval, hval, p, q, &nzones);
+		do {
+			if (zones) {
+				if (z == nzones)
+					break;
+				p = zones[2 * z];
+				q = zones[2 * z + 1];
+				z++;
+			}
+			dst = (oid *) Tloc(bn, 0);
+			/* call type-specific core scan select function */
+#ifdef HAVE_SIMD_SELECT
+			if (!use_imprints && simdselect_usable(t))
+				cnt = simdscan(b, s, bn, tl, th, equi, anti,
+					       p, q, cnt, off, maximum);
+			else
+#endif
+			switch (t) {
+			case TYPE_bte:
+				cnt = fullscan_bte(scanargs);
+				break;
+			case TYPE_sht:
+				cnt = fullscan_sht(scanargs);
+				break;
+			case TYPE_int:
+				cnt = fullscan_int(scanargs);
+				break;
+			case TYPE_flt:
+				cnt = fullscan_flt(scanargs);
+				break;
+			case TYPE_dbl:
+				cnt = fullscan_dbl(scanargs);
+				break;
+			case TYPE_lng:
+				cnt = fullscan_lng(scanargs);
+				break;
 #ifdef HAVE_HGE
-		case TYPE_hge:
-			cnt = fullscan_hge(scanargs);
-			break;
+			case TYPE_hge:
+				cnt = fullscan_hge(scanargs);
+				break;
 #endif
-		case TYPE_str:
-			cnt = fullscan_str(scanargs);
-			break;
-		default:
-			cnt = fullscan_any(scanargs);
-			break;
-		}
+			case TYPE_str:
+				cnt = fullscan_str(scanargs);
+				break;
+			default:
+				cnt = fullscan_any(scanargs);
+				break;
+			}
+		} while (zones && cnt != BUN_NONE);
 	}
+	GDKfree(zones);
 	if (cnt == BUN_NONE) {
 		return NULL;
 	}
@@ -1010,7 +1675,9 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
  * (i.e. in the same order as the input BAT).
  *
  * If s[dense,OID] is specified, its tail column is a list of
- * candidates.  s should be sorted on the tail value.
+ * candidates.  s should be sorted on the tail value.  s may be a
+ * bitmap (see gdk_cand.h); BATmaskselect, which otherwise is the same
+ * as BATselect, may also return one.
  *
  * tl may not be NULL, li, hi, and anti must be either 0 or 1.
  *
@@ -1180,9 +1847,9 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 		/* in the case where equi==1, the check is x == *tl */	\
 	} while (0)
 
-BAT *
-BATselect(BAT *b, BAT *s, const void *tl, const void *th,
-	     int li, int hi, int anti)
+static BAT *
+BATselect_(BAT *b, BAT *s, const void *tl, const void *th,
+	   int li, int hi, int anti, int mask)
 {
 	int hval, lval, equi, t, lnil, hash;
 	bat parent;
@@ -1224,6 +1891,14 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 			 "s must be sorted.\n");
 		return NULL;
 	}
+	/* a bitmap candidate list is only used as is by
+	 * BAT_maskselect */
+	if (s && s->tcompressed &&
+	    (!CMPmask(s) || !maskselect_usable(b)) &&
+	    BATdecompress(s) != GDK_SUCCEED)
+		return NULL;
+	if (CMPmask(b) && BATdecompress(b) != GDK_SUCCEED)
+		return NULL;
 
 	if (b->batCount == 0 ||
 	    (s && (s->batCount == 0 ||
@@ -1370,14 +2045,24 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 				  s && BATtdense(s) ? "(dense)" : "", anti);
 		if (s) {
 			oid o = b->hseqbase + BATcount(b);
-			BUN q = SORTfndfirst(s, &o);
-			BUN p = SORTfndfirst(s, &b->hseqbase);
+			BUN q, p;
+
+			if (CMPmask(s) && BATdecompress(s) != GDK_SUCCEED)
+				return NULL;
+			q = SORTfndfirst(s, &o);
+			p = SORTfndfirst(s, &b->hseqbase);
 			return BATslice(s, p, q);
 		} else {
 			return BATdense(0, b->hseqbase, BATcount(b));
 		}
 	}
 
+	if (b->tcompressed && !CMPmask(b)) {
+		/* work on the compressed representation */
+		return virtualize(CMPselect(b, s, tl, th, li, hi, equi, anti,
+					    lval, hval, lnil));
+	}
+
 	if (ATOMtype(b->ttype) == TYPE_oid) {
 		NORMALIZE(oid);
 	} else {
@@ -1652,6 +2337,21 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 		return virtualize(bn);
 	}
 
+	/* select into a bitmap if the candidates are one, or if a
+	 * bitmap result was asked for and the scan is not going to be
+	 * restricted by an existing hash, imprints or zone map */
+	parent = VIEWtparent(b);
+	if ((s && CMPmask(s)) ||
+	    (mask && !equi && BATcount(b) >= CANDMASK_MIN &&
+	     (s == NULL || BATtdense(s)) && maskselect_usable(b) &&
+	     !BATcheckimprints(b) && b->tzonemap == NULL &&
+	     (parent == 0 ||
+	      ((tmp = BBPquickdesc(parent, 0)) != NULL &&
+	       !BATcheckimprints(tmp) && tmp->tzonemap == NULL)))) {
+		assert(maskselect_usable(b));
+		return BAT_maskselect(b, s, tl, th, anti, mask);
+	}
+
 	/* upper limit for result size */
 	maximum = BATcount(b);
 	if (s) {
@@ -1700,7 +2400,6 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 	}
 	/* refine upper limit by exact size (if known) */
 	maximum = MIN(maximum, estimate);
-	parent = VIEWtparent(b);
 	assert(parent >= 0);
 	/* use hash only for equi-join, and then only if b or its
 	 * parent already has a hash, or if b or its parent is
@@ -1793,7 +2492,7 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 				  s && BATtdense(s) ? "(dense)" : "", anti);
 		bn = BAT_hashselect(b, s, bn, tl, maximum);
 	} else {
-		int use_imprints = 0;
+		int use_imprints = 0, use_zonemap = 0;
 		if (!equi &&
 		    !b->tvarsized &&
 		    (b->batPersistence == PERSISTENT ||
@@ -1807,13 +2506,50 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 			 */
 			use_imprints = 1;
 		}
+		if (!use_imprints &&
+		    !(equi && lnil) &&
+		    ATOMlinear(b->ttype) &&
+		    b->ttype != TYPE_void &&
+		    (b->tzonemap ||
+		     (parent != 0 &&
+		      (tmp = BBPquickdesc(parent, 0)) != NULL &&
+		      tmp->tzonemap) ||
+		     (BATcount(b) >= ZONEMAP_MINCNT &&
+		      (b->batPersistence == PERSISTENT ||
+		       (parent != 0 &&
+			(tmp = BBPquickdesc(parent, 0)) != NULL &&
+			tmp->batPersistence == PERSISTENT))))) {
+			/* use zone maps if
+			 *   i) imprints are not used,
+			 *  ii) it is not a select for nil, and
+			 * iii) there already is a zone map, or the bat
+			 *      is large and (its parent is) persistent.
+			 */
+			use_zonemap = 1;
+		}
+		BATadvise(b, MMAP_SEQUENTIAL);
 		bn = BAT_scanselect(b, s, bn, tl, th, li, hi, equi, anti,
-				    lval, hval, maximum, use_imprints);
+				    lval, hval, maximum, use_imprints,
+				    use_zonemap);
 	}
 
 	return virtualize(bn);
 }
 
+BAT *
+BATselect(BAT *b, BAT *s, const void *tl, const void *th,
+	     int li, int hi, int anti)
+{
+	return BATselect_(b, s, tl, th, li, hi, anti, 0);
+}
+
+BAT *
+BATmaskselect(BAT *b, BAT *s, const void *tl, const void *th,
+	      int li, int hi, int anti)
+{
+	return BATselect_(b, s, tl, th, li, hi, anti, 1);
+}
+
 /* theta select
  *
  * Returns a dense-headed BAT with the OID values of b in the tail for
@@ -1831,8 +2567,8 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
  *
  * If value is nil, the result is empty.
  */
-BAT *
-BATthetaselect(BAT *b, BAT *s, const void *val, const char *op)
+static BAT *
+BATthetaselect_(BAT *b, BAT *s, const void *val, const char *op, int mask)
 {
 	const void *nil;
 
@@ -1845,40 +2581,52 @@ BATthetaselect(BAT *b, BAT *s, const void *val, const char *op)
 		return BATdense(0, 0, 0);
 	if (op[0] == '=' && ((op[1] == '=' && op[2] == 0) || op[1] == 0)) {
 		/* "=" or "==" */
-		return BATselect(b, s, val, NULL, 1, 1, 0);
+		return BATselect_(b, s, val, NULL, 1, 1, 0, mask);
 	}
 	if (op[0] == '!' && op[1] == '=' && op[2] == 0) {
 		/* "!=" (equivalent to "<>") */
-		return BATselect(b, s, val, NULL, 1, 1, 1);
+		return BATselect_(b, s, val, NULL, 1, 1, 1, mask);
 	}
 	if (op[0] == '<') {
 		if (op[1] == 0) {
 			/* "<" */
-			return BATselect(b, s, nil, val, 0, 0, 0);
+			return BATselect_(b, s, nil, val, 0, 0, 0, mask);
 		}
 		if (op[1] == '=' && op[2] == 0) {
 			/* "<=" */
-			return BATselect(b, s, nil, val, 0, 1, 0);
+			return BATselect_(b, s, nil, val, 0, 1, 0, mask);
 		}
 		if (op[1] == '>' && op[2] == 0) {
 			/* "<>" (equivalent to "!=") */
-			return BATselect(b, s, val, NULL, 1, 1, 1);
+			return BATselect_(b, s, val, NULL, 1, 1, 1, mask);
 		}
 	}
 	if (op[0] == '>') {
 		if (op[1] == 0) {
 			/* ">" */
-			return BATselect(b, s, val, nil, 0, 0, 0);
+			return BATselect_(b, s, val, nil, 0, 0, 0, mask);
 		}
 		if (op[1] == '=' && op[2] == 0) {
 			/* ">=" */
-			return BATselect(b, s, val, nil, 1, 0, 0);
+			return BATselect_(b, s, val, nil, 1, 0, 0, mask);
 		}
 	}
 	GDKerror("BATthetaselect: unknown operator.\n");
 	return NULL;
 }
 
+BAT *
+BATthetaselect(BAT *b, BAT *s, const void *val, const char *op)
+{
+	return BATthetaselect_(b, s, val, op, 0);
+}
+
+BAT *
+BATmaskthetaselect(BAT *b, BAT *s, const void *val, const char *op)
+{
+	return BATthetaselect_(b, s, val, op, 1);
+}
+
 #define VALUE(s, x)	(s##vars ?					\
 			 s##vars + VarHeapVal(s##vals, (x), s##width) : \
 			 s##vals + ((x) * s##width))
@@ -29,6 +29,10 @@
 #include <stdlib.h>
 #include "gdk_storage.h"
 #include "mutils.h"
+#include "gdk_atomic.h"
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
 #ifdef HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
@@ -456,6 +460,12 @@ GDKsave(int farmid, const char *nme, const char *ext, void *buf, size_t size, st
 						(unsigned) MIN(1 << 30, size),
 						ret);
 			}
+#ifdef HAVE_SYNC_FILE_RANGE
+			/* if the caller syncs later, at least start
+			 * writing the data now */
+			if (!dosync && err == 0 && !(GDKdebug & FORCEMITOMASK))
+				(void) sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
 			if (dosync && !(GDKdebug & FORCEMITOMASK) &&
 #if defined(NATIVE_WIN32)
 			    _commit(fd) < 0
@@ -515,6 +525,11 @@ GDKload(int farmid, const char *nme, const char *ext, size_t size, size_t *maxsi
 			ssize_t n_expected, n = 0;
 
 			if (ret) {
+				/* place persistent heaps before the
+				 * read touches the pages */
+				if (farmid == 0)
+					GDKnumaplace(ret, *maxsize);
+				GDKhugepages(ret, *maxsize);
 				/* read in chunks, some OSs do not
 				 * give you all at once and Windows
 				 * only accepts int */
@@ -569,6 +584,8 @@ GDKload(int farmid, const char *nme, const char *ext, size_t size, size_t *maxsi
 			if (ret != NULL) {
 				/* success: update allocated size */
 				*maxsize = size;
+				if (farmid == 0)
+					GDKnumaplace(ret, size);
 			}
 			IODEBUG fprintf(stderr, "#mmap(NULL, 0, maxsize " SZFMT ", mod %d, path %s, 0) = " PTRFMT "\n", size, mod, path, PTRFMTCAST(void *)ret);
 		}
@@ -577,6 +594,275 @@ GDKload(int farmid, const char *nme, const char *ext, size_t size, size_t *maxsi
 	return ret;
 }
 
+/*
+ * @- Compressed heaps
+ * A heap with the zsave flag set is saved by GDKzsave as a sequence
+ * of independently deflated blocks, so that a cold column takes less
+ * space on disk and less I/O to read in.  The file consists of
+ *
+ *	magic		8 bytes, ZHEAP_MAGIC
+ *	blocksize	8 bytes, the uncompressed size of a block
+ *	size		8 bytes, the uncompressed size of the heap
+ *	index		8 bytes per block, the offset of the end of the
+ *			block relative to the start of the first block
+ *	blocks
+ *
+ * A block that does not get smaller is stored as is, which is
+ * recognized by its stored size being equal to its uncompressed size.
+ * Such a file cannot be memory mapped, so GDKzload always reads it
+ * into malloced memory.  A file without the magic is read as a plain
+ * heap: the flag may have been set on a heap that has not been saved
+ * since.
+ */
+#ifdef HAVE_LIBZ
+#define ZHEAP_MAGIC	((uint64_t) 0x315A4854454E4F4D) /* "MONETHZ1" */
+#define ZHEAP_BLOCK	((size_t) 1 << 18)
+#define ZHEAP_HDRSIZE	3	/* words before the index */
+
+static volatile ATOMIC_TYPE zheap_savedkb;	/* heap data saved (in KiB) */
+static volatile ATOMIC_TYPE zheap_writtenkb;	/* file data written (in KiB) */
+static volatile ATOMIC_TYPE zheap_loads;	/* compressed heaps loaded */
+#ifdef ATOMIC_LOCK
+static MT_Lock zheap_lock MT_LOCK_INITIALIZER("zheap_lock");
+#endif
+
+/* write or read all of buf; returns -1 on error */
+static int
+zheap_write(int fd, const void *buf, size_t size)
+{
+	ssize_t ret;
+
+	while (size > 0) {
+		ret = write(fd, buf, (unsigned) MIN(1 << 30, size));
+		if (ret < 0)
+			return -1;
+		size -= ret;
+		buf = (const char *) buf + ret;
+	}
+	return 0;
+}
+
+static int
+zheap_read(int fd, void *buf, size_t size)
+{
+	ssize_t ret;
+
+	while (size > 0) {
+		ret = read(fd, buf, (unsigned) MIN(1 << 30, size));
+		if (ret <= 0)
+			return -1;
+		size -= ret;
+		buf = (char *) buf + ret;
+	}
+	return 0;
+}
+#endif
+
+void
+GDKzinit(void)
+{
+#ifdef HAVE_LIBZ
+#ifdef NEED_MT_LOCK_INIT
+	ATOMIC_INIT(zheap_lock);
+#endif
+	ATOMIC_SET(zheap_savedkb, 0, zheap_lock);
+	ATOMIC_SET(zheap_writtenkb, 0, zheap_lock);
+	ATOMIC_SET(zheap_loads, 0, zheap_lock);
+#endif
+}
+
+gdk_return
+GDKzsave(int farmid, const char *nme, const char *ext, void *buf, size_t size, int dosync)
+{
+#ifdef HAVE_LIBZ
+	size_t nblocks = (size + ZHEAP_BLOCK - 1) / ZHEAP_BLOCK;
+	size_t i, len, off = 0;
+	uint64_t *hdr;
+	Bytef *zbuf;
+	uLongf zlen;
+	const Bytef *src;
+	int fd, err = 0;
+
+	IODEBUG fprintf(stderr, "#GDKzsave: name=%s, ext=%s, size=" SZFMT ", dosync=%d\n", nme, ext ? ext : "", size, dosync);
+
+	hdr = GDKmalloc((ZHEAP_HDRSIZE + nblocks) * sizeof(uint64_t));
+	zbuf = GDKmalloc(compressBound((uLong) ZHEAP_BLOCK));
+	if (hdr == NULL || zbuf == NULL) {
+		GDKfree(hdr);
+		GDKfree(zbuf);
+		return GDK_FAIL;
+	}
+	if ((fd = GDKfdlocate(farmid, nme, "wb", ext)) < 0) {
+		GDKfree(hdr);
+		GDKfree(zbuf);
+		GDKerror("GDKzsave: failed name=%s, ext=%s\n",
+			 nme, ext ? ext : "");
+		return GDK_FAIL;
+	}
+	hdr[0] = ZHEAP_MAGIC;
+	hdr[1] = ZHEAP_BLOCK;
+	hdr[2] = size;
+	/* the blocks go after the index, which is written last */
+	if (lseek(fd, (off_t) ((ZHEAP_HDRSIZE + nblocks) * sizeof(uint64_t)), SEEK_SET) < 0)
+		err = -1;
+	for (i = 0; err == 0 && i < nblocks; i++) {
+		src = (const Bytef *) buf + i * ZHEAP_BLOCK;
+		len = MIN(ZHEAP_BLOCK, size - i * ZHEAP_BLOCK);
+		zlen = compressBound((uLong) ZHEAP_BLOCK);
+		if (compress2(zbuf, &zlen, src, (uLong) len, Z_BEST_SPEED) == Z_OK &&
+		    zlen < len) {
+			err = zheap_write(fd, zbuf, zlen);
+			off += zlen;
+		} else {
+			err = zheap_write(fd, src, len);
+			off += len;
+		}
+		hdr[ZHEAP_HDRSIZE + i] = off;
+	}
+	if (err == 0 &&
+	    (lseek(fd, 0, SEEK_SET) < 0 ||
+	     zheap_write(fd, hdr, (ZHEAP_HDRSIZE + nblocks) * sizeof(uint64_t)) < 0))
+		err = -1;
+#ifdef HAVE_SYNC_FILE_RANGE
+	if (err == 0 && !dosync && !(GDKdebug & FORCEMITOMASK))
+		(void) sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+	if (err == 0 && dosync && !(GDKdebug & FORCEMITOMASK) &&
+#if defined(NATIVE_WIN32)
+	    _commit(fd) < 0
+#elif defined(HAVE_FDATASYNC)
+	    fdatasync(fd) < 0
+#elif defined(HAVE_FSYNC)
+	    fsync(fd) < 0
+#else
+	    0
+#endif
+		)
+		err = -1;
+	if (err)
+		GDKsyserror("GDKzsave: error on: name=%s, ext=%s\n",
+			    nme, ext ? ext : "");
+	err |= close(fd);
+	GDKfree(hdr);
+	GDKfree(zbuf);
+	if (err) {
+		if (GDKunlink(farmid, BATDIR, nme, ext) != GDK_SUCCEED)
+			GDKfatal("GDKzsave: could not open: name=%s, ext=%s\n",
+				 nme, ext ? ext : "");
+		return GDK_FAIL;
+	}
+	IODEBUG fprintf(stderr, "#GDKzsave: name=%s, ext=%s: " SZFMT " bytes in " SZFMT " bytes\n", nme, ext ? ext : "", size, off);
+	(void) ATOMIC_ADD(zheap_savedkb, (ATOMIC_TYPE) (size >> 10), zheap_lock);
+	(void) ATOMIC_ADD(zheap_writtenkb, (ATOMIC_TYPE) ((off + (ZHEAP_HDRSIZE + nblocks) * sizeof(uint64_t)) >> 10), zheap_lock);
+	return GDK_SUCCEED;
+#else
+	return GDKsave(farmid, nme, ext, buf, size, STORE_MEM, dosync);
+#endif
+}
+
+/*
+ * Load a heap saved by GDKzsave into malloced memory; the arguments
+ * are as for GDKload.  If the file is not compressed, it is read as
+ * is and *plain is set.
+ */
+char *
+GDKzload(int farmid, const char *nme, const char *ext, size_t size, size_t *maxsize, int *plain)
+{
+#ifdef HAVE_LIBZ
+	uint64_t head[ZHEAP_HDRSIZE], *index = NULL;
+	size_t blocksize, nblocks, i, len, zlen, off = 0;
+	Bytef *zbuf = NULL;
+	char *ret = NULL;
+	uLongf dlen;
+	int fd;
+
+	assert(size <= *maxsize);
+	IODEBUG fprintf(stderr, "#GDKzload: name=%s, ext=%s\n", nme, ext ? ext : "");
+	*plain = 0;
+	if ((fd = GDKfdlocate(farmid, nme, "rb", ext)) < 0) {
+		GDKerror("GDKzload: cannot open: name=%s, ext=%s\n", nme, ext ? ext : "");
+		return NULL;
+	}
+	if (zheap_read(fd, head, sizeof(head)) < 0 ||
+	    head[0] != ZHEAP_MAGIC) {
+		close(fd);
+		*plain = 1;
+		return GDKload(farmid, nme, ext, size, maxsize, STORE_MEM);
+	}
+	blocksize = (size_t) head[1];
+	if (head[2] != size || blocksize == 0 || blocksize > ((size_t) 1 << 30))
+		goto corrupt;
+	nblocks = (size + blocksize - 1) / blocksize;
+	index = GDKmalloc((nblocks + 1) * sizeof(uint64_t));
+	zbuf = GDKmalloc(blocksize);
+	ret = GDKmalloc(*maxsize);
+	if (index == NULL || zbuf == NULL || ret == NULL)
+		goto bailout;
+	if (zheap_read(fd, index, nblocks * sizeof(uint64_t)) < 0)
+		goto corrupt;
+	/* place persistent heaps before the blocks touch the pages */
+	if (farmid == 0)
+		GDKnumaplace(ret, *maxsize);
+	GDKhugepages(ret, *maxsize);
+	for (i = 0; i < nblocks; i++) {
+		len = MIN(blocksize, size - i * blocksize);
+		if (index[i] <= off || index[i] - off > len)
+			goto corrupt;
+		zlen = (size_t) index[i] - off;
+		off = (size_t) index[i];
+		if (zlen == len) {
+			/* stored as is */
+			if (zheap_read(fd, ret + i * blocksize, len) < 0)
+				goto corrupt;
+			continue;
+		}
+		dlen = (uLongf) len;
+		if (zheap_read(fd, zbuf, zlen) < 0 ||
+		    uncompress((Bytef *) ret + i * blocksize, &dlen, zbuf, (uLong) zlen) != Z_OK ||
+		    dlen != len)
+			goto corrupt;
+	}
+#ifndef NDEBUG
+	/* just to make valgrind happy, we initialize the whole
+	 * thing */
+	if (*maxsize > size)
+		memset(ret + size, 0, *maxsize - size);
+#endif
+	close(fd);
+	GDKfree(index);
+	GDKfree(zbuf);
+	(void) ATOMIC_INC(zheap_loads, zheap_lock);
+	return ret;
+
+  corrupt:
+	GDKerror("GDKzload: corrupt compressed heap: name=%s, ext=%s\n", nme, ext ? ext : "");
+  bailout:
+	close(fd);
+	GDKfree(index);
+	GDKfree(zbuf);
+	GDKfree(ret);
+	return NULL;
+#else
+	*plain = 1;
+	return GDKload(farmid, nme, ext, size, maxsize, STORE_MEM);
+#endif
+}
+
+/* Report the number of KiB of heap data saved compressed, the number
+ * of KiB that took on disk, and the number of compressed heaps
+ * loaded. */
+void
+GDKzstatistics(lng *savedkb, lng *writtenkb, lng *loads)
+{
+#ifdef HAVE_LIBZ
+	*savedkb = (lng) ATOMIC_GET(zheap_savedkb, zheap_lock);
+	*writtenkb = (lng) ATOMIC_GET(zheap_writtenkb, zheap_lock);
+	*loads = (lng) ATOMIC_GET(zheap_loads, zheap_lock);
+#else
+	*savedkb = *writtenkb = *loads = 0;
+#endif
+}
+
 /*
  * @+ BAT disk storage
  *
@@ -726,7 +1012,7 @@ BATmsync(BAT *b)
 }
 
 gdk_return
-BATsave(BAT *bd)
+BATsave(BAT *bd, int dosync)
 {
 	gdk_return err = GDK_SUCCEED;
 	char *nme;
@@ -746,6 +1032,9 @@ BATsave(BAT *bd)
 	if (!BATdirty(b)) {
 		return GDK_SUCCEED;
 	}
+	/* only the uncompressed form is saved */
+	if (b->tcompressed && BATdecompress(b) != GDK_SUCCEED)
+		return GDK_FAIL;
 
 	/* copy the descriptor to a local variable in order to let our
 	 * messing in the BAT descriptor not affect other threads that
@@ -766,11 +1055,11 @@ BATsave(BAT *bd)
 	nme = BBP_physical(b->batCacheid);
 	if (b->batCopiedtodisk == 0 || b->batDirty || b->theap.dirty)
 		if (err == GDK_SUCCEED && b->ttype)
-			err = HEAPsave(&b->theap, nme, "tail");
+			err = HEAPsave(&b->theap, nme, "tail", dosync);
 	if (b->tvheap && (b->batCopiedtodisk == 0 || b->batDirty || b->tvheap->dirty))
 		if (b->ttype && b->tvarsized) {
 			if (err == GDK_SUCCEED)
-				err = HEAPsave(b->tvheap, nme, "theap");
+				err = HEAPsave(b->tvheap, nme, "theap", dosync);
 		}
 
 	if (b->tvheap)
@@ -779,12 +1068,56 @@ BATsave(BAT *bd)
 	if (err == GDK_SUCCEED) {
 		bd->batCopiedtodisk = 1;
 		DESCclean(bd);
+		ZMsave(bd);
 		return GDK_SUCCEED;
 	}
 	return err;
 }
 
 
+/*
+ * The heaps of a BAT are saved compressed from its next save on.  A
+ * heap that is memory mapped cannot be switched over in place, since
+ * views may point into it; it is written compressed the next time it
+ * is loaded, which for such a heap is into malloced memory (see
+ * HEAPload).
+ */
+gdk_return
+BATsetdiskcompression(BAT *b, int onoff)
+{
+	int changed = 0;
+
+	BATcheck(b, "BATsetdiskcompression", GDK_FAIL);
+	if (isVIEW(b)) {
+		GDKerror("BATsetdiskcompression: %s is a view\n", BATgetId(b));
+		return GDK_FAIL;
+	}
+#ifndef HAVE_LIBZ
+	if (onoff) {
+		GDKerror("BATsetdiskcompression: no compression library available\n");
+		return GDK_FAIL;
+	}
+#endif
+	onoff = onoff != 0;
+	if (b->ttype != TYPE_void && b->theap.zsave != (unsigned) onoff) {
+		b->theap.zsave = onoff;
+		if (b->theap.storage == STORE_MEM)
+			b->theap.dirty = TRUE;
+		changed = 1;
+	}
+	if (b->tvheap && b->tvheap->zsave != (unsigned) onoff) {
+		b->tvheap->zsave = onoff;
+		if (b->tvheap->storage == STORE_MEM)
+			b->tvheap->dirty = TRUE;
+		changed = 1;
+	}
+	if (changed) {
+		b->batDirtydesc = TRUE;
+		BBPdirty(1);
+	}
+	return GDK_SUCCEED;
+}
+
 /*
  * TODO: move to gdk_bbp.c
  */
@@ -841,6 +1174,150 @@ BATload_intern(bat bid, int lock)
 	return b;
 }
 
+/*
+ * @- BATprefetch
+ * Loading a BAT is synchronous: the first BATdescriptor of a BAT that
+ * is not in memory reads the heaps that are kept in malloced memory,
+ * and the heaps that are memory mapped are read one page fault at a
+ * time as the BAT is used.  A query that reads many cold columns thus
+ * waits for the disk one column after the other.
+ *
+ * BATprefetch queues a BAT for one of a small pool of prefetch
+ * threads, which loads it if it isn't loaded yet and then advises the
+ * OS that its memory mapped heaps will be needed (MMAP_WILLNEED), so
+ * that the kernel reads them ahead.  A query can thus ask for all the
+ * columns it is going to use when it starts, and the I/O for all of
+ * them overlaps with the work on the first ones.  The BAT is not kept
+ * fixed, so it may be unloaded again before it is used; that only
+ * costs the prefetch.  Requests for a BAT that is already queued and
+ * requests that don't fit in the queue are dropped.
+ *
+ * The threads are started on the first request; setting gdk_prefetch
+ * to "no" disables prefetching altogether.
+ */
+#define PREFETCH_MAXTHREADS	4
+#define PREFETCH_QUEUESIZE	1024
+#define PREFETCH_IDLE		10 /* ms to sleep when there is no work */
+
+static MT_Lock prefetch_lock MT_LOCK_INITIALIZER("prefetch_lock");
+static bat prefetch_queue[PREFETCH_QUEUESIZE]; /* circular */
+static int prefetch_first, prefetch_count;
+static int prefetch_threads = -1; /* -1: not started yet */
+static lng prefetch_requests, prefetch_loads, prefetch_dropped;
+
+void
+BATprefetchinit(void)
+{
+#ifdef NEED_MT_LOCK_INIT
+	MT_lock_init(&prefetch_lock, "prefetch_lock");
+#endif
+	prefetch_first = prefetch_count = 0;
+	prefetch_threads = -1;
+}
+
+static void
+BATprefetchThread(void *arg)
+{
+	Thread thr;
+	bat bid;
+	BAT *b;
+	int cold;
+
+	(void) arg;
+	thr = THRnew("BATprefetch");
+	while (!GDKexiting()) {
+		MT_lock_set(&prefetch_lock);
+		if (prefetch_count == 0) {
+			MT_lock_unset(&prefetch_lock);
+			MT_sleep_ms(PREFETCH_IDLE);
+			continue;
+		}
+		bid = prefetch_queue[prefetch_first];
+		prefetch_first = (prefetch_first + 1) % PREFETCH_QUEUESIZE;
+		prefetch_count--;
+		MT_lock_unset(&prefetch_lock);
+
+		/* only BATs that somebody refers to, so that we don't
+		 * resurrect one that is being destroyed */
+		if (BBPcheck(bid, "BATprefetch") == 0 ||
+		    (BBP_lrefs(bid) == 0 && BBP_refs(bid) == 0))
+			continue;
+		cold = BBP_cache(bid) == NULL;
+		if ((b = BATdescriptor(bid)) == NULL)
+			continue;
+		BATadvise(b, MMAP_WILLNEED);
+		BBPunfix(bid);
+		if (cold) {
+			MT_lock_set(&prefetch_lock);
+			prefetch_loads++;
+			MT_lock_unset(&prefetch_lock);
+		}
+	}
+	MT_lock_set(&prefetch_lock);
+	if (--prefetch_threads == 0)
+		prefetch_threads = -1;
+	MT_lock_unset(&prefetch_lock);
+	if (thr)
+		THRdel(thr);
+}
+
+void
+BATprefetch(bat bid)
+{
+	int i, n;
+	MT_Id tid;
+
+	if (BBPcheck(bid, "BATprefetch") == 0 || GDKexiting())
+		return;
+	MT_lock_set(&prefetch_lock);
+	if (prefetch_threads < 0) {
+		const char *p = GDKgetenv("gdk_prefetch");
+
+		prefetch_threads = 0;
+		if (p == NULL || strcmp(p, "no") != 0) {
+			/* the threads mostly wait for the disk, so
+			 * don't take more of them than there are
+			 * cores to process the data */
+			n = GDKnr_threads < PREFETCH_MAXTHREADS ? GDKnr_threads : PREFETCH_MAXTHREADS;
+			for (i = 0; i < n; i++) {
+				if (MT_create_thread(&tid, BATprefetchThread, NULL, MT_THR_JOINABLE) < 0)
+					break;
+				GDKregister(tid);
+				prefetch_threads++;
+			}
+		}
+	}
+	if (prefetch_threads == 0) {
+		MT_lock_unset(&prefetch_lock);
+		return;
+	}
+	prefetch_requests++;
+	for (i = 0; i < prefetch_count; i++)
+		if (prefetch_queue[(prefetch_first + i) % PREFETCH_QUEUESIZE] == bid)
+			break;
+	if (i < prefetch_count || prefetch_count == PREFETCH_QUEUESIZE) {
+		prefetch_dropped++;
+	} else {
+		prefetch_queue[(prefetch_first + prefetch_count) % PREFETCH_QUEUESIZE] = bid;
+		prefetch_count++;
+	}
+	MT_lock_unset(&prefetch_lock);
+}
+
+/* Report the number of prefetch threads, the number of prefetch
+ * requests, how many BATs were loaded by the prefetch threads, and how
+ * many requests were dropped. */
+void
+GDKprefetchstatistics(int *threads, lng *requests, lng *loads, lng *dropped)
+{
+	MT_lock_set(&prefetch_lock);
+	*threads = prefetch_threads < 0 ? 0 : prefetch_threads;
+	*requests = prefetch_requests;
+	*loads = prefetch_loads;
+	*dropped = prefetch_dropped;
+	MT_lock_unset(&prefetch_lock);
+}
+
 /*
  * @- BATdelete
  * The new behavior is to let the routine produce warnings but always
@@ -869,6 +1346,8 @@ BATdelete(BAT *b)
 		HASHdestroy(b);
 		IMPSdestroy(b);
 		OIDXdestroy(b);
+		ZMdestroy(b);
+		CMPdestroy(b);
 	}
 	if (b->batCopiedtodisk || (b->theap.storage != STORE_MEM)) {
 		if (b->ttype != TYPE_void &&
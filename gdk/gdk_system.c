@@ -358,6 +358,31 @@ MT_kill_thread(MT_Id t)
 	return -1;
 }
 
+/* a single pointer of thread specific data, see MT_thread_setdata */
+static DWORD threaddata = TLS_OUT_OF_INDEXES;
+
+void
+MT_thread_init(void)
+{
+	if (threaddata == TLS_OUT_OF_INDEXES)
+		threaddata = TlsAlloc();
+}
+
+void *
+MT_thread_getdata(void)
+{
+	if (threaddata == TLS_OUT_OF_INDEXES)
+		return NULL;
+	return TlsGetValue(threaddata);
+}
+
+void
+MT_thread_setdata(void *data)
+{
+	if (threaddata != TLS_OUT_OF_INDEXES)
+		TlsSetValue(threaddata, data);
+}
+
 #ifdef USE_PTHREAD_LOCKS
 
 void
@@ -652,6 +677,33 @@ MT_kill_thread(MT_Id t)
 #endif
 }
 
+/* a single pointer of thread specific data, currently the memory
+ * arena of the thread (see GDKarenaset) */
+static pthread_key_t threaddata;
+static int threaddata_init = 0;
+
+void
+MT_thread_init(void)
+{
+	if (!threaddata_init && pthread_key_create(&threaddata, NULL) == 0)
+		threaddata_init = 1;
+}
+
+void *
+MT_thread_getdata(void)
+{
+	if (!threaddata_init)
+		return NULL;
+	return pthread_getspecific(threaddata);
+}
+
+void
+MT_thread_setdata(void *data)
+{
+	if (threaddata_init)
+		pthread_setspecific(threaddata, data);
+}
+
 #if defined(_AIX) || defined(__MACH__)
 void
 pthread_sema_init(pthread_sema_t *s, int flag, int nresources)
@@ -21,3 +21,9 @@ __hidden void MT_global_exit(int status)
 	__attribute__((__visibility__("hidden")));
 __hidden int MT_kill_thread(MT_Id t)
 	__attribute__((__visibility__("hidden")));
+__hidden void *MT_thread_getdata(void)
+	__attribute__((__visibility__("hidden")));
+__hidden void MT_thread_init(void)
+	__attribute__((__visibility__("hidden")));
+__hidden void MT_thread_setdata(void *data)
+	__attribute__((__visibility__("hidden")));
@@ -425,6 +425,50 @@ static MT_Lock mallocsuccesslock MT_LOCK_INITIALIZER("mallocsuccesslock");
 #endif
 #endif
 
+/*
+ * The time spent in each phase of the server startup (loading the
+ * BBP, replaying the write-ahead log, loading the MAL modules, loading
+ * the SQL catalog) is registered here, so that a slow restart can be
+ * attributed to a phase.  The phases are registered by the single
+ * thread that starts the server; afterwards the table is only read.
+ */
+#define STARTUP_MAXPHASES	16
+
+static const char *startup_phase[STARTUP_MAXPHASES];
+static lng startup_usec[STARTUP_MAXPHASES];
+static int startup_nphases;
+
+/* Register that the startup phase took usec microseconds.  A phase
+ * that is registered again (e.g. after a GDKreset) is overwritten.
+ * The name must be a string constant. */
+void
+GDKstartupphase(const char *phase, lng usec)
+{
+	int i;
+
+	PERFDEBUG fprintf(stderr, "#GDKstartupphase: %s "LLFMT" usec\n", phase, usec);
+	for (i = 0; i < startup_nphases; i++)
+		if (strcmp(startup_phase[i], phase) == 0)
+			break;
+	if (i == STARTUP_MAXPHASES)
+		return;
+	if (i == startup_nphases) {
+		startup_phase[i] = phase;
+		startup_nphases++;
+	}
+	startup_usec[i] = usec;
+}
+
+/* Return the number of registered startup phases, and their names
+ * and durations (in microseconds) in registration order. */
+int
+GDKstartupstatistics(const char *const **phases, const lng **usec)
+{
+	*phases = startup_phase;
+	*usec = startup_usec;
+	return startup_nphases;
+}
+
 int
 GDKinit(opt *set, int setlen)
 {
@@ -590,6 +634,11 @@ GDKinit(opt *set, int setlen)
 	GDKnr_threads = GDKgetenv_int("gdk_nr_threads", 0);
 	if (GDKnr_threads == 0)
 		GDKnr_threads = MT_check_nr_cores();
+	GDKnumainit();
+	HEAPadviseinit();
+	GDKarenainit();
+	BATprefetchinit();
+	GDKzinit();
 
 	if ((p = GDKgetenv("gdk_dbpath")) != NULL &&
 	    (p = strrchr(p, DIR_SEP)) != NULL) {
@@ -639,6 +688,37 @@ GDKinit(opt *set, int setlen)
 int GDKnr_threads = 0;
 static int GDKnrofthreads;
 
+/* Run func on each of the n argument structures (each of size
+ * argsize) in args.  The first is done by the calling thread, the
+ * others each in a thread of their own.  If a thread cannot be
+ * started, its work is done by the calling thread instead.  The
+ * function returns when all work is done.  Note that the worker
+ * threads are not registered with GDK, so func should not call
+ * GDKerror or anything that depends on thread-specific data. */
+void
+GDKparallel(void (*func)(void *), void *args, size_t argsize, int n)
+{
+	MT_Id *tids = NULL;
+	int i;
+
+	/* the bookkeeping is small, so don't bother GDKmalloc with it */
+	if (n > 1 && (tids = malloc(n * sizeof(MT_Id))) != NULL) {
+		for (i = 1; i < n; i++)
+			if (MT_create_thread(&tids[i], func,
+					     (char *) args + i * argsize,
+					     MT_THR_JOINABLE) < 0)
+				tids[i] = 0;
+	}
+	func(args);
+	for (i = 1; i < n; i++) {
+		if (tids && tids[i])
+			MT_join_thread(tids[i]);
+		else
+			func((char *) args + i * argsize);
+	}
+	free(tids);
+}
+
 int
 GDKexiting(void)
 {
@@ -1607,6 +1687,327 @@ GDKmalloc_internal(size_t size)
 	return s;
 }
 
+/* Per-query arenas
+ *
+ * Almost all intermediate results of a query are short lived: an
+ * operator allocates the heap of its result, the next operator reads
+ * it, and the MAL garbage collector frees it again, after which the
+ * next operator allocates a heap of about the same size.  Under a
+ * concurrent workload this traffic all goes through the system
+ * allocator.  Instead, the interpreter creates an arena for each
+ * query and makes it the arena of the threads that work on that query
+ * (GDKarenaset).  GDKarenamalloc rounds the size up to one of a number
+ * of size classes (four per power of two, from ARENA_MINSIZE up to
+ * ARENA_MAXSIZE) and takes a block of that class from the free list of
+ * the arena, or from malloc if the list is empty.  GDKfree recognizes
+ * an arena block by the ARENA_BLOCK bit in the size word and puts it
+ * back on the free list of its arena.  At the end of the query,
+ * GDKarenadestroy returns all blocks on the free lists to the system
+ * at once.  Blocks that are still in use at that time (e.g. results
+ * that outlive the query) stay valid; they are returned to the system
+ * when they are freed, and the last one frees the arena itself.
+ *
+ * Larger sizes are allocated with GDKmalloc, and heaps larger than
+ * that are usually memory mapped anyway (see HEAPalloc).
+ *
+ * An arena block has two more words in front of it than a normal
+ * block: the arena it belongs to and its size class.  The size word
+ * contains the size of the class plus MALLOC_EXTRA_SPACE, as for a
+ * normal block, so that the debug checks in GDKfree apply to both.
+ */
+
+#define ARENA_LOGMIN	6	/* smallest class: 64 bytes */
+#define ARENA_LOGMAX	24	/* largest class: 16 MiB */
+#define ARENA_MINSIZE	((size_t) 1 << ARENA_LOGMIN)
+#define ARENA_MAXSIZE	((size_t) 1 << ARENA_LOGMAX)
+#define ARENA_NCLASSES	((ARENA_LOGMAX - ARENA_LOGMIN) * 4 + 1)
+#define ARENA_EXTRA_SPACE	(MALLOC_EXTRA_SPACE + 2 * SIZEOF_VOID_P)
+#define ARENA_BLOCK	4	/* bit in size word: block of an arena */
+
+struct arena {
+	MT_Lock lock;
+	void *free[ARENA_NCLASSES]; /* free lists, linked through the
+				     * first word of the blocks */
+	size_t cached;		/* bytes on the free lists */
+	size_t nblocks;		/* blocks not returned to the system */
+	int destroyed;		/* query is done */
+};
+
+static int arena_enabled = 1;
+static volatile ATOMIC_TYPE arena_count;  /* arenas not destroyed */
+static volatile ATOMIC_TYPE arena_hits;	  /* allocations from a free list */
+static volatile ATOMIC_TYPE arena_misses; /* allocations from malloc */
+static volatile ATOMIC_TYPE arena_cached; /* bytes on all free lists */
+#ifdef ATOMIC_LOCK
+static MT_Lock arena_lock MT_LOCK_INITIALIZER("arena_lock");
+#endif
+
+void
+GDKarenainit(void)
+{
+	const char *p = GDKgetenv("gdk_arena");
+
+#ifdef NEED_MT_LOCK_INIT
+	ATOMIC_INIT(arena_lock);
+#endif
+	MT_thread_init();
+	arena_enabled = p == NULL || strcmp(p, "no") != 0;
+}
+
+static inline size_t
+arena_classsize(int c)
+{
+	int k;
+
+	if (c == 0)
+		return ARENA_MINSIZE;
+	k = ARENA_LOGMIN + (c - 1) / 4;
+	return ((size_t) 1 << k) + ((size_t) ((c - 1) % 4 + 1) << (k - 2));
+}
+
+/* the smallest class that can hold size bytes */
+static inline int
+arena_class(size_t size)
+{
+	int k;
+
+	if (size <= ARENA_MINSIZE)
+		return 0;
+	k = 63 - CMPclz((ulng) (size - 1));
+	return (k - ARENA_LOGMIN) * 4 + (int) (((size - 1) >> (k - 2)) & 3) + 1;
+}
+
+static void *
+arena_malloc(Arena *a, size_t size)
+{
+	int c = arena_class(size);
+	size_t csize = arena_classsize(c);
+	void *s;
+
+	assert(size != 0 && size <= ARENA_MAXSIZE);
+	MT_lock_set(&a->lock);
+	if ((s = a->free[c]) != NULL) {
+		a->free[c] = *(void **) s;
+		a->cached -= csize;
+	} else {
+		a->nblocks++;
+	}
+	MT_lock_unset(&a->lock);
+	if (s != NULL) {
+		(void) ATOMIC_SUB(arena_cached, (ATOMIC_TYPE) csize, arena_lock);
+		(void) ATOMIC_INC(arena_hits, arena_lock);
+	} else {
+		if (GDKvm_cursize() + csize >= GDK_vm_maxsize ||
+		    (s = malloc(csize + ARENA_EXTRA_SPACE + DEBUG_SPACE)) == NULL) {
+			MT_lock_set(&a->lock);
+			a->nblocks--;
+			MT_lock_unset(&a->lock);
+			GDKmemfail("GDKarenamalloc", size);
+			GDKerror("GDKarenamalloc: failed for " SZFMT " bytes", size);
+			return NULL;
+		}
+		s = (void *) ((char *) s + ARENA_EXTRA_SPACE);
+		heapinc(csize + ARENA_EXTRA_SPACE + DEBUG_SPACE);
+		((Arena **) s)[-4] = a;
+		((size_t *) s)[-3] = (size_t) c;
+		(void) ATOMIC_INC(arena_misses, arena_lock);
+	}
+	((size_t *) s)[-1] = (csize + MALLOC_EXTRA_SPACE + DEBUG_SPACE) | ARENA_BLOCK;
+	((size_t *) s)[-2] = size;
+#ifndef NDEBUG
+	/* write pattern to help find out-of-bounds writes */
+	memset((char *) s + size, '\xBD', csize + DEBUG_SPACE - size);
+#endif
+	return s;
+}
+
+/* called by GDKfree; asize is the size word without the ARENA_BLOCK
+ * bit */
+static void
+arena_free(void *s, size_t asize)
+{
+	Arena *a = ((Arena **) s)[-4];
+	int c = (int) ((size_t *) s)[-3];
+	size_t csize = arena_classsize(c);
+	int last;
+
+	assert(asize == csize + MALLOC_EXTRA_SPACE + DEBUG_SPACE);
+	MT_lock_set(&a->lock);
+	/* keep at most a sixteenth of the memory in a single arena */
+	if (!a->destroyed && a->cached + csize <= GDK_mem_maxsize / 16) {
+		*(void **) s = a->free[c];
+		a->free[c] = s;
+		a->cached += csize;
+		MT_lock_unset(&a->lock);
+		(void) ATOMIC_ADD(arena_cached, (ATOMIC_TYPE) csize, arena_lock);
+		return;
+	}
+	a->nblocks--;
+	last = a->destroyed && a->nblocks == 0;
+	MT_lock_unset(&a->lock);
+	free((char *) s - ARENA_EXTRA_SPACE);
+	heapdec((ssize_t) (asize - MALLOC_EXTRA_SPACE + ARENA_EXTRA_SPACE));
+	if (last) {
+		MT_lock_destroy(&a->lock);
+		GDKfree(a);
+	}
+}
+
+/* called by GDKrealloc: stay in the block if the new size fits its
+ * class, otherwise move to a block of the right class of the same
+ * arena */
+static void *
+arena_realloc(void *s, size_t size)
+{
+	int c = (int) ((size_t *) s)[-3];
+	size_t csize = arena_classsize(c);
+	size_t osize = ((size_t *) s)[-2];
+	void *p;
+
+	assert((((size_t *) s)[-1] & 2) == 0); /* check against duplicate free */
+	if (size <= csize && (c == 0 || size > arena_classsize(c - 1))) {
+		((size_t *) s)[-2] = size;
+#ifndef NDEBUG
+		/* if growing, initialize new memory with debug pattern,
+		 * and write pattern to help find out-of-bounds writes */
+		if (size > osize)
+			DEADBEEFCHK memset((char *) s + osize, '\xBD', size - osize);
+		memset((char *) s + size, '\xBD', csize + DEBUG_SPACE - size);
+#endif
+		return s;
+	}
+	if (size <= ARENA_MAXSIZE)
+		p = arena_malloc(((Arena **) s)[-4], size);
+	else
+		p = GDKmalloc_internal(size);
+	if (p == NULL)
+		return NULL;
+	memcpy(p, s, MIN(size, osize));
+#ifndef NDEBUG
+	if (size > osize)
+		DEADBEEFCHK memset((char *) p + osize, '\xBD', size - osize);
+#endif
+	GDKfree(s);
+	return p;
+}
+
+Arena *
+GDKarenacreate(void)
+{
+	Arena *a;
+
+	if (!arena_enabled)
+		return NULL;
+	if ((a = GDKzalloc(sizeof(Arena))) == NULL)
+		return NULL;
+	MT_lock_init(&a->lock, "arena");
+	(void) ATOMIC_INC(arena_count, arena_lock);
+	return a;
+}
+
+/* Return the free blocks of the arena to the system.  The arena
+ * itself is freed with its last block. */
+void
+GDKarenadestroy(Arena *a)
+{
+	int c, last;
+	void *s;
+	size_t cached;
+
+	if (a == NULL)
+		return;
+	MT_lock_set(&a->lock);
+	for (c = 0; c < ARENA_NCLASSES; c++) {
+		while ((s = a->free[c]) != NULL) {
+			a->free[c] = *(void **) s;
+			free((char *) s - ARENA_EXTRA_SPACE);
+			heapdec((ssize_t) (arena_classsize(c) + ARENA_EXTRA_SPACE + DEBUG_SPACE));
+			a->nblocks--;
+		}
+	}
+	cached = a->cached;
+	a->cached = 0;
+	a->destroyed = 1;
+	last = a->nblocks == 0;
+	MT_lock_unset(&a->lock);
+	(void) ATOMIC_SUB(arena_cached, (ATOMIC_TYPE) cached, arena_lock);
+	(void) ATOMIC_DEC(arena_count, arena_lock);
+	if (last) {
+		MT_lock_destroy(&a->lock);
+		GDKfree(a);
+	}
+}
+
+/* Make a the arena of the calling thread; returns the previous one. */
+Arena *
+GDKarenaset(Arena *a)
+{
+	Arena *o = MT_thread_getdata();
+
+	if (a != o)
+		MT_thread_setdata(a);
+	return o;
+}
+
+/* the number of bytes on the free lists of the arena, i.e. memory that
+ * can be reused without asking the system */
+size_t
+GDKarenacached(Arena *a)
+{
+	size_t cached;
+
+	if (a == NULL)
+		return 0;
+	MT_lock_set(&a->lock);
+	cached = a->cached;
+	MT_lock_unset(&a->lock);
+	return cached;
+}
+
+void *
+GDKarenamalloc(size_t size)
+{
+	Arena *a;
+	void *s;
+
+	if (size > ARENA_MAXSIZE || (a = MT_thread_getdata()) == NULL)
+		return GDKmalloc(size);
+	if ((s = arena_malloc(a, size)) == NULL)
+		return NULL;
+#ifndef NDEBUG
+	/* write a pattern to help make sure all data is properly
+	 * initialized by the caller */
+	DEADBEEFCHK memset(s, '\xBD', size);
+#endif
+	return s;
+}
+
+void *
+GDKarenazalloc(size_t size)
+{
+	Arena *a;
+	void *s;
+
+	if (size > ARENA_MAXSIZE || (a = MT_thread_getdata()) == NULL)
+		return GDKzalloc(size);
+	if ((s = arena_malloc(a, size)) == NULL)
+		return NULL;
+	memset(s, 0, size);
+	return s;
+}
+
+/* Report the number of arenas of running queries, the number of
+ * allocations that reused a block and that went to the system, and
+ * the number of bytes kept for reuse (in KiB). */
+void
+GDKarenastatistics(int *arenas, lng *hits, lng *misses, lng *cachedkb)
+{
+	*arenas = (int) ATOMIC_GET(arena_count, arena_lock);
+	*hits = (lng) ATOMIC_GET(arena_hits, arena_lock);
+	*misses = (lng) ATOMIC_GET(arena_misses, arena_lock);
+	*cachedkb = (lng) (ATOMIC_GET(arena_cached, arena_lock) >> 10);
+}
+
 #undef GDKmalloc
 void *
 GDKmalloc(size_t size)
@@ -1672,11 +2073,14 @@ void
 GDKfree(void *s)
 {
 	size_t asize;
+	int inarena;
 
 	if (s == NULL)
 		return;
 
 	asize = ((size_t *) s)[-1]; /* how much allocated last */
+	inarena = (asize & ARENA_BLOCK) != 0;
+	asize &= ~(size_t) ARENA_BLOCK;
 
 #ifndef NDEBUG
 	assert((asize & 2) == 0);   /* check against duplicate free */
@@ -1696,6 +2100,10 @@ GDKfree(void *s)
 	DEADBEEFCHK memset(s, '\xDB', asize - MALLOC_EXTRA_SPACE);
 #endif
 
+	if (inarena) {
+		arena_free(s, asize);
+		return;
+	}
 	free((char *) s - MALLOC_EXTRA_SPACE);
 	heapdec((ssize_t) asize);
 }
@@ -1717,6 +2125,8 @@ GDKrealloc(void *s, size_t size)
 
 	nsize = (size + 7) & ~7;
 	asize = ((size_t *) s)[-1]; /* how much allocated last */
+	if (asize & ARENA_BLOCK)
+		return arena_realloc(s, size);
 
 	if (nsize > asize &&
 	    GDKvm_cursize() + nsize - asize >= GDK_vm_maxsize) {
@@ -1828,6 +2238,56 @@ GDKstrndup(const char *s, size_t size)
 	return p;
 }
 
+void
+GDKarenainit(void)
+{
+}
+
+Arena *
+GDKarenacreate(void)
+{
+	return NULL;
+}
+
+void
+GDKarenadestroy(Arena *a)
+{
+	(void) a;
+}
+
+Arena *
+GDKarenaset(Arena *a)
+{
+	(void) a;
+	return NULL;
+}
+
+size_t
+GDKarenacached(Arena *a)
+{
+	(void) a;
+	return 0;
+}
+
+void *
+GDKarenamalloc(size_t size)
+{
+	return GDKmalloc(size);
+}
+
+void *
+GDKarenazalloc(size_t size)
+{
+	return GDKzalloc(size);
+}
+
+void
+GDKarenastatistics(int *arenas, lng *hits, lng *misses, lng *cachedkb)
+{
+	*arenas = 0;
+	*hits = *misses = *cachedkb = 0;
+}
+
 #endif	/* STATIC_CODE_ANALYSIS */
 
 void
@@ -85,6 +85,29 @@ gdk_export void GDKsetmallocsuccesscount(lng count);
  * takes care of this.
  */
 gdk_export int GDKnr_threads;
+
+/* NUMA nodes (real or emulated) over which heaps and worker threads
+ * are distributed, see gdk_numa.c */
+gdk_export int GDKnr_nodes;
+gdk_export int GDKnumabind(int node);
+gdk_export int BATnumanode(BAT *b);
+gdk_export void GDKnumastatistics(int *nodes, int *emulated, lng *placed);
+
+/* huge pages and access pattern advice for heaps, see gdk_heap.c */
+gdk_export void GDKheapstatistics(int *hugepages, lng *hugekb, lng *hugerss, lng *seqkb, lng *randomkb, lng *willneedkb);
+
+/* per-query memory arenas, see gdk_utils.c */
+gdk_export void GDKarenastatistics(int *arenas, lng *hits, lng *misses, lng *cachedkb);
+
+/* background loading of BATs, see BATprefetch in gdk_storage.c */
+gdk_export void GDKprefetchstatistics(int *threads, lng *requests, lng *loads, lng *dropped);
+
+/* compressed heap files, see GDKzsave in gdk_storage.c */
+gdk_export void GDKzstatistics(lng *savedkb, lng *writtenkb, lng *loads);
+
+/* time spent in the phases of the server startup, see gdk_utils.c */
+gdk_export void GDKstartupphase(const char *phase, lng usec);
+gdk_export int GDKstartupstatistics(const char *const **phases, const lng **usec);
 #ifndef HAVE_EMBEDDED
 __declspec(noreturn) gdk_export void GDKexit(int status)
 	__attribute__((__noreturn__));
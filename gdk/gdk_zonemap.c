@@ -0,0 +1,552 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Zone maps.
+ *
+ * A zone map records the smallest and largest non-nil value for each
+ * consecutive block of ZONEMAP_ROWS rows (a zone) of a column.  A
+ * select can skip all zones whose [min,max] interval cannot contain a
+ * qualifying value.  Unlike imprints, zone maps work for all linear
+ * types, including strings (for which the offsets into the string
+ * heap are stored) and types such as date and timestamp.
+ *
+ * Since a zone map only depends on the values in the zones it covers,
+ * appending to a column does not invalidate it: the zone map is simply
+ * extended with the new rows.  The header records how many rows are
+ * covered, so that a zone map that covers a prefix of the column is
+ * still usable.  Any other update destroys the zone map.
+ *
+ * The heap consists of a header of ZONEMAPOFF oids (version, number
+ * of rows covered, rows per zone, width of a value), followed by a
+ * (min,max) pair of values per zone.  For var-sized types, the values
+ * are heap offsets, with offset 0 meaning nil.  A zone consisting of
+ * only nils has nil as its minimum.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+#define ZONEMAP_VERSION		((oid) 1)
+#define ZONEMAPOFF		4
+
+#define ZMwidth(b)	(ATOMvarsized((b)->ttype) ? (int) sizeof(var_t) : ATOMsize(ATOMbasetype((b)->ttype)))
+#define ZMzones(n)	(((n) + ZONEMAP_ROWS - 1) / ZONEMAP_ROWS)
+#define ZMbytes(n, w)	(ZONEMAPOFF * SIZEOF_OID + ZMzones(n) * 2 * (size_t) (w))
+#define ZMvals(hp)	((hp)->base + ZONEMAPOFF * SIZEOF_OID)
+
+static int
+ZMusable(BAT *b)
+{
+	return b->ttype != TYPE_void &&
+		ATOMlinear(b->ttype) &&
+		ATOMnilptr(b->ttype) != NULL;
+}
+
+/* write a zone map heap to disk, setting the persisted flag only
+ * after the heap itself has been written; called with the hash lock
+ * held */
+static void
+ZMpersist(BAT *b, Heap *hp)
+{
+#ifdef PERSISTENTIDX
+	int fd;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	((oid *) hp->base)[0] = ZONEMAP_VERSION;
+	if (HEAPsave(hp, hp->filename, NULL, TRUE) != GDK_SUCCEED ||
+	    (fd = GDKfdlocate(hp->farmid, hp->filename, "rb+", NULL)) < 0) {
+		GDKclrerr();
+		return;
+	}
+	((oid *) hp->base)[0] |= (oid) 1 << 24;
+	if (write(fd, hp->base, SIZEOF_SIZE_T) < 0)
+		perror("write zonemap");
+	if (!(GDKdebug & FORCEMITOMASK)) {
+#if defined(NATIVE_WIN32)
+		_commit(fd);
+#elif defined(HAVE_FDATASYNC)
+		fdatasync(fd);
+#elif defined(HAVE_FSYNC)
+		fsync(fd);
+#endif
+	}
+	close(fd);
+	hp->dirty = FALSE;
+	ALGODEBUG fprintf(stderr, "#ZMpersist: persisting zonemap %d (" LLFMT " usec)\n", b->batCacheid, GDKusec() - t0);
+#else
+	(void) b;
+	(void) hp;
+#endif
+}
+
+/* compute the zones for rows [from,to) of b; if from is not at a
+ * zone boundary, the first zone already contains the minimum and
+ * maximum of the rows before from */
+#define ZMFILL(TYPE)							\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		TYPE *restrict zm = (TYPE *) ZMvals(hp);		\
+		const TYPE nil = TYPE##_nil;				\
+		for (z = from / ZONEMAP_ROWS; z < ZMzones(to); z++) {	\
+			BUN i = z * ZONEMAP_ROWS;			\
+			BUN e = MIN(i + ZONEMAP_ROWS, to);		\
+			TYPE mn = MAXVALUE##TYPE, mx = nil;		\
+			if (i < from) {					\
+				i = from;				\
+				if (zm[2 * z] != nil) {			\
+					mn = zm[2 * z];			\
+					mx = zm[2 * z + 1];		\
+				}					\
+			}						\
+			for (; i < e; i++) {				\
+				const TYPE v = vals[i];			\
+				/* nil is the smallest value */		\
+				if (v != nil && v < mn)			\
+					mn = v;				\
+				if (v > mx)				\
+					mx = v;				\
+			}						\
+			zm[2 * z] = mx == nil ? nil : mn;		\
+			zm[2 * z + 1] = mx;				\
+		}							\
+	} while (0)
+
+#define MAXVALUEbte	GDK_bte_max
+#define MAXVALUEsht	GDK_sht_max
+#define MAXVALUEint	GDK_int_max
+#define MAXVALUElng	GDK_lng_max
+#ifdef HAVE_HGE
+#define MAXVALUEhge	GDK_hge_max
+#endif
+#define MAXVALUEflt	GDK_flt_max
+#define MAXVALUEdbl	GDK_dbl_max
+
+static void
+ZMfill(BAT *b, Heap *hp, BUN from, BUN to)
+{
+	BUN z;
+
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		ZMFILL(bte);
+		break;
+	case TYPE_sht:
+		ZMFILL(sht);
+		break;
+	case TYPE_int:
+		ZMFILL(int);
+		break;
+	case TYPE_lng:
+		ZMFILL(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		ZMFILL(hge);
+		break;
+#endif
+	case TYPE_flt:
+		ZMFILL(flt);
+		break;
+	case TYPE_dbl:
+		ZMFILL(dbl);
+		break;
+	default: {
+		int (*cmp)(const void *, const void *) = ATOMcompare(ATOMbasetype(b->ttype));
+		const void *nil = ATOMnilptr(ATOMbasetype(b->ttype));
+		int varsized = b->tvarsized;
+		int width = ZMwidth(b);
+		char *zm = ZMvals(hp);
+		BATiter bi = bat_iterator(b);
+
+		for (z = from / ZONEMAP_ROWS; z < ZMzones(to); z++) {
+			BUN i = z * ZONEMAP_ROWS;
+			BUN e = MIN(i + ZONEMAP_ROWS, to);
+			BUN mn = BUN_NONE, mx = BUN_NONE;
+			const void *vmn = NULL, *vmx = NULL;
+			char *zmn = zm + 2 * z * width, *zmx = zmn + width;
+
+			if (i < from) {
+				i = from;
+				if (varsized ? *(var_t *) zmn != 0 : (*cmp)(zmn, nil) != 0) {
+					vmn = varsized ? Tbase(b) + *(var_t *) zmn : zmn;
+					vmx = varsized ? Tbase(b) + *(var_t *) zmx : zmx;
+				}
+			}
+			for (; i < e; i++) {
+				const void *v = BUNtail(bi, i);
+				if ((*cmp)(v, nil) == 0)
+					continue;
+				if (vmn == NULL || (*cmp)(v, vmn) < 0) {
+					vmn = v;
+					mn = i;
+				}
+				if (vmx == NULL || (*cmp)(v, vmx) > 0) {
+					vmx = v;
+					mx = i;
+				}
+			}
+			/* only write the zone when it changed, since vmn
+			 * and vmx may point into the zone itself */
+			if (vmn == NULL) {
+				if (varsized) {
+					*(var_t *) zmn = 0;
+					*(var_t *) zmx = 0;
+				} else {
+					memcpy(zmn, nil, width);
+					memcpy(zmx, nil, width);
+				}
+				continue;
+			}
+			if (mn != BUN_NONE) {
+				if (varsized)
+					*(var_t *) zmn = (var_t) BUNtvaroff(bi, mn);
+				else
+					memcpy(zmn, vmn, width);
+			}
+			if (mx != BUN_NONE) {
+				if (varsized)
+					*(var_t *) zmx = (var_t) BUNtvaroff(bi, mx);
+				else
+					memcpy(zmx, vmx, width);
+			}
+		}
+		break;
+	}
+	}
+}
+
+/* extend the zone map of b so that it covers all of b; called with
+ * the hash lock held */
+static gdk_return
+ZMextend(BAT *b, Heap *hp)
+{
+	BUN from = (BUN) ((oid *) hp->base)[1];
+	BUN to = BATcount(b);
+	size_t need;
+
+	if (from >= to)
+		return GDK_SUCCEED;
+	need = ZMbytes(to, ZMwidth(b));
+	if (need > hp->size &&
+	    HEAPextend(hp, MAX(need, hp->size + hp->size / 2), 0) != GDK_SUCCEED)
+		return GDK_FAIL;
+	hp->free = need;
+	ZMfill(b, hp, from, to);
+	((oid *) hp->base)[1] = (oid) to;
+	hp->dirty = TRUE;
+	return GDK_SUCCEED;
+}
+
+/* return TRUE if we have a zone map on the tail, even if we need to
+ * read one from disk */
+int
+BATcheckzonemap(BAT *b)
+{
+	int ret;
+
+	if (b == NULL)
+		return 0;
+	assert(b->batCacheid > 0);
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->tzonemap == (Heap *) 1) {
+		Heap *hp;
+		const char *nme = BBP_physical(b->batCacheid);
+		int fd;
+
+		b->tzonemap = NULL;
+		if ((hp = GDKzalloc(sizeof(*hp))) != NULL &&
+		    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, zonemapheap)) >= 0 &&
+		    (hp->filename = GDKmalloc(strlen(nme) + 10)) != NULL) {
+			sprintf(hp->filename, "%s.tzonemap", nme);
+
+			/* check whether a persisted zone map can be
+			 * found; it may cover fewer rows than the
+			 * column has, but not more */
+			if ((fd = GDKfdlocate(hp->farmid, nme, "rb+", "tzonemap")) >= 0) {
+				struct stat st;
+				oid hdata[ZONEMAPOFF];
+
+				if (read(fd, hdata, sizeof(hdata)) == sizeof(hdata) &&
+				    hdata[0] == (
+#ifdef PERSISTENTIDX
+					    ((oid) 1 << 24) |
+#endif
+					    ZONEMAP_VERSION) &&
+				    hdata[1] <= (oid) BATcount(b) &&
+				    hdata[2] == ZONEMAP_ROWS &&
+				    hdata[3] == (oid) ZMwidth(b) &&
+				    fstat(fd, &st) == 0 &&
+				    st.st_size >= (off_t) (hp->size = hp->free = ZMbytes(hdata[1], hdata[3])) &&
+				    HEAPload(hp, nme, "tzonemap", 0) == GDK_SUCCEED) {
+					close(fd);
+					b->tzonemap = hp;
+					ALGODEBUG fprintf(stderr, "#BATcheckzonemap: reusing persisted zonemap %d\n", b->batCacheid);
+					MT_lock_unset(&GDKhashLock(b->batCacheid));
+					return 1;
+				}
+				close(fd);
+				/* unlink unusable file */
+				GDKunlink(hp->farmid, BATDIR, nme, "tzonemap");
+			}
+			GDKfree(hp->filename);
+		}
+		GDKfree(hp);
+		GDKclrerr();	/* we're not currently interested in errors */
+	}
+	ret = b->tzonemap != NULL;
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	return ret;
+}
+
+/* create a zone map on the tail of b, or extend an existing one to
+ * cover all rows */
+gdk_return
+BATzonemap(BAT *b)
+{
+	Heap *hp;
+	const char *nme;
+	size_t nmelen;
+	int width;
+	lng t0 = 0;
+
+	BATcheck(b, "BATzonemap", GDK_FAIL);
+	if (!ZMusable(b)) {
+		GDKerror("BATzonemap: no zone maps on columns of type %s\n",
+			 ATOMname(b->ttype));
+		return GDK_FAIL;
+	}
+	if (VIEWtparent(b)) {
+		/* zone maps are maintained on the parent */
+		return BATzonemap(BBPdescriptor(VIEWtparent(b)));
+	}
+	ALGODEBUG t0 = GDKusec();
+	(void) BATcheckzonemap(b);
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->tzonemap) != NULL) {
+		if (ZMextend(b, hp) != GDK_SUCCEED) {
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			return GDK_FAIL;
+		}
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+		return GDK_SUCCEED;
+	}
+	nme = BBP_physical(b->batCacheid);
+	nmelen = strlen(nme) + 10;
+	width = ZMwidth(b);
+	if ((hp = GDKzalloc(sizeof(Heap))) == NULL ||
+	    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, zonemapheap)) < 0 ||
+	    (hp->filename = GDKmalloc(nmelen)) == NULL ||
+	    snprintf(hp->filename, nmelen, "%s.tzonemap", nme) < 0 ||
+	    HEAPalloc(hp, ZMbytes(BATcount(b), width), 1) != GDK_SUCCEED) {
+		if (hp)
+			GDKfree(hp->filename);
+		GDKfree(hp);
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+		return GDK_FAIL;
+	}
+	hp->free = ZMbytes(BATcount(b), width);
+	((oid *) hp->base)[0] = ZONEMAP_VERSION;
+	((oid *) hp->base)[1] = 0;
+	((oid *) hp->base)[2] = ZONEMAP_ROWS;
+	((oid *) hp->base)[3] = (oid) width;
+	ZMfill(b, hp, 0, BATcount(b));
+	((oid *) hp->base)[1] = (oid) BATcount(b);
+	hp->dirty = TRUE;
+	b->tzonemap = hp;
+	b->batDirtydesc = TRUE;
+	if ((BBP_status(b->batCacheid) & BBPEXISTING) &&
+	    b->batInserted == b->batCount)
+		ZMpersist(b, hp);
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	ALGODEBUG fprintf(stderr, "#BATzonemap(%d): " BUNFMT " zones (" LLFMT " usec)\n", b->batCacheid, ZMzones(BATcount(b)), GDKusec() - t0);
+	return GDK_SUCCEED;
+}
+
+/* Return the positions of b (clipped to [p,q)) that lie in zones that
+ * may contain values satisfying the select predicate, as a list of
+ * *nruns half-open intervals.  The arguments are as for
+ * BAT_scanselect.  Returns NULL if no zone map could be used. */
+BUN *
+ZMselect(BAT *b, const void *tl, const void *th, int li, int hi,
+	 int equi, int anti, int lval, int hval, BUN p, BUN q, BUN *nruns)
+{
+	BAT *pb = b;
+	Heap *hp;
+	BUN pr_off = 0, z, zlo, zhi, n = 0, nhit = 0, *runs;
+	int t = ATOMbasetype(b->ttype);
+	int (*cmp)(const void *, const void *) = ATOMcompare(t);
+	const void *nil = ATOMnilptr(t);
+	int varsized = b->tvarsized, width, hit;
+	const char *zm;
+	const char *vbase = varsized ? Tbase(b) : NULL;
+
+	assert(p < q);
+	if (VIEWtparent(b)) {
+		pb = BBPdescriptor(VIEWtparent(b));
+		pr_off = (BUN) ((Tloc(b, 0) - Tloc(pb, 0)) >> b->tshift);
+	}
+	if (BATzonemap(pb) != GDK_SUCCEED) {
+		GDKclrerr();	/* not interested in BATzonemap errors */
+		return NULL;
+	}
+	width = ZMwidth(pb);
+	zlo = (p + pr_off) / ZONEMAP_ROWS;
+	zhi = (q - 1 + pr_off) / ZONEMAP_ROWS;
+	if ((runs = GDKmalloc(2 * (zhi - zlo + 2) * sizeof(BUN))) == NULL) {
+		GDKclrerr();
+		return NULL;
+	}
+	MT_lock_set(&GDKhashLock(pb->batCacheid));
+	if ((hp = pb->tzonemap) == NULL || hp == (Heap *) 1 ||
+	    ((oid *) hp->base)[1] < (oid) (q + pr_off)) {
+		/* zone map disappeared or is out of date */
+		MT_lock_unset(&GDKhashLock(pb->batCacheid));
+		GDKfree(runs);
+		return NULL;
+	}
+	zm = ZMvals(hp);
+	for (z = zlo; z <= zhi; z++) {
+		const void *mn = zm + 2 * z * width;
+		const void *mx = zm + (2 * z + 1) * width;
+		int c;
+
+		if (varsized ? *(const var_t *) mn == 0 : (*cmp)(mn, nil) == 0) {
+			/* only nils in this zone */
+			hit = 0;
+		} else {
+			if (varsized) {
+				mn = vbase + *(const var_t *) mn;
+				mx = vbase + *(const var_t *) mx;
+			}
+			if (equi)
+				hit = (*cmp)(tl, mn) >= 0 && (*cmp)(tl, mx) <= 0;
+			else if (anti)
+				hit = (lval &&
+				       ((c = (*cmp)(mn, tl)) < 0 || (!li && c == 0))) ||
+					(hval &&
+					 ((c = (*cmp)(mx, th)) > 0 || (!hi && c == 0)));
+			else
+				hit = (!lval ||
+				       (c = (*cmp)(mx, tl)) > 0 || (li && c == 0)) &&
+					(!hval ||
+					 (c = (*cmp)(mn, th)) < 0 || (hi && c == 0));
+		}
+		if (hit) {
+			BUN s = z * ZONEMAP_ROWS - pr_off;
+
+			nhit++;
+			BUN e = s + ZONEMAP_ROWS;
+
+			if (z == zlo)
+				s = p;
+			if (e > q)
+				e = q;
+			if (n > 0 && runs[2 * n - 1] == s)
+				runs[2 * n - 1] = e;
+			else {
+				runs[2 * n] = s;
+				runs[2 * n + 1] = e;
+				n++;
+			}
+		}
+	}
+	MT_lock_unset(&GDKhashLock(pb->batCacheid));
+	ALGODEBUG fprintf(stderr, "#BATselect(b=%s#" BUNFMT "): zonemap: "
+			  BUNFMT " runs, skipping " BUNFMT " zones out of "
+			  BUNFMT "\n", BATgetId(b), BATcount(b), n,
+			  zhi - zlo + 1 - nhit, zhi - zlo + 1);
+	*nruns = n;
+	return runs;
+}
+
+/* extend a zone map that is in memory after rows were appended */
+void
+ZMappend(BAT *b)
+{
+	Heap *hp;
+
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1 &&
+	    ZMextend(b, hp) != GDK_SUCCEED) {
+		b->tzonemap = NULL;
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+		HEAPdelete(hp, BBP_physical(b->batCacheid), "tzonemap");
+		GDKfree(hp);
+		GDKclrerr();
+		return;
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+}
+
+/* write a zone map that was extended since it was last saved */
+void
+ZMsave(BAT *b)
+{
+	Heap *hp;
+
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1 && hp->dirty &&
+	    b->batPersistence == PERSISTENT)
+		ZMpersist(b, hp);
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+}
+
+lng
+ZMzonemapsize(BAT *b)
+{
+	lng sz = 0;
+
+	if (b && BATcheckzonemap(b)) {
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		if (b->tzonemap && b->tzonemap != (Heap *) 1)
+			sz = (lng) b->tzonemap->free;
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+	}
+	return sz;
+}
+
+void
+ZMfree(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1) {
+			b->tzonemap = (Heap *) 1;
+			HEAPfree(hp, 0);
+			GDKfree(hp);
+		}
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+	}
+}
+
+void
+ZMdestroy(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		hp = b->tzonemap;
+		b->tzonemap = NULL;
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+		if (hp == (Heap *) 1) {
+			GDKunlink(BBPselectfarm(b->batRole, b->ttype, zonemapheap),
+				  BATDIR,
+				  BBP_physical(b->batCacheid),
+				  "tzonemap");
+		} else if (hp != NULL) {
+			HEAPdelete(hp, BBP_physical(b->batCacheid), "tzonemap");
+			GDKfree(hp);
+		}
+	}
+}
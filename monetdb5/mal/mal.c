@@ -81,7 +81,27 @@ void tstAligned(void)
 	    GDKfatal("Recompile with STRUCT_ALIGNED flag disabled\n");
 #endif
 }
+
+/* The time registered for the startup phases so far.  The modules
+ * initialise themselves while they are loaded (e.g. the SQL module
+ * loads its catalog), and those phases are not counted twice. */
+static lng
+startupTime(void)
+{
+	const char *const *phases;
+	const lng *usec;
+	int i, n;
+	lng t = 0;
+
+	n = GDKstartupstatistics(&phases, &usec);
+	for (i = 0; i < n; i++)
+		t += usec[i];
+	return t;
+}
+
 int mal_init(void){
+	lng t0, s0;
+
 #ifdef NEED_MT_LOCK_INIT
 	MT_lock_init( &mal_contextLock, "mal_contextLock");
 	MT_lock_init( &mal_namespaceLock, "mal_namespaceLock");
@@ -106,7 +126,10 @@ int mal_init(void){
 	initHeartbeat();
 #endif
 	initResource();
+	t0 = GDKusec();
+	s0 = startupTime();
 	malBootstrap();
+	GDKstartupphase("mal", GDKusec() - t0 - (startupTime() - s0));
 	initProfiler();
 	return 0;
 }
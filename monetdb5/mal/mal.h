@@ -240,6 +240,7 @@ typedef struct MALSTK {
 	short keepAlive;	/* do not garbage collect when set */
 	short garbageCollect; /* stack needs garbage collection */
 	lng tmpspace;		/* amount of temporary space produced */
+	Arena *arena;		/* memory for the intermediates of the query */
 	/*
 	 * Parallel processing is mostly driven by dataflow, but within this context
 	 * there may be different schemes to take instructions into execution.
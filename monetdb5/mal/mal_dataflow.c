@@ -48,6 +48,7 @@ typedef struct FLOWEVENT {
 	lng hotclaim;   /* memory foot print of result variables */
 	lng argclaim;   /* memory foot print of arguments */
 	lng maxclaim;   /* memory foot print of  largest argument, counld be used to indicate result size */
+	int node;       /* NUMA node holding the arguments, or -1 */
 } *FlowEvent, FlowEventRec;
 
 typedef struct queue {
@@ -79,6 +80,7 @@ typedef struct DATAFLOW {
 
 static struct worker {
 	MT_Id id;
+	int node;					/* NUMA node the worker runs on */
 	enum {IDLE, RUNNING, JOINING, EXITED} flag;
 	Client cntxt;				/* client we do work for (NULL -> any) */
 	MT_Sema s;
@@ -86,6 +88,11 @@ static struct worker {
 
 static Queue *todo = 0;	/* pending instructions */
 
+/* how often a worker took an instruction whose arguments are on its
+ * own NUMA node, on another node, or on no particular node (protected
+ * by the lock of todo) */
+static lng numalocal, numaremote, numaany;
+
 #ifdef ATOMIC_LOCK
 static MT_Lock exitingLock MT_LOCK_INITIALIZER("exitingLock");
 #endif
@@ -105,6 +112,7 @@ mal_dataflow_reset(void)
 	}
 	todo = 0;	/* pending instructions */
 	exiting = 0;
+	numalocal = numaremote = numaany = 0;
 }
 
 /*
@@ -220,11 +228,26 @@ q_requeue(Queue *q, FlowEvent d)
 }
 #endif
 
+/* keep track of the NUMA node of the work taken by a worker of the
+ * given node (called with the lock of todo held) */
+static inline void
+q_numacount(FlowEvent r, int node)
+{
+	if (r == NULL || node < 0)
+		return;
+	if (r->node < 0)
+		numaany++;
+	else if (r->node == node)
+		numalocal++;
+	else
+		numaremote++;
+}
+
 static FlowEvent
-q_dequeue(Queue *q, Client cntxt)
+q_dequeue(Queue *q, Client cntxt, int node)
 {
 	FlowEvent r = NULL, s = NULL;
-	//int i;
+	int i;
 
 	assert(q);
 	MT_sema_down(&q->s);
@@ -232,7 +255,7 @@ q_dequeue(Queue *q, Client cntxt)
 		return NULL;
 	MT_lock_set(&q->l);
 	if (cntxt) {
-		int i, minpc = -1;
+		int minpc = -1;
 
 		for (i = q->last - 1; i >= 0; i--) {
 			if (q->data[i]->flow->cntxt == cntxt) {
@@ -256,6 +279,7 @@ q_dequeue(Queue *q, Client cntxt)
 				i++;
 			}
 		} else r = NULL;
+		q_numacount(r, node);
 
 		MT_lock_unset(&q->l);
 		return r;
@@ -267,8 +291,26 @@ q_dequeue(Queue *q, Client cntxt)
 	}
 	assert(q->last > 0);
 	if (q->last > 0) {
-		/* LIFO favors garbage collection */
-		r = q->data[--q->last];
+		/* LIFO favors garbage collection, but skip work whose
+		 * arguments live on another NUMA node, unless there is
+		 * nothing else to do */
+		i = q->last - 1;
+		if (node >= 0) {
+			int j;
+
+			for (j = i; j >= 0; j--)
+				if (q->data[j]->node < 0 || q->data[j]->node == node) {
+					i = j;
+					break;
+				}
+		}
+		r = q->data[i];
+		q_numacount(r, node);
+		q->last--;
+		while (i < q->last) {
+			q->data[i] = q->data[i + 1];
+			i++;
+		}
 /*  Line coverage test shows it is an expensive loop that is hardly ever leads to adjustment
 		for(i= q->last-1; r &&  i>=0; i--){
 			s= q->data[i];
@@ -299,6 +341,36 @@ q_dequeue(Queue *q, Client cntxt)
 	return r;
 }
 
+/*
+ * An instruction preferably runs on the NUMA node that holds its
+ * arguments.  That is only known for slices of large persistent
+ * columns, i.e. the work produced by mitosis (see gdk_numa.c).
+ */
+static int
+DFLOWnode(DataFlow flow, FlowEvent fe)
+{
+	InstrPtr p = getInstrPtr(flow->mb, fe->pc);
+	BAT *b;
+	bat bid;
+	int i, node;
+
+	if (GDKnr_nodes <= 1)
+		return -1;
+	for (i = p->retc; i < p->argc; i++) {
+		/* only look at BATs that are in memory already */
+		if (flow->stk->stk[getArg(p, i)].vtype != TYPE_bat ||
+		    (bid = flow->stk->stk[getArg(p, i)].val.bval) <= 0 ||
+		    BBP_cache(bid) == NULL ||
+		    (b = BATcdescriptor(bid)) == NULL)
+			continue;
+		node = BATnumanode(b);
+		BBPunfix(bid);
+		if (node >= 0)
+			return node;
+	}
+	return -1;
+}
+
 /*
  * We simply move an instruction into the front of the queue.
  * Beware, we assume that variables are assigned a value once, otherwise
@@ -329,6 +401,9 @@ DFLOWworker(void *T)
 	int i,last;
 	Client cntxt;
 	InstrPtr p;
+#ifdef USE_MAL_ADMISSION
+	lng hotclaim, cached;
+#endif
 
 	thr = THRnew("DFLOWworker");
 
@@ -343,6 +418,11 @@ DFLOWworker(void *T)
 	MT_lock_set(&dataflowLock);
 	cntxt = t->cntxt;
 	MT_lock_unset(&dataflowLock);
+	/* stay on the CPUs of one NUMA node, so that the memory we
+	 * touch first is local */
+	t->node = id % GDKnr_nodes;
+	if (GDKnr_nodes > 1 && GDKnumabind(t->node) < 0)
+		PARDEBUG fprintf(stderr, "#DFLOWworker %d: could not bind to node %d\n", id, t->node);
 	if (cntxt) {
 		/* wait until we are allowed to start working */
 		MT_sema_down(&t->s);
@@ -352,7 +432,7 @@ DFLOWworker(void *T)
 			MT_lock_set(&dataflowLock);
 			cntxt = t->cntxt;
 			MT_lock_unset(&dataflowLock);
-			fe = q_dequeue(todo, cntxt);
+			fe = q_dequeue(todo, cntxt, GDKnr_nodes > 1 ? t->node : -1);
 			if (fe == NULL) {
 				if (cntxt) {
 					/* we're not done yet with work for the current
@@ -387,7 +467,12 @@ DFLOWworker(void *T)
 		MT_lock_unset(&flow->flowlock);
 
 #ifdef USE_MAL_ADMISSION
-		if (MALrunningThreads() > 2 && MALadmission(fe->argclaim, fe->hotclaim)) {
+		/* the part of the result that can be carved from memory
+		 * the arena of the query already holds is not claimed */
+		hotclaim = fe->hotclaim;
+		cached = (lng) GDKarenacached(flow->stk->arena);
+		hotclaim -= MIN(hotclaim, cached);
+		if (MALrunningThreads() > 2 && MALadmission(fe->argclaim, hotclaim)) {
 			// never block on deblockdataflow()
 			p= getInstrPtr(flow->mb,fe->pc);
 			if( p->fcn != (MALfcn) deblockdataflow){
@@ -400,12 +485,14 @@ DFLOWworker(void *T)
 			}
 		}
 #endif
+		GDKarenaset(flow->stk->arena);
 		error = runMALsequence(flow->cntxt, flow->mb, fe->pc, fe->pc + 1, flow->stk, 0, 0);
+		GDKarenaset(NULL);
 		PARDEBUG fprintf(stderr, "#executed pc= %d wrk= %d claim= " LLFMT "," LLFMT "," LLFMT " %s\n",
 						 fe->pc, id, fe->argclaim, fe->hotclaim, fe->maxclaim, error ? error : "");
 #ifdef USE_MAL_ADMISSION
 		/* release the memory claim */
-		MALadmission(-fe->argclaim, -fe->hotclaim);
+		MALadmission(-fe->argclaim, -hotclaim);
 #endif
 		/* update the numa information. keep the thread-id producing the value */
 		p= getInstrPtr(flow->mb,fe->pc);
@@ -465,6 +552,12 @@ DFLOWworker(void *T)
 				break;
 			}
 		MT_lock_unset(&flow->flowlock);
+		/* leave work on data of another NUMA node to its workers */
+		if (fnxt && (fnxt->node = DFLOWnode(flow, fnxt)) >= 0 &&
+			fnxt->node != t->node) {
+			q_enqueue(todo, fnxt);
+			fnxt = 0;
+		}
 
 		q_enqueue(flow->done, fe);
 		if ( fnxt == 0 && malProfileMode) {
@@ -570,6 +663,7 @@ DFLOWinitBlk(DataFlow flow, MalBlkPtr mb, int size)
 		flow->status[n].pc = pc;
 		flow->status[n].state = DFLOWpending;
 		flow->status[n].cost = -1;
+		flow->status[n].node = -1;
 		flow->status[n].flow->error = NULL;
 
 		/* administer flow dependencies */
@@ -739,6 +833,7 @@ DFLOWscheduler(DataFlow flow, struct worker *w)
 			for (j = p->retc; j < p->argc; j++)
 				fe[i].argclaim = getMemoryClaim(fe[0].flow->mb, fe[0].flow->stk, p, j, FALSE);
 #endif
+			fe[i].node = DFLOWnode(flow, fe + i);
 			q_enqueue(todo, flow->status + i);
 			flow->status[i].state = DFLOWrunning;
 			PARDEBUG fprintf(stderr, "#enqueue pc=%d claim=" LLFMT "\n", flow->status[i].pc, flow->status[i].argclaim);
@@ -749,7 +844,7 @@ DFLOWscheduler(DataFlow flow, struct worker *w)
 	PARDEBUG fprintf(stderr, "#run %d instructions in dataflow block\n", actions);
 
 	while (actions != tasks ) {
-		f = q_dequeue(flow->done, NULL);
+		f = q_dequeue(flow->done, NULL, -1);
 		if (ATOMIC_GET(exiting, exitingLock))
 			break;
 		if (f == NULL)
@@ -769,6 +864,7 @@ DFLOWscheduler(DataFlow flow, struct worker *w)
 				if (flow->status[i].blocks == 1 ) {
 					flow->status[i].state = DFLOWrunning;
 					flow->status[i].blocks--;
+					flow->status[i].node = DFLOWnode(flow, flow->status + i);
 					q_enqueue(todo, flow->status + i);
 					PARDEBUG fprintf(stderr, "#enqueue pc=%d claim= " LLFMT "\n", flow->status[i].pc, flow->status[i].argclaim);
 				} else {
@@ -970,6 +1066,21 @@ runMALdataflow(Client cntxt, MalBlkPtr mb, int startpc, int stoppc, MalStkPtr st
 	return msg;
 }
 
+/*
+ * Report how often the workers found work on their own NUMA node.
+ */
+void
+DFLOWnumaStatistics(lng *local, lng *remote, lng *any)
+{
+	if (todo)
+		MT_lock_set(&todo->l);
+	*local = numalocal;
+	*remote = numaremote;
+	*any = numaany;
+	if (todo)
+		MT_lock_unset(&todo->l);
+}
+
 str
 deblockdataflow( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -14,5 +14,6 @@
 
 mal_export str runMALdataflow(Client cntxt, MalBlkPtr mb, int startpc, int stoppc, MalStkPtr stk);
 mal_export str deblockdataflow(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+mal_export void DFLOWnumaStatistics(lng *local, lng *remote, lng *any);
 
 #endif /*  _MAL_DATAFLOW_H*/
@@ -289,6 +289,7 @@ str runMAL(Client cntxt, MalBlkPtr mb, MalBlkPtr mbcaller, MalStkPtr env)
 	int i;
 	ValPtr lhs, rhs;
 	str ret;
+	Arena *arena = NULL, *oarena;
 	(void) mbcaller;
 
 	/* Prepare a new interpreter call. This involves two steps, (1)
@@ -338,6 +339,11 @@ str runMAL(Client cntxt, MalBlkPtr mb, MalBlkPtr mbcaller, MalStkPtr env)
 	}
 	if (stk->cmd && env && stk->cmd != 'f')
 		stk->cmd = env->cmd;
+	/* the intermediates of the query are allocated from its own
+	 * arena, unless we run inside a query that already has one */
+	if (stk->arena == NULL)
+		stk->arena = arena = GDKarenacreate();
+	oarena = GDKarenaset(stk->arena);
 	ret = runMALsequence(cntxt, mb, 1, 0, stk, env, 0);
 
 	/* pass the new debug mode to the caller */
@@ -345,6 +351,11 @@ str runMAL(Client cntxt, MalBlkPtr mb, MalBlkPtr mbcaller, MalStkPtr env)
 		env->cmd = stk->cmd;
 	if (!stk->keepAlive && garbageControl(getInstrPtr(mb, 0)))
 		garbageCollector(cntxt, mb, stk, env != stk);
+	GDKarenaset(oarena);
+	if (arena) {
+		stk->arena = NULL;
+		GDKarenadestroy(arena);
+	}
 	if (stk && stk != env)
 		freeStack(stk);
 	if (cntxt->qtimeout && GDKusec()- mb->starttime > cntxt->qtimeout)
@@ -393,6 +404,7 @@ callMAL(Client cntxt, MalBlkPtr mb, MalStkPtr *env, ValPtr argv[], char debug)
 	int i;
 	ValPtr lhs;
 	InstrPtr pci = getInstrPtr(mb, 0);
+	Arena *arena = NULL, *oarena = NULL;
 
 	cntxt->lastcmd= time(0);
 #ifdef DEBUG_CALLMAL
@@ -426,6 +438,9 @@ callMAL(Client cntxt, MalBlkPtr mb, MalStkPtr *env, ValPtr argv[], char debug)
 				BBPretain(lhs->val.bval);
 		}
 		stk->cmd = debug;
+		if (stk->arena == NULL)
+			stk->arena = arena = GDKarenacreate();
+		oarena = GDKarenaset(stk->arena);
 		ret = runMALsequence(cntxt, mb, 1, 0, stk, 0, 0);
 		break;
 	case FACTORYsymbol:
@@ -438,9 +453,15 @@ callMAL(Client cntxt, MalBlkPtr mb, MalStkPtr *env, ValPtr argv[], char debug)
 		throw(MAL, "mal.interpreter", RUNTIME_UNKNOWN_INSTRUCTION);
 	}
 	if ( ret == MAL_SUCCEED && cntxt->qtimeout && GDKusec()- mb->starttime > cntxt->qtimeout)
-		throw(MAL, "mal.interpreter", RUNTIME_QRY_TIMEOUT);
-	if (stk) 
+		ret = createException(MAL, "mal.interpreter", RUNTIME_QRY_TIMEOUT);
+	if (stk) {
 		garbageCollector(cntxt, mb, stk, TRUE);
+		GDKarenaset(oarena);
+		if (arena) {
+			stk->arena = NULL;
+			GDKarenadestroy(arena);
+		}
+	}
 	return ret;
 }
 
@@ -720,6 +741,7 @@ str runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 				nstk->stkdepth = nstk->stksize + stk->stkdepth;
 				nstk->calldepth = stk->calldepth + 1;
 				nstk->up = stk;
+				nstk->arena = stk->arena;
 				if (nstk->calldepth > 256) {
 					ret= createException(MAL, "mal.interpreter", MAL_CALLDEPTH_FAIL);
 					GDKfree(nstk);
@@ -815,7 +837,7 @@ str runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 								ret = createException(MAL, "mal.propertyCheck", RUNTIME_OBJECT_MISSING);
 							continue;
 						}
-						b = BATdescriptor(stk->stk[getArg(pci, i)].val.bval);
+						b = BATcdescriptor(stk->stk[getArg(pci, i)].val.bval);
 						if (b) {
 							BATassertProps(b);
 							BBPunfix(b->batCacheid);
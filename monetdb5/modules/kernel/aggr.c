@@ -988,3 +988,126 @@ AGGRsubquantilecand(bat *retval, const bat *bid, const bat *quantile, const bat
 							 0, TYPE_any, NULL, NULL, BATgroupquantile,
 							 quantile, "aggr.subquantile");
 }
+
+/* approximate aggregates, calculated from mergeable sketches */
+mal_export str AGGRapprox_count_distinct(bat *retval, const bat *bid, const bit *skip_nils);
+str
+AGGRapprox_count_distinct(bat *retval, const bat *bid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+						  0, TYPE_lng, BATgroupapproxcountdistinct, NULL,
+						  "aggr.subapprox_count_distinct");
+}
+
+mal_export str AGGRsubapprox_count_distinct(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubapprox_count_distinct(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+						  0, TYPE_lng, BATgroupapproxcountdistinct, NULL,
+						  "aggr.subapprox_count_distinct");
+}
+
+mal_export str AGGRsubapprox_count_distinctcand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+str
+AGGRsubapprox_count_distinctcand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, gid, eid, sid, *skip_nils,
+						  0, TYPE_lng, BATgroupapproxcountdistinct, NULL,
+						  "aggr.subapprox_count_distinct");
+}
+
+mal_export str AGGRhll(bat *retval, const bat *bid, const bit *skip_nils);
+str
+AGGRhll(bat *retval, const bat *bid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+						  0, TYPE_str, BATgrouphll, NULL, "aggr.subhll");
+}
+
+mal_export str AGGRsubhll(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubhll(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+						  0, TYPE_str, BATgrouphll, NULL, "aggr.subhll");
+}
+
+mal_export str AGGRhllcount(bat *retval, const bat *bid, const bit *skip_nils);
+str
+AGGRhllcount(bat *retval, const bat *bid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+						  0, TYPE_lng, BATgrouphllcount, NULL,
+						  "aggr.subhllcount");
+}
+
+mal_export str AGGRsubhllcount(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubhllcount(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+						  0, TYPE_lng, BATgrouphllcount, NULL,
+						  "aggr.subhllcount");
+}
+
+mal_export str AGGRapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bit *skip_nils);
+str
+AGGRapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bit *skip_nils)
+{
+	return AGGRsubgroupedExt(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+							 0, TYPE_dbl, NULL, NULL, BATgroupapproxquantile,
+							 quantile, "aggr.subapprox_quantile");
+}
+
+mal_export str AGGRsubapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRsubgroupedExt(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+							 0, TYPE_dbl, NULL, NULL, BATgroupapproxquantile,
+							 quantile, "aggr.subapprox_quantile");
+}
+
+mal_export str AGGRsubapprox_quantilecand(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+str
+AGGRsubapprox_quantilecand(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	return AGGRsubgroupedExt(retval, NULL, bid, gid, eid, sid, *skip_nils,
+							 0, TYPE_dbl, NULL, NULL, BATgroupapproxquantile,
+							 quantile, "aggr.subapprox_quantile");
+}
+
+mal_export str AGGRtdigest(bat *retval, const bat *bid, const bit *skip_nils);
+str
+AGGRtdigest(bat *retval, const bat *bid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+						  0, TYPE_str, BATgrouptdigest, NULL, "aggr.subtdigest");
+}
+
+mal_export str AGGRsubtdigest(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubtdigest(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRsubgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+						  0, TYPE_str, BATgrouptdigest, NULL, "aggr.subtdigest");
+}
+
+mal_export str AGGRtdigestquantile(bat *retval, const bat *bid, const bat *quantile, const bit *skip_nils);
+str
+AGGRtdigestquantile(bat *retval, const bat *bid, const bat *quantile, const bit *skip_nils)
+{
+	return AGGRsubgroupedExt(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+							 0, TYPE_dbl, NULL, NULL, BATgrouptdigestquantile,
+							 quantile, "aggr.subtdigestquantile");
+}
+
+mal_export str AGGRsubtdigestquantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubtdigestquantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRsubgroupedExt(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+							 0, TYPE_dbl, NULL, NULL, BATgrouptdigestquantile,
+							 quantile, "aggr.subtdigestquantile");
+}
@@ -258,4 +258,90 @@ command subquantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],s:bat[:o
 address AGGRsubquantilecand
 comment "Grouped median quantile with candidate list";
 
+function approx_count_distinct(b:bat[:any_1]) :lng;
+	bn := subapprox_count_distinct(b, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.approx_count_distinct;
+
+command subapprox_count_distinct(b:bat[:any_1],skip_nils:bit) :bat[:lng]
+address AGGRapprox_count_distinct
+comment "Approximate number of distinct values (HyperLogLog)";
+
+command subapprox_count_distinct(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:lng]
+address AGGRsubapprox_count_distinct
+comment "Grouped approximate number of distinct values (HyperLogLog)";
+
+command subapprox_count_distinct(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],s:bat[:oid],skip_nils:bit) :bat[:lng]
+address AGGRsubapprox_count_distinctcand
+comment "Grouped approximate number of distinct values (HyperLogLog) with candidate list";
+
+function hll(b:bat[:any_1]) :str;
+	bn := subhll(b, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.hll;
+
+command subhll(b:bat[:any_1],skip_nils:bit) :bat[:str]
+address AGGRhll
+comment "HyperLogLog sketch of the values, to be merged with hllcount";
+
+command subhll(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:str]
+address AGGRsubhll
+comment "Grouped HyperLogLog sketches of the values, to be merged with subhllcount";
+
+command subhllcount(b:bat[:str],skip_nils:bit) :bat[:lng]
+address AGGRhllcount
+comment "Approximate number of distinct values from merging HyperLogLog sketches";
+
+command subhllcount(b:bat[:str],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:lng]
+address AGGRsubhllcount
+comment "Grouped approximate number of distinct values from merging HyperLogLog sketches";
+
+function hllcount(b:bat[:str]) :lng;
+	bn := subhllcount(b, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.hllcount;
+
+function approx_quantile(b:bat[:any_1],q:bat[:dbl]) :dbl;
+	bn := subapprox_quantile(b, q, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.approx_quantile;
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],skip_nils:bit) :bat[:dbl]
+address AGGRapprox_quantile
+comment "Approximate quantile (t-digest)";
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:dbl]
+address AGGRsubapprox_quantile
+comment "Grouped approximate quantile (t-digest)";
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],s:bat[:oid],skip_nils:bit) :bat[:dbl]
+address AGGRsubapprox_quantilecand
+comment "Grouped approximate quantile (t-digest) with candidate list";
+
+function tdigest(b:bat[:any_1]) :str;
+	bn := subtdigest(b, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.tdigest;
+
+command subtdigest(b:bat[:any_1],skip_nils:bit) :bat[:str]
+address AGGRtdigest
+comment "t-digest of the values, to be merged with tdigestquantile";
+
+command subtdigest(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:str]
+address AGGRsubtdigest
+comment "Grouped t-digests of the values, to be merged with subtdigestquantile";
+
+command subtdigestquantile(b:bat[:str],q:bat[:dbl],skip_nils:bit) :bat[:dbl]
+address AGGRtdigestquantile
+comment "Approximate quantile from merging t-digests";
+
+command subtdigestquantile(b:bat[:str],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:dbl]
+address AGGRsubtdigestquantile
+comment "Grouped approximate quantile from merging t-digests";
+
+function tdigestquantile(b:bat[:str],q:bat[:dbl]) :dbl;
+	bn := subtdigestquantile(b, q, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.tdigestquantile;
+
 EOF
@@ -133,7 +133,7 @@ ALGminany(ptr result, const bat *bid)
 	ptr p;
 	str msg = MAL_SUCCEED;
 
-	if (result == NULL || (b = BATdescriptor(*bid)) == NULL)
+	if (result == NULL || (b = BATcdescriptor(*bid)) == NULL)
 		throw(MAL, "algebra.min", RUNTIME_OBJECT_MISSING);
 
 	if (!ATOMlinear(b->ttype)) {
@@ -161,7 +161,7 @@ ALGmaxany(ptr result, const bat *bid)
 	ptr p;
 	str msg = MAL_SUCCEED;
 
-	if (result == NULL || (b = BATdescriptor(*bid)) == NULL)
+	if (result == NULL || (b = BATcdescriptor(*bid)) == NULL)
 		throw(MAL, "algebra.max", RUNTIME_OBJECT_MISSING);
 
 	if (!ATOMlinear(b->ttype)) {
@@ -237,10 +237,11 @@ ALGselect2(bat *result, const bat *bid, const bat *sid, const void *low, const v
 		(*anti != 0 && *anti != 1)) {
 		throw(MAL, "algebra.select", ILLEGAL_ARGUMENT);
 	}
-	if ((b = BATdescriptor(*bid)) == NULL) {
+	if ((b = BATcdescriptor(*bid)) == NULL) {
 		throw(MAL, "algebra.select", RUNTIME_OBJECT_MISSING);
 	}
-	if (sid && *sid != bat_nil && (s = BATdescriptor(*sid)) == NULL) {
+	/* the candidates may be a bitmap */
+	if (sid && *sid != bat_nil && (s = BATcdescriptor(*sid)) == NULL) {
 		BBPunfix(b->batCacheid);
 		throw(MAL, "algebra.select", RUNTIME_OBJECT_MISSING);
 	}
@@ -253,7 +254,7 @@ ALGselect2(bat *result, const bat *bid, const bat *sid, const void *low, const v
 		/* special case: equi-select for NIL */
 		high = NULL;
 	}
-	bn = BATselect(b, s, low, high, *li, *hi, *anti);
+	bn = BATmaskselect(b, s, low, high, *li, *hi, *anti);
 	BBPunfix(b->batCacheid);
 	if (s)
 		BBPunfix(s->batCacheid);
@@ -275,15 +276,16 @@ ALGthetaselect2(bat *result, const bat *bid, const bat *sid, const void *val, co
 {
 	BAT *b, *s = NULL, *bn;
 
-	if ((b = BATdescriptor(*bid)) == NULL) {
+	if ((b = BATcdescriptor(*bid)) == NULL) {
 		throw(MAL, "algebra.thetaselect", RUNTIME_OBJECT_MISSING);
 	}
-	if (sid && *sid != bat_nil && (s = BATdescriptor(*sid)) == NULL) {
+	/* the candidates may be a bitmap */
+	if (sid && *sid != bat_nil && (s = BATcdescriptor(*sid)) == NULL) {
 		BBPunfix(b->batCacheid);
 		throw(MAL, "algebra.thetaselect", RUNTIME_OBJECT_MISSING);
 	}
 	derefStr(b, val);
-	bn = BATthetaselect(b, s, val, *op);
+	bn = BATmaskthetaselect(b, s, val, *op);
 	BBPunfix(b->batCacheid);
 	if (s)
 		BBPunfix(s->batCacheid);
@@ -511,6 +513,44 @@ ALGintersect(bat *r1, const bat *lid, const bat *rid, const bat *slid, const bat
 				   BATsemijoin, NULL, NULL, NULL, NULL, "algebra.difference");
 }
 
+str
+ALGbloomselect(bat *result, const bat *lid, const bat *slid, const bat *rid, const bat *srid)
+{
+	BAT *l, *r, *sl = NULL, *sr = NULL, *bn;
+
+	if ((l = BATdescriptor(*lid)) == NULL)
+		goto fail;
+	if ((r = BATdescriptor(*rid)) == NULL) {
+		BBPunfix(l->batCacheid);
+		goto fail;
+	}
+	if (slid && *slid != bat_nil && (sl = BATdescriptor(*slid)) == NULL)
+		goto fail1;
+	if (srid && *srid != bat_nil && (sr = BATdescriptor(*srid)) == NULL) {
+		if (sl)
+			BBPunfix(sl->batCacheid);
+		goto fail1;
+	}
+	bn = BATbloomselect(l, sl, r, sr);
+	BBPunfix(l->batCacheid);
+	BBPunfix(r->batCacheid);
+	if (sl)
+		BBPunfix(sl->batCacheid);
+	if (sr)
+		BBPunfix(sr->batCacheid);
+	if (bn == NULL)
+		throw(MAL, "algebra.bloomselect", GDK_EXCEPTION);
+	*result = bn->batCacheid;
+	BBPkeepref(bn->batCacheid);
+	return MAL_SUCCEED;
+
+  fail1:
+	BBPunfix(l->batCacheid);
+	BBPunfix(r->batCacheid);
+  fail:
+	throw(MAL, "algebra.bloomselect", RUNTIME_OBJECT_MISSING);
+}
+
 /* algebra.firstn(b:bat[:any],
  *                [ s:bat[:oid],
  *                [ g:bat[:oid], ] ]
@@ -593,28 +633,6 @@ ALGunary(bat *result, const bat *bid, BAT *(*func)(BAT *), const char *name)
 	return MAL_SUCCEED;
 }
 
-static str
-ALGbinary(bat *result, const bat *lid, const bat *rid, BAT *(*func)(BAT *, BAT *), const char *name)
-{
-	BAT *left, *right,*bn= NULL;
-
-	if ((left = BATdescriptor(*lid)) == NULL) {
-		throw(MAL, name, RUNTIME_OBJECT_MISSING);
-	}
-	if ((right = BATdescriptor(*rid)) == NULL) {
-		BBPunfix(left->batCacheid);
-		throw(MAL, name, RUNTIME_OBJECT_MISSING);
-	}
-	bn = (*func)(left, right);
-	BBPunfix(left->batCacheid);
-	BBPunfix(right->batCacheid);
-	if (bn == NULL)
-		throw(MAL, name, GDK_EXCEPTION);
-	*result = bn->batCacheid;
-	BBPkeepref(*result);
-	return MAL_SUCCEED;
-}
-
 static BAT *
 BATwcopy(BAT *b)
 {
@@ -682,7 +700,25 @@ ALGcrossproduct2( bat *l, bat *r, const bat *left, const bat *right)
 str
 ALGprojection(bat *result, const bat *lid, const bat *rid)
 {
-	return ALGbinary(result, lid, rid, BATproject, "algebra.projection");
+	BAT *left, *right, *bn;
+
+	/* BATproject can project through a bitmap of candidates and
+	 * from a compressed BAT */
+	if ((left = BATcdescriptor(*lid)) == NULL) {
+		throw(MAL, "algebra.projection", RUNTIME_OBJECT_MISSING);
+	}
+	if ((right = BATcdescriptor(*rid)) == NULL) {
+		BBPunfix(left->batCacheid);
+		throw(MAL, "algebra.projection", RUNTIME_OBJECT_MISSING);
+	}
+	bn = BATproject(left, right);
+	BBPunfix(left->batCacheid);
+	BBPunfix(right->batCacheid);
+	if (bn == NULL)
+		throw(MAL, "algebra.projection", GDK_EXCEPTION);
+	*result = bn->batCacheid;
+	BBPkeepref(*result);
+	return MAL_SUCCEED;
 }
 
 str
@@ -36,6 +36,7 @@ mal_export str ALGbandjoin(bat *r1, bat *r2, const bat *lid, const bat *rid, con
 mal_export str ALGrangejoin(bat *r1, bat *r2, const bat *lid, const bat *rlid, const bat *rhid, const bat *slid, const bat *srid, const bit *li, const bit *hi, const lng *estimate);
 mal_export str ALGdifference(bat *r1, const bat *lid, const bat *rid, const bat *slid, const bat *srid, const bit *nil_matches, const lng *estimate);
 mal_export str ALGintersect(bat *r1, const bat *lid, const bat *rid, const bat *slid, const bat *srid, const bit *nil_matches, const lng *estimate);
+mal_export str ALGbloomselect(bat *result, const bat *lid, const bat *slid, const bat *rid, const bat *srid);
 
 /* legacy join functions */
 mal_export str ALGcrossproduct2(bat *l, bat *r, const bat *lid, const bat *rid);
@@ -822,6 +822,7 @@ BKCgetSize(lng *tot, const bat *bid){
 		if (b->thash)
 			size += ROUND_UP(sizeof(BUN) * cnt, blksize);
 		size += IMPSimprintsize(b);
+		size += ZMzonemapsize(b);
 	} 
 	*tot = size;
 	BBPunfix(*bid);
@@ -990,6 +991,33 @@ BKCsetImprints(bit *ret, const bat *bid)
 	return MAL_SUCCEED;
 }
 
+str
+BKCprefetch(void *ret, const bat *bid)
+{
+	(void) ret;
+	if (!BBPcheck(*bid, "bat.prefetch"))
+		throw(MAL, "bat.prefetch", RUNTIME_OBJECT_MISSING);
+	BATprefetch(*bid);
+	return MAL_SUCCEED;
+}
+
+str
+BKCsetDiskCompression(void *ret, const bat *bid, const bit *onoff)
+{
+	BAT *b;
+	gdk_return rc;
+
+	(void) ret;
+	if ((b = BATdescriptor(*bid)) == NULL) {
+		throw(MAL, "bat.setDiskCompression", RUNTIME_OBJECT_MISSING);
+	}
+	rc = BATsetdiskcompression(b, *onoff == TRUE);
+	BBPunfix(b->batCacheid);
+	if (rc != GDK_SUCCEED)
+		throw(MAL, "bat.setDiskCompression", OPERATION_FAILED);
+	return MAL_SUCCEED;
+}
+
 str
 BKCgetSequenceBase(oid *r, const bat *bid)
 {
@@ -1366,10 +1394,11 @@ BKCmergecand(bat *ret, const bat *aid, const bat *bid)
 {
 	BAT *a, *b, *bn;
 
-	if ((a = BATdescriptor(*aid)) == NULL) {
+	/* the lists may be bitmaps, which are combined as such */
+	if ((a = BATcdescriptor(*aid)) == NULL) {
 		throw(MAL, "bat.mergecand", RUNTIME_OBJECT_MISSING);
 	}
-	if ((b = BATdescriptor(*bid)) == NULL) {
+	if ((b = BATcdescriptor(*bid)) == NULL) {
 		BBPunfix(a->batCacheid);
 		throw(MAL, "bat.mergecand", RUNTIME_OBJECT_MISSING);
 	}
@@ -1388,10 +1417,11 @@ BKCintersectcand(bat *ret, const bat *aid, const bat *bid)
 {
 	BAT *a, *b, *bn;
 
-	if ((a = BATdescriptor(*aid)) == NULL) {
+	/* the lists may be bitmaps, which are combined as such */
+	if ((a = BATcdescriptor(*aid)) == NULL) {
 		throw(MAL, "bat.intersectcand", RUNTIME_OBJECT_MISSING);
 	}
-	if ((b = BATdescriptor(*bid)) == NULL) {
+	if ((b = BATcdescriptor(*bid)) == NULL) {
 		BBPunfix(a->batCacheid);
 		throw(MAL, "bat.intersectcand", RUNTIME_OBJECT_MISSING);
 	}
@@ -127,3 +127,80 @@ GRPgroup1(bat *ngid, bat *next, bat *nhis, const bat *bid)
 {
 	return GRPsubgroup5(ngid, next, nhis, bid, NULL, NULL, NULL, NULL);
 }
+
+/* (groups, extents, histo, r1, ..., rn) :=
+ *	group.groupaggr(b, op1, c1, skip_nils1, ..., opn, cn, skip_nilsn)
+ * Group b and compute the aggregates in the same pass; the result
+ * types are the types of r1, ..., rn. */
+str
+GRPgroupaggr(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	BAT *b, *gn, *en, *hn;
+	BAT **vals, **res;
+	int *ops, *tps, *nils;
+	int i, k, naggr = pci->retc - 3;
+	str msg = MAL_SUCCEED;
+	const char *op;
+
+	(void) cntxt;
+	if (naggr < 0 || pci->argc - pci->retc - 1 != 3 * naggr)
+		throw(MAL, "group.groupaggr", ILLEGAL_ARGUMENT);
+	vals = GDKzalloc(naggr * sizeof(BAT *) + 1);
+	res = GDKzalloc(naggr * sizeof(BAT *) + 1);
+	ops = GDKmalloc(naggr * sizeof(int) + 1);
+	tps = GDKmalloc(naggr * sizeof(int) + 1);
+	nils = GDKmalloc(naggr * sizeof(int) + 1);
+	if (vals == NULL || res == NULL || ops == NULL || tps == NULL || nils == NULL) {
+		msg = createException(MAL, "group.groupaggr", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (k = 0; k < naggr; k++) {
+		i = pci->retc + 1 + 3 * k;
+		op = *getArgReference_str(stk, pci, i);
+		if (strcmp(op, "count") == 0)
+			ops[k] = GDK_AGGR_COUNT;
+		else if (strcmp(op, "sum") == 0)
+			ops[k] = GDK_AGGR_SUM;
+		else if (strcmp(op, "min") == 0)
+			ops[k] = GDK_AGGR_MIN;
+		else if (strcmp(op, "max") == 0)
+			ops[k] = GDK_AGGR_MAX;
+		else {
+			msg = createException(MAL, "group.groupaggr", ILLEGAL_ARGUMENT ": unknown aggregate %s", op);
+			goto bailout;
+		}
+		if ((vals[k] = BATdescriptor(*getArgReference_bat(stk, pci, i + 1))) == NULL) {
+			msg = createException(MAL, "group.groupaggr", RUNTIME_OBJECT_MISSING);
+			goto bailout;
+		}
+		nils[k] = *getArgReference_bit(stk, pci, i + 2) != 0;
+		tps[k] = getBatType(getArgType(mb, pci, 3 + k));
+	}
+	if ((b = BATdescriptor(*getArgReference_bat(stk, pci, pci->retc))) == NULL) {
+		msg = createException(MAL, "group.groupaggr", RUNTIME_OBJECT_MISSING);
+		goto bailout;
+	}
+	if (BATgroupaggr(&gn, &en, &hn, res, b, naggr, ops, vals, tps, nils, 1) != GDK_SUCCEED) {
+		BBPunfix(b->batCacheid);
+		msg = createException(MAL, "group.groupaggr", GDK_EXCEPTION);
+		goto bailout;
+	}
+	BBPunfix(b->batCacheid);
+	BBPkeepref(*getArgReference_bat(stk, pci, 0) = gn->batCacheid);
+	BBPkeepref(*getArgReference_bat(stk, pci, 1) = en->batCacheid);
+	BBPkeepref(*getArgReference_bat(stk, pci, 2) = hn->batCacheid);
+	for (k = 0; k < naggr; k++)
+		BBPkeepref(*getArgReference_bat(stk, pci, 3 + k) = res[k]->batCacheid);
+
+  bailout:
+	if (vals)
+		for (k = 0; k < naggr; k++)
+			if (vals[k])
+				BBPunfix(vals[k]->batCacheid);
+	GDKfree(vals);
+	GDKfree(res);
+	GDKfree(ops);
+	GDKfree(tps);
+	GDKfree(nils);
+	return msg;
+}
@@ -9,6 +9,7 @@
 #ifndef _GROUP_H_
 #define _GROUP_H_
 #include "gdk.h"
+#include "mal_interpreter.h"
 
 mal_export str GRPgroup1(bat *ngid, bat *next, bat *nhis, const bat *bid);
 mal_export str GRPgroup2(bat *ngid, bat *next, bat *nhis,
@@ -38,5 +39,6 @@ mal_export str GRPsubgroup8(bat *ngid, bat *next,
 mal_export str GRPsubgroup9(bat *ngid, bat *next,
 							const bat *bid, const bat *sid,
 							const bat *gid, const bat *eid, const bat *hid);
+mal_export str GRPgroupaggr(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 
 #endif /* _GROUP_H_ */
@@ -24,6 +24,7 @@
 #include <stdarg.h>
 #include <time.h>
 #include "mal_exception.h"
+#include "mal_dataflow.h"
 #include "status.h"
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
@@ -228,6 +229,236 @@ SYSmemStatistics(bat *ret, bat *ret2)
 	throw(MAL, "status.memStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 }
 
+str
+SYSnumaStatistics(bat *ret, bat *ret2)
+{
+	BAT *b, *bn;
+	int nodes, emulated;
+	lng placed, local, remote, any, i;
+
+	bn = COLnew(0, TYPE_str, 8, TRANSIENT);
+	b = COLnew(0, TYPE_lng, 8, TRANSIENT);
+	if (b == 0 || bn == 0) {
+		if ( b) BBPunfix(b->batCacheid);
+		if ( bn) BBPunfix(bn->batCacheid);
+		throw(MAL, "status.numaStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	GDKnumastatistics(&nodes, &emulated, &placed);
+	DFLOWnumaStatistics(&local, &remote, &any);
+	i = nodes;
+	if (BUNappend(bn, "nodes", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &i, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	i = emulated;
+	if (BUNappend(bn, "emulated", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &i, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "placedkb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &placed, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "local", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &local, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "remote", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &remote, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "anywhere", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &any, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (pseudo(ret,ret2,bn,b))
+		goto bailout;
+	return MAL_SUCCEED;
+  bailout:
+	BBPunfix(b->batCacheid);
+	BBPunfix(bn->batCacheid);
+	throw(MAL, "status.numaStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+}
+
+str
+SYSheapStatistics(bat *ret, bat *ret2)
+{
+	BAT *b, *bn;
+	int hugepages;
+	lng hugekb, hugerss, seqkb, randomkb, willneedkb, i;
+
+	bn = COLnew(0, TYPE_str, 8, TRANSIENT);
+	b = COLnew(0, TYPE_lng, 8, TRANSIENT);
+	if (b == 0 || bn == 0) {
+		if ( b) BBPunfix(b->batCacheid);
+		if ( bn) BBPunfix(bn->batCacheid);
+		throw(MAL, "status.heapStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	GDKheapstatistics(&hugepages, &hugekb, &hugerss, &seqkb, &randomkb, &willneedkb);
+	i = hugepages;
+	if (BUNappend(bn, "hugepages", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &i, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "hugepagekb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &hugekb, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "hugersskb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &hugerss, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "sequentialkb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &seqkb, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "randomkb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &randomkb, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "willneedkb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &willneedkb, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (pseudo(ret,ret2,bn,b))
+		goto bailout;
+	return MAL_SUCCEED;
+  bailout:
+	BBPunfix(b->batCacheid);
+	BBPunfix(bn->batCacheid);
+	throw(MAL, "status.heapStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+}
+
+str
+SYSarenaStatistics(bat *ret, bat *ret2)
+{
+	BAT *b, *bn;
+	int arenas;
+	lng hits, misses, cachedkb, i;
+
+	bn = COLnew(0, TYPE_str, 4, TRANSIENT);
+	b = COLnew(0, TYPE_lng, 4, TRANSIENT);
+	if (b == 0 || bn == 0) {
+		if ( b) BBPunfix(b->batCacheid);
+		if ( bn) BBPunfix(bn->batCacheid);
+		throw(MAL, "status.arenaStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	GDKarenastatistics(&arenas, &hits, &misses, &cachedkb);
+	i = arenas;
+	if (BUNappend(bn, "arenas", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &i, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "hits", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &hits, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "misses", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &misses, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "cachedkb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &cachedkb, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (pseudo(ret,ret2,bn,b))
+		goto bailout;
+	return MAL_SUCCEED;
+  bailout:
+	BBPunfix(b->batCacheid);
+	BBPunfix(bn->batCacheid);
+	throw(MAL, "status.arenaStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+}
+
+str
+SYSprefetchStatistics(bat *ret, bat *ret2)
+{
+	BAT *b, *bn;
+	int threads;
+	lng requests, loads, dropped, i;
+
+	bn = COLnew(0, TYPE_str, 4, TRANSIENT);
+	b = COLnew(0, TYPE_lng, 4, TRANSIENT);
+	if (b == 0 || bn == 0) {
+		if ( b) BBPunfix(b->batCacheid);
+		if ( bn) BBPunfix(bn->batCacheid);
+		throw(MAL, "status.prefetchStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	GDKprefetchstatistics(&threads, &requests, &loads, &dropped);
+	i = threads;
+	if (BUNappend(bn, "threads", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &i, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "requests", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &requests, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "loads", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &loads, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "dropped", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &dropped, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (pseudo(ret,ret2,bn,b))
+		goto bailout;
+	return MAL_SUCCEED;
+  bailout:
+	BBPunfix(b->batCacheid);
+	BBPunfix(bn->batCacheid);
+	throw(MAL, "status.prefetchStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+}
+
+str
+SYSzheapStatistics(bat *ret, bat *ret2)
+{
+	BAT *b, *bn;
+	lng savedkb, writtenkb, loads;
+
+	bn = COLnew(0, TYPE_str, 3, TRANSIENT);
+	b = COLnew(0, TYPE_lng, 3, TRANSIENT);
+	if (b == 0 || bn == 0) {
+		if ( b) BBPunfix(b->batCacheid);
+		if ( bn) BBPunfix(bn->batCacheid);
+		throw(MAL, "status.zheapStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	GDKzstatistics(&savedkb, &writtenkb, &loads);
+	if (BUNappend(bn, "savedkb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &savedkb, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "writtenkb", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &writtenkb, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (BUNappend(bn, "loads", FALSE) != GDK_SUCCEED ||
+		BUNappend(b, &loads, FALSE) != GDK_SUCCEED)
+		goto bailout;
+	if (pseudo(ret,ret2,bn,b))
+		goto bailout;
+	return MAL_SUCCEED;
+  bailout:
+	BBPunfix(b->batCacheid);
+	BBPunfix(bn->batCacheid);
+	throw(MAL, "status.zheapStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+}
+
+str
+SYSstartupStatistics(bat *ret, bat *ret2)
+{
+	BAT *b, *bn;
+	const char *const *phases;
+	const lng *usec;
+	int i, n;
+
+	n = GDKstartupstatistics(&phases, &usec);
+	bn = COLnew(0, TYPE_str, n, TRANSIENT);
+	b = COLnew(0, TYPE_lng, n, TRANSIENT);
+	if (b == 0 || bn == 0) {
+		if ( b) BBPunfix(b->batCacheid);
+		if ( bn) BBPunfix(bn->batCacheid);
+		throw(MAL, "status.startupStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	for (i = 0; i < n; i++) {
+		if (BUNappend(bn, phases[i], FALSE) != GDK_SUCCEED ||
+			BUNappend(b, &usec[i], FALSE) != GDK_SUCCEED)
+			goto bailout;
+	}
+	if (pseudo(ret,ret2,bn,b))
+		goto bailout;
+	return MAL_SUCCEED;
+  bailout:
+	BBPunfix(b->batCacheid);
+	BBPunfix(bn->batCacheid);
+	throw(MAL, "status.startupStatistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+}
+
 #define heap(X1,X2,X3,X4)									\
 	if (X1) {												\
 		sz = HEAPmemsize(X2);								\
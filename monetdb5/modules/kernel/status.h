@@ -18,6 +18,12 @@ mal_export str SYSsetvm_maxsize(void *ret, const lng *num);
 mal_export str SYSioStatistics(bat *ret, bat *ret2);
 mal_export str SYScpuStatistics(bat *ret, bat *ret2);
 mal_export str SYSmemStatistics(bat *ret, bat *ret2);
+mal_export str SYSnumaStatistics(bat *ret, bat *ret2);
+mal_export str SYSheapStatistics(bat *ret, bat *ret2);
+mal_export str SYSarenaStatistics(bat *ret, bat *ret2);
+mal_export str SYSprefetchStatistics(bat *ret, bat *ret2);
+mal_export str SYSzheapStatistics(bat *ret, bat *ret2);
+mal_export str SYSstartupStatistics(bat *ret, bat *ret2);
 mal_export str SYSmem_usage(bat *ret, bat *ret2, const lng *minsize);
 mal_export str SYSvm_usage(bat *ret, bat *ret2, const lng *minsize);
 mal_export str SYSgdkEnv(bat *ret, bat *ret2);
@@ -187,3 +187,80 @@ CMDBATimprintsize(lng *ret, bat *bid)
 	BBPunfix(b->batCacheid);
 	return MAL_SUCCEED;
 }
+
+str
+CMDBATzonemap(void *ret, bat *bid)
+{
+	BAT *b;
+	gdk_return r;
+
+	(void) ret;
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "bat.zonemap", INTERNAL_BAT_ACCESS);
+
+	r = BATzonemap(b);
+	BBPunfix(b->batCacheid);
+	if (r != GDK_SUCCEED)
+		throw(MAL, "bat.zonemap", GDK_EXCEPTION);
+	return MAL_SUCCEED;
+}
+
+str
+CMDBATzonemapsize(lng *ret, bat *bid)
+{
+	BAT *b;
+
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "bat.zonemapsize", INTERNAL_BAT_ACCESS);
+
+	*ret = ZMzonemapsize(b);
+	BBPunfix(b->batCacheid);
+	return MAL_SUCCEED;
+}
+
+str
+CMDBATcompress(bat *ret, bat *bid)
+{
+	BAT *b, *bn;
+
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "bat.compress", INTERNAL_BAT_ACCESS);
+
+	bn = BATcompress(b);
+	BBPunfix(b->batCacheid);
+	if (bn == NULL)
+		throw(MAL, "bat.compress", GDK_EXCEPTION);
+	BBPkeepref(*ret = bn->batCacheid);
+	return MAL_SUCCEED;
+}
+
+str
+CMDBATcompression(str *ret, bat *bid)
+{
+	BAT *b;
+
+	if ((b = BATcdescriptor(*bid)) == NULL)
+		throw(MAL, "bat.compression", INTERNAL_BAT_ACCESS);
+
+	*ret = GDKstrdup(BATcompression(b));
+	BBPunfix(b->batCacheid);
+	if (*ret == NULL)
+		throw(MAL, "bat.compression", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	return MAL_SUCCEED;
+}
+
+str
+CMDBATmaskcand(bat *ret, bat *sid)
+{
+	BAT *s, *bn;
+
+	if ((s = BATdescriptor(*sid)) == NULL)
+		throw(MAL, "bat.maskcand", INTERNAL_BAT_ACCESS);
+
+	bn = BATmaskcand(s);
+	BBPunfix(s->batCacheid);
+	if (bn == NULL)
+		throw(MAL, "bat.maskcand", GDK_EXCEPTION);
+	BBPkeepref(*ret = bn->batCacheid);
+	return MAL_SUCCEED;
+}
@@ -22,5 +22,10 @@ mal_export str CMDBATpartition(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrP
 mal_export str CMDBATpartition2(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 mal_export str CMDBATimprints(void *ret, bat *bid);
 mal_export str CMDBATimprintsize(lng *ret, bat *bid);
+mal_export str CMDBATzonemap(void *ret, bat *bid);
+mal_export str CMDBATzonemapsize(lng *ret, bat *bid);
+mal_export str CMDBATcompress(bat *ret, bat *bid);
+mal_export str CMDBATcompression(str *ret, bat *bid);
+mal_export str CMDBATmaskcand(bat *ret, bat *sid);
 
 #endif /* _BAT_EXTENSIONS_ */
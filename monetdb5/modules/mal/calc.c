@@ -761,7 +761,7 @@ CMDBATsumprod(MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 	int nil_if_empty = 1;
 	gdk_return r;
 
-	if ((b = BATdescriptor(bid)) == NULL)
+	if ((b = BATcdescriptor(bid)) == NULL)
 		throw(MAL, func, RUNTIME_OBJECT_MISSING);
 	if (pci->argc >= 3) {
 		if (getArgType(mb, pci, 2) == TYPE_bit) {
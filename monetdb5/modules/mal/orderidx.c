@@ -66,28 +66,13 @@ OIDXcreateImplementation(Client cntxt, int tpe, BAT *b, int pieces)
 		throw(MAL, "bat.orderidx", TYPE_NOT_SUPPORTED);
 	}
 
-	if( pieces < 0 ){
-		if (GDKnr_threads <= 1) {
-			pieces = 1;
-		} else {
-			if (GDKdebug & FORCEMITOMASK) {
-				/* we want many pieces, even tiny ones */
-				if (BATcount(b) < 4)
-					pieces = 1;
-				else if (BATcount(b) / 2 < (BUN) GDKnr_threads)
-					pieces = (int) (BATcount(b) / 2);
-				else
-					pieces = GDKnr_threads;
-			} else {
-				if (BATcount(b) < 2 * MIN_PIECE)
-					pieces = 1;
-				else if (BATcount(b) / MIN_PIECE < (BUN) GDKnr_threads)
-					pieces = (int) (BATcount(b) / MIN_PIECE);
-				else
-					pieces = GDKnr_threads;
-			}
-		}
-	} else if (BATcount(b) < (BUN) pieces || BATcount(b) < MIN_PIECE) {
+	if (pieces < 0) {
+		/* BATorderidx sorts large BATs in parallel by itself */
+		if (BATorderidx(b, 1) != GDK_SUCCEED)
+			throw(MAL, "bat.orderidx", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		return MAL_SUCCEED;
+	}
+	if (BATcount(b) < (BUN) pieces || BATcount(b) < MIN_PIECE) {
 		pieces = 1;
 	}
 #ifdef _DEBUG_OIDX_
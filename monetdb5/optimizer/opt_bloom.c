@@ -0,0 +1,180 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Sideways information passing through Bloom filters.
+ * An equi-join or semi-join between a large unfiltered column (the
+ * fact table) and a column on which a selection was applied (the
+ * dimension table) probes many values that find no match.  We
+ * introduce a Bloom filter over the filtered side, which reduces the
+ * large side to a candidate list before the join:
+ *
+ *	(X,Y) := algebra.join(L, R, nil:bat, SR, false, E);
+ * becomes
+ *	C := algebra.bloomselect(L, nil:bat, R, SR);
+ *	(X,Y) := algebra.join(L, R, C, SR, false, E);
+ *
+ * The join result is the same, since a Bloom filter has no false
+ * negatives.  At runtime the filter is skipped when it does not
+ * reduce the large side enough.
+ */
+#include "monetdb_config.h"
+#include "opt_bloom.h"
+
+/* minimal estimated size of the large side */
+#define BLOOMROWS	((BUN) 1 << 16)
+
+static int
+isSelection(InstrPtr p)
+{
+	return p != NULL && getModuleId(p) == algebraRef &&
+		(getFunctionId(p) == selectRef ||
+		 getFunctionId(p) == thetaselectRef ||
+		 getFunctionId(p) == likeselectRef ||
+		 getFunctionId(p) == ilikeselectRef ||
+		 getFunctionId(p) == likethetaselectRef ||
+		 getFunctionId(p) == ilikethetaselectRef);
+}
+
+/* a column restricted by a selection */
+static int
+isFiltered(InstrPtr *def, int var)
+{
+	InstrPtr p = def[var];
+
+	return p != NULL && getModuleId(p) == algebraRef &&
+		(getFunctionId(p) == projectionRef ||
+		 getFunctionId(p) == projectionpathRef) &&
+		isSelection(def[getArg(p, 1)]);
+}
+
+/* the estimated size of an unrestricted column, or 0 if the column is
+ * restricted or its size is unknown */
+static BUN
+unfilteredRows(MalBlkPtr mb, InstrPtr *def, int var)
+{
+	InstrPtr p = def[var], q;
+
+	if (p == NULL)
+		return 0;
+	if (getModuleId(p) == sqlRef && getFunctionId(p) == bindRef && p->retc == 1)
+		return getRowCnt(mb, var);
+	if (getModuleId(p) == algebraRef && getFunctionId(p) == projectionRef &&
+	    p->argc == 3) {
+		q = def[getArg(p, 1)];
+		if (q == NULL || getModuleId(q) != sqlRef || getFunctionId(q) != tidRef)
+			return 0;
+		if (getRowCnt(mb, getArg(q, 0)) == 0)
+			return unfilteredRows(mb, def, getArg(p, 2));
+		return getRowCnt(mb, getArg(q, 0));
+	}
+	return 0;
+}
+
+static int
+isNilCand(MalBlkPtr mb, int var)
+{
+	return getVarType(mb, var) == TYPE_bat;
+}
+
+/* add a Bloom filter select of the large column (argument LARG) using
+ * the filtered column (argument RARG) and make it the candidate list of
+ * the large column */
+static void
+addBloomselect(MalBlkPtr mb, InstrPtr p, int larg, int rarg)
+{
+	InstrPtr q;
+
+	q = newInstruction(mb, algebraRef, bloomselectRef);
+	getArg(q, 0) = newTmpVariable(mb, newBatType(TYPE_oid));
+	setVarUDFtype(mb, getArg(q, 0));
+	q = pushArgument(mb, q, getArg(p, larg));
+	q = pushArgument(mb, q, getArg(p, larg + 2));
+	q = pushArgument(mb, q, getArg(p, rarg));
+	q = pushArgument(mb, q, getArg(p, rarg + 2));
+	pushInstruction(mb, q);
+	getArg(p, larg + 2) = getArg(q, 0);
+}
+
+str
+OPTbloomImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, l, r, actions = 0;
+	int limit, slimit;
+	InstrPtr p, *old, *def;
+	char buf[256];
+	lng usec = GDKusec();
+
+	(void) pci;
+	(void) stk;
+	for (i = 0; i < mb->stop; i++) {
+		p = getInstrPtr(mb, i);
+		if (getModuleId(p) == algebraRef &&
+		    (getFunctionId(p) == joinRef || getFunctionId(p) == semijoinRef))
+			break;
+	}
+	if (i == mb->stop)
+		goto wrapup;
+
+	def = (InstrPtr *) GDKzalloc(sizeof(InstrPtr) * mb->vtop);
+	if (def == NULL)
+		throw(MAL, "optimizer.bloom", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	old = mb->stmt;
+	limit = mb->stop;
+	slimit = mb->ssize;
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		GDKfree(def);
+		throw(MAL, "optimizer.bloom", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		/* (l, r, sl, sr, nil_matches, estimate) */
+		if (getModuleId(p) == algebraRef &&
+		    (getFunctionId(p) == joinRef || getFunctionId(p) == semijoinRef) &&
+		    p->retc == 2 && p->argc == 8 &&
+		    isVarConstant(mb, getArg(p, 6)) &&
+		    getVarConstant(mb, getArg(p, 6)).val.btval == 0) {
+			l = getArg(p, 2);
+			r = getArg(p, 3);
+			if (isNilCand(mb, getArg(p, 4)) &&
+			    isFiltered(def, r) &&
+			    unfilteredRows(mb, def, l) >= BLOOMROWS) {
+				addBloomselect(mb, p, 2, 3);
+				actions++;
+			} else if (isNilCand(mb, getArg(p, 5)) &&
+				   isFiltered(def, l) &&
+				   unfilteredRows(mb, def, r) >= BLOOMROWS) {
+				addBloomselect(mb, p, 3, 2);
+				actions++;
+			}
+		}
+		pushInstruction(mb, p);
+		if (p->retc == 1 && p->barrier == 0)
+			def[getArg(p, 0)] = p;
+	}
+	for (; i < slimit; i++)
+		if (old[i])
+			freeInstruction(old[i]);
+	GDKfree(old);
+	GDKfree(def);
+
+	/* Defense line against incorrect plans */
+	if (actions > 0) {
+		chkTypes(cntxt->usermodule, mb, FALSE);
+		chkFlow(mb);
+		chkDeclarations(mb);
+	}
+  wrapup:
+	/* keep all actions taken as a post block comment */
+	usec = GDKusec() - usec;
+	snprintf(buf, 256, "%-20s actions=%2d time=" LLFMT " usec", "bloom", actions, usec);
+	newComment(mb, buf);
+	addtoMalBlkHistory(mb);
+	return MAL_SUCCEED;
+}
@@ -0,0 +1,276 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2017 MonetDB B.V.
+ */
+
+/*
+ * Fusion of grouping and aggregation.
+ * A GROUP BY on a single column creates the groups with one pass over
+ * the grouping column, after which each aggregate makes another pass
+ * over its column and the group ids:
+ *
+ *	(G,E,H) := group.groupdone(B);
+ *	S := aggr.subsum(V, G, E, true, true);
+ *	M := aggr.submax(W, G, E, true);
+ * becomes
+ *	(G,E,H,S,M) := group.groupaggr(B, "sum", V, true, "max", W, true);
+ *
+ * which calculates the groups and the aggregates in a single pass.
+ * Aggregates whose column is calculated after the grouping (typically
+ * a projection of the column on the selection) are fused too, by moving
+ * the side-effect free instructions that calculate the column in front
+ * of the grouping.  Aggregates that cannot be calculated in the same
+ * pass at runtime are calculated with the groups afterwards, so the
+ * result is always the same.
+ */
+#include "monetdb_config.h"
+#include "opt_groupaggr.h"
+
+/* how deep we look for instructions that can be moved in front of the
+ * grouping */
+#define HOISTDEPTH	3
+
+static int
+isGrouping(InstrPtr p, const int *defpc)
+{
+	int j;
+
+	if (getModuleId(p) != groupRef ||
+	    (getFunctionId(p) != groupRef && getFunctionId(p) != groupdoneRef) ||
+	    p->barrier != 0 ||
+	    (p->retc != 2 && p->retc != 3) || p->argc != p->retc + 1)
+		return 0;
+	for (j = 0; j < p->retc; j++)
+		if (defpc[getArg(p, j)] < 0)
+			return 0;
+	return 1;
+}
+
+/* the name of the aggregate calculated by p, or NULL if p is not an
+ * aggregate over groups that group.groupaggr can calculate */
+static const char *
+isAggregate(MalBlkPtr mb, InstrPtr p)
+{
+	if (getModuleId(p) != aggrRef || p->barrier != 0 || p->retc != 1)
+		return NULL;
+	if (getFunctionId(p) == subsumRef) {
+		/* (v, g, e, skip_nils, abort_on_error) */
+		if (p->argc != 6 || !isVarConstant(mb, getArg(p, 4)) ||
+		    !isVarConstant(mb, getArg(p, 5)) ||
+		    getVarType(mb, getArg(p, 5)) != TYPE_bit ||
+		    getVarConstant(mb, getArg(p, 5)).val.btval != 1)
+			return NULL;
+		return "sum";
+	}
+	/* (v, g, e, skip_nils) */
+	if (p->argc != 5 || !isVarConstant(mb, getArg(p, 4)))
+		return NULL;
+	if (getFunctionId(p) == subcountRef)
+		return "count";
+	if (getFunctionId(p) == subminRef)
+		return "min";
+	if (getFunctionId(p) == submaxRef)
+		return "max";
+	return NULL;
+}
+
+/* whether variable var is available at instruction pc, possibly after
+ * moving the instructions that calculate it in front of pc (but not
+ * aggregates that were fused themselves) */
+static int
+isAvailable(MalBlkPtr mb, InstrPtr *old, const int *defpc, const int *blk, const int *fused, int var, int pc, int depth)
+{
+	int d = defpc[var], j;
+	InstrPtr q;
+
+	if (d == -1 || (d >= 0 && d < pc))
+		return 1;
+	if (d < 0 || depth == 0)
+		return 0;
+	q = old[d];
+	if (blk[d] != blk[pc] || fused[d] > 0 || q->barrier != 0 || q->retc != 1 ||
+	    hasSideEffects(mb, q, TRUE))
+		return 0;
+	for (j = q->retc; j < q->argc; j++)
+		if (!isAvailable(mb, old, defpc, blk, fused, getArg(q, j), pc, depth - 1))
+			return 0;
+	return 1;
+}
+
+/* mark the instructions needed to calculate var to be moved in front
+ * of instruction pc */
+static void
+hoist(InstrPtr *old, const int *defpc, int *moveto, int var, int pc)
+{
+	int d = defpc[var], j;
+	InstrPtr q;
+
+	if (d < pc)
+		return;
+	if (moveto[d] == 0 || moveto[d] > pc)
+		moveto[d] = pc;
+	q = old[d];
+	for (j = q->retc; j < q->argc; j++)
+		hoist(old, defpc, moveto, getArg(q, j), pc);
+}
+
+str
+OPTgroupaggrImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, j, k, b, g, actions = 0;
+	int limit, slimit;
+	int *defpc = NULL, *blk = NULL, *grp = NULL, *fused = NULL, *moveto = NULL;
+	InstrPtr p, q, *old = NULL;
+	const char *op;
+	char buf[256];
+	lng usec = GDKusec();
+	str msg = MAL_SUCCEED;
+
+	(void) pci;
+	(void) stk;
+	for (i = 0; i < mb->stop; i++) {
+		p = getInstrPtr(mb, i);
+		if (getModuleId(p) == groupRef &&
+		    (getFunctionId(p) == groupRef || getFunctionId(p) == groupdoneRef))
+			break;
+	}
+	if (i == mb->stop)
+		goto wrapup;
+
+	limit = mb->stop;
+	slimit = mb->ssize;
+	defpc = GDKmalloc(sizeof(int) * mb->vtop);
+	blk = GDKmalloc(sizeof(int) * limit);
+	grp = GDKzalloc(sizeof(int) * mb->vtop);
+	fused = GDKzalloc(sizeof(int) * limit);
+	moveto = GDKzalloc(sizeof(int) * limit);
+	if (defpc == NULL || blk == NULL || grp == NULL || fused == NULL || moveto == NULL) {
+		msg = createException(MAL, "optimizer.groupaggr", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	old = mb->stmt;
+
+	/* where variables are assigned (-1: never, -2: more than once),
+	 * and which instructions are in the same basic block */
+	for (i = 0; i < mb->vtop; i++)
+		defpc[i] = -1;
+	for (i = 1, b = 0; i < limit; i++) {
+		p = old[i];
+		if (p->barrier != 0)
+			b++;
+		blk[i] = b;
+		for (j = 0; j < p->retc; j++)
+			defpc[getArg(p, j)] = defpc[getArg(p, j)] == -1 ? i : -2;
+	}
+
+	/* find the aggregates that can be fused with a grouping; grp maps
+	 * the groups variable to the grouping instruction, fused maps the
+	 * aggregate to it, and is -1 for a grouping with fused aggregates */
+	for (i = 1; i < limit; i++) {
+		p = old[i];
+		if (isGrouping(p, defpc)) {
+			grp[getArg(p, 0)] = i;
+			continue;
+		}
+		if ((op = isAggregate(mb, p)) == NULL ||
+		    (g = grp[getArg(p, 2)]) == 0 ||
+		    getArg(old[g], 1) != getArg(p, 3) ||
+		    blk[g] != blk[i] || defpc[getArg(p, 0)] != i)
+			continue;
+		if (getArg(p, 1) == getArg(old[g], 0)) {
+			/* count(*) over the groups is a count of the
+			 * grouping column including nils */
+			if (strcmp(op, "count") != 0 ||
+			    getVarConstant(mb, getArg(p, 4)).val.btval != 0)
+				continue;
+		} else if (!isAvailable(mb, old, defpc, blk, fused, getArg(p, 1), g, HOISTDEPTH))
+			continue;
+		else
+			hoist(old, defpc, moveto, getArg(p, 1), g);
+		fused[i] = g;
+		fused[g] = -1;
+		actions++;
+	}
+	if (actions == 0)
+		goto bailout;
+
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		mb->stmt = old;
+		old = NULL;
+		msg = createException(MAL, "optimizer.groupaggr", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	pushInstruction(mb, old[0]);
+	for (i = 1; i < limit; i++) {
+		p = old[i];
+		if (fused[i] > 0) {
+			freeInstruction(p);
+			continue;
+		}
+		if (moveto[i])
+			continue;
+		if (fused[i] == 0) {
+			pushInstruction(mb, p);
+			continue;
+		}
+		/* the instructions moved in front of the grouping */
+		for (j = i + 1; j < limit; j++)
+			if (moveto[j] == i)
+				pushInstruction(mb, old[j]);
+		q = newInstruction(mb, groupRef, groupaggrRef);
+		getArg(q, 0) = getArg(p, 0);
+		q = pushReturn(mb, q, getArg(p, 1));
+		if (p->retc == 3) {
+			q = pushReturn(mb, q, getArg(p, 2));
+		} else {
+			k = newTmpVariable(mb, newBatType(TYPE_lng));
+			setVarUDFtype(mb, k);
+			q = pushReturn(mb, q, k);
+		}
+		for (j = i + 1; j < limit; j++)
+			if (fused[j] == i)
+				q = pushReturn(mb, q, getArg(old[j], 0));
+		q = pushArgument(mb, q, getArg(p, p->retc));
+		for (j = i + 1; j < limit; j++) {
+			if (fused[j] != i)
+				continue;
+			q = pushStr(mb, q, isAggregate(mb, old[j]));
+			if (getArg(old[j], 1) == getArg(p, 0))
+				q = pushArgument(mb, q, getArg(p, p->retc));
+			else
+				q = pushArgument(mb, q, getArg(old[j], 1));
+			q = pushArgument(mb, q, getArg(old[j], 4));
+		}
+		pushInstruction(mb, q);
+		freeInstruction(p);
+	}
+	for (; i < slimit; i++)
+		if (old[i])
+			freeInstruction(old[i]);
+	GDKfree(old);
+	old = NULL;
+
+	/* Defense line against incorrect plans */
+	chkTypes(cntxt->usermodule, mb, FALSE);
+	chkFlow(mb);
+	chkDeclarations(mb);
+
+  bailout:
+	GDKfree(defpc);
+	GDKfree(blk);
+	GDKfree(grp);
+	GDKfree(fused);
+	GDKfree(moveto);
+	if (msg != MAL_SUCCEED)
+		return msg;
+  wrapup:
+	/* keep all actions taken as a post block comment */
+	usec = GDKusec() - usec;
+	snprintf(buf, 256, "%-20s actions=%2d time=" LLFMT " usec", "groupaggr", actions, usec);
+	newComment(mb, buf);
+	addtoMalBlkHistory(mb);
+	return MAL_SUCCEED;
+}
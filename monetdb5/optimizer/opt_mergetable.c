@@ -1084,6 +1084,60 @@ mat_group_aggr(MalBlkPtr mb, InstrPtr p, mat_t *mat, int b, int g, int e)
 	pushInstruction(mb, ai2);
 }
 
+/* The approximate aggregates are calculated from sketches that can be
+ * merged: each partition calculates the sketches of its groups, and the
+ * packed sketches are merged per group of the combined result, e.g.
+ *	a := aggr.subapprox_quantile(b, q, g, e, true);
+ * becomes
+ *	t1 := aggr.subtdigest(b1, g1, e1, true);
+ *	...
+ *	t := mat.pack(t1, ...);
+ *	a := aggr.subtdigestquantile(t, q, G, E, true);
+ * Without groups (g and e are -1) each partition has a single sketch. */
+static void
+mat_sketch_aggr(MalBlkPtr mb, InstrPtr p, matlist_t *ml, int b, int g, int e)
+{
+	int tp = newBatType(TYPE_str), k, q;
+	int isQuantile = (getFunctionId(p) == approx_quantileRef || getFunctionId(p) == subapprox_quantileRef);
+	InstrPtr ai1 = newInstruction(mb, matRef, packRef), r;
+
+	getArg(ai1,0) = newTmpVariable(mb, tp);
+	for(k=1; k<ml->v[b].mi->argc; k++) {
+		r = newInstruction(mb, aggrRef, isQuantile ? subtdigestRef : subhllRef);
+		getArg(r,0) = newTmpVariable(mb, tp);
+		r = pushArgument(mb, r, getArg(ml->v[b].mi,k));
+		if (g >= 0) {
+			r = pushArgument(mb, r, getArg(ml->v[g].mi,k));
+			r = pushArgument(mb, r, getArg(ml->v[e].mi,k));
+		}
+		r = pushBit(mb, r, 1); /* skip nils */
+		pushInstruction(mb,r);
+
+		/* pack the sketches into a mat */
+		ai1 = pushArgument(mb, ai1, getArg(r,0));
+	}
+	pushInstruction(mb, ai1);
+
+	/* the quantile is needed as a whole */
+	if (isQuantile && (q = is_a_mat(getArg(p,2), ml)) >= 0)
+		mat_pack(mb, ml, q);
+
+	if (g >= 0)
+		r = newInstruction(mb, aggrRef, isQuantile ? subtdigestquantileRef : subhllcountRef);
+	else
+		r = newInstruction(mb, aggrRef, isQuantile ? tdigestquantileRef : hllcountRef);
+	getArg(r,0) = getArg(p,0);
+	r = pushArgument(mb, r, getArg(ai1,0));
+	if (isQuantile)
+		r = pushArgument(mb, r, getArg(p,2));
+	if (g >= 0) {
+		r = pushArgument(mb, r, ml->v[g].mv);
+		r = pushArgument(mb, r, ml->v[e].mv);
+		r = pushBit(mb, r, 1); /* skip nils */
+	}
+	pushInstruction(mb, r);
+}
+
 /* The mat_group_{new,derive} keep an ext,attr1..attrn table.
  * This is the input for the final second phase group by.
  */
@@ -1653,6 +1707,28 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 				continue;
 			}
 		}
+		/* approximate aggregates are merged through their sketches */
+		if (getModuleId(p) == aggrRef && p->retc == 1 &&
+		    ((getFunctionId(p) == approx_count_distinctRef && p->argc == 2) ||
+		     (getFunctionId(p) == approx_quantileRef && p->argc == 3)) &&
+		    (m=is_a_mat(getArg(p,1), &ml)) >= 0) {
+			mat_sketch_aggr(mb, p, &ml, m, -1, -1);
+			actions++;
+			continue;
+		}
+		if (getModuleId(p) == aggrRef && p->retc == 1 &&
+		    ((getFunctionId(p) == subapprox_count_distinctRef && p->argc == 5 &&
+		      (m=is_a_mat(getArg(p,1), &ml)) >= 0 &&
+		      (n=is_a_mat(getArg(p,2), &ml)) >= 0 &&
+		      (o=is_a_mat(getArg(p,3), &ml)) >= 0) ||
+		     (getFunctionId(p) == subapprox_quantileRef && p->argc == 6 &&
+		      (m=is_a_mat(getArg(p,1), &ml)) >= 0 &&
+		      (n=is_a_mat(getArg(p,3), &ml)) >= 0 &&
+		      (o=is_a_mat(getArg(p,4), &ml)) >= 0))) {
+			mat_sketch_aggr(mb, p, &ml, m, n, o);
+			actions++;
+			continue;
+		}
 		/*
 		 * Aggregate handling is a prime target for optimization.
 		 * The simple cases are dealt with first.
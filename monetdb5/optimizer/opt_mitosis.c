@@ -65,13 +65,17 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 		    	getFunctionId(p) != subavgRef &&
 		    	getFunctionId(p) != subsumRef &&
 		    	getFunctionId(p) != subprodRef &&
+		    	getFunctionId(p) != subapprox_count_distinctRef &&
+		    	getFunctionId(p) != subapprox_quantileRef &&
 
 		        getFunctionId(p) != countRef &&
 		    	getFunctionId(p) != minRef &&
 		    	getFunctionId(p) != maxRef &&
 		    	getFunctionId(p) != avgRef &&
 		    	getFunctionId(p) != sumRef &&
-		    	getFunctionId(p) != prodRef)
+		    	getFunctionId(p) != prodRef &&
+		    	getFunctionId(p) != approx_count_distinctRef &&
+		    	getFunctionId(p) != approx_quantileRef)
 			return 0;
 
 		if (p->argc > 2 && (getModuleId(p) == rapiRef || getModuleId(p) == pyapiRef || getModuleId(p) == pyapi3Ref) && 
@@ -248,6 +252,7 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 
 			qv = getArg(q, 0) = newTmpVariable(mb, qtpe);
 			setVarUDFtype(mb, qv);
+			setRowCnt(mb, qv, r / pieces);
 			if (upd) {
 				rv = getArg(q, 1) = newTmpVariable(mb, rtpe);
 				setVarUDFtype(mb, rv);
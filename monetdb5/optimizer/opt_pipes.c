@@ -82,6 +82,8 @@ static struct PIPELINES {
 	 "optimizer.deadcode();"
 	 "optimizer.reorder();"
 //	 "optimizer.reduce();" deprecated
+	 "optimizer.groupaggr();"
+	 "optimizer.bloom();"
 	 "optimizer.matpack();"
 	 "optimizer.dataflow();"
 	 "optimizer.querylog();"
@@ -116,6 +118,8 @@ static struct PIPELINES {
 	 "optimizer.deadcode();"
 	 "optimizer.reorder();"
 //	 "optimizer.reduce();" deprecated
+	 "optimizer.groupaggr();"
+	 "optimizer.bloom();"
 	 "optimizer.matpack();"
 	 "optimizer.dataflow();"
 	 "optimizer.querylog();"
@@ -157,6 +161,8 @@ static struct PIPELINES {
 	 "optimizer.reorder();"
 	 "optimizer.deadcode();"
 //	 "optimizer.reduce();" deprecated
+	 "optimizer.groupaggr();"
+	 "optimizer.bloom();"
 	 "optimizer.matpack();"
 	 "optimizer.dataflow();"
 	 "optimizer.querylog();"
@@ -197,6 +203,8 @@ static struct PIPELINES {
 	 "optimizer.reorder();"
 	 "optimizer.deadcode();"
 //	 "optimizer.reduce();" deprecated
+	 "optimizer.groupaggr();"
+	 "optimizer.bloom();"
 	 "optimizer.matpack();"
 	 "optimizer.querylog();"
 	 "optimizer.multiplex();"
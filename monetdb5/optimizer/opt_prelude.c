@@ -39,6 +39,8 @@ str andRef;
 str antijoinRef;
 str appendidxRef;
 str appendRef;
+str approx_count_distinctRef;
+str approx_quantileRef;
 str arrayRef;
 str assertRef;
 str attachRef;
@@ -64,6 +66,7 @@ str binddbatRef;
 str bindidxRef;
 str bindRef;
 str blockRef;
+str bloomselectRef;
 str bpmRef;
 str bstreamRef;
 str calcRef;
@@ -130,11 +133,13 @@ str getTraceRef;
 str grant_functionRef;
 str grantRef;
 str grant_rolesRef;
+str groupaggrRef;
 str groupbyRef;
 str groupdoneRef;
 str groupRef;
 str hashRef;
 str hgeRef;
+str hllcountRef;
 str identityRef;
 str ifthenelseRef;
 str ilikeRef;
@@ -259,6 +264,8 @@ str stopRef;
 str stoptraceRef;
 str streamsRef;
 str strRef;
+str subapprox_count_distinctRef;
+str subapprox_quantileRef;
 str subavgRef;
 str subcountRef;
 str subdeltaRef;
@@ -266,6 +273,8 @@ str subdiffRef;
 str subeval_aggrRef;
 str subgroupdoneRef;
 str subgroupRef;
+str subhllRef;
+str subhllcountRef;
 str subinterRef;
 str submaxRef;
 str submedianRef;
@@ -273,9 +282,12 @@ str subminRef;
 str subprodRef;
 str subsliceRef;
 str subsumRef;
+str subtdigestRef;
+str subtdigestquantileRef;
 str subuniformRef;
 str sumRef;
 str takeRef;
+str tdigestquantileRef;
 str thetajoinRef;
 str thetaselectRef;
 str tidRef;
@@ -339,6 +351,7 @@ void optimizerInit(void)
 	betweenRef = putName("between");
 	betweensymmetricRef = putName("betweensymmetric");
 	blockRef = putName("block");
+	bloomselectRef = putName("bloomselect");
 	bbpRef = putName("bbp");
 	tidRef = putName("tid");
 	deltaRef = putName("delta");
@@ -421,6 +434,7 @@ void optimizerInit(void)
 	subgroupRef = putName("subgroup");
 	subgroupdoneRef= putName("subgroupdone");
 	groupbyRef = putName("groupby");
+	groupaggrRef = putName("groupaggr");
 	hgeRef = putName("hge");
 	hashRef = putName("hash");
 	identityRef = putName("identity");
@@ -497,6 +511,16 @@ void optimizerInit(void)
 	preludeRef = putName("prelude");
 	prodRef = putName("prod");
 	subprodRef = putName("subprod");
+	approx_count_distinctRef = putName("approx_count_distinct");
+	approx_quantileRef = putName("approx_quantile");
+	hllcountRef = putName("hllcount");
+	subapprox_count_distinctRef = putName("subapprox_count_distinct");
+	subapprox_quantileRef = putName("subapprox_quantile");
+	subhllRef = putName("subhll");
+	subhllcountRef = putName("subhllcount");
+	subtdigestRef = putName("subtdigest");
+	subtdigestquantileRef = putName("subtdigestquantile");
+	tdigestquantileRef = putName("tdigestquantile");
 	profilerRef = putName("profiler");
 	postludeRef = putName("postlude");
 	projectRef = putName("project");
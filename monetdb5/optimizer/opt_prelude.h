@@ -37,6 +37,8 @@ mal_export	str andRef;
 mal_export  str antijoinRef;
 mal_export  str appendidxRef;
 mal_export  str appendRef;
+mal_export  str approx_count_distinctRef;
+mal_export  str approx_quantileRef;
 mal_export  str arrayRef;
 mal_export  str assertRef;
 mal_export  str attachRef;
@@ -62,6 +64,7 @@ mal_export  str binddbatRef;
 mal_export  str bindidxRef;
 mal_export  str bindRef;
 mal_export  str blockRef;
+mal_export  str bloomselectRef;
 mal_export  str bpmRef;
 mal_export  str bstreamRef;
 mal_export  str calcRef;
@@ -128,11 +131,13 @@ mal_export  str getTraceRef;
 mal_export  str grant_functionRef;
 mal_export  str grantRef;
 mal_export  str grant_rolesRef;
+mal_export  str groupaggrRef;
 mal_export  str groupbyRef;
 mal_export  str groupdoneRef;
 mal_export  str groupRef;
 mal_export  str hashRef;
 mal_export  str hgeRef;
+mal_export  str hllcountRef;
 mal_export  str identityRef;
 mal_export  str ifthenelseRef;
 mal_export  str ilikeRef;
@@ -259,6 +264,8 @@ mal_export  str stopRef;
 mal_export  str stoptraceRef;
 mal_export  str streamsRef;
 mal_export  str strRef;
+mal_export  str subapprox_count_distinctRef;
+mal_export  str subapprox_quantileRef;
 mal_export  str subavgRef;
 mal_export  str subcountRef;
 mal_export  str subdeltaRef;
@@ -266,6 +273,8 @@ mal_export  str subdiffRef;
 mal_export  str subeval_aggrRef;
 mal_export  str subgroupdoneRef;
 mal_export  str subgroupRef;
+mal_export  str subhllRef;
+mal_export  str subhllcountRef;
 mal_export  str subinterRef;
 mal_export  str submaxRef;
 mal_export  str submedianRef;
@@ -273,9 +282,12 @@ mal_export  str subminRef;
 mal_export  str subprodRef;
 mal_export  str subsliceRef;
 mal_export  str subsumRef;
+mal_export  str subtdigestRef;
+mal_export  str subtdigestquantileRef;
 mal_export  str subuniformRef;
 mal_export  str sumRef;
 mal_export  str takeRef;
+mal_export  str tdigestquantileRef;
 mal_export  str thetajoinRef;
 mal_export  str thetaselectRef;
 mal_export  str tidRef;
@@ -28,6 +28,7 @@ struct OPTcatalog {
 	int actions;
 } optcatalog[]= {
 {"aliases",		0,	0,	0},
+{"bloom",		0,	0,	0},
 {"coercions",	0,	0,	0},
 {"commonTerms",	0,	0,	0},
 {"constants",	0,	0,	0},
@@ -38,6 +39,7 @@ struct OPTcatalog {
 {"evaluate",	0,	0,	0},
 {"garbage",		0,	0,	0},
 {"generator",	0,	0,	0},
+{"groupaggr",	0,	0,	0},
 {"history",		0,	0,	0},
 {"inline",		0,	0,	0},
 {"projectionpath",	0,	0,	0},
@@ -23,6 +23,7 @@
 #include "opt_aliases.h"
 #include "opt_coercion.h"
 #include "opt_commonTerms.h"
+#include "opt_bloom.h"
 #include "opt_candidates.h"
 #include "opt_constants.h"
 #include "opt_costModel.h"
@@ -32,6 +33,7 @@
 #include "opt_evaluate.h"
 #include "opt_garbageCollector.h"
 #include "opt_generator.h"
+#include "opt_groupaggr.h"
 #include "opt_inline.h"
 #include "opt_jit.h"
 #include "opt_projectionpath.h"
@@ -58,6 +60,7 @@ struct{
 	lng timing;
 } codes[] = {
 	{"aliases", &OPTaliasesImplementation,0,0},
+	{"bloom", &OPTbloomImplementation,0,0},
 	{"candidates", &OPTcandidatesImplementation,0,0},
 	{"coercions", &OPTcoercionImplementation,0,0},
 	{"commonTerms", &OPTcommonTermsImplementation,0,0},
@@ -69,6 +72,7 @@ struct{
 	{"evaluate", &OPTevaluateImplementation,0,0},
 	{"garbageCollector", &OPTgarbageCollectorImplementation,0,0},
 	{"generator", &OPTgeneratorImplementation,0,0},
+	{"groupaggr", &OPTgroupaggrImplementation,0,0},
 	{"inline", &OPTinlineImplementation,0,0},
 	{"jit", &OPTjitImplementation,0,0},
 	{"json", &OPTjsonImplementation,0,0},
@@ -3957,6 +3957,83 @@ SQLvacuum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return MAL_SUCCEED;
 }
 
+/*
+ * Compressing a table makes the persistent BATs of its columns and
+ * indices be saved block-compressed (see BATsetdiskcompression), which
+ * takes effect at the next checkpoint.  Only the data that is merged
+ * into those BATs is affected, recent inserts are saved as is.
+ */
+static str
+diskcompression(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, int onoff, const char *name)
+{
+	const char *sch = *getArgReference_str(stk, pci, 1);
+	const char *tbl = *getArgReference_str(stk, pci, 2);
+	sql_trans *tr;
+	sql_schema *s;
+	sql_table *t;
+	mvc *m = NULL;
+	str msg;
+	BAT *b;
+	node *o;
+	bat bid;
+	gdk_return rc;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	s = mvc_bind_schema(m, sch);
+	if (s == NULL)
+		throw(SQL, name, SQLSTATE(3F000) "Schema missing %s",sch);
+	t = mvc_bind_table(m, s, tbl);
+	if (t == NULL)
+		throw(SQL, name, SQLSTATE(42S02) "Table missing %s.%s",sch,tbl);
+
+	if (m->user_id != USER_MONETDB)
+		throw(SQL, name, SQLSTATE(42000) "Insufficient privileges");
+	if (!isTable(t) || t->persistence != SQL_PERSIST)
+		throw(SQL, name, SQLSTATE(42000) "%s only allowed on persistent tables", name + 4);
+
+	tr = m->session->tr;
+	for (o = t->columns.set->h; o; o = o->next) {
+		b = store_funcs.bind_col(tr, o->data, QUICK);
+		if (b == NULL || (b = BATdescriptor(bid = b->batCacheid)) == NULL)
+			throw(SQL, name, SQLSTATE(HY005) "Cannot access column descriptor");
+		rc = BATsetdiskcompression(b, onoff);
+		BBPunfix(bid);
+		if (rc != GDK_SUCCEED)
+			throw(SQL, name, SQLSTATE(HY005) "Cannot %s column", name + 4);
+	}
+	if (t->idxs.set) {
+		for (o = t->idxs.set->h; o; o = o->next) {
+			sql_idx *i = o->data;
+
+			if (!idx_has_column(i->type))
+				continue;
+			b = store_funcs.bind_idx(tr, i, QUICK);
+			if (b == NULL || (b = BATdescriptor(bid = b->batCacheid)) == NULL)
+				throw(SQL, name, SQLSTATE(HY005) "Cannot access index descriptor");
+			rc = BATsetdiskcompression(b, onoff);
+			BBPunfix(bid);
+			if (rc != GDK_SUCCEED)
+				throw(SQL, name, SQLSTATE(HY005) "Cannot %s index", name + 4);
+		}
+	}
+	return MAL_SUCCEED;
+}
+
+str
+SQLcompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	return diskcompression(cntxt, mb, stk, pci, 1, "sql.compress");
+}
+
+str
+SQLdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	return diskcompression(cntxt, mb, stk, pci, 0, "sql.decompress");
+}
+
 /*
  * The drop_hash operation cleans up any hash indices on any of the tables columns.
  */
@@ -185,6 +185,61 @@ SQLsetTrace(Client cntxt, MalBlkPtr mb)
 	chkTypes(cntxt->usermodule, mb, TRUE);
 }
 
+/*
+ * Before the plan is run, all persistent columns it reads are handed
+ * to the background loader, such that the I/O of the columns used
+ * later in the plan overlaps with the work on the first ones.
+ * Only the descriptors are looked up here; no BAT is loaded.
+ */
+static void
+SQLprefetch(mvc *m, MalBlkPtr mb)
+{
+	sql_trans *tr = m->session->tr;
+	int i;
+
+	for (i = 0; i < mb->stop; i++) {
+		InstrPtr p = getInstrPtr(mb, i);
+		char *sname, *tname, *cname;
+		sql_schema *s;
+		BAT *b = NULL;
+
+		if (getModuleId(p) != sqlRef ||
+		    (getFunctionId(p) != bindRef && getFunctionId(p) != bindidxRef) ||
+		    p->retc != 1 || p->argc != 6 ||
+		    !isVarConstant(mb, getArg(p, 2)) ||
+		    !isVarConstant(mb, getArg(p, 3)) ||
+		    !isVarConstant(mb, getArg(p, 4)) ||
+		    !isVarConstant(mb, getArg(p, 5)) ||
+		    getVarConstant(mb, getArg(p, 5)).val.ival != RDONLY)
+			continue;
+		sname = getVarConstant(mb, getArg(p, 2)).val.sval;
+		tname = getVarConstant(mb, getArg(p, 3)).val.sval;
+		cname = getVarConstant(mb, getArg(p, 4)).val.sval;
+		if ((s = mvc_bind_schema(m, sname)) == NULL)
+			continue;
+		if (getFunctionId(p) == bindRef) {
+			sql_table *t = mvc_bind_table(m, s, tname);
+			sql_column *c;
+
+			if (t == NULL || !isTable(t) || isRemote(t) ||
+			    isMergeTable(t) ||
+			    (c = mvc_bind_column(m, t, cname)) == NULL ||
+			    isTemp(c))
+				continue;
+			b = store_funcs.bind_col(tr, c, QUICK);
+		} else {
+			sql_idx *x = mvc_bind_idx(m, s, cname);
+
+			if (x == NULL || !isTable(x->t) || isRemote(x->t) ||
+			    isMergeTable(x->t) || isTemp(x))
+				continue;
+			b = store_funcs.bind_idx(tr, x, QUICK);
+		}
+		if (b)
+			BATprefetch(b->batCacheid);
+	}
+}
+
 /*
  * Execution of the SQL program is delegated to the MALengine.
  * Different cases should be distinguished. The default is to
@@ -255,6 +310,7 @@ SQLexecutePrepared(Client c, backend *be, MalBlkPtr mb)
 		}
 	}
 	glb = (MalStkPtr) (q->stk);
+	SQLprefetch(m, mb);
 	ret = callMAL(c, mb, &glb, argv, (m->emod & mod_debug ? 'n' : 0));
 	/* cleanup the arguments */
 	for (i = pci->retc; i < pci->argc; i++) {
@@ -358,6 +414,7 @@ SQLrun(Client c, backend *be, mvc *m)
 	} else if( m->emod & mod_debug) {
 		msg = runMALDebugger(c, mb);
 	} else {
+		SQLprefetch(m, mb);
 		if( m->emod & mod_trace){
 			SQLsetTrace(c,mb);
 			msg = runMAL(c, mb, 0, 0);
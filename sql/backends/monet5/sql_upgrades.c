@@ -236,7 +236,11 @@ sql_update_hugeint(Client c, mvc *sql)
 			"create aggregate quantile(val HUGEINT, q DOUBLE) returns HUGEINT\n"
 			"    external name \"aggr\".\"quantile\";\n"
 			"create aggregate corr(e1 HUGEINT, e2 HUGEINT) returns HUGEINT\n"
-			"    external name \"aggr\".\"corr\";\n");
+			"    external name \"aggr\".\"corr\";\n"
+			"create aggregate approx_count_distinct(val HUGEINT) returns BIGINT\n"
+			"    external name \"aggr\".\"approx_count_distinct\";\n"
+			"create aggregate approx_quantile(val HUGEINT, q DOUBLE) returns DOUBLE\n"
+			"    external name \"aggr\".\"approx_quantile\";\n");
 
 	/* 40_json_hge.sql */
 	pos += snprintf(buf + pos, bufsize - pos,
@@ -256,7 +260,7 @@ sql_update_hugeint(Client c, mvc *sql)
 			"from sys.storagemodel() group by \"schema\",\"table\";\n");
 
 	pos += snprintf(buf + pos, bufsize - pos,
-			"insert into sys.systemfunctions (select id from sys.functions where name in ('fuse', 'generate_series', 'stddev_samp', 'stddev_pop', 'var_samp', 'var_pop', 'median', 'quantile', 'corr') and schema_id = (select id from sys.schemas where name = 'sys') and id not in (select function_id from sys.systemfunctions));\n"
+			"insert into sys.systemfunctions (select id from sys.functions where name in ('fuse', 'generate_series', 'stddev_samp', 'stddev_pop', 'var_samp', 'var_pop', 'median', 'quantile', 'corr', 'approx_count_distinct', 'approx_quantile') and schema_id = (select id from sys.schemas where name = 'sys') and id not in (select function_id from sys.systemfunctions));\n"
 			"insert into sys.systemfunctions (select id from sys.functions where name = 'filter' and schema_id = (select id from sys.schemas where name = 'json') and id not in (select function_id from sys.systemfunctions));\n"
 			"update sys._tables set system = true where name = 'tablestoragemodel' and schema_id = (select id from sys.schemas where name = 'sys');\n");
 
@@ -275,6 +279,8 @@ sql_update_hugeint(Client c, mvc *sql)
 			"grant execute on aggregate sys.median(hugeint) to public;\n"
 			"grant execute on aggregate sys.quantile(hugeint, double) to public;\n"
 			"grant execute on aggregate sys.corr(hugeint, hugeint) to public;\n"
+			"grant execute on aggregate sys.approx_count_distinct(hugeint) to public;\n"
+			"grant execute on aggregate sys.approx_quantile(hugeint, double) to public;\n"
 			"grant execute on function json.filter(json, hugeint) to public;\n");
 
 	if (schema)
@@ -916,6 +922,99 @@ sql_update_default(Client c, mvc *sql)
 	return err;		/* usually MAL_SUCCEED */
 }
 
+static str
+sql_update_approx(Client c, mvc *sql)
+{
+	size_t bufsize = 10000, pos = 0;
+	char *buf = GDKmalloc(bufsize), *err = NULL;
+	char *schema = stack_get_string(sql, "current_schema");
+	static const char *const types[] = {
+		"tinyint", "smallint", "integer", "bigint", "decimal",
+		"real", "double", "date", "time", "timestamp", "clob",
+#ifdef HAVE_HGE
+		"hugeint",
+#endif
+		NULL,
+	};
+	sql_subtype tp;
+	int i;
+
+	if( buf== NULL)
+		throw(SQL, "sql_update_approx", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	pos += snprintf(buf + pos, bufsize - pos, "set schema \"sys\";\n");
+
+	/* 39_analytics.sql and 39_analytics_hge.sql */
+	for (i = 0; types[i]; i++) {
+		int quantile = strcmp(types[i], "tinyint") == 0 ||
+			strcmp(types[i], "smallint") == 0 ||
+			strcmp(types[i], "integer") == 0 ||
+			strcmp(types[i], "bigint") == 0 ||
+			strcmp(types[i], "real") == 0 ||
+			strcmp(types[i], "double") == 0;
+#ifdef HAVE_HGE
+		if (strcmp(types[i], "hugeint") == 0) {
+			/* created by sql_update_hugeint if the
+			 * database is converted to hugeint support */
+			sql_find_subtype(&tp, "hugeint", 0, 0);
+			if (!have_hge || sql_bind_aggr(sql->sa, mvc_bind_schema(sql, "sys"), "approx_count_distinct", &tp))
+				continue;
+			quantile = 1;
+		}
+#endif
+		pos += snprintf(buf + pos, bufsize - pos,
+				"create aggregate approx_count_distinct(val %s) returns BIGINT\n"
+				"    external name \"aggr\".\"approx_count_distinct\";\n"
+				"grant execute on aggregate approx_count_distinct(%s) to public;\n",
+				types[i], types[i]);
+		if (quantile)
+			pos += snprintf(buf + pos, bufsize - pos,
+					"create aggregate approx_quantile(val %s, q DOUBLE) returns DOUBLE\n"
+					"    external name \"aggr\".\"approx_quantile\";\n"
+					"grant execute on aggregate approx_quantile(%s, double) to public;\n",
+					types[i], types[i]);
+	}
+	pos += snprintf(buf + pos, bufsize - pos,
+			"insert into sys.systemfunctions (select id from sys.functions where name in ('approx_count_distinct', 'approx_quantile') and schema_id = (select id from sys.schemas where name = 'sys') and id not in (select function_id from sys.systemfunctions));\n");
+
+	if (schema)
+		pos += snprintf(buf + pos, bufsize - pos, "set schema \"%s\";\n", schema);
+
+	assert(pos < bufsize);
+	printf("Running database upgrade commands:\n%s\n", buf);
+	err = SQLstatementIntern(c, &buf, "update", 1, 0, NULL);
+	GDKfree(buf);
+	return err;		/* usually MAL_SUCCEED */
+}
+
+static str
+sql_update_compress(Client c, mvc *sql)
+{
+	size_t bufsize = 1000, pos = 0;
+	char *buf = GDKmalloc(bufsize), *err = NULL;
+	char *schema = stack_get_string(sql, "current_schema");
+
+	if( buf== NULL)
+		throw(SQL, "sql_update_compress", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	pos += snprintf(buf + pos, bufsize - pos, "set schema \"sys\";\n");
+
+	/* 20_vacuum.sql */
+	pos += snprintf(buf + pos, bufsize - pos,
+			"create procedure compress(sys string, tab string)\n"
+			"external name sql.compress;\n"
+			"create procedure decompress(sys string, tab string)\n"
+			"external name sql.decompress;\n"
+			"insert into sys.systemfunctions (select id from sys.functions where name in ('compress', 'decompress') and schema_id = (select id from sys.schemas where name = 'sys') and id not in (select function_id from sys.systemfunctions));\n");
+
+	if (schema)
+		pos += snprintf(buf + pos, bufsize - pos, "set schema \"%s\";\n", schema);
+
+	assert(pos < bufsize);
+	printf("Running database upgrade commands:\n%s\n", buf);
+	err = SQLstatementIntern(c, &buf, "update", 1, 0, NULL);
+	GDKfree(buf);
+	return err;		/* usually MAL_SUCCEED */
+}
+
 static str
 sql_update_default_geom(Client c, mvc *sql, sql_table *t)
 {
@@ -1066,6 +1165,22 @@ SQLupgrades(Client c, mvc *m)
 		}
 	}
 
+	sql_find_subtype(&tp, "int", 0, 0);
+	if (!sql_bind_aggr(m->sa, s, "approx_count_distinct", &tp)) {
+		if ((err = sql_update_approx(c, m)) != NULL) {
+			fprintf(stderr, "!%s\n", err);
+			freeException(err);
+		}
+	}
+
+	sql_find_subtype(&tp, "clob", 0, 0);
+	if (!sql_bind_func(m->sa, s, "compress", &tp, &tp, F_PROC)) {
+		if ((err = sql_update_compress(c, m)) != NULL) {
+			fprintf(stderr, "!%s\n", err);
+			freeException(err);
+		}
+	}
+
 	if ((t = mvc_bind_table(m, s, "geometry_columns")) != NULL &&
 	    (col = mvc_bind_column(m, t, "coord_dimension")) != NULL &&
 	    strcmp(col->type.type->sqlname, "int") != 0) {
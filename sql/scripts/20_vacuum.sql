@@ -20,3 +20,12 @@ create procedure reuse(sys string, tab string)
 create procedure vacuum(sys string, tab string)
 	external name sql.vacuum;
 
+-- Compressing a table saves its columns block-compressed on disk,
+-- which reduces their footprint and the I/O to read them in, at the
+-- expense of decompressing them when they are loaded.
+
+create procedure compress(sys string, tab string)
+	external name sql.compress;
+
+create procedure decompress(sys string, tab string)
+	external name sql.decompress;
@@ -203,3 +203,57 @@ GRANT EXECUTE ON AGGREGATE corr(REAL, REAL) TO PUBLIC;
 create aggregate corr(e1 DOUBLE, e2 DOUBLE) returns DOUBLE
 	external name "aggr"."corr";
 GRANT EXECUTE ON AGGREGATE corr(DOUBLE, DOUBLE) TO PUBLIC;
+
+create aggregate approx_count_distinct(val TINYINT) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(TINYINT) TO PUBLIC;
+create aggregate approx_count_distinct(val SMALLINT) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(SMALLINT) TO PUBLIC;
+create aggregate approx_count_distinct(val INTEGER) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(INTEGER) TO PUBLIC;
+create aggregate approx_count_distinct(val BIGINT) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(BIGINT) TO PUBLIC;
+create aggregate approx_count_distinct(val DECIMAL) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(DECIMAL) TO PUBLIC;
+create aggregate approx_count_distinct(val REAL) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(REAL) TO PUBLIC;
+create aggregate approx_count_distinct(val DOUBLE) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(DOUBLE) TO PUBLIC;
+
+create aggregate approx_count_distinct(val DATE) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(DATE) TO PUBLIC;
+create aggregate approx_count_distinct(val TIME) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(TIME) TO PUBLIC;
+create aggregate approx_count_distinct(val TIMESTAMP) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(TIMESTAMP) TO PUBLIC;
+create aggregate approx_count_distinct(val CLOB) returns BIGINT
+	external name "aggr"."approx_count_distinct";
+GRANT EXECUTE ON AGGREGATE approx_count_distinct(CLOB) TO PUBLIC;
+
+create aggregate approx_quantile(val TINYINT, q DOUBLE) returns DOUBLE
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(TINYINT, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val SMALLINT, q DOUBLE) returns DOUBLE
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(SMALLINT, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val INTEGER, q DOUBLE) returns DOUBLE
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(INTEGER, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val BIGINT, q DOUBLE) returns DOUBLE
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(BIGINT, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val REAL, q DOUBLE) returns DOUBLE
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(REAL, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val DOUBLE, q DOUBLE) returns DOUBLE
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(DOUBLE, DOUBLE) TO PUBLIC;
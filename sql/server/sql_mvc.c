@@ -298,6 +298,7 @@ mvc_commit(mvc *m, int chain, const char *name)
 {
 	sql_trans *cur, *tr = m->session->tr, *ctr;
 	int ok = SQL_OK;//, wait = 0;
+	lng commitnr = 0;
 
 	assert(tr);
 	assert(m->session->active);	/* only commit an active transaction */
@@ -376,7 +377,7 @@ build up the hash (not copied in the trans dup)) */
 	 * */
 	/* validation phase */
 	if (sql_trans_validate(tr)) {
-		if ((ok = sql_trans_commit(tr)) != SQL_OK) {
+		if ((ok = sql_trans_commit_nosync(tr, &commitnr)) != SQL_OK) {
 			char *msg = sql_message(SQLSTATE(40000) "COMMIT: transaction commit failed (perhaps your disk is full?) exiting (kernel error: %s)", GDKerrbuf);
 			GDKfatal("%s", msg);
 			_DELETE(msg);
@@ -392,6 +393,13 @@ build up the hash (not copied in the trans dup)) */
 	if (chain) 
 		sql_trans_begin(m->session);
 	store_unlock();
+	/* the commit is only done once it is on disk; syncing
+	 * outside the store lock lets concurrent commits share it */
+	if (store_sync(commitnr) != LOG_OK) {
+		char *msg = sql_message(SQLSTATE(40000) "COMMIT: transaction commit failed (perhaps your disk is full?) exiting (kernel error: %s)", GDKerrbuf);
+		GDKfatal("%s", msg);
+		_DELETE(msg);
+	}
 	m->type = Q_TRANS;
 	if (mvc_debug)
 		fprintf(stderr, "#mvc_commit %s done\n", (name) ? name : "");
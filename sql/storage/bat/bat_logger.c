@@ -222,6 +222,8 @@ bl_destroy(void)
 	bat_logger = NULL;
 	if (l) {
 		close_stream(l->log);
+		MT_lock_destroy(&l->synclock);
+		MT_lock_destroy(&l->flushlock);
 		GDKfree(l->fn);
 		GDKfree(l->dir);
 		GDKfree(l->local_dir);
@@ -330,6 +332,18 @@ bl_tend(void)
 	return log_tend(bat_logger) == GDK_SUCCEED ? LOG_OK : LOG_ERR;
 }
 
+static int 
+bl_tflush(lng *commitnr)
+{
+	return log_tflush(bat_logger, commitnr) == GDK_SUCCEED ? LOG_OK : LOG_ERR;
+}
+
+static int 
+bl_tsync(lng commitnr)
+{
+	return log_tsync(bat_logger, commitnr) == GDK_SUCCEED ? LOG_OK : LOG_ERR;
+}
+
 static int 
 bl_sequence(int seq, lng id)
 {
@@ -354,6 +368,8 @@ bat_logger_init( logger_functions *lf )
 	lf->log_isnew = bl_log_isnew;
 	lf->log_tstart = bl_tstart;
 	lf->log_tend = bl_tend;
+	lf->log_tflush = bl_tflush;
+	lf->log_tsync = bl_tsync;
 	lf->log_sequence = bl_sequence;
 }
 
@@ -289,6 +289,8 @@ typedef int (*logger_reload_fptr) (void);
 typedef int (*log_isnew_fptr)(void);
 typedef int (*log_tstart_fptr) (void);
 typedef int (*log_tend_fptr) (void);
+typedef int (*log_tflush_fptr) (lng *commitnr);
+typedef int (*log_tsync_fptr) (lng commitnr);
 typedef int (*log_sequence_fptr) (int seq, lng id);
 
 typedef struct logger_functions {
@@ -308,6 +310,8 @@ typedef struct logger_functions {
 	log_isnew_fptr log_isnew;
 	log_tstart_fptr log_tstart;
 	log_tend_fptr log_tend;
+	log_tflush_fptr log_tflush;
+	log_tsync_fptr log_tsync;
 	log_sequence_fptr log_sequence;
 } logger_functions;
 
@@ -334,12 +338,14 @@ extern void idle_manager(void);
 
 extern void store_lock(void);
 extern void store_unlock(void);
+extern int store_sync(lng commitnr);
 extern int store_next_oid(void);
 
 extern sql_trans *sql_trans_create(backend_stack stk, sql_trans *parent, const char *name);
 extern sql_trans *sql_trans_destroy(sql_trans *tr);
 extern int sql_trans_validate(sql_trans *tr);
 extern int sql_trans_commit(sql_trans *tr);
+extern int sql_trans_commit_nosync(sql_trans *tr, lng *commitnr);
 
 extern sql_type *sql_trans_create_type(sql_trans *tr, sql_schema * s, const char *sqlname, int digits, int scale, int radix, const char *impl);
 extern int sql_trans_drop_type(sql_trans *tr, sql_schema * s, int id, int drop_action);
@@ -1560,7 +1560,8 @@ int
 store_init(int debug, store_type store, int readonly, int singleuser, logger_settings *log_settings, backend_stack stk)
 {
 
-	int v = 1;
+	int v = 1, first;
+	lng t0;
 
 	backend_stk = stk;
 	logger_debug = debug;
@@ -1595,11 +1596,14 @@ store_init(int debug, store_type store, int readonly, int singleuser, logger_set
 		}
 	}
 	active_store_type = store;
+	t0 = GDKusec();
 	if (!logger_funcs.create ||
 	    logger_funcs.create(debug, log_settings->logdir, CATALOG_VERSION*v, keep_persisted_log_files) != LOG_OK) {
 		MT_lock_unset(&bs_lock);
 		return -1;
 	}
+	/* opening the logger replays the write-ahead log */
+	GDKstartupphase("logger", GDKusec() - t0);
 
 	if (create_shared_logger) {
 		/* create a read-only logger for the shared directory */
@@ -1614,7 +1618,10 @@ store_init(int debug, store_type store, int readonly, int singleuser, logger_set
 
 	/* create the initial store structure or re-load previous data */
 	MT_lock_unset(&bs_lock);
-	return store_load();
+	t0 = GDKusec();
+	first = store_load();
+	GDKstartupphase("catalog", GDKusec() - t0);
+	return first;
 }
 
 static int logging = 0;
@@ -1874,6 +1881,16 @@ store_unlock(void)
 	MT_lock_unset(&bs_lock);
 }
 
+/* wait until the transaction committed with sql_trans_commit_nosync
+ * is on disk; must be called without holding the store lock */
+int
+store_sync(lng commitnr)
+{
+	if (commitnr == 0)
+		return LOG_OK;
+	return logger_funcs.log_tsync(commitnr);
+}
+
 static sql_kc *
 kc_dup_(sql_trans *tr, int flag, sql_kc *kc, sql_table *t, int copy)
 {
@@ -3510,8 +3527,8 @@ catalog_corrupt( sql_trans *tr )
 }
 #endif /*CAT_DEBUG*/
 
-int
-sql_trans_commit(sql_trans *tr)
+static int
+trans_commit(sql_trans *tr, lng *commitnr)
 {
 	int ok = LOG_OK;
 
@@ -3530,7 +3547,7 @@ sql_trans_commit(sql_trans *tr)
 			ok = logger_funcs.log_sequence(OBJ_SID, store_oid);
 		prev_oid = store_oid;
 		if (ok == LOG_OK)
-			ok = logger_funcs.log_tend();
+			ok = commitnr ? logger_funcs.log_tflush(commitnr) : logger_funcs.log_tend();
 		tr->schema_number = store_schema_number();
 	}
 	if (ok == LOG_OK) {
@@ -3543,6 +3560,23 @@ sql_trans_commit(sql_trans *tr)
 	return (ok==LOG_OK)?SQL_OK:SQL_ERR;
 }
 
+int
+sql_trans_commit(sql_trans *tr)
+{
+	return trans_commit(tr, NULL);
+}
+
+/* Commit tr without waiting for the log to reach the disk.  The
+ * caller must release the store lock and call store_sync(*commitnr)
+ * before it reports the commit, so that concurrent commits share a
+ * single sync of the log (group commit). */
+int
+sql_trans_commit_nosync(sql_trans *tr, lng *commitnr)
+{
+	*commitnr = 0;
+	return trans_commit(tr, commitnr);
+}
+
 
 static void
 sql_trans_drop_all_dependencies(sql_trans *tr, sql_schema *s, int id, short type)